@@ -35,6 +35,14 @@ extern "C" {
 #include "net/if.h"
 #endif
 
+/**
+ * @brief   Number of receive buffers lent to the network stack with the
+ *          `netdev_recv_loan` module, at most 8
+ */
+#ifndef CONFIG_NETDEV_TAP_RX_BUF_NUMOF
+#define CONFIG_NETDEV_TAP_RX_BUF_NUMOF  (4U)
+#endif
+
 /**
  * @brief tap interface state
  */
@@ -44,6 +52,13 @@ typedef struct netdev_tap {
     int tap_fd;                         /**< host file descriptor for the TAP */
     uint8_t addr[ETHERNET_ADDR_LEN];    /**< The MAC address of the TAP */
     uint8_t promiscuous;                 /**< Flag for promiscuous mode */
+#if defined(MODULE_NETDEV_RECV_LOAN) || defined(DOXYGEN)
+    /**
+     * @brief   Receive buffers lent to the network stack
+     */
+    uint8_t rx_buf[CONFIG_NETDEV_TAP_RX_BUF_NUMOF][ETHERNET_FRAME_LEN];
+    uint8_t rx_lent;                    /**< Lent receive buffers, a bit each */
+#endif
 } netdev_tap_t;
 
 /**
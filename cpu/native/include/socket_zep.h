@@ -31,6 +31,14 @@
 extern "C" {
 #endif
 
+/**
+ * @brief   Number of receive buffers lent to the network stack with the
+ *          `netdev_recv_loan` module, at most 8
+ */
+#ifndef CONFIG_SOCKET_ZEP_RX_BUF_NUMOF
+#define CONFIG_SOCKET_ZEP_RX_BUF_NUMOF  (4U)
+#endif
+
 /**
  * @brief   ZEP device state
  */
@@ -48,6 +56,14 @@ typedef struct {
      */
     uint8_t snd_hdr_buf[sizeof(zep_v2_data_hdr_t)];
     uint16_t chksum_buf;            /**< buffer for send checksum calculation */
+#if defined(MODULE_NETDEV_RECV_LOAN) || defined(DOXYGEN)
+    /**
+     * @brief   Receive buffers lent to the network stack
+     */
+    uint8_t rx_buf[CONFIG_SOCKET_ZEP_RX_BUF_NUMOF][sizeof(zep_v2_data_hdr_t) +
+                                                   IEEE802154_FRAME_LEN_MAX];
+    uint8_t rx_lent;                /**< Lent receive buffers, a bit each */
+#endif
 } socket_zep_t;
 
 /**
@@ -53,6 +53,7 @@
 #include "async_read.h"
 
 #include "iolist.h"
+#include "irq.h"
 #include "net/eui64.h"
 #include "net/netdev.h"
 #include "net/netdev/eth.h"
@@ -68,6 +69,10 @@
 static int _init(netdev_t *netdev);
 static int _send(netdev_t *netdev, const iolist_t *iolist);
 static int _recv(netdev_t *netdev, void *buf, size_t n, void *info);
+#ifdef MODULE_NETDEV_RECV_LOAN
+static int _recv_loan(netdev_t *netdev, void **buf, void *info);
+static void _recv_release(netdev_t *netdev, void *buf);
+#endif
 
 static inline void _get_mac_addr(netdev_t *netdev, uint8_t *dst)
 {
@@ -158,6 +163,10 @@ static int _set(netdev_t *dev, netopt_t opt, const void *value, size_t value_len
 static const netdev_driver_t netdev_driver_tap = {
     .send = _send,
     .recv = _recv,
+#ifdef MODULE_NETDEV_RECV_LOAN
+    .recv_loan = _recv_loan,
+    .recv_release = _recv_release,
+#endif
     .init = _init,
     .isr = _isr,
     .get = _get,
@@ -273,6 +282,48 @@ static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
     return -1;
 }
 
+#ifdef MODULE_NETDEV_RECV_LOAN
+static_assert(CONFIG_NETDEV_TAP_RX_BUF_NUMOF <= 8,
+              "netdev_tap: rx_lent has a bit for 8 buffers at most");
+
+static int _recv_loan(netdev_t *netdev, void **buf, void *info)
+{
+    netdev_tap_t *dev = (netdev_tap_t*)netdev;
+    unsigned i;
+
+    for (i = 0; i < CONFIG_NETDEV_TAP_RX_BUF_NUMOF; i++) {
+        if (!(dev->rx_lent & (1U << i))) {
+            break;
+        }
+    }
+    if (i == CONFIG_NETDEV_TAP_RX_BUF_NUMOF) {
+        DEBUG("netdev_tap: all receive buffers lent\n");
+        return -ENOBUFS;
+    }
+
+    int nread = _recv(netdev, dev->rx_buf[i], ETHERNET_FRAME_LEN, info);
+    if (nread > 0) {
+        /* buffers are given back from other threads */
+        unsigned state = irq_disable();
+        dev->rx_lent |= (1U << i);
+        irq_restore(state);
+        *buf = dev->rx_buf[i];
+    }
+    return nread;
+}
+
+static void _recv_release(netdev_t *netdev, void *buf)
+{
+    netdev_tap_t *dev = (netdev_tap_t*)netdev;
+    unsigned i = ((uint8_t *)buf - dev->rx_buf[0]) / ETHERNET_FRAME_LEN;
+
+    assert(i < CONFIG_NETDEV_TAP_RX_BUF_NUMOF);
+    unsigned state = irq_disable();
+    dev->rx_lent &= ~(1U << i);
+    irq_restore(state);
+}
+#endif
+
 static int _send(netdev_t *netdev, const iolist_t *iolist)
 {
     netdev_tap_t *dev = (netdev_tap_t*)netdev;
@@ -27,6 +27,7 @@
 #include "async_read.h"
 #include "byteorder.h"
 #include "checksum/ucrc16.h"
+#include "irq.h"
 #include "native_internal.h"
 #include "random.h"
 
@@ -174,6 +175,76 @@ static inline bool _dst_not_me(socket_zep_t *dev, const void *buf)
     }
 }
 
+/* Reads a ZEP packet into rcv_buf, which is of the size of dev->rcv_buf, and
+ * copies its frame to buf unless that already points to the frame in rcv_buf.
+ * With buf NULL the frame is dropped and info is left untouched */
+static int _read_frame(socket_zep_t *dev, uint8_t *rcv_buf, void *buf,
+                       size_t len, void *info)
+{
+    int size = real_read(dev->sock_fd, rcv_buf, sizeof(dev->rcv_buf));
+
+    if (size > 0) {
+        zep_hdr_t *tmp = (zep_hdr_t *)rcv_buf;
+
+        if ((tmp->preamble[0] != 'E') || (tmp->preamble[1] != 'X')) {
+            DEBUG("socket_zep::recv: invalid ZEP header");
+            return -1;
+        }
+        switch (tmp->version) {
+            case 2: {
+                zep_v2_data_hdr_t *zep = (zep_v2_data_hdr_t *)tmp;
+                void *payload = &rcv_buf[sizeof(zep_v2_data_hdr_t)];
+
+                if (zep->type != ZEP_V2_TYPE_DATA) {
+                    DEBUG("socket_zep::recv: unexpected ZEP type\n");
+                    /* don't support ACK frames for now*/
+                    return -1;
+                }
+                if (((sizeof(zep_v2_data_hdr_t) + zep->length) != (unsigned)size) ||
+                    (zep->length > len) || (zep->chan != dev->netdev.chan) ||
+                    /* TODO promiscuous mode */
+                    _dst_not_me(dev, payload)) {
+                    /* TODO: check checksum */
+                    return -1;
+                }
+                /* don't hand FCS to stack */
+                size = zep->length - sizeof(uint16_t);
+                if (buf != NULL) {
+                    if (buf != payload) {
+                        memcpy(buf, payload, size);
+                    }
+                    if (info != NULL) {
+                        struct netdev_radio_rx_info *rx_info = info;
+                        rx_info->lqi = zep->lqi_val;
+                        rx_info->rssi = UINT8_MAX;
+                    }
+                }
+                break;
+            }
+            default:
+                DEBUG("socket_zep::recv: unexpected ZEP version\n");
+                return -1;
+        }
+    }
+    else if (size == 0) {
+        DEBUG("socket_zep::recv: ignoring null-event\n");
+        return -1;
+    }
+    else if (size == -1) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        }
+        else {
+            err(EXIT_FAILURE, "zep: read");
+        }
+    }
+    else {
+        errx(EXIT_FAILURE, "internal error _rx_event");
+    }
+    _continue_reading(dev);
+
+    return size;
+}
+
 static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
 {
     socket_zep_t *dev = (socket_zep_t *)netdev;
@@ -193,70 +264,53 @@ static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
 #endif
         return size;
     }
-    else if (len > 0) {
-        size = real_read(dev->sock_fd, dev->rcv_buf, sizeof(dev->rcv_buf));
+    return _read_frame(dev, dev->rcv_buf, buf, len, info);
+}
 
-        if (size > 0) {
-            zep_hdr_t *tmp = (zep_hdr_t *)&dev->rcv_buf;
+#ifdef MODULE_NETDEV_RECV_LOAN
+static_assert(CONFIG_SOCKET_ZEP_RX_BUF_NUMOF <= 8,
+              "socket_zep: rx_lent has a bit for 8 buffers at most");
 
-            if ((tmp->preamble[0] != 'E') || (tmp->preamble[1] != 'X')) {
-                DEBUG("socket_zep::recv: invalid ZEP header");
-                return -1;
-            }
-            switch (tmp->version) {
-                case 2: {
-                    zep_v2_data_hdr_t *zep = (zep_v2_data_hdr_t *)tmp;
-                    void *payload = &dev->rcv_buf[sizeof(zep_v2_data_hdr_t)];
-
-                    if (zep->type != ZEP_V2_TYPE_DATA) {
-                        DEBUG("socket_zep::recv: unexpected ZEP type\n");
-                        /* don't support ACK frames for now*/
-                        return -1;
-                    }
-                    if (((sizeof(zep_v2_data_hdr_t) + zep->length) != (unsigned)size) ||
-                        (zep->length > len) || (zep->chan != dev->netdev.chan) ||
-                        /* TODO promiscuous mode */
-                        _dst_not_me(dev, payload)) {
-                        /* TODO: check checksum */
-                        return -1;
-                    }
-                    /* don't hand FCS to stack */
-                    size = zep->length - sizeof(uint16_t);
-                    if (buf != NULL) {
-                        memcpy(buf, payload, size);
-                        if (info != NULL) {
-                            struct netdev_radio_rx_info *rx_info = info;
-                            rx_info->lqi = zep->lqi_val;
-                            rx_info->rssi = UINT8_MAX;
-                        }
-                    }
-                    break;
-                }
-                default:
-                    DEBUG("socket_zep::recv: unexpected ZEP version\n");
-                    return -1;
-            }
-        }
-        else if (size == 0) {
-            DEBUG("socket_zep::recv: ignoring null-event\n");
-            return -1;
-        }
-        else if (size == -1) {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-            }
-            else {
-                err(EXIT_FAILURE, "zep: read");
-            }
-        }
-        else {
-            errx(EXIT_FAILURE, "internal error _rx_event");
+static int _recv_loan(netdev_t *netdev, void **buf, void *info)
+{
+    socket_zep_t *dev = (socket_zep_t *)netdev;
+    unsigned i;
+
+    for (i = 0; i < CONFIG_SOCKET_ZEP_RX_BUF_NUMOF; i++) {
+        if (!(dev->rx_lent & (1U << i))) {
+            break;
         }
     }
-    _continue_reading(dev);
+    if (i == CONFIG_SOCKET_ZEP_RX_BUF_NUMOF) {
+        DEBUG("socket_zep::recv_loan: all receive buffers lent\n");
+        return -ENOBUFS;
+    }
 
+    uint8_t *frame = &dev->rx_buf[i][sizeof(zep_v2_data_hdr_t)];
+    int size = _read_frame(dev, dev->rx_buf[i], frame,
+                           IEEE802154_FRAME_LEN_MAX, info);
+    if (size > 0) {
+        /* buffers are given back from other threads */
+        unsigned state = irq_disable();
+        dev->rx_lent |= (1U << i);
+        irq_restore(state);
+        *buf = frame;
+    }
     return size;
 }
 
+static void _recv_release(netdev_t *netdev, void *buf)
+{
+    socket_zep_t *dev = (socket_zep_t *)netdev;
+    unsigned i = ((uint8_t *)buf - dev->rx_buf[0]) / sizeof(dev->rx_buf[0]);
+
+    assert(i < CONFIG_SOCKET_ZEP_RX_BUF_NUMOF);
+    unsigned state = irq_disable();
+    dev->rx_lent &= ~(1U << i);
+    irq_restore(state);
+}
+#endif
+
 static void _isr(netdev_t *netdev)
 {
     if (netdev->event_callback) {
@@ -316,6 +370,10 @@ static int _set(netdev_t *netdev, netopt_t opt, const void *value,
 static const netdev_driver_t socket_zep_driver = {
     .send = _send,
     .recv = _recv,
+#ifdef MODULE_NETDEV_RECV_LOAN
+    .recv_loan = _recv_loan,
+    .recv_release = _recv_release,
+#endif
     .init = _init,
     .isr = _isr,
     .get = _get,
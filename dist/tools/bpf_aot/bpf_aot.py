@@ -0,0 +1,369 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2020 Inria
+# Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+"""Translate eBPF application bytecode into a C function.
+
+The generated function mirrors the semantics of sys/bpf/jumptable.c
+instruction by instruction and is executed through bpf_execute() by setting
+bpf_t::native.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+INSTRUCTION_SIZE = 8
+
+OPCODE_LDDW = 0x18
+OPCODE_JA = 0x05
+OPCODE_CALL = 0x85
+OPCODE_RETURN = 0x95
+
+CALL_PSEUDO = 0x1
+FUNC_BPF_TAIL_CALL = 0x2
+
+ALU_OPS = {
+    0x00: '+', 0x10: '-', 0x20: '*', 0x30: '/', 0x40: '|', 0x50: '&',
+    0x60: '<<', 0x70: '>>', 0x90: '%', 0xa0: '^',
+}
+
+JMP_OPS = {
+    0x10: ('uint64_t', '=='), 0x20: ('uint64_t', '>'),
+    0x30: ('uint64_t', '>='), 0xa0: ('uint64_t', '<'),
+    0xb0: ('uint64_t', '<='), 0x40: ('uint64_t', '&'),
+    0x50: ('uint64_t', '!='), 0x60: ('int64_t', '>'),
+    0x70: ('int64_t', '>='), 0xc0: ('int64_t', '<'),
+    0xd0: ('int64_t', '<='),
+}
+
+MEM_SIZES = {0x10: 'uint8_t', 0x08: 'uint16_t', 0x00: 'uint32_t',
+             0x18: 'uint64_t'}
+MEM_LDX = 0x61
+MEM_ST = 0x62
+MEM_STX = 0x63
+
+CLS_ALU32_IMM = 0x04
+CLS_ALU64_IMM = 0x07
+CLS_ALU32_REG = 0x0c
+CLS_ALU64_REG = 0x0f
+
+C_HEADER = """/* This file was automatically generated by bpf_aot.
+ * !!!! DO NOT EDIT !!!!!
+ */
+
+"""
+
+
+class TranslationError(Exception):
+    pass
+
+
+class Instruction:
+    def __init__(self, raw):
+        self.opcode, regs, self.offset, self.imm = struct.unpack('<BBhi', raw)
+        self.dst = regs & 0x0f
+        self.src = regs >> 4
+
+
+def _imm(value):
+    """Immediates keep their int32_t type, as in the interpreter"""
+    return 'INT32_C({})'.format(value)
+
+
+def _u64(value):
+    return 'UINT64_C(0x{:x})'.format(value & 0xffffffffffffffff)
+
+
+class Translator:
+    def __init__(self, name, code, unchecked=False):
+        if not code or len(code) % INSTRUCTION_SIZE:
+            raise TranslationError('application length is not a multiple of '
+                                   'the instruction size')
+        self.name = name
+        self.unchecked = unchecked
+        self.instrs = [Instruction(code[i:i + INSTRUCTION_SIZE])
+                       for i in range(0, len(code), INSTRUCTION_SIZE)]
+        if self.instrs[-1].opcode != OPCODE_RETURN:
+            raise TranslationError('application does not end with a return '
+                                   'instruction')
+        self.targets = set()
+        self.errors = set()
+
+    def _is_jump(self, instr):
+        if instr.opcode == OPCODE_JA:
+            return True
+        return ((instr.opcode & 0x0f) in (0x05, 0x0d) and
+                (instr.opcode & 0xf0) in JMP_OPS)
+
+    def _find_targets(self):
+        pc = 0
+        while pc < len(self.instrs):
+            instr = self.instrs[pc]
+            if instr.opcode == OPCODE_LDDW:
+                if pc + 1 >= len(self.instrs):
+                    raise TranslationError('truncated lddw at {}'.format(pc))
+                pc += 2
+                continue
+            if self._is_jump(instr):
+                target = pc + instr.offset + 1
+                if not 1 <= target < len(self.instrs):
+                    raise TranslationError('jump out of bounds at {}'
+                                           .format(pc))
+                self.targets.add(target)
+            pc += 1
+
+    def _error(self, label):
+        self.errors.add(label)
+        return 'goto {};'.format(label)
+
+    def _alu(self, instr):
+        op = instr.opcode & 0xf0
+        cls = instr.opcode & 0x0f
+        dst = 'r{}'.format(instr.dst)
+        if cls in (CLS_ALU64_REG, CLS_ALU32_REG):
+            src = 'r{}'.format(instr.src)
+        else:
+            src = _imm(instr.imm)
+        alu32 = cls in (CLS_ALU32_IMM, CLS_ALU32_REG)
+
+        if op in (0x30, 0x90) and cls in (CLS_ALU32_IMM, CLS_ALU64_IMM) \
+                and instr.imm == 0:
+            raise TranslationError('division by zero')
+
+        if op == 0x80:
+            if cls == CLS_ALU64_REG:
+                return '{0} = -(int64_t){0};'.format(dst)
+            if cls == CLS_ALU32_REG:
+                return '{0} = (int32_t){0};'.format(dst)
+            return None
+        if op == 0xb0:
+            if alu32:
+                return '{} = (uint32_t){};'.format(dst, src)
+            return '{} = {};'.format(dst, src)
+        if op == 0xc0:
+            if alu32:
+                return '{0} = (int32_t){0} >> {1};'.format(dst, src)
+            return '{0} = (uint64_t)((int64_t){0} >> {1});'.format(dst, src)
+        if op not in ALU_OPS:
+            return None
+        if alu32:
+            return '{0} = (uint32_t){0} {1} (uint32_t){2};'.format(
+                dst, ALU_OPS[op], src)
+        return '{0} = {0} {1} {2};'.format(dst, ALU_OPS[op], src)
+
+    def _jump(self, pc, instr):
+        label = 'L{}'.format(pc + instr.offset + 1)
+        if instr.opcode == OPCODE_JA:
+            return 'goto {};'.format(label)
+        ctype, cmp_op = JMP_OPS[instr.opcode & 0xf0]
+        if instr.opcode & 0x08:
+            src = 'r{}'.format(instr.src)
+        else:
+            src = _imm(instr.imm)
+        if ctype == 'int64_t':
+            return 'if ((int64_t)r{} {} (int64_t){}) {{ goto {}; }}'.format(
+                instr.dst, cmp_op, src, label)
+        return 'if (r{} {} (uint64_t){}) {{ goto {}; }}'.format(
+            instr.dst, cmp_op, src, label)
+
+    def _mem(self, instr):
+        size = MEM_SIZES.get(instr.opcode & 0x18)
+        base = instr.opcode & ~0x18 & 0xff
+        if base in (MEM_LDX, MEM_STX, MEM_ST) and not self.unchecked:
+            self.errors.add('mem_error')
+        if base == MEM_LDX:
+            return 'BPF_AOT_LOAD({}, r{}, r{} + ({}));'.format(
+                size, instr.dst, instr.src, instr.offset)
+        if base == MEM_STX:
+            return 'BPF_AOT_STORE({}, r{} + ({}), r{});'.format(
+                size, instr.dst, instr.offset, instr.src)
+        if base == MEM_ST:
+            return 'BPF_AOT_STORE({}, r{} + ({}), {});'.format(
+                size, instr.dst, instr.offset, _imm(instr.imm))
+        return None
+
+    def _call(self, pc, instr):
+        if instr.src == CALL_PSEUDO:
+            raise TranslationError('bpf-to-bpf call at {} is not supported'
+                                   .format(pc))
+        if instr.imm == FUNC_BPF_TAIL_CALL:
+            raise TranslationError('tail call at {} is not supported'
+                                   .format(pc))
+        self.errors.add('call_error')
+        return 'BPF_AOT_CALL(0x{:x});'.format(instr.imm & 0xffffffff)
+
+    def _translate(self, pc, instr):
+        opcode = instr.opcode
+        cls = opcode & 0x0f
+        if opcode == OPCODE_RETURN:
+            return 'goto exit;'
+        if opcode == OPCODE_CALL:
+            return self._call(pc, instr)
+        if self._is_jump(instr):
+            return self._jump(pc, instr)
+        if cls in (CLS_ALU64_IMM, CLS_ALU64_REG):
+            stmt = self._alu(instr)
+            if stmt:
+                return stmt
+        if cls in (CLS_ALU32_IMM, CLS_ALU32_REG):
+            stmt = self._alu(instr)
+            if stmt:
+                self.errors.add('invalid_instruction')
+                return ('#if CONFIG_BPF_ENABLE_ALU32\n{}\n#else\n'
+                        'goto invalid_instruction;\n#endif'.format(stmt))
+        if opcode & 0x07 in (0x01, 0x02, 0x03):
+            stmt = self._mem(instr)
+            if stmt:
+                return stmt
+        return self._error('invalid_instruction')
+
+    @staticmethod
+    def _emit(lines, stmt):
+        for line in stmt.split('\n'):
+            lines.append(line if line.startswith('#') else '    ' + line)
+
+    def _body(self):
+        lines = []
+        pc = 0
+        while pc < len(self.instrs):
+            instr = self.instrs[pc]
+            if pc in self.targets:
+                lines.append('L{}:'.format(pc))
+            if instr.opcode == OPCODE_LDDW:
+                high = self.instrs[pc + 1]
+                value = (instr.imm & 0xffffffff) | \
+                    ((high.imm << 32) & 0xffffffffffffffff)
+                lines.append('    r{} = {};'.format(instr.dst, _u64(value)))
+                if pc + 1 in self.targets:
+                    # Jumps into the second half execute it as an instruction
+                    if pc + 2 >= len(self.instrs):
+                        raise TranslationError('truncated lddw at {}'
+                                               .format(pc))
+                    lines.append('    goto L{};'.format(pc + 2))
+                    self.targets.add(pc + 2)
+                    lines.append('L{}:'.format(pc + 1))
+                    self._emit(lines, self._translate(pc + 1, high))
+                pc += 2
+                continue
+            self._emit(lines, self._translate(pc, instr))
+            pc += 1
+        return lines
+
+    def function_name(self):
+        return 'bpf_aot_{}'.format(self.name)
+
+    def prototype(self):
+        return 'int {}(bpf_t *bpf, const void *ctx, int64_t *result)'.format(
+            self.function_name())
+
+    def source(self, header):
+        self._find_targets()
+        body = self._body()
+
+        out = [C_HEADER.rstrip('\n'), '']
+        if self.unchecked:
+            # Memory accesses are checked by the MPU, see sys/include/bpf/mpu.h
+            out.extend(['#define BPF_AOT_UNCHECKED', ''])
+        out += ['#include <stdint.h>', '',
+                '#include "bpf.h"',
+                '#include "bpf/aot.h"',
+                '#include "{}"'.format(header), '',
+                self.prototype(),
+                '{',
+                '    int res = BPF_OK;',
+                ]
+        for reg in range(11):
+            if reg and not re.search(r'\br{}\b'.format(reg), '\n'.join(body)) \
+                    and not (reg <= 5 and 'call_error' in self.errors):
+                continue
+            if reg == 1:
+                init = '(uint64_t)(uintptr_t)ctx'
+            elif reg == 10:
+                init = '(uint64_t)(uintptr_t)(bpf->stack + bpf->stack_size)'
+            else:
+                init = '0'
+            out.append('    uint64_t r{} = {};'.format(reg, init))
+        out.append('')
+        out.append('    (void)bpf;')
+        out.append('    (void)ctx;')
+        out.append('')
+        out.extend(body)
+        out.append('')
+        for label, code in (('invalid_instruction', 'BPF_ILLEGAL_INSTRUCTION'),
+                            ('mem_error', 'BPF_ILLEGAL_MEM'),
+                            ('call_error', 'BPF_ILLEGAL_CALL')):
+            if label in self.errors:
+                out.append('{}:'.format(label))
+                out.append('    res = {};'.format(code))
+                out.append('    goto exit;')
+                out.append('')
+        out.append('exit:')
+        out.append('    *result = r0;')
+        out.append('    return res;')
+        out.append('}')
+        return '\n'.join(out) + '\n'
+
+    def header(self):
+        guard = 'BPF_AOT_{}_H'.format(self.name.upper())
+        return '\n'.join([
+            C_HEADER.rstrip('\n'), '',
+            '#ifndef {}'.format(guard),
+            '#define {}'.format(guard), '',
+            '#include <stdint.h>',
+            '#include "bpf.h"', '',
+            '#ifdef __cplusplus',
+            'extern "C" {',
+            '#endif', '',
+            '{};'.format(self.prototype()), '',
+            '#ifdef __cplusplus',
+            '}',
+            '#endif',
+            '#endif /* {} */'.format(guard),
+        ]) + '\n'
+
+
+def _symbol(path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    return re.sub(r'[^A-Za-z0-9_]', '_', name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('input', help='raw application binary')
+    parser.add_argument('-o', '--output', required=True,
+                        help='generated C source')
+    parser.add_argument('--header', required=True,
+                        help='generated C header')
+    parser.add_argument('-n', '--name',
+                        help='symbol suffix, defaults to the input file name')
+    parser.add_argument('--unchecked', action='store_true',
+                        help='leave memory checks to the MPU, the '
+                             'application must be executed isolated')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        code = f.read()
+
+    translator = Translator(args.name or _symbol(args.input), code,
+                            args.unchecked)
+    try:
+        source = translator.source(os.path.basename(args.header))
+    except TranslationError as e:
+        sys.exit('{}: {}'.format(args.input, e))
+
+    with open(args.output, 'w') as f:
+        f.write(source)
+    with open(args.header, 'w') as f:
+        f.write(translator.header())
+
+
+if __name__ == '__main__':
+    main()
@@ -393,6 +393,47 @@ typedef struct netdev_driver {
      */
     int (*recv)(netdev_t *dev, void *buf, size_t len, void *info);
 
+#if defined(MODULE_NETDEV_RECV_LOAN) || defined(DOXYGEN)
+    /**
+     * @brief   Get a received frame in a buffer lent by the driver
+     *
+     * @pre     `(dev != NULL) && (buf != NULL)`
+     *
+     * Zero-copy alternative to @ref netdev_driver_t::recv for drivers that
+     * receive into buffers of their own, e.g. DMA or host buffers. The frame
+     * is handed over in one call and stays in the buffer until it is given
+     * back with @ref netdev_driver_t::recv_release. May be NULL if the driver
+     * doesn't lend buffers.
+     *
+     * @note    Only available with the `netdev_recv_loan` module.
+     *
+     * @param[in]   dev     network device descriptor. Must not be NULL.
+     * @param[out]  buf     the lent buffer the frame starts at
+     * @param[out]  info    status information for the received frame, as with
+     *                      @ref netdev_driver_t::recv. May be NULL.
+     *
+     * @retval  -ENOBUFS    if all buffers are lent, the frame wasn't touched
+     *                      and can be received with @ref netdev_driver_t::recv
+     * @return  negative errno on other errors, the frame is dropped
+     * @return  0, if no frame for this device was received
+     * @return  length of the frame in @p buf
+     */
+    int (*recv_loan)(netdev_t *dev, void **buf, void *info);
+
+    /**
+     * @brief   Give back a buffer lent by @ref netdev_driver_t::recv_loan
+     *
+     * @pre     `(dev != NULL)`
+     *
+     * May be called from any thread.
+     *
+     * @param[in]   dev     network device descriptor. Must not be NULL.
+     * @param[in]   buf     the buffer as returned by
+     *                      @ref netdev_driver_t::recv_loan
+     */
+    void (*recv_release)(netdev_t *dev, void *buf);
+#endif
+
     /**
      * @brief   the driver's initialization function
      *
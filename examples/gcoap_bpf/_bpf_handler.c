@@ -4,9 +4,10 @@
 #include <string.h>
 #include "net/gcoap.h"
 #include "bpf.h"
+#include "bpf/instance.h"
+#include "bpf/mgmt.h"
 #include "bpf/shared.h"
 
-static ssize_t _bpf_state_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len, void *ctx);
 static ssize_t _bpf_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len, void *ctx);
 static ssize_t _riot_board_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len, void *ctx);
 static ssize_t _bpf_submit_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len, void *ctx);
@@ -14,14 +15,13 @@ static ssize_t _bpf_submit_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len, vo
 #define GCOAP_BPF_APP_SIZE  4096
 
 static uint8_t _application[GCOAP_BPF_APP_SIZE] = { 0 };
-static uint8_t _stack[512] = { 0 };
+static bpf_instance_t *_instance = NULL;
 
 static bool _locked = true;
 
 /* CoAP resources. Must be sorted by path (ASCII order). */
 static const coap_resource_t _resources[] = {
     { "/bpf/handle", COAP_GET, _bpf_handler, NULL },
-    { "/bpf/state", COAP_GET, _bpf_state_handler, NULL },
     { "/bpf/submit", COAP_POST, _bpf_submit_handler, NULL },
     { "/riot/board", COAP_GET, _riot_board_handler, NULL },
 };
@@ -33,22 +33,6 @@ static gcoap_listener_t _listener = {
     NULL
 };
 
-static bpf_t _bpf = {
-    .application = _application,
-    .application_len = 0,
-    .stack = _stack,
-    .stack_size = sizeof(_stack),
-};
-
-static ssize_t _bpf_state_handler(coap_pkt_t *pdu, uint8_t*buf, size_t len, void *ctx)
-{
-    (void)pdu;
-    (void)buf;
-    (void)len;
-    (void)ctx;
-    return -1;
-}
-
 static ssize_t _bpf_submit_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len, void *ctx)
 {
     (void)ctx;
@@ -62,20 +46,34 @@ static ssize_t _bpf_submit_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len, vo
            (unsigned)block1.offset, pdu->payload_len, blockwise, block1.more);
 
     if (block1.blknum == 0) {
-        /* lock bpf_handler */
+        /* lock bpf_handler and drop the previous application */
         _locked = true;
+        if (_instance) {
+            bpf_instance_free(_instance);
+            _instance = NULL;
+        }
     }
+
+    memcpy(_application + block1.offset, pdu->payload, pdu->payload_len);
+
     if (!block1.more) {
         /* unlock bpf_handler */
-        _bpf.application_len = block1.offset + pdu->payload_len;
+        bpf_program_t *program = bpf_program_load(_application,
+                                                  block1.offset + pdu->payload_len);
+        if (program) {
+            _instance = bpf_instance_new(program);
+            /* The instance holds its own reference */
+            bpf_program_release(program);
+        }
+        if (!_instance) {
+            resp_code = COAP_CODE_INTERNAL_SERVER_ERROR;
+        }
         _locked = false;
     }
     else {
         resp_code = COAP_CODE_CONTINUE;
     }
 
-    memcpy(_application + block1.offset, pdu->payload, pdu->payload_len);
-
     gcoap_resp_init(pdu, buf, len, resp_code);
 
     if (blockwise) {
@@ -95,14 +93,13 @@ static ssize_t _bpf_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len, void *ctx
     };
     printf("[BPF]: executing gcoap handler\n");
 
-    if (_locked) {
+    if (_locked || !_instance) {
         return -1;
     }
 
-    bpf_setup(&_bpf);
     int64_t result = -1;
     uint32_t start = xtimer_now_usec();
-    int res = bpf_execute(&_bpf, &bpf_ctx, sizeof(bpf_ctx), &result);
+    int res = bpf_instance_execute(_instance, &bpf_ctx, sizeof(bpf_ctx), &result);
     uint32_t stop = xtimer_now_usec();
     printf("Execution done res=%i, result=%i\n", res, (int)result);
     printf("duration: %"PRIu32" us\n",
@@ -132,4 +129,5 @@ void gcoap_bpf_init(void)
 {
     bpf_init();
     gcoap_register_listener(&_listener);
+    bpf_mgmt_coap_init();
 }
@@ -13,7 +13,10 @@ DIRS += $(RIOTBASE)/core $(RIOTBASE)/drivers $(RIOTBASE)/sys
 # submakefiles.
 #
 # As workaround, $(RIOTBASE)/Makefile.include passes BLOBS to this
-# Makefile as APPLICATION_BLOBS.
+# Makefile as APPLICATION_BLOBS. BPF_AOT_PROGRAMS and
+# BPF_AOT_ISOLATED_PROGRAMS are passed the same way.
 BLOBS = $(APPLICATION_BLOBS)
+BPF_AOT_PROGRAMS = $(APPLICATION_BPF_AOT_PROGRAMS)
+BPF_AOT_ISOLATED_PROGRAMS = $(APPLICATION_BPF_AOT_ISOLATED_PROGRAMS)
 
 include $(RIOTBASE)/Makefile.base
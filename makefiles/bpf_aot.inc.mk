@@ -0,0 +1,45 @@
+#
+# compiles the eBPF applications in BPF_AOT_PROGRAMS to native code
+#
+# # Usage:
+#
+# Add this to an application or module Makefile:
+#
+#     BPF_AOT_PROGRAMS += bpf/foo.bin
+#
+# Then include in C file:
+#
+#    #include "bpf_aot/foo.h"
+#
+# The compiled application is the function "bpf_aot_foo", see
+# sys/include/bpf/aot.h for how to execute it.
+#
+# Applications in BPF_AOT_ISOLATED_PROGRAMS are compiled without memory
+# checks and must be executed isolated by the MPU, see
+# sys/include/bpf/mpu.h.
+#
+
+BPF_AOT ?= $(RIOTTOOLS)/bpf_aot/bpf_aot.py
+
+# use "bpf_aot/bpf_aot" so the headers can be included as "bpf_aot/foo.h"
+BPF_AOT_DIR ?= $(BINDIR)/$(MODULE)/bpf_aot/bpf_aot
+BPF_AOT_SRC := $(foreach prog,$(BPF_AOT_PROGRAMS) $(BPF_AOT_ISOLATED_PROGRAMS),\
+                 $(BPF_AOT_DIR)/$(basename $(notdir $(prog))).c)
+
+ifneq (,$(BPF_AOT_SRC))
+  GENSRC += $(BPF_AOT_SRC)
+  CFLAGS += -I$(dir $(BPF_AOT_DIR))
+
+  # regular sources include the generated headers
+  $(SRC): $(BPF_AOT_SRC)
+endif
+
+define _bpf_aot_rule
+$(BPF_AOT_DIR)/$(basename $(notdir $(1))).c: $(1) $(BPF_AOT)
+	@mkdir -p $$(@D)
+	$(Q)$(BPF_AOT) $$< -o $$@ --header $$(@:.c=.h) $(2)
+endef
+
+$(foreach prog,$(BPF_AOT_PROGRAMS),$(eval $(call _bpf_aot_rule,$(prog))))
+$(foreach prog,$(BPF_AOT_ISOLATED_PROGRAMS),\
+  $(eval $(call _bpf_aot_rule,$(prog),--unchecked)))
@@ -5,6 +5,15 @@ PSEUDOMODULES += at_urc_isr_medium
 PSEUDOMODULES += at_urc_isr_highest
 PSEUDOMODULES += at24c%
 PSEUDOMODULES += base64url
+PSEUDOMODULES += bpf_instance
+PSEUDOMODULES += bpf_log
+PSEUDOMODULES += bpf_map
+PSEUDOMODULES += bpf_mgmt
+PSEUDOMODULES += bpf_mpu
+PSEUDOMODULES += bpf_pkt
+PSEUDOMODULES += bpf_sched
+PSEUDOMODULES += bpf_snapshot
+PSEUDOMODULES += bpf_verify_cache
 PSEUDOMODULES += can_mbox
 PSEUDOMODULES += can_pm
 PSEUDOMODULES += can_raw
@@ -35,11 +44,16 @@ PSEUDOMODULES += gnrc_ipv6_nib_dns
 PSEUDOMODULES += gnrc_ipv6_nib_router
 PSEUDOMODULES += gnrc_netdev_default
 PSEUDOMODULES += gnrc_neterr
+PSEUDOMODULES += gnrc_netapi_batch
 PSEUDOMODULES += gnrc_netapi_callbacks
 PSEUDOMODULES += gnrc_netapi_mbox
 PSEUDOMODULES += gnrc_netif_bus
 PSEUDOMODULES += gnrc_netif_events
+PSEUDOMODULES += gnrc_netreg_hash
 PSEUDOMODULES += gnrc_pktbuf_cmd
+PSEUDOMODULES += gnrc_pktbuf_static_classes
+PSEUDOMODULES += gnrc_pktbuf_static_latency
+PSEUDOMODULES += gnrc_pktbuf_static_loan
 PSEUDOMODULES += gnrc_netif_6lo
 PSEUDOMODULES += gnrc_netif_ipv6
 PSEUDOMODULES += gnrc_netif_mac
@@ -79,6 +93,7 @@ PSEUDOMODULES += netdev_ieee802154_%
 PSEUDOMODULES += netdev_ieee802154
 PSEUDOMODULES += netdev_eth
 PSEUDOMODULES += netdev_layer
+PSEUDOMODULES += netdev_recv_loan
 PSEUDOMODULES += netdev_register
 PSEUDOMODULES += netstats
 PSEUDOMODULES += netstats_l2
@@ -7,29 +7,110 @@
  * directory for more details.
  */
 
+#include <errno.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "assert.h"
 #include "bpf.h"
 #include "bpf/store.h"
+#include "bpf/instance.h"
+#include "bpf/log.h"
+#include "bpf/mpu.h"
+#include "bpf/sched.h"
+#include "bpf/verify.h"
+#include "irq.h"
+#include "kernel_defines.h"
+#include "xtimer.h"
 
 extern int bpf_run(bpf_t *bpf, const void *ctx, int64_t *result);
 
+/* Result classes at which a resolved policy ends the chain */
+#define STOP_NEGATIVE       (0x01)
+#define STOP_ZERO           (0x02)
+#define STOP_POSITIVE       (0x04)
+
+typedef struct {
+    bpf_hook_t *hook;
+    bpf_native_t run;           /* Interpreter or compiled application */
+    uint8_t stop;               /* Result classes that end the chain */
+} _hook_entry_t;
+
+struct bpf_hook_chain {
+    _hook_entry_t entries[CONFIG_BPF_HOOK_CHAIN_NUMOF];
+    unsigned len;
+};
+
 static bpf_hook_t *_hooks[BPF_HOOK_NUM] = { 0 };
 
-static bool _continue(bpf_hook_t *hook, int64_t *res)
+/* Rebuilt in place with irqs disabled, executions copy the entries they run
+ * with irqs disabled too, so a rebuild never changes a running chain */
+static bpf_hook_chain_t _chains[BPF_HOOK_NUM];
+
+const bpf_hook_chain_t *bpf_hook_chains[BPF_HOOK_NUM] = { 0 };
+
+static uint8_t _stop(bpf_hook_policy_t policy)
 {
-    switch(hook->policy) {
+    switch(policy) {
         case BPF_POLICY_CONTINUE:
-            return true;
+            return 0;
         case BPF_POLICY_SINGLE:
-            return false;
+            return STOP_NEGATIVE | STOP_ZERO | STOP_POSITIVE;
         case BPF_POLICY_ABORT_ON_NEGATIVE:
-            return (*res < 0) ? false : true;
+            return STOP_NEGATIVE;
         case BPF_POLICY_ABORT_ON_POSITIVE:
-            return (*res > 0) ? false : true;
+            return STOP_POSITIVE;
     }
-    return true;
+    return 0;
+}
+
+static inline uint8_t _result_class(int64_t res)
+{
+    /* STOP_NEGATIVE, STOP_ZERO or STOP_POSITIVE without branches */
+    return 1 << ((res > 0) - (res < 0) + 1);
+}
+
+static int _run_isolated(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    return bpf_mpu_execute(bpf, (void*)ctx, bpf->arg_region.len, result);
+}
+
+static int _run_denied(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    (void)bpf;
+    (void)ctx;
+    (void)result;
+    return BPF_ILLEGAL_MEM;
+}
+
+/* Resolves what bpf_execute() would run for the application */
+static bpf_native_t _runner(const bpf_t *bpf)
+{
+    if (!bpf->native) {
+        return bpf_run;
+    }
+    if (!(bpf->flags & BPF_FLAG_ISOLATED)) {
+        return bpf->native;
+    }
+    return IS_USED(MODULE_BPF_MPU) ? _run_isolated : _run_denied;
+}
+
+/* Flattens the hooks of trigger into a chain, called with irqs disabled */
+static void _compile(bpf_hook_trigger_t trigger)
+{
+    bpf_hook_chain_t *chain = &_chains[trigger];
+
+    chain->len = 0;
+    for (bpf_hook_t *h = _hooks[trigger]; h; h = h->next) {
+        assert(chain->len < CONFIG_BPF_HOOK_CHAIN_NUMOF);
+        chain->entries[chain->len++] = (_hook_entry_t){
+            .hook = h,
+            .run = (h->flags & BPF_HOOK_FLAG_SCHED) ?
+                NULL : _runner(h->application),
+            .stop = _stop(h->policy),
+        };
+    }
+    bpf_hook_chains[trigger] = chain->len ? chain : NULL;
 }
 
 int bpf_execute(bpf_t *bpf, void *ctx, size_t ctx_len, int64_t *result)
@@ -38,6 +119,15 @@ int bpf_execute(bpf_t *bpf, void *ctx, size_t ctx_len, int64_t *result)
     bpf->arg_region.start = ctx;
     bpf->arg_region.len = ctx_len;
 
+    if (bpf->native) {
+        if (bpf->flags & BPF_FLAG_ISOLATED) {
+            if (!IS_USED(MODULE_BPF_MPU)) {
+                return BPF_ILLEGAL_MEM;
+            }
+            return bpf_mpu_execute(bpf, ctx, ctx_len, result);
+        }
+        return bpf->native(bpf, ctx, result);
+    }
     return bpf_run(bpf, ctx, result);
 }
 
@@ -51,6 +141,16 @@ void bpf_setup(bpf_t *bpf)
 
     bpf->arg_region.flag = (BPF_MEM_REGION_READ | BPF_MEM_REGION_WRITE);
 
+    /* Not bpf_verify(), the cache would hash the application on every
+     * setup */
+    bpf->frame_size = bpf_verify_frame_size(bpf->application,
+                                            bpf->application_len);
+    /* The stack must at least hold the frame of the entry function */
+    assert(bpf->frame_size <= bpf->stack_size);
+#if CONFIG_BPF_SAUL_CACHE_NUMOF
+    memset(bpf->saul_cache, 0, sizeof(bpf->saul_cache));
+#endif
+
     bpf->flags |= BPF_FLAG_SETUP_DONE;
 }
 
@@ -73,26 +173,103 @@ static void _register(bpf_hook_t **install_hook, bpf_hook_t *new)
 void bpf_init(void)
 {
     bpf_store_init();
+    if (IS_USED(MODULE_BPF_INSTANCE)) {
+        bpf_instance_init();
+    }
+    if (IS_USED(MODULE_BPF_SCHED)) {
+        bpf_sched_init();
+    }
+    if (IS_USED(MODULE_BPF_LOG)) {
+        bpf_log_init();
+    }
+    if (IS_USED(MODULE_BPF_MPU)) {
+        bpf_mpu_init();
+    }
 }
 
 int bpf_hook_install(bpf_hook_t *hook, bpf_hook_trigger_t trigger) {
     assert(trigger < BPF_HOOK_NUM);
-    _register(&_hooks[trigger], hook);
-    return 0;
+    assert(hook->application->flags & BPF_FLAG_SETUP_DONE);
+    int res = 0;
+
+    unsigned state = irq_disable();
+    if (_chains[trigger].len == CONFIG_BPF_HOOK_CHAIN_NUMOF) {
+        res = -ENOSPC;
+    }
+    else {
+        _register(&_hooks[trigger], hook);
+        _compile(trigger);
+    }
+    irq_restore(state);
+    return res;
 }
 
-int bpf_hook_execute(bpf_hook_trigger_t trigger, void *ctx, size_t ctx_size, int64_t *script_res)
+int bpf_hook_uninstall(bpf_hook_t *hook, bpf_hook_trigger_t trigger)
 {
     assert(trigger < BPF_HOOK_NUM);
+    int res = -ENOENT;
+
+    unsigned state = irq_disable();
+    for (bpf_hook_t **h = &_hooks[trigger]; *h; h = &(*h)->next) {
+        if (*h == hook) {
+            *h = hook->next;
+            _compile(trigger);
+            res = 0;
+            break;
+        }
+    }
+    irq_restore(state);
+    return res;
+}
 
+int bpf_hook_execute_chain(bpf_hook_trigger_t trigger, void *ctx,
+                           size_t ctx_size, int64_t *script_res)
+{
+    assert(trigger < BPF_HOOK_NUM);
     int res = BPF_OK;
+    _hook_entry_t entries[CONFIG_BPF_HOOK_CHAIN_NUMOF];
 
-    for (bpf_hook_t *h = _hooks[trigger]; h; h = h->next) {
-        res = bpf_execute(h->application, ctx, ctx_size, script_res);
+    /* Read at once, hooks (un)installed from here on don't change this
+     * execution */
+    unsigned state = irq_disable();
+    unsigned len = _chains[trigger].len;
+    memcpy(entries, _chains[trigger].entries, len * sizeof(entries[0]));
+    irq_restore(state);
+
+    for (const _hook_entry_t *e = entries; e < &entries[len]; e++) {
+        bpf_hook_t *h = e->hook;
+        bpf_t *bpf = h->application;
+
+        if (IS_USED(MODULE_BPF_SCHED) && !e->run) {
+            /* Runs later from the runtime thread, unless bpf_sched_stop()
+             * stopped the entry after the chain was read */
+            state = irq_disable();
+            if (h->flags & BPF_HOOK_FLAG_SCHED) {
+                bpf_sched_trigger(container_of(h, bpf_sched_entry_t, hook));
+                h->executions++;
+            }
+            irq_restore(state);
+            continue;
+        }
+
+        /* The rest of the setup is done when compiling the chain */
+        bpf->arg_region.start = ctx;
+        bpf->arg_region.len = ctx_size;
+#if CONFIG_BPF_HOOK_PROFILE
+        uint32_t start = xtimer_now_usec();
+#endif
+        res = e->run(bpf, ctx, script_res);
+#if CONFIG_BPF_HOOK_PROFILE
+        h->duration_us += xtimer_now_usec() - start;
+#endif
         h->executions++;
-        if ((res == BPF_OK) && !_continue(h, script_res)) {
+        if (res != BPF_OK) {
+            h->errors++;
+        }
+        else if (e->stop & _result_class(*script_res)) {
             break;
         }
     }
+
     return res;
 }
@@ -7,15 +7,22 @@
  * directory for more details.
  */
 
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "bpf.h"
 #include "bpf/instruction.h"
+#include "bpf/call.h"
+#include "bpf/log.h"
+#include "bpf/map.h"
+#include "bpf/pkt.h"
 #include "bpf/store.h"
 #include "bpf/shared.h"
+#include "byteorder.h"
 #include "xtimer.h"
 
 #ifdef MODULE_GCOAP
@@ -25,11 +32,23 @@
 #include "saul.h"
 #include "saul_reg.h"
 #include "fmt.h"
+#ifdef MODULE_CHECKSUM
+#include "checksum/crc16_ccitt.h"
+#include "checksum/fletcher32.h"
+#endif
+#ifdef MODULE_HASHES
+#include "hashes/sha256.h"
+#endif
 
 uint32_t bpf_vm_printf(bpf_t *bpf, uint32_t fmt, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
 {
+#ifdef MODULE_BPF_LOG
+    const uint32_t args[BPF_LOG_ARGS_NUMOF] = { a2, a3, a4, a5 };
+    return (uint32_t)bpf_log_printf(bpf, (const char*)(uintptr_t)fmt, args);
+#else
     (void)bpf;
     return printf((char*)(uintptr_t)fmt, a2, a3, a4, a5);
+#endif
 }
 
 uint32_t bpf_vm_store_local(bpf_t *bpf, uint32_t key, uint32_t value, uint32_t a3, uint32_t a4, uint32_t a5)
@@ -78,15 +97,37 @@ uint32_t bpf_vm_now_ms(bpf_t *bpf, uint32_t a1, uint32_t a2, uint32_t a3, uint32
     return xtimer_now_usec64()/US_PER_MS;
 }
 
-uint32_t bpf_vm_saul_reg_find_nth(bpf_t *bpf, uint32_t nth, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+static saul_reg_t *_saul_find_nth(bpf_t *bpf, unsigned pos)
 {
+    if (pos > INT_MAX) {
+        /* Would be a negative position for saul_reg_find_nth() */
+        return NULL;
+    }
+#if CONFIG_BPF_SAUL_CACHE_NUMOF
+    if (pos < CONFIG_BPF_SAUL_CACHE_NUMOF) {
+        if (bpf->saul_generation != saul_reg_generation) {
+            /* Devices were added or removed, positions may have moved */
+            memset(bpf->saul_cache, 0, sizeof(bpf->saul_cache));
+            bpf->saul_generation = saul_reg_generation;
+        }
+        if (!bpf->saul_cache[pos]) {
+            bpf->saul_cache[pos] = saul_reg_find_nth(pos);
+        }
+        return bpf->saul_cache[pos];
+    }
+#else
     (void)bpf;
+#endif
+    return saul_reg_find_nth(pos);
+}
+
+uint32_t bpf_vm_saul_reg_find_nth(bpf_t *bpf, uint32_t nth, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+{
     (void)a2;
     (void)a3;
     (void)a4;
     (void)a5;
-    int pos = (int)nth;
-    saul_reg_t *reg = saul_reg_find_nth(pos);
+    saul_reg_t *reg = _saul_find_nth(bpf, nth);
     return (uint32_t)(intptr_t)reg;
 }
 
@@ -116,6 +157,266 @@ uint32_t bpf_vm_saul_reg_read(bpf_t *bpf, uint32_t dev_p, uint32_t data_p, uint3
     return (uint32_t)res;
 }
 
+uint32_t bpf_vm_saul_read_batch(bpf_t *bpf, uint32_t positions_p, uint32_t data_p, uint32_t num, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    const uint8_t *positions = (const uint8_t*)(intptr_t)positions_p;
+    phydat_t *data = (phydat_t*)(intptr_t)data_p;
+
+    /* Registry positions are limited to uint8_t, this also keeps the size
+     * calculation below from overflowing */
+    if ((num > UINT8_MAX) ||
+            (bpf_check_mem(bpf, (intptr_t)positions, num,
+                           BPF_MEM_REGION_READ) < 0) ||
+            (bpf_check_mem(bpf, (intptr_t)data, num * sizeof(phydat_t),
+                           BPF_MEM_REGION_WRITE) < 0)) {
+        return (uint32_t)-1;
+    }
+
+    uint32_t i;
+    for (i = 0; i < num; i++) {
+        saul_reg_t *dev = _saul_find_nth(bpf, positions[i]);
+        if (!dev || saul_reg_read(dev, &data[i]) < 0) {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Helper arguments are passed as 32 bit register values */
+static int _check_area(const bpf_t *bpf, uint32_t addr, uint32_t len,
+                       uint8_t type)
+{
+    return bpf_check_mem(bpf, (intptr_t)addr, len, type);
+}
+
+uint32_t bpf_vm_memcpy(bpf_t *bpf, uint32_t dest_p, uint32_t src_p, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    if ((_check_area(bpf, dest_p, len, BPF_MEM_REGION_WRITE) < 0) ||
+            (_check_area(bpf, src_p, len, BPF_MEM_REGION_READ) < 0)) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    /* Both areas can be on the application stack */
+    memmove((void*)(uintptr_t)dest_p, (const void*)(uintptr_t)src_p, len);
+    return 0;
+}
+
+uint32_t bpf_vm_memset(bpf_t *bpf, uint32_t dest_p, uint32_t c, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    if (_check_area(bpf, dest_p, len, BPF_MEM_REGION_WRITE) < 0) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    memset((void*)(uintptr_t)dest_p, (int)c, len);
+    return 0;
+}
+
+uint32_t bpf_vm_memcmp(bpf_t *bpf, uint32_t a_p, uint32_t b_p, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    if ((_check_area(bpf, a_p, len, BPF_MEM_REGION_READ) < 0) ||
+            (_check_area(bpf, b_p, len, BPF_MEM_REGION_READ) < 0)) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    int res = memcmp((const void*)(uintptr_t)a_p, (const void*)(uintptr_t)b_p,
+                     len);
+    /* Keep the result clear of the error code */
+    return (uint32_t)((res > 0) - (res < 0));
+}
+
+#ifdef MODULE_CHECKSUM
+uint32_t bpf_vm_fletcher32(bpf_t *bpf, uint32_t buf_p, uint32_t words, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)a3;
+    (void)a4;
+    (void)a5;
+
+    /* A fletcher32 checksum is never zero */
+    if ((words > UINT32_MAX / sizeof(uint16_t)) ||
+            (_check_area(bpf, buf_p, words * sizeof(uint16_t),
+                         BPF_MEM_REGION_READ) < 0)) {
+        return 0;
+    }
+    return fletcher32((const uint16_t*)(uintptr_t)buf_p, words);
+}
+
+uint32_t bpf_vm_crc16_ccitt(bpf_t *bpf, uint32_t crc, uint32_t buf_p, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    if (_check_area(bpf, buf_p, len, BPF_MEM_REGION_READ) < 0) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    return crc16_ccitt_update((uint16_t)crc,
+                              (const unsigned char*)(uintptr_t)buf_p, len);
+}
+#endif
+
+#ifdef MODULE_HASHES
+uint32_t bpf_vm_sha256_init(bpf_t *bpf, uint32_t ctx_p, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)a2;
+    (void)a3;
+    (void)a4;
+    (void)a5;
+
+    if (_check_area(bpf, ctx_p, sizeof(sha256_context_t),
+                    BPF_MEM_REGION_WRITE) < 0) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    sha256_init((sha256_context_t*)(uintptr_t)ctx_p);
+    return 0;
+}
+
+uint32_t bpf_vm_sha256_update(bpf_t *bpf, uint32_t ctx_p, uint32_t data_p, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    if ((_check_area(bpf, ctx_p, sizeof(sha256_context_t),
+                     BPF_MEM_REGION_WRITE) < 0) ||
+            (_check_area(bpf, data_p, len, BPF_MEM_REGION_READ) < 0)) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    sha256_update((sha256_context_t*)(uintptr_t)ctx_p,
+                  (const void*)(uintptr_t)data_p, len);
+    return 0;
+}
+
+uint32_t bpf_vm_sha256_final(bpf_t *bpf, uint32_t ctx_p, uint32_t digest_p, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)a3;
+    (void)a4;
+    (void)a5;
+
+    if ((_check_area(bpf, ctx_p, sizeof(sha256_context_t),
+                     BPF_MEM_REGION_WRITE) < 0) ||
+            (_check_area(bpf, digest_p, SHA256_DIGEST_LENGTH,
+                         BPF_MEM_REGION_WRITE) < 0)) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    sha256_final((sha256_context_t*)(uintptr_t)ctx_p,
+                 (void*)(uintptr_t)digest_p);
+    return 0;
+}
+#endif
+
+#ifdef MODULE_BPF_PKT
+uint32_t bpf_vm_pkt_load_bytes(bpf_t *bpf, uint32_t offset, uint32_t dst_p, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    if (!bpf->pkt ||
+            (_check_area(bpf, dst_p, len, BPF_MEM_REGION_WRITE) < 0) ||
+            (bpf_pkt_load(bpf->pkt, offset, (void*)(uintptr_t)dst_p, len) < 0)) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    return 0;
+}
+
+/* Loads beyond the packet return 0, applications check the length in the
+ * context first */
+uint32_t bpf_vm_pkt_load_u8(bpf_t *bpf, uint32_t offset, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)a2;
+    (void)a3;
+    (void)a4;
+    (void)a5;
+
+    uint8_t val;
+    if (!bpf->pkt || (bpf_pkt_load(bpf->pkt, offset, &val, sizeof(val)) < 0)) {
+        return 0;
+    }
+    return val;
+}
+
+uint32_t bpf_vm_pkt_load_u16(bpf_t *bpf, uint32_t offset, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)a2;
+    (void)a3;
+    (void)a4;
+    (void)a5;
+
+    uint8_t buf[sizeof(uint16_t)];
+    if (!bpf->pkt || (bpf_pkt_load(bpf->pkt, offset, buf, sizeof(buf)) < 0)) {
+        return 0;
+    }
+    return byteorder_bebuftohs(buf);
+}
+
+uint32_t bpf_vm_pkt_load_u32(bpf_t *bpf, uint32_t offset, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)a2;
+    (void)a3;
+    (void)a4;
+    (void)a5;
+
+    uint8_t buf[sizeof(uint32_t)];
+    if (!bpf->pkt || (bpf_pkt_load(bpf->pkt, offset, buf, sizeof(buf)) < 0)) {
+        return 0;
+    }
+    return byteorder_bebuftohl(buf);
+}
+#endif
+
+#ifdef MODULE_BPF_MAP
+uint32_t bpf_vm_map_bloom_check(bpf_t *bpf, uint32_t id, uint32_t key_p, uint32_t len, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    bpf_map_bloom_t *map = (bpf_map_bloom_t *)bpf_map_find(id, BPF_MAP_TYPE_BLOOM);
+    if (!map) {
+        return (uint32_t)BPF_ILLEGAL_CALL;
+    }
+    if (_check_area(bpf, key_p, len, BPF_MEM_REGION_READ) < 0) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+    return bloom_check(&map->bloom, (const uint8_t*)(uintptr_t)key_p, len);
+}
+
+uint32_t bpf_vm_map_lpm_lookup(bpf_t *bpf, uint32_t id, uint32_t addr_p, uint32_t value_p, uint32_t a4, uint32_t a5)
+{
+    (void)a4;
+    (void)a5;
+
+    const bpf_map_lpm_t *map = (const bpf_map_lpm_t *)bpf_map_find(id, BPF_MAP_TYPE_LPM);
+    if (!map) {
+        return (uint32_t)BPF_ILLEGAL_CALL;
+    }
+    if ((_check_area(bpf, addr_p, sizeof(ipv6_addr_t), BPF_MEM_REGION_READ) < 0) ||
+            (value_p && (_check_area(bpf, value_p, sizeof(uint32_t),
+                                     BPF_MEM_REGION_WRITE) < 0))) {
+        return (uint32_t)BPF_ILLEGAL_MEM;
+    }
+
+    /* The address may be unaligned in a packet buffer */
+    ipv6_addr_t addr;
+    uint32_t value;
+    memcpy(&addr, (const void*)(uintptr_t)addr_p, sizeof(addr));
+    int res = bpf_map_lpm_lookup(map, &addr, &value);
+    if (res < 0) {
+        /* Keep clear of the error codes */
+        return (uint32_t)-1;
+    }
+    if (value_p) {
+        memcpy((void*)(uintptr_t)value_p, &value, sizeof(value));
+    }
+    return (uint32_t)res;
+}
+#endif
+
 #ifdef MODULE_GCOAP
 uint32_t bpf_vm_gcoap_resp_init(bpf_t *bpf, uint32_t coap_ctx_p, uint32_t resp_code_u, uint32_t a3, uint32_t a4, uint32_t a5)
 {
@@ -182,3 +483,81 @@ uint32_t bpf_vm_fmt_s16_dfp(bpf_t *bpf, uint32_t out_p, uint32_t val, uint32_t f
     return (uint32_t)res;
 }
 #endif
+
+bpf_call_t bpf_get_call(uint32_t num)
+{
+    switch(num) {
+        case BPF_FUNC_BPF_PRINTF:
+            return &bpf_vm_printf;
+        case BPF_FUNC_BPF_STORE_LOCAL:
+            return &bpf_vm_store_local;
+        case BPF_FUNC_BPF_STORE_GLOBAL:
+            return &bpf_vm_store_global;
+        case BPF_FUNC_BPF_FETCH_LOCAL:
+            return &bpf_vm_fetch_local;
+        case BPF_FUNC_BPF_FETCH_GLOBAL:
+            return &bpf_vm_fetch_global;
+        case BPF_FUNC_BPF_NOW_MS:
+            return &bpf_vm_now_ms;
+        case BPF_FUNC_BPF_SAUL_REG_FIND_NTH:
+            return &bpf_vm_saul_reg_find_nth;
+        case BPF_FUNC_BPF_SAUL_REG_FIND_TYPE:
+            return &bpf_vm_saul_reg_find_type;
+        case BPF_FUNC_BPF_SAUL_REG_READ:
+            return &bpf_vm_saul_reg_read;
+        case BPF_FUNC_BPF_SAUL_READ_BATCH:
+            return &bpf_vm_saul_read_batch;
+        case BPF_FUNC_BPF_MEMCPY:
+            return &bpf_vm_memcpy;
+        case BPF_FUNC_BPF_MEMSET:
+            return &bpf_vm_memset;
+        case BPF_FUNC_BPF_MEMCMP:
+            return &bpf_vm_memcmp;
+#ifdef MODULE_CHECKSUM
+        case BPF_FUNC_BPF_FLETCHER32:
+            return &bpf_vm_fletcher32;
+        case BPF_FUNC_BPF_CRC16_CCITT:
+            return &bpf_vm_crc16_ccitt;
+#endif
+#ifdef MODULE_HASHES
+        case BPF_FUNC_BPF_SHA256_INIT:
+            return &bpf_vm_sha256_init;
+        case BPF_FUNC_BPF_SHA256_UPDATE:
+            return &bpf_vm_sha256_update;
+        case BPF_FUNC_BPF_SHA256_FINAL:
+            return &bpf_vm_sha256_final;
+#endif
+#ifdef MODULE_BPF_PKT
+        case BPF_FUNC_BPF_PKT_LOAD_BYTES:
+            return &bpf_vm_pkt_load_bytes;
+        case BPF_FUNC_BPF_PKT_LOAD_U8:
+            return &bpf_vm_pkt_load_u8;
+        case BPF_FUNC_BPF_PKT_LOAD_U16:
+            return &bpf_vm_pkt_load_u16;
+        case BPF_FUNC_BPF_PKT_LOAD_U32:
+            return &bpf_vm_pkt_load_u32;
+#endif
+#ifdef MODULE_BPF_MAP
+        case BPF_FUNC_BPF_MAP_BLOOM_CHECK:
+            return &bpf_vm_map_bloom_check;
+        case BPF_FUNC_BPF_MAP_LPM_LOOKUP:
+            return &bpf_vm_map_lpm_lookup;
+#endif
+#ifdef MODULE_GCOAP
+        case BPF_FUNC_BPF_GCOAP_RESP_INIT:
+            return &bpf_vm_gcoap_resp_init;
+        case BPF_FUNC_BPF_COAP_OPT_FINISH:
+            return &bpf_vm_coap_opt_finish;
+        case BPF_FUNC_BPF_COAP_ADD_FORMAT:
+            return &bpf_vm_coap_add_format;
+        case BPF_FUNC_BPF_COAP_GET_PDU:
+            return &bpf_vm_coap_get_pdu;
+#endif
+#ifdef MODULE_FMT
+        case BPF_FUNC_BPF_FMT_S16_DFP:
+            return &bpf_vm_fmt_s16_dfp;
+#endif
+        default:
+            return NULL;
+    }
+}
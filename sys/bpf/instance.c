@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "assert.h"
+#include "bpf.h"
+#include "bpf/instance.h"
+#include "bpf/store.h"
+#include "bpf/verify.h"
+#include "memarray.h"
+#include "mutex.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+typedef union {
+    uint64_t align;
+    uint8_t stack[CONFIG_BPF_INSTANCE_STACK_SIZE];
+} _stack_t;
+
+typedef union {
+    uint64_t align;
+    uint8_t stack[CONFIG_BPF_INSTANCE_SMALL_STACK_SIZE];
+} _small_stack_t;
+
+static mutex_t _lock = MUTEX_INIT;
+
+static memarray_t _program_pool;
+static memarray_t _instance_pool;
+static memarray_t _stack_pool;
+static memarray_t _small_stack_pool;
+static memarray_t _region_pool;
+
+static bpf_program_t _programs[CONFIG_BPF_PROGRAM_NUMOF];
+static bpf_instance_t _instances[CONFIG_BPF_INSTANCE_NUMOF];
+static _stack_t _stacks[CONFIG_BPF_INSTANCE_STACK_NUMOF];
+static _small_stack_t _small_stacks[CONFIG_BPF_INSTANCE_SMALL_STACK_NUMOF];
+static bpf_mem_region_t _regions[CONFIG_BPF_INSTANCE_REGION_NUMOF];
+
+void bpf_instance_init(void)
+{
+    memarray_init(&_program_pool, _programs, sizeof(bpf_program_t),
+                  CONFIG_BPF_PROGRAM_NUMOF);
+    memarray_init(&_instance_pool, _instances, sizeof(bpf_instance_t),
+                  CONFIG_BPF_INSTANCE_NUMOF);
+    memarray_init(&_stack_pool, _stacks, sizeof(_stack_t),
+                  CONFIG_BPF_INSTANCE_STACK_NUMOF);
+    memarray_init(&_small_stack_pool, _small_stacks, sizeof(_small_stack_t),
+                  CONFIG_BPF_INSTANCE_SMALL_STACK_NUMOF);
+    memarray_init(&_region_pool, _regions, sizeof(bpf_mem_region_t),
+                  CONFIG_BPF_INSTANCE_REGION_NUMOF);
+}
+
+static bool _is_pool_region(const bpf_mem_region_t *region)
+{
+    return (region >= &_regions[0]) &&
+           (region < &_regions[CONFIG_BPF_INSTANCE_REGION_NUMOF]);
+}
+
+static bool _is_small_stack(const void *stack)
+{
+    return ((const _small_stack_t *)stack >= &_small_stacks[0]) &&
+           ((const _small_stack_t *)stack <
+            &_small_stacks[CONFIG_BPF_INSTANCE_SMALL_STACK_NUMOF]);
+}
+
+static uint8_t *_stack_alloc(size_t depth, size_t *size)
+{
+    if (depth <= CONFIG_BPF_INSTANCE_SMALL_STACK_SIZE) {
+        _small_stack_t *stack = memarray_alloc(&_small_stack_pool);
+        if (stack) {
+            *size = sizeof(stack->stack);
+            return stack->stack;
+        }
+    }
+    /* Fall back to the large class when the small class is exhausted */
+    _stack_t *stack = memarray_alloc(&_stack_pool);
+    if (stack) {
+        *size = sizeof(stack->stack);
+        return stack->stack;
+    }
+    return NULL;
+}
+
+static void _stack_free(uint8_t *stack)
+{
+    memarray_free(_is_small_stack(stack) ? &_small_stack_pool : &_stack_pool,
+                  stack);
+}
+
+static bpf_program_t *_find_program(const uint8_t *application, size_t len)
+{
+    for (unsigned i = 0; i < CONFIG_BPF_PROGRAM_NUMOF; i++) {
+        bpf_program_t *program = &_programs[i];
+        if (program->refcount && program->application == application &&
+                program->application_len == len) {
+            return program;
+        }
+    }
+    return NULL;
+}
+
+bpf_program_t *bpf_program_load(const uint8_t *application, size_t len)
+{
+    mutex_lock(&_lock);
+    bpf_program_t *program = _find_program(application, len);
+    if (program) {
+        program->refcount++;
+        mutex_unlock(&_lock);
+        return program;
+    }
+    mutex_unlock(&_lock);
+
+    bpf_verify_result_t verified;
+    if (bpf_verify(application, len, &verified) < 0) {
+        DEBUG("bpf_instance: malformed application\n");
+        return NULL;
+    }
+    if (verified.stack_depth > CONFIG_BPF_INSTANCE_STACK_SIZE) {
+        DEBUG("bpf_instance: application requires %u bytes of stack\n",
+              (unsigned)verified.stack_depth);
+        return NULL;
+    }
+
+    mutex_lock(&_lock);
+    /* Loaded by another thread while this one was verifying */
+    program = _find_program(application, len);
+    if (program) {
+        program->refcount++;
+        mutex_unlock(&_lock);
+        return program;
+    }
+    program = memarray_calloc(&_program_pool);
+    if (program) {
+        program->application = application;
+        program->application_len = len;
+        program->stack_size = verified.stack_depth;
+        program->refcount = 1;
+    }
+    mutex_unlock(&_lock);
+    DEBUG("bpf_instance: loaded program %p, refcount %u\n",
+          (void *)program, program ? program->refcount : 0);
+    return program;
+}
+
+static void _program_release(bpf_program_t *program)
+{
+    assert(program->refcount);
+    if (--program->refcount == 0) {
+        memarray_free(&_program_pool, program);
+    }
+}
+
+void bpf_program_release(bpf_program_t *program)
+{
+    mutex_lock(&_lock);
+    _program_release(program);
+    mutex_unlock(&_lock);
+}
+
+bpf_instance_t *bpf_instance_new(bpf_program_t *program)
+{
+    assert(program->refcount);
+
+    mutex_lock(&_lock);
+    bpf_instance_t *instance = memarray_calloc(&_instance_pool);
+    if (!instance) {
+        mutex_unlock(&_lock);
+        return NULL;
+    }
+    size_t stack_size;
+    uint8_t *stack = _stack_alloc(program->stack_size, &stack_size);
+    if (!stack) {
+        memarray_free(&_instance_pool, instance);
+        mutex_unlock(&_lock);
+        return NULL;
+    }
+
+    program->refcount++;
+    mutex_unlock(&_lock);
+
+    instance->program = program;
+    instance->bpf.application = program->application;
+    instance->bpf.application_len = program->application_len;
+    instance->bpf.stack = stack;
+    instance->bpf.stack_size = stack_size;
+    bpf_setup(&instance->bpf);
+
+    return instance;
+}
+
+void bpf_instance_free(bpf_instance_t *instance)
+{
+    bpf_t *bpf = &instance->bpf;
+
+    bpf_store_clear_local(bpf);
+
+    mutex_lock(&_lock);
+    bpf_mem_region_t *region = bpf->stack_region.next;
+    while (region && region != &bpf->arg_region) {
+        bpf_mem_region_t *next = region->next;
+        if (_is_pool_region(region)) {
+            memarray_free(&_region_pool, region);
+        }
+        region = next;
+    }
+    _stack_free(bpf->stack);
+    _program_release(instance->program);
+    memarray_free(&_instance_pool, instance);
+    mutex_unlock(&_lock);
+}
+
+int bpf_instance_add_region(bpf_instance_t *instance,
+                            void *start, size_t len, uint8_t flags)
+{
+    mutex_lock(&_lock);
+    bpf_mem_region_t *region = memarray_alloc(&_region_pool);
+    mutex_unlock(&_lock);
+
+    if (!region) {
+        return -ENOMEM;
+    }
+    bpf_add_region(&instance->bpf, region, start, len, flags);
+    return 0;
+}
@@ -57,38 +57,6 @@ static int _check_store(const bpf_t *bpf, uint8_t opcode, const intptr_t addr)
     return _check_mem(bpf, opcode, addr, BPF_MEM_REGION_WRITE);
 }
 
-static bpf_call_t _bpf_get_call(uint32_t num)
-{
-    switch(num) {
-        case BPF_FUNC_BPF_PRINTF:
-            return &bpf_vm_printf;
-        case BPF_FUNC_BPF_STORE_LOCAL:
-            return &bpf_vm_store_local;
-        case BPF_FUNC_BPF_STORE_GLOBAL:
-            return &bpf_vm_store_global;
-        case BPF_FUNC_BPF_FETCH_LOCAL:
-            return &bpf_vm_fetch_local;
-        case BPF_FUNC_BPF_FETCH_GLOBAL:
-            return &bpf_vm_fetch_global;
-        case BPF_FUNC_BPF_NOW_MS:
-            return &bpf_vm_now_ms;
-        case BPF_FUNC_BPF_SAUL_REG_FIND_NTH:
-            return &bpf_vm_saul_reg_find_nth;
-        case BPF_FUNC_BPF_SAUL_REG_FIND_TYPE:
-            return &bpf_vm_saul_reg_find_type;
-        case BPF_FUNC_BPF_SAUL_REG_READ:
-            return &bpf_vm_saul_reg_read;
-#ifdef MODULE_GCOAP
-        case BPF_FUNC_BPF_GCOAP_RESP_INIT:
-            return &bpf_vm_gcoap_resp_init;
-        case BPF_FUNC_BPF_COAP_OPT_FINISH:
-            return &bpf_vm_coap_opt_finish;
-#endif
-        default:
-            return NULL;
-    }
-}
-
 /* ALU type instructions */
 static int _alu64(uint8_t opcode, uint64_t *src, uint64_t *dst)
 {
@@ -157,8 +125,8 @@ static int _ld(const bpf_instruction_t **pc, uint64_t *src, uint64_t *dst)
 
     switch(opcode) {
         case 0x18: /* LDDW */
-            *dst = ((uint64_t)instruction[0].immediate) +
-                    ((uint64_t)instruction[1].immediate << 32);
+            *dst = (uint32_t)instruction[0].immediate |
+                   ((uint64_t)(uint32_t)instruction[1].immediate << 32);
             (*pc)++;
             break;
         /* Other BPF instructions are Linux socket/filter specific */
@@ -337,7 +305,9 @@ static int _instruction(bpf_t *bpf, uint64_t *regmap,
 
 int bpf_run(bpf_t *bpf, const void *ctx, int64_t *result)
 {
-    bpf->instruction_count = 0;
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    uint32_t instruction_count = 0;
+#endif
     uint64_t regmap[11] = { 0 };
     regmap[1] = (uint64_t)(uintptr_t)ctx;
     regmap[10] = (uint64_t)(uintptr_t)(bpf->stack + bpf->stack_size);
@@ -346,11 +316,24 @@ int bpf_run(bpf_t *bpf, const void *ctx, int64_t *result)
     const bpf_instruction_t *pc = (const bpf_instruction_t*)bpf->application;
 
     while (!end) {
+#if CONFIG_BPF_INSTRUCTION_BUDGET
+        if (instruction_count >= CONFIG_BPF_INSTRUCTION_BUDGET) {
+            bpf->instruction_count = instruction_count;
+            return BPF_OUT_OF_BUDGET;
+        }
+#endif
         int res = _instruction(bpf, regmap, &pc);
-        bpf->instruction_count++;
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+        instruction_count++;
+#endif
         if (res < 0) {
-            if (pc->opcode == 0x85) {
-                bpf_call_t call = _bpf_get_call(pc->immediate);
+            if (pc->opcode == 0x85 && pc->src == BPF_INSTRUCTION_CALL_PSEUDO) {
+                /* bpf-to-bpf calls are only supported by the jumptable
+                 * interpreter */
+                return BPF_ILLEGAL_CALL;
+            }
+            else if (pc->opcode == 0x85) {
+                bpf_call_t call = bpf_get_call(pc->immediate);
                 if (call) {
                     regmap[0] = (*(call))(bpf,
                                           regmap[1],
@@ -378,7 +361,10 @@ int bpf_run(bpf_t *bpf, const void *ctx, int64_t *result)
         }
     }
 
-    DEBUG("Number of instructions: %"PRIu32"\n", bpf->instruction_count);
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    bpf->instruction_count = instruction_count;
+    DEBUG("Number of instructions: %"PRIu32"\n", instruction_count);
+#endif
     *result = regmap[0];
     return BPF_OK;
 }
@@ -10,10 +10,12 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "bpf.h"
 #include "bpf/instruction.h"
 #include "bpf/call.h"
+#include "bpf/verify.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
@@ -22,18 +24,11 @@ typedef int dont_be_pedantic;
 
 static int _check_mem(const bpf_t *bpf, uint8_t size, const intptr_t addr, uint8_t type)
 {
-    const intptr_t end = addr + size;
-    for (const bpf_mem_region_t *region = &bpf->stack_region; region; region = region->next) {
-        if ((addr  >= (intptr_t)region->start) &&
-                (end <= (intptr_t)(region->start + region->len)) &&
-                (region->flag & type)) {
-
-            return 0;
-        }
+    if (bpf_check_mem(bpf, addr, size, type) < 0) {
+        DEBUG("Denied access to %p with len %u\n", (void*)addr, size);
+        return -1;
     }
-
-    DEBUG("Denied access to %p with len %u\n",(void*)addr, end - addr);
-    return -1;
+    return 0;
 }
 
 static inline int _check_load(const bpf_t *bpf, uint8_t size, const intptr_t addr)
@@ -46,59 +41,24 @@ static inline int _check_store(const bpf_t *bpf, uint8_t size, const intptr_t ad
     return _check_mem(bpf, size, addr, BPF_MEM_REGION_WRITE);
 }
 
-static int _preflight_checks(const bpf_t *bpf)
-{
-    if (bpf->application_len % sizeof(bpf_instruction_t)) {
-        return BPF_ILLEGAL_LEN;
-    }
-
-    size_t num_instructions = bpf->application_len/sizeof(bpf_instruction_t);
-    const bpf_instruction_t *instr = (const bpf_instruction_t*)bpf->application;
-
-    if (instr[num_instructions - 1].opcode != 0x95) {
-        return BPF_NO_RETURN;
-    }
-    return BPF_OK;
-}
+typedef struct {
+    const bpf_instruction_t *ret;   /**< Call instruction to return to */
+    uint64_t regs[4];               /**< Callee saved registers r6 to r9 */
+} _call_frame_t;
 
-static bpf_call_t _bpf_get_call(uint32_t num)
+static bpf_t *_tail_call_target(const bpf_t *bpf, uint64_t index)
 {
-    switch(num) {
-        case BPF_FUNC_BPF_PRINTF:
-            return &bpf_vm_printf;
-        case BPF_FUNC_BPF_STORE_LOCAL:
-            return &bpf_vm_store_local;
-        case BPF_FUNC_BPF_STORE_GLOBAL:
-            return &bpf_vm_store_global;
-        case BPF_FUNC_BPF_FETCH_LOCAL:
-            return &bpf_vm_fetch_local;
-        case BPF_FUNC_BPF_FETCH_GLOBAL:
-            return &bpf_vm_fetch_global;
-        case BPF_FUNC_BPF_NOW_MS:
-            return &bpf_vm_now_ms;
-        case BPF_FUNC_BPF_SAUL_REG_FIND_NTH:
-            return &bpf_vm_saul_reg_find_nth;
-        case BPF_FUNC_BPF_SAUL_REG_FIND_TYPE:
-            return &bpf_vm_saul_reg_find_type;
-        case BPF_FUNC_BPF_SAUL_REG_READ:
-            return &bpf_vm_saul_reg_read;
-#ifdef MODULE_GCOAP
-        case BPF_FUNC_BPF_GCOAP_RESP_INIT:
-            return &bpf_vm_gcoap_resp_init;
-        case BPF_FUNC_BPF_COAP_OPT_FINISH:
-            return &bpf_vm_coap_opt_finish;
-        case BPF_FUNC_BPF_COAP_ADD_FORMAT:
-            return &bpf_vm_coap_add_format;
-        case BPF_FUNC_BPF_COAP_GET_PDU:
-            return &bpf_vm_coap_get_pdu;
-#endif
-#ifdef MODULE_FMT
-        case BPF_FUNC_BPF_FMT_S16_DFP:
-            return &bpf_vm_fmt_s16_dfp;
-#endif
-        default:
-            return NULL;
+    const bpf_prog_array_t *array = bpf->tail_calls;
+    if (!array || index >= array->len) {
+        return NULL;
+    }
+    bpf_t *target = array->programs[index];
+    if (!target || !(target->flags & BPF_FLAG_SETUP_DONE) ||
+            bpf_verify_preflight(target->application,
+                                 target->application_len) < 0) {
+        return NULL;
     }
+    return target;
 }
 
 #define DST regmap[instr->dst]
@@ -174,15 +134,26 @@ static bpf_call_t _bpf_get_call(uint32_t num)
 int bpf_run(bpf_t *bpf, const void *ctx, int64_t *result)
 {
     int res = BPF_OK;
-    bpf->instruction_count = 0;
     uint64_t regmap[11] = { 0 };
     regmap[1] = (uint64_t)(uintptr_t)ctx;
     regmap[10] = (uint64_t)(uintptr_t)(bpf->stack + bpf->stack_size);
 
+    /* Interpreter state lives in locals, bpf is only written back on exit */
     const bpf_instruction_t *instr = (const bpf_instruction_t*)bpf->application;
+    const bpf_instruction_t *app_start = instr;
+    const bpf_instruction_t *app_end =
+        (const bpf_instruction_t*)(bpf->application + bpf->application_len);
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    uint32_t instruction_count = 0;
+    /* Tail calls replace bpf, the count belongs to the program executed */
+    bpf_t *const origin = bpf;
+#endif
     bool jump_cond = false;
+    _call_frame_t frames[CONFIG_BPF_MAX_CALL_DEPTH];
+    unsigned frame = 0;
+    unsigned tail_calls = 0;
 
-    res = _preflight_checks(bpf);
+    res = bpf_verify_preflight(bpf->application, bpf->application_len);
     if (res < 0) {
         return res;
     }
@@ -232,18 +203,25 @@ int bpf_run(bpf_t *bpf, const void *ctx, int64_t *result)
 jump_instr:
     if (jump_cond) {
         instr += instr->offset;
-        if (((intptr_t)instr >= (intptr_t)(bpf->application + bpf->application_len))
-                || ((intptr_t)instr < (intptr_t)bpf->application)) {
+        if ((instr >= app_end) || (instr < app_start)) {
             res = BPF_ILLEGAL_JUMP;
             goto exit;
         }
+#if CONFIG_BPF_INSTRUCTION_BUDGET
+        if (instruction_count >= CONFIG_BPF_INSTRUCTION_BUDGET) {
+            res = BPF_OUT_OF_BUDGET;
+            goto exit;
+        }
+#endif
     }
 
     /* Intentionally falls through to select_instr */
 select_instr:
     instr++;
 bpf_start:
-    bpf->instruction_count++;
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    instruction_count++;
+#endif
     goto *_jumptable[instr->opcode];
 
     ALU(ADD,  +)
@@ -275,10 +253,10 @@ ALU32_MOV_REG:
     CONT;
 #endif
 ALU64_MOV_IMM:
-    DST = (uint32_t)IMM;
+    DST = (int64_t)IMM;
     CONT;
 ALU64_MOV_REG:
-    DST = (uint32_t)SRC;
+    DST = SRC;
     CONT;
 
     /* Arithmetic shift */
@@ -298,9 +276,10 @@ ALU32_ARSH_IMM:
 #endif
 
 MEM_LDDW_IMM:
-    DST = (uint64_t)instr->immediate;
+    /* DST refers to the second slot after advancing */
+    DST = (uint32_t)instr->immediate |
+          ((uint64_t)(uint32_t)instr[1].immediate << 32);
     instr++;
-    DST |= ((uint64_t)(instr->immediate)) << 32;
     CONT;
 
 #define MEM(SIZEOP, SIZE)                     \
@@ -345,8 +324,54 @@ JUMP_ALWAYS:
     COND_JMP(i, SLT, <)
     COND_JMP(i, SLE, <=)
 OPCODE_CALL:
+    if (instr->src == BPF_INSTRUCTION_CALL_PSEUDO) {
+        if ((frame == CONFIG_BPF_MAX_CALL_DEPTH) ||
+                (regmap[10] - bpf->frame_size < (uintptr_t)bpf->stack)) {
+            res = BPF_STACK_OVERFLOW;
+            goto exit;
+        }
+        frames[frame].ret = instr;
+        memcpy(frames[frame].regs, &regmap[6], sizeof(frames[frame].regs));
+        frame++;
+        regmap[10] -= bpf->frame_size;
+        instr += instr->immediate;
+        /* Check the call target, not the instruction before it */
+        if ((instr + 1 >= app_end) || (instr + 1 < app_start)) {
+            res = BPF_ILLEGAL_JUMP;
+            goto exit;
+        }
+        CONT;
+    }
+    if (instr->immediate == BPF_FUNC_BPF_TAIL_CALL) {
+        bpf_t *target = _tail_call_target(bpf, regmap[2]);
+        if (!target || frame || (tail_calls == CONFIG_BPF_MAX_TAIL_CALLS)) {
+            /* Failed tail calls continue with the next instruction */
+            regmap[0] = (uint64_t)-1;
+            CONT;
+        }
+#if CONFIG_BPF_INSTRUCTION_BUDGET
+        if (instruction_count >= CONFIG_BPF_INSTRUCTION_BUDGET) {
+            res = BPF_OUT_OF_BUDGET;
+            goto exit;
+        }
+#endif
+        tail_calls++;
+        target->arg_region.start = bpf->arg_region.start;
+        target->arg_region.len = bpf->arg_region.len;
+#ifdef MODULE_BPF_PKT
+        target->pkt = bpf->pkt;
+        bpf->pkt = NULL;
+#endif
+        bpf = target;
+        instr = (const bpf_instruction_t*)bpf->application;
+        app_start = instr;
+        app_end = (const bpf_instruction_t*)(bpf->application +
+                                             bpf->application_len);
+        regmap[10] = (uint64_t)(uintptr_t)(bpf->stack + bpf->stack_size);
+        goto bpf_start;
+    }
     {
-        bpf_call_t call = _bpf_get_call(instr->immediate);
+        bpf_call_t call = bpf_get_call(instr->immediate);
         if (call) {
             regmap[0] = (*(call))(bpf,
                                   regmap[1],
@@ -362,6 +387,13 @@ OPCODE_CALL:
         }
     }
 OPCODE_RETURN:
+    if (frame) {
+        frame--;
+        instr = frames[frame].ret;
+        memcpy(&regmap[6], frames[frame].regs, sizeof(frames[frame].regs));
+        regmap[10] += bpf->frame_size;
+        CONT;
+    }
     goto exit;
 
 invalid_instruction:
@@ -372,8 +404,14 @@ mem_error:
     res = BPF_ILLEGAL_MEM;
 
 exit:
-
-    DEBUG("Number of instructions: %"PRIu32"\n", bpf->instruction_count);
+#ifdef MODULE_BPF_PKT
+    /* Don't leave the packet with a tail call target */
+    bpf->pkt = NULL;
+#endif
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    origin->instruction_count = instruction_count;
+    DEBUG("Number of instructions: %"PRIu32"\n", instruction_count);
+#endif
     *result = regmap[0];
     return res;
 }
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bpf.h"
+#include "bpf/log.h"
+#include "irq.h"
+#include "mutex.h"
+#include "thread.h"
+#include "tsrb.h"
+
+#if CONFIG_BPF_LOG_FMT_MAX > UINT8_MAX
+#error "CONFIG_BPF_LOG_FMT_MAX must fit in a uint8_t"
+#endif
+
+/* Followed by fmt_len bytes of format string in the buffer */
+typedef struct {
+    uint32_t args[BPF_LOG_ARGS_NUMOF];
+    uint8_t fmt_len;
+} _record_t;
+
+static uint8_t _buf[CONFIG_BPF_LOG_BUF_SIZE];
+static tsrb_t _rb = TSRB_INIT(_buf);
+static uint32_t _dropped;
+
+/* Serializes the log thread and the shell command */
+static mutex_t _drain_lock = MUTEX_INIT;
+
+#if CONFIG_BPF_LOG_THREAD
+static char _stack[CONFIG_BPF_LOG_STACKSIZE];
+/* Unlocked by writers to wake up the log thread */
+static mutex_t _pending = MUTEX_INIT_LOCKED;
+
+static void *_log_thread(void *arg)
+{
+    (void)arg;
+    while (1) {
+        mutex_lock(&_pending);
+        bpf_log_drain();
+    }
+    return NULL;
+}
+#endif
+
+void bpf_log_init(void)
+{
+#if CONFIG_BPF_LOG_THREAD
+    thread_create(_stack, sizeof(_stack), CONFIG_BPF_LOG_PRIO,
+                  THREAD_CREATE_STACKTEST, _log_thread, NULL, "bpf_log");
+#endif
+}
+
+int bpf_log_write(const char *fmt, size_t fmt_len, const uint32_t *args)
+{
+    _record_t record = { .fmt_len = fmt_len };
+    memcpy(record.args, args, sizeof(record.args));
+
+    /* Writers can preempt each other and tsrb only supports a single
+     * producer, so mask interrupts to keep records contiguous */
+    unsigned state = irq_disable();
+    if (tsrb_free(&_rb) < sizeof(record) + fmt_len) {
+        _dropped++;
+        irq_restore(state);
+        return -ENOBUFS;
+    }
+    tsrb_add(&_rb, (const uint8_t *)&record, sizeof(record));
+    tsrb_add(&_rb, (const uint8_t *)fmt, fmt_len);
+    irq_restore(state);
+
+#if CONFIG_BPF_LOG_THREAD
+    mutex_unlock(&_pending);
+#endif
+    return 0;
+}
+
+int bpf_log_printf(const bpf_t *bpf, const char *fmt, const uint32_t *args)
+{
+    size_t len = 0;
+
+    while (len < CONFIG_BPF_LOG_FMT_MAX) {
+        if (bpf_check_mem(bpf, (intptr_t)&fmt[len], 1,
+                          BPF_MEM_REGION_READ) < 0) {
+            return -EFAULT;
+        }
+        if (fmt[len] == '\0') {
+            break;
+        }
+        len++;
+    }
+    return bpf_log_write(fmt, len, args);
+}
+
+static void _print_verbatim(const char *start, const char *end)
+{
+    if (end > start) {
+        printf("%.*s", (int)(end - start), start);
+    }
+}
+
+static void _print_record(const char *fmt, size_t len, const uint32_t *args)
+{
+    const char *end = fmt + len;
+    unsigned arg = 0;
+
+    while (fmt < end) {
+        const char *conv = memchr(fmt, '%', end - fmt);
+        if (!conv) {
+            _print_verbatim(fmt, end);
+            return;
+        }
+        _print_verbatim(fmt, conv);
+
+        /* Copy flags, width and precision, drop length modifiers */
+        char spec[16] = "%";
+        size_t spec_len = 1;
+        const char *pos = conv + 1;
+        while ((pos < end) && *pos && strchr("-+ #.0123456789", *pos) &&
+                (spec_len < sizeof(spec) - 4)) {
+            spec[spec_len++] = *pos++;
+        }
+        while ((pos < end) && ((*pos == 'l') || (*pos == 'h'))) {
+            pos++;
+        }
+        if (pos == end) {
+            _print_verbatim(conv, end);
+            return;
+        }
+
+        const char *length = NULL;
+        switch (*pos) {
+            case 'd':
+            case 'i':
+                length = PRId32;
+                break;
+            case 'u':
+                length = PRIu32;
+                break;
+            case 'x':
+                length = PRIx32;
+                break;
+            case 'X':
+                length = PRIX32;
+                break;
+            case 'c':
+                length = "c";
+                break;
+            case '%':
+                if (pos == conv + 1) {
+                    putchar('%');
+                    fmt = pos + 1;
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (!length || (arg == BPF_LOG_ARGS_NUMOF)) {
+            _print_verbatim(conv, pos + 1);
+            /* Pointers are not valid anymore, but keep the arguments aligned */
+            if (((*pos == 's') || (*pos == 'p')) &&
+                    (arg < BPF_LOG_ARGS_NUMOF)) {
+                arg++;
+            }
+        }
+        else {
+            strcpy(&spec[spec_len], length);
+            if (*pos == 'c') {
+                printf(spec, (int)(char)args[arg++]);
+            }
+            else if ((*pos == 'd') || (*pos == 'i')) {
+                printf(spec, (int32_t)args[arg++]);
+            }
+            else {
+                printf(spec, args[arg++]);
+            }
+        }
+        fmt = pos + 1;
+    }
+}
+
+unsigned bpf_log_drain(void)
+{
+    unsigned count = 0;
+    _record_t record;
+    char fmt[CONFIG_BPF_LOG_FMT_MAX];
+
+    mutex_lock(&_drain_lock);
+    /* Records are added atomically, the format string is always there */
+    while (tsrb_get(&_rb, (uint8_t *)&record, sizeof(record)) ==
+            sizeof(record)) {
+        tsrb_get(&_rb, (uint8_t *)fmt, record.fmt_len);
+        _print_record(fmt, record.fmt_len, record.args);
+        count++;
+    }
+    mutex_unlock(&_drain_lock);
+    return count;
+}
+
+uint32_t bpf_log_dropped(void)
+{
+    return _dropped;
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bloom.h"
+#include "bpf/map.h"
+#include "bpf/snapshot.h"
+#include "irq.h"
+#include "kernel_defines.h"
+#include "memarray.h"
+#include "net/ipv6/addr.h"
+
+static bpf_map_t *_maps;
+
+static void _invalidate(void)
+{
+    if (IS_USED(MODULE_BPF_SNAPSHOT)) {
+        bpf_snapshot_invalidate();
+    }
+}
+
+/* Marks a part of the map content as dirty in the snapshot image */
+static void _mark(const bpf_map_t *map, size_t offset, size_t len)
+{
+    if (IS_USED(MODULE_BPF_SNAPSHOT)) {
+        size_t start = bpf_snapshot_map_offset(map);
+        if (start) {
+            bpf_snapshot_mark(start + offset, len);
+        }
+    }
+}
+
+void bpf_map_register(bpf_map_t *map)
+{
+    unsigned state = irq_disable();
+    map->next = _maps;
+    _maps = map;
+    irq_restore(state);
+    _invalidate();
+}
+
+void bpf_map_unregister(bpf_map_t *map)
+{
+    unsigned state = irq_disable();
+    for (bpf_map_t **slot = &_maps; *slot; slot = &(*slot)->next) {
+        if (*slot == map) {
+            *slot = map->next;
+            break;
+        }
+    }
+    irq_restore(state);
+    _invalidate();
+}
+
+bpf_map_t *bpf_map_find(uint32_t id, bpf_map_type_t type)
+{
+    for (bpf_map_t *map = _maps; map; map = map->next) {
+        if (map->id == id) {
+            return (map->type == type) ? map : NULL;
+        }
+    }
+    return NULL;
+}
+
+bpf_map_t *bpf_map_next(const bpf_map_t *prev)
+{
+    return prev ? prev->next : _maps;
+}
+
+void bpf_map_bloom_init(bpf_map_bloom_t *map, uint32_t id, uint8_t *bitfield,
+                        size_t size, hashfp_t *hashes, int hashes_numof)
+{
+    map->super.id = id;
+    map->super.type = BPF_MAP_TYPE_BLOOM;
+    bloom_init(&map->bloom, size, bitfield, hashes, hashes_numof);
+}
+
+void bpf_map_bloom_add(bpf_map_bloom_t *map, const void *key, size_t len)
+{
+    bloom_add(&map->bloom, key, len);
+    /* The hashes scatter the bits over the full filter */
+    _mark(&map->super, 0, (map->bloom.m + 7) / 8);
+}
+
+void bpf_map_lpm_init(bpf_map_lpm_t *map, uint32_t id,
+                      bpf_map_lpm_node_t *nodes, size_t nodes_numof)
+{
+    map->super.id = id;
+    map->super.type = BPF_MAP_TYPE_LPM;
+    map->root = NULL;
+    map->storage = nodes;
+    map->storage_numof = nodes_numof;
+    memset(nodes, 0, nodes_numof * sizeof(bpf_map_lpm_node_t));
+    memarray_init(&map->nodes, nodes, sizeof(bpf_map_lpm_node_t), nodes_numof);
+}
+
+void bpf_map_lpm_clear(bpf_map_lpm_t *map)
+{
+    map->root = NULL;
+    memset(map->storage, 0, map->storage_numof * sizeof(bpf_map_lpm_node_t));
+    memarray_init(&map->nodes, map->storage, sizeof(bpf_map_lpm_node_t),
+                  map->storage_numof);
+    _mark(&map->super, 0,
+          map->storage_numof * BPF_SNAPSHOT_LPM_RECORD_SIZE);
+}
+
+static void _mark_node(const bpf_map_lpm_t *map,
+                       const bpf_map_lpm_node_t *node)
+{
+    _mark(&map->super,
+          (size_t)(node - map->storage) * BPF_SNAPSHOT_LPM_RECORD_SIZE,
+          BPF_SNAPSHOT_LPM_RECORD_SIZE);
+}
+
+static unsigned _bit(const ipv6_addr_t *addr, uint8_t pos)
+{
+    return (addr->u8[pos / 8] >> (7 - (pos % 8))) & 1;
+}
+
+/* Number of leading bits of the node prefix shared with the first len bits
+ * of addr */
+static uint8_t _match(const bpf_map_lpm_node_t *node, const ipv6_addr_t *addr,
+                      uint8_t len)
+{
+    uint8_t match = ipv6_addr_match_prefix(&node->prefix, addr);
+
+    if (match > node->len) {
+        match = node->len;
+    }
+    return (match > len) ? len : match;
+}
+
+static bpf_map_lpm_node_t *_alloc_node(bpf_map_lpm_t *map,
+                                       const ipv6_addr_t *prefix, uint8_t len)
+{
+    bpf_map_lpm_node_t *node = memarray_calloc(&map->nodes);
+
+    if (node) {
+        ipv6_addr_init_prefix(&node->prefix, prefix, len);
+        node->len = len;
+    }
+    return node;
+}
+
+int bpf_map_lpm_add(bpf_map_lpm_t *map, const ipv6_addr_t *prefix,
+                    uint8_t len, uint32_t value)
+{
+    bpf_map_lpm_node_t **slot = &map->root;
+    bpf_map_lpm_node_t *node;
+    uint8_t match = 0;
+
+    if (len > IPV6_ADDR_BIT_LEN) {
+        len = IPV6_ADDR_BIT_LEN;
+    }
+
+    while ((node = *slot)) {
+        match = _match(node, prefix, len);
+        if ((match != node->len) || (node->len == len)) {
+            break;
+        }
+        slot = &node->child[_bit(prefix, node->len)];
+    }
+
+    if (node && (match == len) && (node->len == len)) {
+        node->value = value;
+        node->has_value = true;
+        _mark_node(map, node);
+        return 0;
+    }
+
+    bpf_map_lpm_node_t *new = _alloc_node(map, prefix, len);
+    if (!new) {
+        return -ENOMEM;
+    }
+    new->value = value;
+    new->has_value = true;
+    _mark_node(map, new);
+
+    if (!node) {
+        *slot = new;
+        return 0;
+    }
+
+    if (match == len) {
+        /* The new prefix contains the existing node */
+        new->child[_bit(&node->prefix, len)] = node;
+        *slot = new;
+        return 0;
+    }
+
+    /* Both branch off at match, join them with an intermediate node */
+    bpf_map_lpm_node_t *branch = _alloc_node(map, prefix, match);
+    if (!branch) {
+        memarray_free(&map->nodes, new);
+        return -ENOMEM;
+    }
+    unsigned bit = _bit(prefix, match);
+    branch->child[bit] = new;
+    branch->child[!bit] = node;
+    *slot = branch;
+    return 0;
+}
+
+int bpf_map_lpm_remove(bpf_map_lpm_t *map, const ipv6_addr_t *prefix,
+                       uint8_t len)
+{
+    bpf_map_lpm_node_t **parent_slot = NULL;
+    bpf_map_lpm_node_t **slot = &map->root;
+    bpf_map_lpm_node_t *node;
+
+    if (len > IPV6_ADDR_BIT_LEN) {
+        len = IPV6_ADDR_BIT_LEN;
+    }
+
+    while ((node = *slot)) {
+        if (_match(node, prefix, len) != node->len) {
+            return -ENOENT;
+        }
+        if (node->len == len) {
+            break;
+        }
+        parent_slot = slot;
+        slot = &node->child[_bit(prefix, node->len)];
+    }
+
+    if (!node || !node->has_value) {
+        return -ENOENT;
+    }
+
+    if (node->child[0] && node->child[1]) {
+        /* Still needed as a branch */
+        node->has_value = false;
+        _mark_node(map, node);
+        return 0;
+    }
+
+    *slot = node->child[0] ? node->child[0] : node->child[1];
+    /* Free nodes are skipped by bpf_map_lpm_next() */
+    node->has_value = false;
+    _mark_node(map, node);
+    memarray_free(&map->nodes, node);
+
+    /* An intermediate parent with a single child left is not needed */
+    if (!*slot && parent_slot && !(*parent_slot)->has_value) {
+        bpf_map_lpm_node_t *parent = *parent_slot;
+        *parent_slot = parent->child[0] ? parent->child[0] : parent->child[1];
+        memarray_free(&map->nodes, parent);
+    }
+    return 0;
+}
+
+int bpf_map_lpm_lookup(const bpf_map_lpm_t *map, const ipv6_addr_t *addr,
+                       uint32_t *value)
+{
+    const bpf_map_lpm_node_t *found = NULL;
+    const bpf_map_lpm_node_t *node = map->root;
+
+    while (node && (_match(node, addr, IPV6_ADDR_BIT_LEN) == node->len)) {
+        if (node->has_value) {
+            found = node;
+        }
+        if (node->len == IPV6_ADDR_BIT_LEN) {
+            break;
+        }
+        node = node->child[_bit(addr, node->len)];
+    }
+
+    if (!found) {
+        return -ENOENT;
+    }
+    if (value) {
+        *value = found->value;
+    }
+    return found->len;
+}
+
+const bpf_map_lpm_node_t *bpf_map_lpm_next(const bpf_map_lpm_t *map,
+                                           const bpf_map_lpm_node_t *prev)
+{
+    /* Only nodes in the trie have a value, walking the storage doesn't need
+     * a stack */
+    size_t i = prev ? (size_t)(prev - map->storage) + 1 : 0;
+
+    for (; i < map->storage_numof; i++) {
+        if (map->storage[i].has_value) {
+            return &map->storage[i];
+        }
+    }
+    return NULL;
+}
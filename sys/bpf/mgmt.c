@@ -0,0 +1,499 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bpf.h"
+#include "bpf/instance.h"
+#include "bpf/mgmt.h"
+#include "bpf/verify.h"
+#include "mutex.h"
+#include "nanocbor/nanocbor.h"
+
+#ifdef MODULE_BPF_MAP
+#include "bpf/map.h"
+#endif
+#ifdef MODULE_GCOAP
+#include "net/gcoap.h"
+#endif
+#ifdef MODULE_VFS
+#include "vfs.h"
+#endif
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static bpf_mgmt_slot_t _slots[CONFIG_BPF_MGMT_SLOT_NUMOF];
+static mutex_t _lock = MUTEX_INIT;
+
+int bpf_mgmt_verify(const uint8_t *application, size_t len)
+{
+    bpf_verify_result_t verified;
+    if (bpf_verify(application, len, &verified) < 0) {
+        return -EINVAL;
+    }
+    return verified.stack_depth;
+}
+
+static bpf_mgmt_slot_t *_used(unsigned slot)
+{
+    if ((slot >= CONFIG_BPF_MGMT_SLOT_NUMOF) || !_slots[slot].instance) {
+        return NULL;
+    }
+    return &_slots[slot];
+}
+
+/* Reserves a free slot by setting its length, called with _lock held */
+static int _reserve(size_t len)
+{
+    if (len > CONFIG_BPF_MGMT_APP_SIZE) {
+        return -EFBIG;
+    }
+    for (unsigned i = 0; i < CONFIG_BPF_MGMT_SLOT_NUMOF; i++) {
+        if (!_slots[i].application_len) {
+            _slots[i].application_len = len;
+            return i;
+        }
+    }
+    return -ENOSPC;
+}
+
+/* Instantiates the bytecode in a reserved slot, called with _lock held */
+static int _instantiate(unsigned slot)
+{
+    bpf_mgmt_slot_t *s = &_slots[slot];
+    bpf_program_t *program = bpf_program_load(s->app.application,
+                                              s->application_len);
+    if (program) {
+        s->instance = bpf_instance_new(program);
+        /* The instance holds its own reference */
+        bpf_program_release(program);
+    }
+    if (!s->instance) {
+        s->application_len = 0;
+        return -EINVAL;
+    }
+    s->hook = (bpf_hook_t){ .application = &s->instance->bpf };
+    s->trigger = -1;
+    DEBUG("bpf_mgmt: loaded %u bytes into slot %u\n",
+          (unsigned)s->application_len, slot);
+    return slot;
+}
+
+int bpf_mgmt_load(const uint8_t *application, size_t len)
+{
+    mutex_lock(&_lock);
+    int slot = _reserve(len);
+    if (slot >= 0) {
+        memcpy(_slots[slot].app.application, application, len);
+        slot = _instantiate(slot);
+    }
+    mutex_unlock(&_lock);
+    return slot;
+}
+
+#ifdef MODULE_VFS
+/* Reads a file into a reserved slot, called with _lock held */
+static int _read_file(const char *path)
+{
+    int fd = vfs_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        return fd;
+    }
+
+    int slot = _reserve(CONFIG_BPF_MGMT_APP_SIZE);
+    if (slot >= 0) {
+        bpf_mgmt_slot_t *s = &_slots[slot];
+        ssize_t res = vfs_read(fd, s->app.application, sizeof(s->app));
+        /* Reject files that don't fit instead of using a truncated copy */
+        char extra;
+        if ((res > 0) && (vfs_read(fd, &extra, 1) == 0)) {
+            s->application_len = res;
+        }
+        else {
+            s->application_len = 0;
+            slot = (res < 0) ? (int)res : -EFBIG;
+        }
+    }
+    vfs_close(fd);
+    return slot;
+}
+
+int bpf_mgmt_load_file(const char *path)
+{
+    mutex_lock(&_lock);
+    int slot = _read_file(path);
+    if (slot >= 0) {
+        slot = _instantiate(slot);
+    }
+    mutex_unlock(&_lock);
+    return slot;
+}
+
+int bpf_mgmt_verify_file(const char *path)
+{
+    mutex_lock(&_lock);
+    int res = _read_file(path);
+    if (res >= 0) {
+        /* Only borrowed the slot buffer */
+        bpf_mgmt_slot_t *s = &_slots[res];
+        res = bpf_mgmt_verify(s->app.application, s->application_len);
+        s->application_len = 0;
+    }
+    mutex_unlock(&_lock);
+    return res;
+}
+#endif
+
+static int _detach(bpf_mgmt_slot_t *s)
+{
+    if (s->trigger < 0) {
+        return -ENOENT;
+    }
+    bpf_hook_uninstall(&s->hook, s->trigger);
+    s->trigger = -1;
+    return 0;
+}
+
+int bpf_mgmt_unload(unsigned slot)
+{
+    mutex_lock(&_lock);
+    bpf_mgmt_slot_t *s = _used(slot);
+    if (!s) {
+        mutex_unlock(&_lock);
+        return -ENOENT;
+    }
+    _detach(s);
+    bpf_instance_free(s->instance);
+    s->instance = NULL;
+    s->application_len = 0;
+    mutex_unlock(&_lock);
+    return 0;
+}
+
+int bpf_mgmt_attach(unsigned slot, unsigned trigger, bpf_hook_policy_t policy)
+{
+    if ((trigger >= BPF_HOOK_NUM) || (policy > BPF_POLICY_SINGLE)) {
+        return -EINVAL;
+    }
+
+    int res = 0;
+    mutex_lock(&_lock);
+    bpf_mgmt_slot_t *s = _used(slot);
+    if (!s) {
+        res = -ENOENT;
+    }
+    else if (s->trigger >= 0) {
+        res = -EALREADY;
+    }
+    else {
+        s->hook.policy = policy;
+        res = bpf_hook_install(&s->hook, trigger);
+        if (res == 0) {
+            s->trigger = trigger;
+        }
+    }
+    mutex_unlock(&_lock);
+    return res;
+}
+
+int bpf_mgmt_detach(unsigned slot)
+{
+    mutex_lock(&_lock);
+    bpf_mgmt_slot_t *s = _used(slot);
+    int res = s ? _detach(s) : -ENOENT;
+    mutex_unlock(&_lock);
+    return res;
+}
+
+const bpf_mgmt_slot_t *bpf_mgmt_get(unsigned slot)
+{
+    return _used(slot);
+}
+
+static ssize_t _encoded(nanocbor_encoder_t *enc, size_t len)
+{
+    /* The encoder keeps counting when the buffer is full */
+    size_t res = nanocbor_encoded_len(enc);
+    return (res > len) ? -ENOBUFS : (ssize_t)res;
+}
+
+ssize_t bpf_mgmt_list_cbor(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+    size_t used = 0;
+
+    nanocbor_encoder_init(&enc, buf, len);
+
+    mutex_lock(&_lock);
+    for (unsigned i = 0; i < CONFIG_BPF_MGMT_SLOT_NUMOF; i++) {
+        used += _used(i) ? 1 : 0;
+    }
+    nanocbor_fmt_array(&enc, used);
+    for (unsigned i = 0; i < CONFIG_BPF_MGMT_SLOT_NUMOF; i++) {
+        const bpf_mgmt_slot_t *s = _used(i);
+        if (!s) {
+            continue;
+        }
+        nanocbor_fmt_array(&enc, 8);
+        nanocbor_fmt_uint(&enc, i);
+        nanocbor_fmt_uint(&enc, s->application_len);
+        nanocbor_fmt_uint(&enc, s->instance->program->stack_size);
+        if (s->trigger < 0) {
+            nanocbor_fmt_null(&enc);
+        }
+        else {
+            nanocbor_fmt_uint(&enc, s->trigger);
+        }
+        nanocbor_fmt_uint(&enc, s->hook.policy);
+        nanocbor_fmt_uint(&enc, s->hook.executions);
+        nanocbor_fmt_uint(&enc, s->hook.errors);
+#if CONFIG_BPF_HOOK_PROFILE
+        nanocbor_fmt_uint(&enc, s->hook.duration_us);
+#else
+        nanocbor_fmt_null(&enc);
+#endif
+    }
+    mutex_unlock(&_lock);
+    return _encoded(&enc, len);
+}
+
+#ifdef MODULE_BPF_MAP
+static void _encode_lpm(nanocbor_encoder_t *enc, const bpf_map_lpm_t *map)
+{
+    size_t num = 0;
+
+    for (const bpf_map_lpm_node_t *node = bpf_map_lpm_next(map, NULL); node;
+            node = bpf_map_lpm_next(map, node)) {
+        num++;
+    }
+    nanocbor_fmt_array(enc, num);
+    for (const bpf_map_lpm_node_t *node = bpf_map_lpm_next(map, NULL); node;
+            node = bpf_map_lpm_next(map, node)) {
+        nanocbor_fmt_array(enc, 3);
+        nanocbor_put_bstr(enc, node->prefix.u8, (node->len + 7) / 8);
+        nanocbor_fmt_uint(enc, node->len);
+        nanocbor_fmt_uint(enc, node->value);
+    }
+}
+
+ssize_t bpf_mgmt_maps_cbor(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+    size_t num = 0;
+
+    nanocbor_encoder_init(&enc, buf, len);
+
+    for (bpf_map_t *map = bpf_map_next(NULL); map; map = bpf_map_next(map)) {
+        num++;
+    }
+    nanocbor_fmt_array(&enc, num);
+    for (bpf_map_t *map = bpf_map_next(NULL); map; map = bpf_map_next(map)) {
+        nanocbor_fmt_array(&enc, 3);
+        nanocbor_fmt_uint(&enc, map->id);
+        nanocbor_fmt_uint(&enc, map->type);
+        if (map->type == BPF_MAP_TYPE_BLOOM) {
+            const bloom_t *bloom = &((bpf_map_bloom_t *)map)->bloom;
+            nanocbor_put_bstr(&enc, bloom->a, (bloom->m + 7) / 8);
+        }
+        else {
+            _encode_lpm(&enc, (bpf_map_lpm_t *)map);
+        }
+    }
+    return _encoded(&enc, len);
+}
+#endif
+
+#ifdef MODULE_GCOAP
+static union {
+    uint64_t align;
+    uint8_t application[CONFIG_BPF_MGMT_APP_SIZE];
+} _upload;
+
+static ssize_t _reply_cbor(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                           ssize_t (*encode)(uint8_t *, size_t))
+{
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    coap_opt_add_format(pdu, COAP_FORMAT_CBOR);
+    ssize_t resp_len = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+
+    ssize_t res = encode(pdu->payload, pdu->payload_len);
+    if (res < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_INTERNAL_SERVER_ERROR);
+    }
+    return resp_len + res;
+}
+
+static ssize_t _reply_int(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                          unsigned code, int64_t val)
+{
+    gcoap_resp_init(pdu, buf, len, code);
+    coap_opt_add_format(pdu, COAP_FORMAT_CBOR);
+    ssize_t resp_len = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, pdu->payload, pdu->payload_len);
+    nanocbor_fmt_int(&enc, val);
+    return resp_len + _encoded(&enc, pdu->payload_len);
+}
+
+static unsigned _errno_to_code(int res)
+{
+    switch (res) {
+        case -ENOENT:
+            return COAP_CODE_PATH_NOT_FOUND;
+        case -EFBIG:
+            return COAP_CODE_REQUEST_ENTITY_TOO_LARGE;
+        case -EINVAL:
+        case -EALREADY:
+            return COAP_CODE_BAD_REQUEST;
+        default:
+            return COAP_CODE_INTERNAL_SERVER_ERROR;
+    }
+}
+
+static ssize_t _prog_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             void *ctx)
+{
+    (void)ctx;
+
+    if (coap_method2flag(coap_get_code_detail(pdu)) == COAP_GET) {
+        return _reply_cbor(pdu, buf, len, bpf_mgmt_list_cbor);
+    }
+
+    coap_block1_t block1 = { 0 };
+    int blockwise = coap_get_block1(pdu, &block1);
+
+    if ((block1.offset + pdu->payload_len) > sizeof(_upload)) {
+        return gcoap_response(pdu, buf, len,
+                              COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
+    }
+    memcpy(&_upload.application[block1.offset], pdu->payload,
+           pdu->payload_len);
+
+    if (block1.more) {
+        gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTINUE);
+        coap_opt_add_block1_control(pdu, &block1);
+        return coap_opt_finish(pdu, COAP_OPT_FINISH_NONE);
+    }
+
+    int res = bpf_mgmt_load(_upload.application,
+                            block1.offset + pdu->payload_len);
+    if (res < 0) {
+        return gcoap_response(pdu, buf, len, _errno_to_code(res));
+    }
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CREATED);
+    if (blockwise) {
+        coap_opt_add_block1_control(pdu, &block1);
+    }
+    coap_opt_add_format(pdu, COAP_FORMAT_CBOR);
+    ssize_t resp_len = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, pdu->payload, pdu->payload_len);
+    nanocbor_fmt_uint(&enc, res);
+    return resp_len + _encoded(&enc, pdu->payload_len);
+}
+
+static ssize_t _verify_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                               void *ctx)
+{
+    (void)ctx;
+
+    int res = bpf_mgmt_verify(pdu->payload, pdu->payload_len);
+    if (res < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_REQUEST);
+    }
+    return _reply_int(pdu, buf, len, COAP_CODE_CONTENT, res);
+}
+
+static ssize_t _attach_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                               void *ctx)
+{
+    (void)ctx;
+    nanocbor_value_t val, arr;
+    uint32_t slot, trigger, policy;
+
+    nanocbor_decoder_init(&val, pdu->payload, pdu->payload_len);
+    if ((nanocbor_enter_array(&val, &arr) < 0) ||
+            (nanocbor_get_uint32(&arr, &slot) < 0) ||
+            (nanocbor_get_uint32(&arr, &trigger) < 0) ||
+            (nanocbor_get_uint32(&arr, &policy) < 0)) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_REQUEST);
+    }
+    int res = bpf_mgmt_attach(slot, trigger, policy);
+    return gcoap_response(pdu, buf, len,
+                          res < 0 ? _errno_to_code(res) : COAP_CODE_CHANGED);
+}
+
+static ssize_t _slot_op(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                        int (*op)(unsigned))
+{
+    nanocbor_value_t val;
+    uint32_t slot;
+
+    nanocbor_decoder_init(&val, pdu->payload, pdu->payload_len);
+    if (nanocbor_get_uint32(&val, &slot) < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_REQUEST);
+    }
+    int res = op(slot);
+    return gcoap_response(pdu, buf, len,
+                          res < 0 ? _errno_to_code(res) : COAP_CODE_CHANGED);
+}
+
+static ssize_t _detach_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                               void *ctx)
+{
+    (void)ctx;
+    return _slot_op(pdu, buf, len, bpf_mgmt_detach);
+}
+
+static ssize_t _unload_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                               void *ctx)
+{
+    (void)ctx;
+    return _slot_op(pdu, buf, len, bpf_mgmt_unload);
+}
+
+#ifdef MODULE_BPF_MAP
+static ssize_t _maps_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             void *ctx)
+{
+    (void)ctx;
+    return _reply_cbor(pdu, buf, len, bpf_mgmt_maps_cbor);
+}
+#endif
+
+/* Must be sorted by path */
+static const coap_resource_t _resources[] = {
+    { "/bpf/attach", COAP_POST, _attach_handler, NULL },
+    { "/bpf/detach", COAP_POST, _detach_handler, NULL },
+#ifdef MODULE_BPF_MAP
+    { "/bpf/maps", COAP_GET, _maps_handler, NULL },
+#endif
+    { "/bpf/prog", COAP_GET | COAP_POST, _prog_handler, NULL },
+    { "/bpf/unload", COAP_POST, _unload_handler, NULL },
+    { "/bpf/verify", COAP_POST, _verify_handler, NULL },
+};
+
+static gcoap_listener_t _listener = {
+    &_resources[0],
+    ARRAY_SIZE(_resources),
+    NULL,
+    NULL
+};
+
+void bpf_mgmt_coap_init(void)
+{
+    gcoap_register_listener(&_listener);
+}
+#endif
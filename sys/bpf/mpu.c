@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bpf.h"
+#include "bpf/mpu.h"
+#include "irq.h"
+#include "mutex.h"
+#include "native_internal.h"
+
+static mutex_t _lock = MUTEX_INIT;
+
+/* Context of the running application, helpers are called with it */
+static bpf_t *_bpf;
+
+/* Set while an isolated application runs, faults end the execution */
+static volatile bool _active;
+
+static sigjmp_buf _env;
+static unsigned _irq_state;
+
+static void _segv(int sig, siginfo_t *info, void *context)
+{
+    (void)info;
+    (void)context;
+
+    if (_active) {
+        _active = false;
+        siglongjmp(_env, 1);
+    }
+    /* Not caused by an application, fault again with the default action */
+    signal(sig, SIG_DFL);
+}
+
+void bpf_mpu_init(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = _segv;
+    sa.sa_flags = SA_SIGINFO;
+
+    _native_syscall_enter();
+    int res = sigaction(SIGSEGV, &sa, NULL);
+    _native_syscall_leave();
+    assert(res == 0);
+    (void)res;
+}
+
+static int _check_regions(const bpf_t *bpf)
+{
+    const uintptr_t mask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+
+    for (const bpf_mem_region_t *region = &bpf->stack_region; region;
+         region = region->next) {
+        if (region->len && (((uintptr_t)region->start | region->len) & mask)) {
+            return -EINVAL;
+        }
+    }
+    return 0;
+}
+
+static void _protect(const bpf_t *bpf, bool isolate)
+{
+    for (const bpf_mem_region_t *region = &bpf->stack_region; region;
+         region = region->next) {
+        int prot = PROT_READ | PROT_WRITE;
+        if (!region->len) {
+            continue;
+        }
+        if (isolate) {
+            prot = ((region->flag & BPF_MEM_REGION_READ) ? PROT_READ : 0) |
+                   ((region->flag & BPF_MEM_REGION_WRITE) ? PROT_WRITE : 0);
+        }
+        mprotect((void *)region->start, region->len, prot);
+    }
+}
+
+static void _enter(void)
+{
+    sigset_t set;
+
+    /* Interrupts are signals, keep them from switching threads but don't
+     * block the segmentation faults of the application */
+    _irq_state = irq_disable();
+    sigemptyset(&set);
+    sigaddset(&set, SIGSEGV);
+    sigprocmask(SIG_UNBLOCK, &set, NULL);
+    _active = true;
+}
+
+static void _leave(void)
+{
+    _active = false;
+    irq_restore(_irq_state);
+}
+
+static int _run(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    int res;
+
+    _protect(bpf, true);
+    _enter();
+    if (sigsetjmp(_env, 1) == 0) {
+        res = bpf->native(bpf, ctx, result);
+    }
+    else {
+        res = BPF_ILLEGAL_MEM;
+    }
+    _leave();
+    _protect(bpf, false);
+    return res;
+}
+
+uint32_t bpf_mpu_call(bpf_t *bpf, uint32_t num, uint32_t a1, uint32_t a2,
+                      uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    (void)bpf;
+    bpf_call_t call = bpf_get_call(num);
+
+    if (!call) {
+        return (uint32_t)BPF_ILLEGAL_CALL;
+    }
+    _leave();
+    uint32_t res = call(_bpf, a1, a2, a3, a4, a5);
+    _enter();
+    return res;
+}
+
+int bpf_mpu_execute(bpf_t *bpf, void *ctx, size_t ctx_len, int64_t *result)
+{
+    if (!bpf->native) {
+        return bpf_execute(bpf, ctx, ctx_len, result);
+    }
+
+    assert(bpf->flags & BPF_FLAG_SETUP_DONE);
+    bpf->arg_region.start = ctx;
+    bpf->arg_region.len = ctx_len;
+
+    if (_check_regions(bpf) < 0) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&_lock);
+    _bpf = bpf;
+    int res = _run(bpf, ctx, result);
+    mutex_unlock(&_lock);
+    return res;
+}
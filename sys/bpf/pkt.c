@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bpf.h"
+#include "bpf/pkt.h"
+#include "bpf/shared.h"
+#include "net/gnrc/pkt.h"
+
+static gnrc_pktsnip_t *_data_snip(gnrc_pktsnip_t *snip)
+{
+    while (snip && (snip->type == GNRC_NETTYPE_NETIF)) {
+        snip = snip->next;
+    }
+    return snip;
+}
+
+int bpf_pkt_execute(bpf_t *bpf, gnrc_pktsnip_t *pkt, int64_t *result)
+{
+    bpf_pkt_t state = {
+        .pkt = _data_snip(pkt),
+    };
+
+    for (gnrc_pktsnip_t *snip = state.pkt; snip; snip = _data_snip(snip->next)) {
+        state.len += snip->size;
+    }
+    state.snip = state.pkt;
+
+    bpf_pkt_ctx_t ctx = { .len = state.len };
+
+    bpf->pkt = &state;
+    int res = bpf_execute(bpf, &ctx, sizeof(ctx), result);
+    /* The state is on the stack, don't leave it behind */
+    bpf->pkt = NULL;
+    return res;
+}
+
+int bpf_pkt_load(bpf_pkt_t *state, uint32_t offset, void *dst, uint32_t len)
+{
+    if ((offset > state->len) || (len > state->len - offset)) {
+        return -1;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    if (offset < state->snip_offset) {
+        state->snip = state->pkt;
+        state->snip_offset = 0;
+    }
+
+    gnrc_pktsnip_t *snip = state->snip;
+    uint32_t start = state->snip_offset;
+
+    /* The length check above guarantees the snip exists */
+    while (offset >= start + snip->size) {
+        start += snip->size;
+        snip = _data_snip(snip->next);
+    }
+    state->snip = snip;
+    state->snip_offset = start;
+
+    uint8_t *out = dst;
+    size_t pos = offset - start;
+    while (1) {
+        size_t chunk = snip->size - pos;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(out, (const uint8_t *)snip->data + pos, chunk);
+        out += chunk;
+        len -= chunk;
+        if (len == 0) {
+            return 0;
+        }
+        snip = _data_snip(snip->next);
+        pos = 0;
+    }
+}
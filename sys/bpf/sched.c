@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "assert.h"
+#include "bpf.h"
+#include "bpf/sched.h"
+#include "event.h"
+#include "irq.h"
+#include "kernel_defines.h"
+#include "mutex.h"
+#include "thread.h"
+#include "ztimer/periodic.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static char _stack[CONFIG_BPF_SCHED_STACKSIZE];
+static event_queue_t _queues[BPF_SCHED_PRIO_NUMOF];
+
+/* Entries bound to message types */
+static bpf_sched_entry_t *_msg_entries;
+static mutex_t _msg_lock = MUTEX_INIT;
+
+static void *_runtime(void *arg)
+{
+    (void)arg;
+    event_queues_claim(_queues, BPF_SCHED_PRIO_NUMOF);
+    event_loop_multi(_queues, BPF_SCHED_PRIO_NUMOF);
+
+    /* should be never reached */
+    return NULL;
+}
+
+void bpf_sched_init(void)
+{
+    event_queues_init_detached(_queues, BPF_SCHED_PRIO_NUMOF);
+    thread_create(_stack, sizeof(_stack), CONFIG_BPF_SCHED_PRIO,
+                  THREAD_CREATE_STACKTEST, _runtime, NULL, "bpf");
+}
+
+static void _execute(event_t *event)
+{
+    bpf_sched_entry_t *entry = container_of(event, bpf_sched_entry_t, super);
+
+#ifdef MODULE_SAUL_REG
+    if (entry->dev) {
+        if (saul_reg_read(entry->dev, &entry->data) < 0) {
+            DEBUG("bpf_sched: sampling %s failed\n", entry->dev->name);
+            return;
+        }
+    }
+#endif
+
+    int64_t result = 0;
+    int res = bpf_execute(entry->bpf, entry->ctx, entry->ctx_len, &result);
+    entry->executions++;
+    DEBUG("bpf_sched: executed %p, res %d\n", (void *)entry, res);
+
+    if (entry->done) {
+        entry->done(entry, res, result);
+    }
+}
+
+static int _periodic_cb(void *arg)
+{
+    bpf_sched_trigger(arg);
+    return ZTIMER_PERIODIC_KEEP_GOING;
+}
+
+void bpf_sched_entry_init(bpf_sched_entry_t *entry, bpf_t *bpf,
+                          void *ctx, size_t ctx_len, bpf_sched_prio_t prio,
+                          bpf_sched_done_t done)
+{
+    assert(prio < BPF_SCHED_PRIO_NUMOF);
+
+    *entry = (bpf_sched_entry_t){
+        .super.handler = _execute,
+        .bpf = bpf,
+        .ctx = ctx,
+        .ctx_len = ctx_len,
+        .prio = prio,
+        .done = done,
+    };
+}
+
+void bpf_sched_trigger(bpf_sched_entry_t *entry)
+{
+    event_queue_t *queue = &_queues[entry->prio];
+
+    /* Checked and queued at once, so concurrent triggers are counted */
+    unsigned state = irq_disable();
+    bool pending = entry->super.list_node.next;
+    if (pending) {
+        entry->coalesced++;
+    }
+    else {
+        clist_rpush(&queue->event_list, &entry->super.list_node);
+    }
+    thread_t *waiter = queue->waiter;
+    irq_restore(state);
+
+    if (!pending && waiter) {
+        thread_flags_set(waiter, THREAD_FLAG_EVENT);
+    }
+}
+
+void bpf_sched_periodic(bpf_sched_entry_t *entry, ztimer_clock_t *clock,
+                        uint32_t interval)
+{
+    ztimer_periodic_init(clock, &entry->timer, _periodic_cb, entry, interval);
+    ztimer_periodic_start(&entry->timer);
+}
+
+#ifdef MODULE_SAUL_REG
+void bpf_sched_saul(bpf_sched_entry_t *entry, saul_reg_t *dev,
+                    ztimer_clock_t *clock, uint32_t interval)
+{
+    entry->dev = dev;
+    entry->ctx = &entry->data;
+    entry->ctx_len = sizeof(entry->data);
+    bpf_sched_periodic(entry, clock, interval);
+}
+#endif
+
+void bpf_sched_msg(bpf_sched_entry_t *entry, uint16_t type)
+{
+    entry->ctx = &entry->msg;
+    entry->ctx_len = sizeof(entry->msg);
+    entry->msg.type = type;
+
+    mutex_lock(&_msg_lock);
+    entry->msg_next = _msg_entries;
+    _msg_entries = entry;
+    mutex_unlock(&_msg_lock);
+}
+
+unsigned bpf_sched_msg_dispatch(const msg_t *msg)
+{
+    unsigned triggered = 0;
+
+    mutex_lock(&_msg_lock);
+    for (bpf_sched_entry_t *entry = _msg_entries; entry;
+            entry = entry->msg_next) {
+        if (entry->msg.type == msg->type) {
+            entry->msg = *msg;
+            bpf_sched_trigger(entry);
+            triggered++;
+        }
+    }
+    mutex_unlock(&_msg_lock);
+    return triggered;
+}
+
+int bpf_sched_hook(bpf_sched_entry_t *entry, bpf_hook_trigger_t trigger)
+{
+    entry->hook = (bpf_hook_t){
+        .application = entry->bpf,
+        .policy = BPF_POLICY_CONTINUE,
+        .flags = BPF_HOOK_FLAG_SCHED,
+    };
+    entry->trigger = trigger;
+    return bpf_hook_install(&entry->hook, trigger);
+}
+
+void bpf_sched_stop(bpf_sched_entry_t *entry)
+{
+    if (entry->timer.clock) {
+        ztimer_periodic_stop(&entry->timer);
+    }
+    if (entry->hook.flags & BPF_HOOK_FLAG_SCHED) {
+        bpf_hook_uninstall(&entry->hook, entry->trigger);
+        /* Running hook executions don't trigger the entry anymore */
+        entry->hook.flags = 0;
+    }
+    mutex_lock(&_msg_lock);
+    for (bpf_sched_entry_t **e = &_msg_entries; *e; e = &(*e)->msg_next) {
+        if (*e == entry) {
+            *e = entry->msg_next;
+            break;
+        }
+    }
+    mutex_unlock(&_msg_lock);
+    event_cancel(&_queues[entry->prio], &entry->super);
+}
@@ -0,0 +1,501 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bitfield.h"
+#include "bpf.h"
+#include "bpf/snapshot.h"
+#include "bpf/store.h"
+#include "irq.h"
+
+#ifdef MODULE_BPF_MAP
+#include "bpf/map.h"
+#endif
+#ifdef MODULE_VFS
+#include <fcntl.h>
+#include "vfs.h"
+#endif
+
+#define SNAPSHOT_MAGIC          "BPFS"
+#define SNAPSHOT_VERSION        (1U)
+
+#define HEADER_SIZE             (16U)
+#define STORE_RECORD_SIZE       (12U)
+#define MAP_HEADER_SIZE         (12U)
+#define LPM_RECORD_SIZE         BPF_SNAPSHOT_LPM_RECORD_SIZE
+
+#define OWNER_GLOBAL            (0U)
+#define OWNER_FREE              (0xffffU)
+
+#define STORE_OFFSET            HEADER_SIZE
+#define MAPS_OFFSET             (STORE_OFFSET + \
+                                 CONFIG_BPF_STORE_NUM_VALUES * STORE_RECORD_SIZE)
+
+static bpf_snapshot_app_t *_apps;
+
+static BITFIELD(_dirty, CONFIG_BPF_SNAPSHOT_PAGES_MAX);
+static bool _all_dirty = true;
+
+static void _put_u16(uint8_t *buf, uint16_t val)
+{
+    buf[0] = val;
+    buf[1] = val >> 8;
+}
+
+static void _put_u32(uint8_t *buf, uint32_t val)
+{
+    _put_u16(buf, val);
+    _put_u16(buf + 2, val >> 16);
+}
+
+static uint16_t _get_u16(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8);
+}
+
+static uint32_t _get_u32(const uint8_t *buf)
+{
+    return _get_u16(buf) | ((uint32_t)_get_u16(buf + 2) << 16);
+}
+
+void bpf_snapshot_register(bpf_snapshot_app_t *app, bpf_t *bpf, uint16_t id)
+{
+    app->bpf = bpf;
+    app->id = id;
+
+    unsigned state = irq_disable();
+    app->next = _apps;
+    _apps = app;
+    irq_restore(state);
+    bpf_snapshot_invalidate();
+}
+
+void bpf_snapshot_unregister(bpf_snapshot_app_t *app)
+{
+    unsigned state = irq_disable();
+    for (bpf_snapshot_app_t **slot = &_apps; *slot; slot = &(*slot)->next) {
+        if (*slot == app) {
+            *slot = app->next;
+            break;
+        }
+    }
+    irq_restore(state);
+    bpf_snapshot_invalidate();
+}
+
+static bpf_snapshot_app_t *_find_app(uint16_t id)
+{
+    for (bpf_snapshot_app_t *app = _apps; app; app = app->next) {
+        if (app->id == id) {
+            return app;
+        }
+    }
+    return NULL;
+}
+
+void bpf_snapshot_invalidate(void)
+{
+    _all_dirty = true;
+}
+
+void bpf_snapshot_mark(size_t offset, size_t len)
+{
+    if (!len) {
+        return;
+    }
+    size_t last = (offset + len - 1) / CONFIG_BPF_SNAPSHOT_PAGE_SIZE;
+    for (size_t page = offset / CONFIG_BPF_SNAPSHOT_PAGE_SIZE;
+         (page <= last) && (page < CONFIG_BPF_SNAPSHOT_PAGES_MAX); page++) {
+        bf_set(_dirty, page);
+    }
+}
+
+void bpf_snapshot_mark_store(unsigned idx)
+{
+    bpf_snapshot_mark(STORE_OFFSET + idx * STORE_RECORD_SIZE,
+                      STORE_RECORD_SIZE);
+}
+
+/* Copies the part of a section overlapping [offset, offset + len) of the
+ * image. The section starts at *pos, which is advanced past it. */
+static void _copy(uint8_t *buf, size_t offset, size_t len, size_t *pos,
+                  const uint8_t *section, size_t section_len)
+{
+    size_t start = *pos;
+    size_t end = start + section_len;
+
+    *pos = end;
+    if ((end <= offset) || (start >= offset + len)) {
+        return;
+    }
+    size_t from = (offset > start) ? offset - start : 0;
+    size_t to = ((offset + len) < end) ? (offset + len) - start : section_len;
+    memcpy(buf + (start + from - offset), section + from, to - from);
+}
+
+/* Whether part of the section at pos overlaps the requested range */
+static bool _overlaps(size_t offset, size_t len, size_t pos, size_t section_len)
+{
+    return (pos < offset + len) && (pos + section_len > offset);
+}
+
+static void _header(uint8_t *rec)
+{
+    unsigned maps = 0;
+
+#ifdef MODULE_BPF_MAP
+    for (bpf_map_t *map = bpf_map_next(NULL); map; map = bpf_map_next(map)) {
+        maps++;
+    }
+#endif
+    memset(rec, 0, HEADER_SIZE);
+    memcpy(rec, SNAPSHOT_MAGIC, 4);
+    rec[4] = SNAPSHOT_VERSION;
+    _put_u16(rec + 6, CONFIG_BPF_STORE_NUM_VALUES);
+    _put_u16(rec + 8, maps);
+    _put_u32(rec + 12, bpf_snapshot_len());
+}
+
+static void _store_record(uint8_t *rec, unsigned idx)
+{
+    bpf_store_keyval_t *keyval = bpf_store_get_slot(idx);
+    uint16_t owner = OWNER_FREE;
+
+    memset(rec, 0, STORE_RECORD_SIZE);
+    if (bpf_store_contains(NULL, keyval)) {
+        owner = OWNER_GLOBAL;
+    }
+    else {
+        for (bpf_snapshot_app_t *app = _apps; app; app = app->next) {
+            if (bpf_store_contains(app->bpf, keyval)) {
+                owner = app->id;
+                break;
+            }
+        }
+    }
+    _put_u16(rec, owner);
+    if (owner != OWNER_FREE) {
+        _put_u32(rec + 4, bpf_store_get_key(keyval));
+        _put_u32(rec + 8, bpf_store_get_value(keyval));
+    }
+}
+
+#ifdef MODULE_BPF_MAP
+static size_t _map_content_len(const bpf_map_t *map)
+{
+    if (map->type == BPF_MAP_TYPE_BLOOM) {
+        return (((const bpf_map_bloom_t *)map)->bloom.m + 7) / 8;
+    }
+    return ((const bpf_map_lpm_t *)map)->storage_numof * LPM_RECORD_SIZE;
+}
+
+static void _lpm_record(uint8_t *rec, const bpf_map_lpm_node_t *node)
+{
+    memset(rec, 0, LPM_RECORD_SIZE);
+    if (node->has_value) {
+        memcpy(rec, &node->prefix, sizeof(node->prefix));
+        rec[16] = node->len;
+        rec[17] = 1;
+        _put_u32(rec + 20, node->value);
+    }
+}
+
+static void _map(uint8_t *buf, size_t offset, size_t len, size_t *pos,
+                 const bpf_map_t *map)
+{
+    uint8_t rec[LPM_RECORD_SIZE];
+    size_t content_len = _map_content_len(map);
+
+    memset(rec, 0, MAP_HEADER_SIZE);
+    _put_u32(rec, map->id);
+    rec[4] = map->type;
+    _put_u32(rec + 8, content_len);
+    _copy(buf, offset, len, pos, rec, MAP_HEADER_SIZE);
+
+    if (map->type == BPF_MAP_TYPE_BLOOM) {
+        _copy(buf, offset, len, pos, ((const bpf_map_bloom_t *)map)->bloom.a,
+              content_len);
+        return;
+    }
+    const bpf_map_lpm_t *lpm = (const bpf_map_lpm_t *)map;
+    for (size_t i = 0; i < lpm->storage_numof; i++) {
+        if (_overlaps(offset, len, *pos, LPM_RECORD_SIZE)) {
+            _lpm_record(rec, &lpm->storage[i]);
+        }
+        _copy(buf, offset, len, pos, rec, LPM_RECORD_SIZE);
+    }
+}
+#endif
+
+size_t bpf_snapshot_map_offset(const struct bpf_map *map)
+{
+#ifdef MODULE_BPF_MAP
+    size_t pos = MAPS_OFFSET;
+    for (bpf_map_t *m = bpf_map_next(NULL); m; m = bpf_map_next(m)) {
+        pos += MAP_HEADER_SIZE;
+        if (m == map) {
+            return pos;
+        }
+        pos += _map_content_len(m);
+    }
+#else
+    (void)map;
+#endif
+    return 0;
+}
+
+size_t bpf_snapshot_len(void)
+{
+    size_t len = MAPS_OFFSET;
+
+#ifdef MODULE_BPF_MAP
+    for (bpf_map_t *map = bpf_map_next(NULL); map; map = bpf_map_next(map)) {
+        len += MAP_HEADER_SIZE + _map_content_len(map);
+    }
+#endif
+    return len;
+}
+
+size_t bpf_snapshot_read(size_t offset, void *buf, size_t len)
+{
+    uint8_t rec[HEADER_SIZE];
+    size_t pos = 0;
+    size_t image_len = bpf_snapshot_len();
+
+    if (offset >= image_len) {
+        return 0;
+    }
+    if (len > image_len - offset) {
+        len = image_len - offset;
+    }
+
+    if (_overlaps(offset, len, pos, HEADER_SIZE)) {
+        _header(rec);
+    }
+    _copy(buf, offset, len, &pos, rec, HEADER_SIZE);
+
+    for (unsigned i = 0; i < CONFIG_BPF_STORE_NUM_VALUES; i++) {
+        if (_overlaps(offset, len, pos, STORE_RECORD_SIZE)) {
+            _store_record(rec, i);
+        }
+        _copy(buf, offset, len, &pos, rec, STORE_RECORD_SIZE);
+    }
+
+#ifdef MODULE_BPF_MAP
+    for (bpf_map_t *map = bpf_map_next(NULL); map && (pos < offset + len);
+         map = bpf_map_next(map)) {
+        _map(buf, offset, len, &pos, map);
+    }
+#endif
+    return len;
+}
+
+int bpf_snapshot_save(bpf_snapshot_write_t write, void *arg)
+{
+    uint8_t page[CONFIG_BPF_SNAPSHOT_PAGE_SIZE];
+    size_t len = bpf_snapshot_len();
+    size_t pages = (len + CONFIG_BPF_SNAPSHOT_PAGE_SIZE - 1) /
+                   CONFIG_BPF_SNAPSHOT_PAGE_SIZE;
+    int written = 0;
+
+    if (pages > CONFIG_BPF_SNAPSHOT_PAGES_MAX) {
+        return -EFBIG;
+    }
+    if (_all_dirty) {
+        memset(_dirty, 0xff, sizeof(_dirty));
+        _all_dirty = false;
+    }
+
+    for (size_t i = 0; i < pages; i++) {
+        if (!bf_isset(_dirty, i)) {
+            continue;
+        }
+        size_t offset = i * CONFIG_BPF_SNAPSHOT_PAGE_SIZE;
+        size_t page_len = bpf_snapshot_read(offset, page, sizeof(page));
+        int res = write(arg, offset, page, page_len);
+        if (res < 0) {
+            return res;
+        }
+        bf_unset(_dirty, i);
+        written++;
+    }
+    return written;
+}
+
+/* Reads exactly len bytes */
+static int _read(bpf_snapshot_read_t read, void *arg, void *buf, size_t len)
+{
+    uint8_t *pos = buf;
+
+    while (len) {
+        ssize_t res = read(arg, pos, len);
+        if (res <= 0) {
+            return res ? (int)res : -EINVAL;
+        }
+        pos += res;
+        len -= res;
+    }
+    return 0;
+}
+
+static int _skip(bpf_snapshot_read_t read, void *arg, size_t len)
+{
+    uint8_t buf[LPM_RECORD_SIZE];
+
+    while (len) {
+        size_t chunk = (len < sizeof(buf)) ? len : sizeof(buf);
+        int res = _read(read, arg, buf, chunk);
+        if (res < 0) {
+            return res;
+        }
+        len -= chunk;
+    }
+    return 0;
+}
+
+static void _restore_value(const uint8_t *rec)
+{
+    uint16_t owner = _get_u16(rec);
+    uint32_t key = _get_u32(rec + 4);
+    uint32_t value = _get_u32(rec + 8);
+
+    if (owner == OWNER_GLOBAL) {
+        bpf_store_update_global(key, value);
+    }
+    else if (owner != OWNER_FREE) {
+        bpf_snapshot_app_t *app = _find_app(owner);
+        if (app) {
+            bpf_store_update_local(app->bpf, key, value);
+        }
+    }
+}
+
+#ifdef MODULE_BPF_MAP
+static int _restore_map(bpf_snapshot_read_t read, void *arg, uint32_t id,
+                        uint8_t type, size_t len)
+{
+    bpf_map_t *map = bpf_map_find(id, type);
+
+    if (!map || (_map_content_len(map) != len)) {
+        return _skip(read, arg, len);
+    }
+    if (type == BPF_MAP_TYPE_BLOOM) {
+        return _read(read, arg, ((bpf_map_bloom_t *)map)->bloom.a, len);
+    }
+
+    /* The records replace the current content of the trie */
+    bpf_map_lpm_t *lpm = (bpf_map_lpm_t *)map;
+    bpf_map_lpm_clear(lpm);
+    for (size_t i = 0; i < lpm->storage_numof; i++) {
+        uint8_t rec[LPM_RECORD_SIZE];
+        int res = _read(read, arg, rec, sizeof(rec));
+        if (res < 0) {
+            return res;
+        }
+        if (rec[17]) {
+            ipv6_addr_t prefix;
+            memcpy(&prefix, rec, sizeof(prefix));
+            bpf_map_lpm_add(lpm, &prefix, rec[16], _get_u32(rec + 20));
+        }
+    }
+    return 0;
+}
+#endif
+
+int bpf_snapshot_restore(bpf_snapshot_read_t read, void *arg)
+{
+    uint8_t rec[HEADER_SIZE];
+    int res = _read(read, arg, rec, HEADER_SIZE);
+
+    if (res < 0) {
+        return res;
+    }
+    if (memcmp(rec, SNAPSHOT_MAGIC, 4) || (rec[4] != SNAPSHOT_VERSION) ||
+        (_get_u16(rec + 6) != CONFIG_BPF_STORE_NUM_VALUES)) {
+        return -EINVAL;
+    }
+    unsigned maps = _get_u16(rec + 8);
+
+    for (unsigned i = 0; i < CONFIG_BPF_STORE_NUM_VALUES; i++) {
+        res = _read(read, arg, rec, STORE_RECORD_SIZE);
+        if (res < 0) {
+            return res;
+        }
+        _restore_value(rec);
+    }
+
+    for (unsigned i = 0; i < maps; i++) {
+        res = _read(read, arg, rec, MAP_HEADER_SIZE);
+        if (res < 0) {
+            return res;
+        }
+#ifdef MODULE_BPF_MAP
+        res = _restore_map(read, arg, _get_u32(rec), rec[4],
+                           _get_u32(rec + 8));
+#else
+        res = _skip(read, arg, _get_u32(rec + 8));
+#endif
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    bpf_snapshot_invalidate();
+    return 0;
+}
+
+#ifdef MODULE_VFS
+static int _write_file(void *arg, size_t offset, const void *buf, size_t len)
+{
+    int fd = *(int *)arg;
+    off_t res = vfs_lseek(fd, offset, SEEK_SET);
+
+    if (res < 0) {
+        return res;
+    }
+    ssize_t written = vfs_write(fd, buf, len);
+    if (written < 0) {
+        return written;
+    }
+    return ((size_t)written == len) ? 0 : -EIO;
+}
+
+static ssize_t _read_file(void *arg, void *buf, size_t len)
+{
+    return vfs_read(*(int *)arg, buf, len);
+}
+
+int bpf_snapshot_save_file(const char *path)
+{
+    int fd = vfs_open(path, O_WRONLY | O_CREAT, 0);
+
+    if (fd < 0) {
+        return fd;
+    }
+    int res = bpf_snapshot_save(_write_file, &fd);
+    vfs_close(fd);
+    return res;
+}
+
+int bpf_snapshot_restore_file(const char *path)
+{
+    int fd = vfs_open(path, O_RDONLY, 0);
+
+    if (fd < 0) {
+        return fd;
+    }
+    int res = bpf_snapshot_restore(_read_file, &fd);
+    vfs_close(fd);
+    return res;
+}
+#endif
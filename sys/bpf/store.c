@@ -12,6 +12,8 @@
 #include "btree.h"
 #include "bpf.h"
 #include "bpf/store.h"
+#include "bpf/snapshot.h"
+#include "kernel_defines.h"
 #include "memarray.h"
 
 static btree_t _global;
@@ -20,6 +22,13 @@ static btree_t _global;
 static memarray_t _array;
 static bpf_store_keyval_t _vals[CONFIG_BPF_STORE_NUM_VALUES];
 
+static void _mark(bpf_store_keyval_t *keyval)
+{
+    if (IS_USED(MODULE_BPF_SNAPSHOT)) {
+        bpf_snapshot_mark_store(keyval - _vals);
+    }
+}
+
 void bpf_store_init(void)
 {
     memarray_init(&_array, _vals, sizeof(bpf_store_keyval_t),
@@ -34,6 +43,7 @@ static int _alloc_value(btree_t *tree, uint32_t key, uint32_t value)
         return -1;
     }
     btree_insert(tree, &keyval->node, key);
+    _mark(keyval);
     return 0;
 }
 
@@ -54,7 +64,10 @@ static int _store_value(btree_t *tree, uint32_t key, uint32_t value)
     if (!keyval) {
         return _alloc_value(tree, key, value);
     }
-    bpf_store_set_value(keyval, value);
+    if (bpf_store_get_value(keyval) != value) {
+        bpf_store_set_value(keyval, value);
+        _mark(keyval);
+    }
     return 0;
 }
 
@@ -81,3 +94,26 @@ int bpf_store_fetch_local(bpf_t *bpf, uint32_t key, uint32_t *value)
  * default value */
     return _fetch_value(&bpf->btree, key, value);
 }
+
+void bpf_store_clear_local(bpf_t *bpf)
+{
+    /* Removing the root node until the tree is empty avoids having to keep
+     * track of the traversal while the tree is rebalanced */
+    while (bpf->btree.start) {
+        btree_node_t *node = btree_remove(&bpf->btree,
+                                          btree_node_key(bpf->btree.start));
+        _mark((bpf_store_keyval_t *)node);
+        memarray_free(&_array, node);
+    }
+}
+
+bpf_store_keyval_t *bpf_store_get_slot(unsigned idx)
+{
+    return &_vals[idx];
+}
+
+bool bpf_store_contains(bpf_t *bpf, bpf_store_keyval_t *keyval)
+{
+    btree_t *tree = bpf ? &bpf->btree : &_global;
+    return btree_find_key(tree, bpf_store_get_key(keyval)) == &keyval->node;
+}
@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bpf.h"
+#include "bpf/instruction.h"
+#include "bpf/verify.h"
+#include "kernel_defines.h"
+
+#if IS_USED(MODULE_BPF_VERIFY_CACHE)
+#include "hashes/sha256.h"
+#include "mutex.h"
+#endif
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define BPF_REG_FP          (10)
+#define BPF_NUM_REGS        (11)
+
+#define OPCODE_LDDW         (0x18)
+#define OPCODE_ADD64_IMM    (0x07)
+#define OPCODE_SUB64_IMM    (0x17)
+#define OPCODE_MOV64_REG    (0xbf)
+#define OPCODE_CALL         (0x85)
+#define OPCODE_RETURN       (0x95)
+
+/* Bound on tracked offsets, keeps offset arithmetic and the frame size in
+ * range of an int */
+#define FP_OFFSET_MAX       (INT32_MAX / 2)
+
+/* Frame pointer derived register tracking */
+typedef struct {
+    int32_t offset[BPF_NUM_REGS];
+    uint16_t valid;
+    int32_t min;
+} _fp_track_t;
+
+static inline bool _is_fp(const _fp_track_t *t, unsigned reg)
+{
+    return t->valid & (1 << reg);
+}
+
+static inline void _set_fp(_fp_track_t *t, unsigned reg, int32_t offset)
+{
+    t->valid |= (1 << reg);
+    t->offset[reg] = offset;
+    if (offset < t->min) {
+        t->min = offset;
+    }
+}
+
+static inline void _clobber(_fp_track_t *t, unsigned reg)
+{
+    if (reg != BPF_REG_FP) {
+        t->valid &= ~(1 << reg);
+    }
+}
+
+static void _mem_access(_fp_track_t *t, unsigned base, int16_t offset)
+{
+    if (_is_fp(t, base)) {
+        int32_t addr = t->offset[base] + offset;
+        if (addr < t->min) {
+            t->min = addr;
+        }
+    }
+}
+
+int bpf_verify_preflight(const uint8_t *application, size_t len)
+{
+    if ((len == 0) || (len % sizeof(bpf_instruction_t))) {
+        return BPF_ILLEGAL_LEN;
+    }
+
+    size_t num_instructions = len/sizeof(bpf_instruction_t);
+    const bpf_instruction_t *instr = (const bpf_instruction_t*)application;
+
+    if (instr[num_instructions - 1].opcode != OPCODE_RETURN) {
+        return BPF_NO_RETURN;
+    }
+    return BPF_OK;
+}
+
+static int _frame_size(const uint8_t *application, size_t len)
+{
+    _fp_track_t t = { .valid = 0, .min = 0 };
+    _set_fp(&t, BPF_REG_FP, 0);
+
+    const bpf_instruction_t *end =
+        (const bpf_instruction_t*)(application + len);
+
+    for (const bpf_instruction_t *instr = (const bpf_instruction_t*)application;
+            instr < end; instr++) {
+        uint8_t cls = instr->opcode & BPF_INSTRUCTION_CLS_MASK;
+
+        switch (instr->opcode) {
+            case OPCODE_LDDW:
+                _clobber(&t, instr->dst);
+                instr++;
+                continue;
+            case OPCODE_MOV64_REG:
+                if (_is_fp(&t, instr->src)) {
+                    _set_fp(&t, instr->dst, t.offset[instr->src]);
+                }
+                else {
+                    _clobber(&t, instr->dst);
+                }
+                continue;
+            case OPCODE_ADD64_IMM:
+            case OPCODE_SUB64_IMM:
+                if (_is_fp(&t, instr->dst) && instr->dst != BPF_REG_FP) {
+                    if (instr->immediate == INT32_MIN) {
+                        /* The offset can't be negated */
+                        return BPF_ILLEGAL_INSTRUCTION;
+                    }
+                    int32_t imm = (instr->opcode == OPCODE_ADD64_IMM) ?
+                        instr->immediate : -instr->immediate;
+                    int64_t offset = (int64_t)t.offset[instr->dst] + imm;
+                    if (offset < -FP_OFFSET_MAX || offset > FP_OFFSET_MAX) {
+                        return BPF_ILLEGAL_INSTRUCTION;
+                    }
+                    _set_fp(&t, instr->dst, offset);
+                }
+                continue;
+            case OPCODE_CALL:
+                /* Helper calls clobber r0 to r5 */
+                for (unsigned reg = 0; reg <= 5; reg++) {
+                    _clobber(&t, reg);
+                }
+                continue;
+            default:
+                break;
+        }
+
+        switch (cls) {
+            case BPF_INSTRUCTION_CLS_LDX:
+                _mem_access(&t, instr->src, instr->offset);
+                _clobber(&t, instr->dst);
+                break;
+            case BPF_INSTRUCTION_CLS_ST:
+            case BPF_INSTRUCTION_CLS_STX:
+                _mem_access(&t, instr->dst, instr->offset);
+                break;
+            case BPF_INSTRUCTION_CLS_ALU32:
+            case BPF_INSTRUCTION_CLS_ALU64:
+                _clobber(&t, instr->dst);
+                break;
+            default:
+                break;
+        }
+    }
+
+    int depth = -t.min;
+    DEBUG("bpf_verify: frame size %u bytes\n", (unsigned)depth);
+    return (depth + 7) & ~7;
+}
+
+size_t bpf_verify_frame_size(const uint8_t *application, size_t len)
+{
+    int size = _frame_size(application, len);
+    return (size < 0) ? 0 : (size_t)size;
+}
+
+static inline bool _is_pseudo_call(const bpf_instruction_t *instr)
+{
+    return (instr->opcode == OPCODE_CALL) &&
+           (instr->src == BPF_INSTRUCTION_CALL_PSEUDO);
+}
+
+/* Functions start at the application entry and at every pseudo call target,
+ * a function ends where the next one starts. The call depth of every function
+ * is computed once, so the analysis is linear in the number of call sites. */
+#define DEPTH_UNKNOWN       (-1)
+#define DEPTH_VISITING      (-2)
+
+typedef struct {
+    const bpf_instruction_t *start;
+    int depth;
+} _func_t;
+
+typedef struct {
+    _func_t funcs[CONFIG_BPF_VERIFY_MAX_FUNCTIONS];
+    unsigned num;
+    const bpf_instruction_t *end;
+} _call_graph_t;
+
+static inline const bpf_instruction_t *_call_target(const bpf_instruction_t *instr)
+{
+    return instr + instr->immediate + 1;
+}
+
+/* Index of the function starting at start, functions are sorted by start */
+static unsigned _func_find(const _call_graph_t *graph,
+                           const bpf_instruction_t *start)
+{
+    unsigned idx = 0;
+    while (idx < graph->num && graph->funcs[idx].start < start) {
+        idx++;
+    }
+    return idx;
+}
+
+static int _func_add(_call_graph_t *graph, const bpf_instruction_t *start)
+{
+    unsigned idx = _func_find(graph, start);
+    if (idx < graph->num && graph->funcs[idx].start == start) {
+        return BPF_OK;
+    }
+    if (graph->num == CONFIG_BPF_VERIFY_MAX_FUNCTIONS) {
+        return BPF_ILLEGAL_CALL;
+    }
+    memmove(&graph->funcs[idx + 1], &graph->funcs[idx],
+            (graph->num - idx) * sizeof(_func_t));
+    graph->funcs[idx].start = start;
+    graph->funcs[idx].depth = DEPTH_UNKNOWN;
+    graph->num++;
+    return BPF_OK;
+}
+
+static int _func_depth(_call_graph_t *graph, unsigned idx)
+{
+    _func_t *func = &graph->funcs[idx];
+
+    if (func->depth == DEPTH_VISITING) {
+        /* Recursion */
+        return BPF_ILLEGAL_CALL;
+    }
+    if (func->depth != DEPTH_UNKNOWN) {
+        return func->depth;
+    }
+    func->depth = DEPTH_VISITING;
+
+    int max = 0;
+    const bpf_instruction_t *func_end = (idx + 1 < graph->num) ?
+        graph->funcs[idx + 1].start : graph->end;
+
+    for (const bpf_instruction_t *instr = func->start; instr < func_end;
+            instr++) {
+        if (instr->opcode == OPCODE_LDDW) {
+            instr++;
+            continue;
+        }
+        if (!_is_pseudo_call(instr)) {
+            continue;
+        }
+        int res = _func_depth(graph, _func_find(graph, _call_target(instr)));
+        if (res < 0) {
+            return res;
+        }
+        if (res + 1 > max) {
+            max = res + 1;
+        }
+    }
+    if (max > (int)CONFIG_BPF_MAX_CALL_DEPTH) {
+        return BPF_ILLEGAL_CALL;
+    }
+    func->depth = max;
+    return max;
+}
+
+static int _call_depth(const uint8_t *application, size_t len,
+                       _call_graph_t *graph)
+{
+    const bpf_instruction_t *begin = (const bpf_instruction_t*)application;
+
+    graph->num = 0;
+    graph->end = (const bpf_instruction_t*)(application + len);
+
+    int res = _func_add(graph, begin);
+    for (const bpf_instruction_t *instr = begin;
+            (res == BPF_OK) && (instr < graph->end); instr++) {
+        if (instr->opcode == OPCODE_LDDW) {
+            instr++;
+            continue;
+        }
+        if (!_is_pseudo_call(instr)) {
+            continue;
+        }
+        const bpf_instruction_t *target = _call_target(instr);
+        if (target < begin || target >= graph->end) {
+            return BPF_ILLEGAL_JUMP;
+        }
+        res = _func_add(graph, target);
+    }
+    if (res < 0) {
+        return res;
+    }
+    return _func_depth(graph, 0);
+}
+
+int bpf_verify_call_depth(const uint8_t *application, size_t len)
+{
+    _call_graph_t graph;
+    return _call_depth(application, len, &graph);
+}
+
+int bpf_verify_stack_depth(const uint8_t *application, size_t len)
+{
+    int depth = bpf_verify_call_depth(application, len);
+    if (depth < 0) {
+        return depth;
+    }
+    int size = _frame_size(application, len);
+    if (size < 0) {
+        return size;
+    }
+    return size * (depth + 1);
+}
+
+static int _verify(const uint8_t *application, size_t len,
+                   bpf_verify_result_t *result)
+{
+    int res = bpf_verify_preflight(application, len);
+    if (res < 0) {
+        return res;
+    }
+    _call_graph_t graph;
+    int depth = _call_depth(application, len, &graph);
+    if (depth < 0) {
+        return depth;
+    }
+    int size = _frame_size(application, len);
+    if (size < 0) {
+        return size;
+    }
+    result->frame_size = size;
+    result->stack_depth = result->frame_size * (depth + 1);
+    result->num_functions = graph.num;
+    for (unsigned i = 0; i < graph.num; i++) {
+        result->functions[i] = graph.funcs[i].start -
+                               (const bpf_instruction_t*)application;
+    }
+    return BPF_OK;
+}
+
+#if IS_USED(MODULE_BPF_VERIFY_CACHE)
+typedef struct {
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    uint32_t len;               /* 0 when the entry is unused */
+    uint32_t last_use;
+    int res;
+    bpf_verify_result_t result;
+} _cache_entry_t;
+
+static _cache_entry_t _cache[CONFIG_BPF_VERIFY_CACHE_NUMOF];
+static bpf_verify_cache_stats_t _stats;
+static uint32_t _uses;
+static mutex_t _cache_lock = MUTEX_INIT;
+
+/* Returns the entry of the digest, or the least recently used one */
+static _cache_entry_t *_cache_lookup(const uint8_t *digest, size_t len)
+{
+    _cache_entry_t *victim = &_cache[0];
+
+    for (_cache_entry_t *e = _cache;
+            e < &_cache[CONFIG_BPF_VERIFY_CACHE_NUMOF]; e++) {
+        if (e->len == len &&
+                memcmp(e->digest, digest, SHA256_DIGEST_LENGTH) == 0) {
+            return e;
+        }
+        if (!e->len || (victim->len && e->last_use < victim->last_use)) {
+            victim = e;
+        }
+    }
+    return victim;
+}
+
+int bpf_verify(const uint8_t *application, size_t len,
+               bpf_verify_result_t *result)
+{
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    sha256(application, len, digest);
+
+    mutex_lock(&_cache_lock);
+    _cache_entry_t *e = _cache_lookup(digest, len);
+    if (e->len == len && memcmp(e->digest, digest, sizeof(digest)) == 0) {
+        _stats.hits++;
+    }
+    else {
+        _stats.misses++;
+        memcpy(e->digest, digest, sizeof(digest));
+        e->len = len;
+        e->result = (bpf_verify_result_t){ 0 };
+        e->res = _verify(application, len, &e->result);
+        DEBUG("bpf_verify: cached %u byte application, result %d\n",
+              (unsigned)len, e->res);
+    }
+    e->last_use = ++_uses;
+    int res = e->res;
+    *result = e->result;
+    mutex_unlock(&_cache_lock);
+    return res;
+}
+
+void bpf_verify_cache_stats(bpf_verify_cache_stats_t *stats)
+{
+    mutex_lock(&_cache_lock);
+    *stats = _stats;
+    mutex_unlock(&_cache_lock);
+}
+
+void bpf_verify_cache_clear(void)
+{
+    mutex_lock(&_cache_lock);
+    memset(_cache, 0, sizeof(_cache));
+    mutex_unlock(&_cache_lock);
+}
+#else
+int bpf_verify(const uint8_t *application, size_t len,
+               bpf_verify_result_t *result)
+{
+    return _verify(application, len, result);
+}
+#endif /* MODULE_BPF_VERIFY_CACHE */
@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include "assert.h"
 #include "btree.h"
 
 #ifdef __cplusplus
@@ -36,6 +37,71 @@ extern "C" {
 #define CONFIG_BPF_ENABLE_ALU32 (0)
 #endif
 
+/**
+ * @brief Number of SAUL device handles cached per application
+ *
+ * Devices at registry positions below this value are resolved once per
+ * application instead of walking the SAUL registry on every lookup. The cache
+ * is dropped when devices are added to or removed from the registry.
+ */
+#ifndef CONFIG_BPF_SAUL_CACHE_NUMOF
+#define CONFIG_BPF_SAUL_CACHE_NUMOF (4U)
+#endif
+
+/**
+ * @brief Maximum nesting of bpf-to-bpf calls
+ */
+#ifndef CONFIG_BPF_MAX_CALL_DEPTH
+#define CONFIG_BPF_MAX_CALL_DEPTH   (4U)
+#endif
+
+/**
+ * @brief Maximum number of consecutive tail calls in a single execution
+ */
+#ifndef CONFIG_BPF_MAX_TAIL_CALLS
+#define CONFIG_BPF_MAX_TAIL_CALLS   (8U)
+#endif
+
+/**
+ * @brief Count the instructions executed by the interpreter
+ *
+ * The count is kept in a local variable while the application runs and is
+ * stored in @ref bpf_t::instruction_count when the application exits.
+ */
+#ifndef CONFIG_BPF_COUNT_INSTRUCTIONS
+#define CONFIG_BPF_COUNT_INSTRUCTIONS   (0)
+#endif
+
+/**
+ * @brief Maximum number of instructions executed per run, 0 for no limit
+ *
+ * Checked on every taken jump and tail call, requires
+ * @ref CONFIG_BPF_COUNT_INSTRUCTIONS
+ */
+#ifndef CONFIG_BPF_INSTRUCTION_BUDGET
+#define CONFIG_BPF_INSTRUCTION_BUDGET   (0U)
+#endif
+
+#if CONFIG_BPF_INSTRUCTION_BUDGET && !CONFIG_BPF_COUNT_INSTRUCTIONS
+#error "CONFIG_BPF_INSTRUCTION_BUDGET requires CONFIG_BPF_COUNT_INSTRUCTIONS"
+#endif
+
+/**
+ * @brief Measure the execution time of hooks
+ *
+ * The time is accumulated in @ref bpf_hook_t::duration_us
+ */
+#ifndef CONFIG_BPF_HOOK_PROFILE
+#define CONFIG_BPF_HOOK_PROFILE         (0)
+#endif
+
+/**
+ * @brief Maximum number of hooks installed at a single trigger
+ */
+#ifndef CONFIG_BPF_HOOK_CHAIN_NUMOF
+#define CONFIG_BPF_HOOK_CHAIN_NUMOF     (4U)
+#endif
+
 typedef enum {
     BPF_POLICY_CONTINUE,            /**< Always execute next hook */
     BPF_POLICY_ABORT_ON_NEGATIVE,   /**< Execute next script unless result is negative */
@@ -57,6 +123,8 @@ enum {
     BPF_ILLEGAL_CALL        = -4,
     BPF_ILLEGAL_LEN         = -5,
     BPF_NO_RETURN           = -6,
+    BPF_STACK_OVERFLOW      = -7,
+    BPF_OUT_OF_BUDGET       = -8,
 };
 
 typedef struct bpf_mem_region bpf_mem_region_t;
@@ -74,38 +142,180 @@ struct bpf_mem_region {
 };
 
 #define BPF_FLAG_SETUP_DONE    0x01
+/**
+ * @brief The native application is compiled without memory checks and
+ *        @ref bpf_execute runs it isolated, see @ref sys_bpf_mpu
+ */
+#define BPF_FLAG_ISOLATED      0x02
+
+typedef struct bpf_prog_array bpf_prog_array_t;
+
+typedef struct bpf bpf_t;
+
+typedef struct bpf_pkt bpf_pkt_t;
 
-typedef struct {
+/**
+ * @brief Natively compiled application
+ *
+ * Generated from the application bytecode by the ahead-of-time compiler, see
+ * @ref sys_bpf_aot
+ *
+ * @param   bpf     bpf context
+ * @param   ctx     Context passed to the application in r1
+ * @param   result  Return value of the application
+ *
+ * @returns         Same return codes as the interpreter
+ */
+typedef int (*bpf_native_t)(bpf_t *bpf, const void *ctx, int64_t *result);
+
+struct bpf {
     bpf_mem_region_t stack_region;
     bpf_mem_region_t arg_region;
     const uint8_t *application; /**< Application bytecode */
     size_t application_len;     /**< Application length */
     uint8_t *stack;             /**< VM stack, must be a multiple of 8 bytes and aligned */
-    size_t stack_size;          /**< VM stack size in bytes */
+    size_t stack_size;          /**< VM stack size in bytes, at least
+                                     *   @ref bpf_verify_frame_size */
+    size_t frame_size;          /**< Stack frame size of bpf-to-bpf calls */
+    const bpf_prog_array_t *tail_calls; /**< Tail call targets, may be NULL */
+    bpf_native_t native;        /**< Natively compiled application, may be NULL */
     btree_t btree;              /**< Local btree */
+#if CONFIG_BPF_SAUL_CACHE_NUMOF
+    void *saul_cache[CONFIG_BPF_SAUL_CACHE_NUMOF]; /**< Resolved SAUL devices */
+    unsigned saul_generation;   /**< Registry generation of @p saul_cache */
+#endif
+#if defined(MODULE_BPF_PKT) || defined(DOXYGEN)
+    bpf_pkt_t *pkt;             /**< Packet while running from bpf_pkt_execute() */
+#endif
     uint16_t flags;
-    uint32_t instruction_count;
-} bpf_t;
+#if CONFIG_BPF_COUNT_INSTRUCTIONS || defined(DOXYGEN)
+    uint32_t instruction_count; /**< Instructions executed by the last run */
+#endif
+};
+
+/**
+ * @brief Program array with the targets of the bpf_tail_call helper
+ */
+struct bpf_prog_array {
+    bpf_t *const *programs;     /**< Programs, indexed by the tail call index */
+    size_t len;                 /**< Number of entries in @p programs */
+};
 
 typedef struct bpf_hook bpf_hook_t;
 
+/**
+ * @brief The hook triggers the schedule entry it is part of instead of running
+ *        the application, see @ref bpf_sched_hook
+ */
+#define BPF_HOOK_FLAG_SCHED     0x01
+
 struct bpf_hook {
     struct bpf_hook *next;
     bpf_t *application;
     uint32_t executions;
-    bpf_hook_policy_t policy;
+    uint32_t errors;            /**< Executions that returned an error */
+#if CONFIG_BPF_HOOK_PROFILE || defined(DOXYGEN)
+    uint32_t duration_us;       /**< Total execution time in microseconds */
+#endif
+    bpf_hook_policy_t policy;   /**< Policy, resolved when installing the hook */
+    uint8_t flags;              /**< Hook flags */
 };
 
+/**
+ * @brief Hook chain of a trigger, flattened when a hook is (un)installed
+ */
+typedef struct bpf_hook_chain bpf_hook_chain_t;
+
+/**
+ * @brief Installed hook chains, NULL for triggers without hooks
+ */
+extern const bpf_hook_chain_t *bpf_hook_chains[BPF_HOOK_NUM];
+
 void bpf_init(void);
 void bpf_setup(bpf_t *bpf);
 
 int bpf_execute(bpf_t *bpf, void *ctx, size_t ctx_size, int64_t *result);
 
-int bpf_install_hook(bpf_t *bpf);
+/**
+ * @brief Install a hook at the front of the chain of @p trigger
+ *
+ * The application must be set up with @ref bpf_setup
+ *
+ * @returns         0 on success
+ * @returns         -ENOSPC when @ref CONFIG_BPF_HOOK_CHAIN_NUMOF hooks are
+ *                  installed at @p trigger
+ */
+int bpf_hook_install(bpf_hook_t *hook, bpf_hook_trigger_t trigger);
+
+/**
+ * @brief Remove a hook from the chain of @p trigger
+ *
+ * Executions of the chain that are already running may still run the hook,
+ * executions started after this returns don't.
+ *
+ * @returns         0 on success
+ * @returns         -ENOENT when the hook is not installed at @p trigger
+ */
+int bpf_hook_uninstall(bpf_hook_t *hook, bpf_hook_trigger_t trigger);
+
+/**
+ * @brief Execute a hook chain, use @ref bpf_hook_execute instead
+ */
+int bpf_hook_execute_chain(bpf_hook_trigger_t trigger, void *ctx,
+                           size_t ctx_size, int64_t *script_res);
+
+/**
+ * @brief Execute the hooks of @p trigger according to their policies
+ *
+ * Costs a single branch when no hook is installed at @p trigger, @p
+ * script_res is left untouched in that case.
+ */
+static inline int bpf_hook_execute(bpf_hook_trigger_t trigger, void *ctx,
+                                   size_t ctx_size, int64_t *script_res)
+{
+    assert(trigger < BPF_HOOK_NUM);
+    if (bpf_hook_chains[trigger]) {
+        return bpf_hook_execute_chain(trigger, ctx, ctx_size, script_res);
+    }
+    return BPF_OK;
+}
 
 void bpf_add_region(bpf_t *bpf, bpf_mem_region_t *region,
                     void *start, size_t len, uint8_t flags);
 
+/**
+ * @brief Check whether the application is allowed to access a memory area
+ *
+ * @param   bpf     bpf context
+ * @param   addr    Start of the memory area
+ * @param   len     Length of the memory area
+ * @param   type    Access type, @ref BPF_MEM_REGION_READ or
+ *                  @ref BPF_MEM_REGION_WRITE
+ *
+ * @returns         0 if the access is allowed
+ * @returns         -1 if the access is denied
+ */
+static inline int bpf_check_mem(const bpf_t *bpf, const intptr_t addr,
+                                size_t len, uint8_t type)
+{
+    const uintptr_t start = (uintptr_t)addr;
+    const uintptr_t end = start + len;
+
+    /* The length is controlled by the application, reject areas wrapping
+     * around the address space */
+    if (end < start) {
+        return -1;
+    }
+    for (const bpf_mem_region_t *region = &bpf->stack_region; region; region = region->next) {
+        if ((start >= (uintptr_t)region->start) &&
+                (end <= (uintptr_t)region->start + region->len) &&
+                (region->flag & type)) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
 #ifdef __cplusplus
 }
 #endif
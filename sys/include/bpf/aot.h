@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_aot BPF ahead-of-time compiler
+ * @ingroup     sys_bpf
+ * @brief       Applications compiled to native code at build time
+ *
+ * The `dist/tools/bpf_aot/bpf_aot.py` tool translates application bytecode
+ * into a C function with the same semantics as the interpreter. Every memory
+ * access is checked against the memory regions of the application and helper
+ * calls are dispatched through @ref bpf_get_call, so a compiled application
+ * is sandboxed the same way as an interpreted one.
+ *
+ * Add the raw application binaries to the application Makefile:
+ *
+ *     BPF_AOT_PROGRAMS += bpf/foo.bin
+ *
+ * The build system generates the function `bpf_aot_foo` and the header
+ * `bpf_aot/foo.h` declaring it. The compiled application is registered by
+ * setting @ref bpf_t::native, everything else is identical to an
+ * interpreted application:
+ *
+ * ```
+ * #include "bpf_aot/foo.h"
+ *
+ * bpf_t bpf = {
+ *     .native = bpf_aot_foo,
+ *     .stack = stack,
+ *     .stack_size = sizeof(stack),
+ * };
+ * bpf_setup(&bpf);
+ * ```
+ *
+ * Applications in `BPF_AOT_ISOLATED_PROGRAMS` are compiled without the memory
+ * checks, they rely on the memory protection hardware instead and must be
+ * executed with the @ref BPF_FLAG_ISOLATED flag set, see @ref sys_bpf_mpu.
+ *
+ * bpf-to-bpf calls and tail calls are not supported by the compiler and such
+ * applications are rejected at build time. Compiled applications don't count
+ * instructions, @ref CONFIG_BPF_INSTRUCTION_BUDGET doesn't apply to them.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_AOT_H
+#define BPF_AOT_H
+
+#include <stdint.h>
+#include "bpf.h"
+#include "bpf/call.h"
+#ifdef BPF_AOT_UNCHECKED
+#include "bpf/mpu.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(BPF_AOT_UNCHECKED) && !defined(DOXYGEN)
+/* Isolated applications leave the memory checks to the hardware and call
+ * helpers through bpf_mpu_call() */
+#define BPF_AOT_LOAD(SIZE, DST, ADDR)                                   \
+    DST = *(const SIZE *)(uintptr_t)(ADDR)
+
+#define BPF_AOT_STORE(SIZE, ADDR, VAL)                                  \
+    *(SIZE *)(uintptr_t)(ADDR) = (VAL)
+
+#define BPF_AOT_CALL(NUM)                                               \
+    do {                                                                \
+        if (!bpf_get_call(NUM)) {                                       \
+            goto call_error;                                            \
+        }                                                               \
+        r0 = bpf_mpu_call(bpf, NUM, r1, r2, r3, r4, r5);                \
+    } while (0)
+
+#else
+/**
+ * @brief Checked load of a @p SIZE typed value at @p ADDR into @p DST
+ *
+ * Jumps to the `mem_error` label of the generated function when the access is
+ * denied.
+ */
+#define BPF_AOT_LOAD(SIZE, DST, ADDR)                                   \
+    do {                                                                \
+        const uint64_t _addr = (ADDR);                                  \
+        if (bpf_check_mem(bpf, _addr, sizeof(SIZE),                     \
+                          BPF_MEM_REGION_READ) < 0) {                   \
+            goto mem_error;                                             \
+        }                                                               \
+        DST = *(const SIZE *)(uintptr_t)_addr;                          \
+    } while (0)
+
+/**
+ * @brief Checked store of @p VAL as a @p SIZE typed value at @p ADDR
+ *
+ * Jumps to the `mem_error` label of the generated function when the access is
+ * denied.
+ */
+#define BPF_AOT_STORE(SIZE, ADDR, VAL)                                  \
+    do {                                                                \
+        const uint64_t _addr = (ADDR);                                  \
+        if (bpf_check_mem(bpf, _addr, sizeof(SIZE),                     \
+                          BPF_MEM_REGION_WRITE) < 0) {                  \
+            goto mem_error;                                             \
+        }                                                               \
+        *(SIZE *)(uintptr_t)_addr = (VAL);                              \
+    } while (0)
+
+/**
+ * @brief Call helper @p NUM with the argument registers
+ *
+ * Jumps to the `call_error` label of the generated function when the helper
+ * is not available.
+ */
+#define BPF_AOT_CALL(NUM)                                               \
+    do {                                                                \
+        bpf_call_t _call = bpf_get_call(NUM);                           \
+        if (!_call) {                                                   \
+            goto call_error;                                            \
+        }                                                               \
+        r0 = _call(bpf, r1, r2, r3, r4, r5);                            \
+    } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_AOT_H */
+/** @} */
@@ -27,6 +27,8 @@ typedef signed ssize_t;
 typedef void bpf_saul_reg_t;
 
 static void *(*bpf_printf)(const char *fmt, ...) = (void *) BPF_FUNC_BPF_PRINTF;
+/* Only returns when the tail call failed */
+static int (*bpf_tail_call)(void *ctx, uint32_t index) = (void *) BPF_FUNC_BPF_TAIL_CALL;
 
 static int (*bpf_store_global)(uint32_t key, uint32_t value) = (void *) BPF_FUNC_BPF_STORE_GLOBAL;
 static int (*bpf_store_local)(uint32_t key, uint32_t value) = (void *) BPF_FUNC_BPF_STORE_LOCAL;
@@ -38,6 +40,9 @@ static uint32_t (*bpf_now_ms)(void) = (void *) BPF_FUNC_BPF_NOW_MS;
 static bpf_saul_reg_t *(*bpf_saul_reg_find_nth)(int pos) = (void *) BPF_FUNC_BPF_SAUL_REG_FIND_NTH;
 static bpf_saul_reg_t *(*bpf_saul_reg_find_type)(uint8_t type) = (void *) BPF_FUNC_BPF_SAUL_REG_FIND_TYPE;
 static int (*bpf_saul_reg_read)(bpf_saul_reg_t *dev, phydat_t *data) = (void *) BPF_FUNC_BPF_SAUL_REG_READ;
+/* Reads the devices at the registry positions in positions into data, returns
+ * the number of devices read */
+static int (*bpf_saul_read_batch)(const uint8_t *positions, phydat_t *data, uint32_t num) = (void *) BPF_FUNC_BPF_SAUL_READ_BATCH;
 
 /* CoAP calls */
 static void (*bpf_gcoap_resp_init)(bpf_coap_ctx_t *ctx, unsigned resp_code) = (void *) BPF_FUNC_BPF_GCOAP_RESP_INIT;
@@ -48,6 +53,40 @@ static uint8_t *(*bpf_coap_get_pdu)(bpf_coap_ctx_t *ctx) = (void *) BPF_FUNC_BPF
 /* FMT calls */
 static size_t (*bpf_fmt_s16_dfp)(char *out, int16_t val, int fp_digits) = (void *) BPF_FUNC_BPF_FMT_S16_DFP;
 
+/* Memory calls, return BPF_ILLEGAL_MEM (-2) when an area is not accessible.
+ * bpf_memcpy allows overlapping areas, bpf_memcmp returns -1, 0 or 1 */
+static int (*bpf_memcpy)(void *dest, const void *src, uint32_t len) = (void *) BPF_FUNC_BPF_MEMCPY;
+static int (*bpf_memset)(void *dest, int c, uint32_t len) = (void *) BPF_FUNC_BPF_MEMSET;
+static int (*bpf_memcmp)(const void *a, const void *b, uint32_t len) = (void *) BPF_FUNC_BPF_MEMCMP;
+
+/* Checksum and hash calls, bpf_fletcher32 returns 0 when the buffer is not
+ * accessible. ctx points to a sha256_context_t, digest to 32 bytes */
+static uint32_t (*bpf_fletcher32)(const uint16_t *buf, uint32_t words) = (void *) BPF_FUNC_BPF_FLETCHER32;
+static int (*bpf_crc16_ccitt)(uint16_t crc, const void *buf, uint32_t len) = (void *) BPF_FUNC_BPF_CRC16_CCITT;
+static int (*bpf_sha256_init)(void *ctx) = (void *) BPF_FUNC_BPF_SHA256_INIT;
+static int (*bpf_sha256_update)(void *ctx, const void *data, uint32_t len) = (void *) BPF_FUNC_BPF_SHA256_UPDATE;
+static int (*bpf_sha256_final)(void *ctx, void *digest) = (void *) BPF_FUNC_BPF_SHA256_FINAL;
+
+/* Packet calls, only available when running from bpf_pkt_execute() with a
+ * bpf_pkt_ctx_t context. Offsets are relative to the start of the packet,
+ * the fixed-width loads convert from network byte order and return 0 beyond
+ * the packet length. bpf_pkt_load_bytes returns BPF_ILLEGAL_MEM (-2) when
+ * the packet area or dst is not accessible */
+static int (*bpf_pkt_load_bytes)(uint32_t offset, void *dst, uint32_t len) = (void *) BPF_FUNC_BPF_PKT_LOAD_BYTES;
+static uint8_t (*bpf_pkt_load_u8)(uint32_t offset) = (void *) BPF_FUNC_BPF_PKT_LOAD_U8;
+static uint16_t (*bpf_pkt_load_u16)(uint32_t offset) = (void *) BPF_FUNC_BPF_PKT_LOAD_U16;
+static uint32_t (*bpf_pkt_load_u32)(uint32_t offset) = (void *) BPF_FUNC_BPF_PKT_LOAD_U32;
+
+/* Map calls, maps are registered by the host with bpf_map_register(). Both
+ * return BPF_ILLEGAL_CALL (-4) when there is no map of the right type with
+ * the id and BPF_ILLEGAL_MEM (-2) when an area is not accessible.
+ * bpf_map_bloom_check returns 1 when the key may be in the set, 0 when it is
+ * not. bpf_map_lpm_lookup returns the length of the longest prefix containing
+ * the 16 byte address at addr and stores its value, or -1 when no prefix
+ * matches. value may be NULL */
+static int (*bpf_map_bloom_check)(uint32_t id, const void *key, uint32_t len) = (void *) BPF_FUNC_BPF_MAP_BLOOM_CHECK;
+static int (*bpf_map_lpm_lookup)(uint32_t id, const void *addr, uint32_t *value) = (void *) BPF_FUNC_BPF_MAP_LPM_LOOKUP;
+
 
 #ifdef __cplusplus
 
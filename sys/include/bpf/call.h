@@ -28,12 +28,37 @@ uint32_t bpf_vm_now_ms(bpf_t *bpf, uint32_t a1, uint32_t a2, uint32_t a3, uint32
 uint32_t bpf_vm_saul_reg_find_nth(bpf_t *bpf, uint32_t nth, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_saul_reg_find_type(bpf_t *bpf, uint32_t type, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_saul_reg_read(bpf_t *bpf, uint32_t dev_p, uint32_t data_p, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_saul_read_batch(bpf_t *bpf, uint32_t positions_p, uint32_t data_p, uint32_t num, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_memcpy(bpf_t *bpf, uint32_t dest_p, uint32_t src_p, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_memset(bpf_t *bpf, uint32_t dest_p, uint32_t c, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_memcmp(bpf_t *bpf, uint32_t a_p, uint32_t b_p, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_fletcher32(bpf_t *bpf, uint32_t buf_p, uint32_t words, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_crc16_ccitt(bpf_t *bpf, uint32_t crc, uint32_t buf_p, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_sha256_init(bpf_t *bpf, uint32_t ctx_p, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_sha256_update(bpf_t *bpf, uint32_t ctx_p, uint32_t data_p, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_sha256_final(bpf_t *bpf, uint32_t ctx_p, uint32_t digest_p, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_pkt_load_bytes(bpf_t *bpf, uint32_t offset, uint32_t dst_p, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_pkt_load_u8(bpf_t *bpf, uint32_t offset, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_pkt_load_u16(bpf_t *bpf, uint32_t offset, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_pkt_load_u32(bpf_t *bpf, uint32_t offset, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_map_bloom_check(bpf_t *bpf, uint32_t id, uint32_t key_p, uint32_t len, uint32_t a4, uint32_t a5);
+uint32_t bpf_vm_map_lpm_lookup(bpf_t *bpf, uint32_t id, uint32_t addr_p, uint32_t value_p, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_gcoap_resp_init(bpf_t *bpf, uint32_t coap_ctx_p, uint32_t resp_code_u, uint32_t a3, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_coap_opt_finish(bpf_t *bpf, uint32_t coap_ctx_p, uint32_t flags_u, uint32_t a3, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_fmt_s16_dfp(bpf_t *bpf, uint32_t out_p, uint32_t val, uint32_t fp_digits, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_coap_add_format(bpf_t *bpf, uint32_t coap_ctx_p, uint32_t format, uint32_t a3, uint32_t a4, uint32_t a5);
 uint32_t bpf_vm_coap_get_pdu(bpf_t *bpf, uint32_t coap_ctx_p, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5);
 
+/**
+ * @brief Look up the helper function for a call instruction
+ *
+ * @param   num     Helper number, one of the BPF_FUNC_* values
+ *
+ * @returns         The helper function
+ * @returns         NULL when the helper is not available
+ */
+bpf_call_t bpf_get_call(uint32_t num);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_instance BPF instance manager
+ * @ingroup     sys_bpf
+ * @brief       Pool based allocation of eBPF programs and their execution
+ *              contexts
+ *
+ * Programs, VM stacks and memory region descriptors are allocated from
+ * fixed-size pools. Installing and removing applications at runtime therefore
+ * takes constant time and never fragments the heap.
+ *
+ * Stacks come in two size classes. The stack depth of a program is computed
+ * by the verifier when it is loaded and every instance gets a stack from the
+ * smallest class that fits. Programs requiring more stack than the largest
+ * class provides are rejected at load time.
+ *
+ * The key-value storage of an instance is not pooled here, its local values
+ * come from the pool of @ref sys_bpf_store (see
+ * @ref CONFIG_BPF_STORE_NUM_VALUES) and are returned to it when the instance
+ * is destroyed.
+ *
+ * A loaded program only references the application bytecode, it can be
+ * instantiated multiple times. Every instance keeps a reference to its
+ * program, the program is released when the last reference is dropped.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_INSTANCE_H
+#define BPF_INSTANCE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bpf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of programs that can be loaded simultaneously
+ */
+#ifndef CONFIG_BPF_PROGRAM_NUMOF
+#define CONFIG_BPF_PROGRAM_NUMOF            (4U)
+#endif
+
+/**
+ * @brief Number of program instances that can exist simultaneously
+ */
+#ifndef CONFIG_BPF_INSTANCE_NUMOF
+#define CONFIG_BPF_INSTANCE_NUMOF           (4U)
+#endif
+
+/**
+ * @brief Size in bytes of the large stack class, must be a multiple of 8
+ *
+ * This is the maximum stack depth a program can use.
+ */
+#ifndef CONFIG_BPF_INSTANCE_STACK_SIZE
+#define CONFIG_BPF_INSTANCE_STACK_SIZE      (512U)
+#endif
+
+/**
+ * @brief Number of stacks in the large stack class
+ */
+#ifndef CONFIG_BPF_INSTANCE_STACK_NUMOF
+#define CONFIG_BPF_INSTANCE_STACK_NUMOF     (2U)
+#endif
+
+/**
+ * @brief Size in bytes of the small stack class, must be a multiple of 8
+ */
+#ifndef CONFIG_BPF_INSTANCE_SMALL_STACK_SIZE
+#define CONFIG_BPF_INSTANCE_SMALL_STACK_SIZE    (128U)
+#endif
+
+/**
+ * @brief Number of stacks in the small stack class
+ */
+#ifndef CONFIG_BPF_INSTANCE_SMALL_STACK_NUMOF
+#define CONFIG_BPF_INSTANCE_SMALL_STACK_NUMOF   (4U)
+#endif
+
+/**
+ * @brief Number of additional memory region descriptors shared by all
+ *        instances
+ */
+#ifndef CONFIG_BPF_INSTANCE_REGION_NUMOF
+#define CONFIG_BPF_INSTANCE_REGION_NUMOF    (8U)
+#endif
+
+/**
+ * @brief Loaded eBPF program
+ */
+typedef struct {
+    const uint8_t *application; /**< Application bytecode */
+    size_t application_len;     /**< Application length */
+    size_t stack_size;          /**< Stack depth required by the program */
+    uint16_t refcount;          /**< Number of references to this program */
+} bpf_program_t;
+
+/**
+ * @brief Instance of a loaded eBPF program
+ */
+typedef struct {
+    bpf_t bpf;                  /**< VM context, must be the first member */
+    bpf_program_t *program;     /**< Program executed by this instance */
+} bpf_instance_t;
+
+/**
+ * @brief Initialize the instance manager pools
+ *
+ * Called by @ref bpf_init
+ */
+void bpf_instance_init(void);
+
+/**
+ * @brief Load an application into the program pool
+ *
+ * The bytecode is not copied and must stay valid while the program is loaded.
+ * Loading an application that is already loaded returns the existing program
+ * with an additional reference.
+ *
+ * @param   application     Application bytecode
+ * @param   len             Length of the application in bytes
+ *
+ * @returns                 The program with a reference held by the caller
+ * @returns                 NULL when the program pool is exhausted, the
+ *                          application is malformed or requires more stack
+ *                          than @ref CONFIG_BPF_INSTANCE_STACK_SIZE
+ */
+bpf_program_t *bpf_program_load(const uint8_t *application, size_t len);
+
+/**
+ * @brief Drop a reference to a program
+ *
+ * The program is returned to the pool when no references are left.
+ *
+ * @param   program         Program to release
+ */
+void bpf_program_release(bpf_program_t *program);
+
+/**
+ * @brief Create a new instance of a program
+ *
+ * The instance holds a reference to @p program and has a stack allocated from
+ * the smallest stack class that fits the program. The returned instance is
+ * already set up with @ref bpf_setup.
+ *
+ * @param   program         Program to instantiate
+ *
+ * @returns                 The new instance
+ * @returns                 NULL when the instance pool or the stack pools are
+ *                          exhausted
+ */
+bpf_instance_t *bpf_instance_new(bpf_program_t *program);
+
+/**
+ * @brief Destroy an instance
+ *
+ * Returns the stack, the memory regions and the local store values of the
+ * instance to their pools and drops the reference to the program.
+ *
+ * @param   instance        Instance to destroy
+ */
+void bpf_instance_free(bpf_instance_t *instance);
+
+/**
+ * @brief Allow the instance access to an additional memory region
+ *
+ * The region descriptor is allocated from the region pool and is released
+ * together with the instance.
+ *
+ * @param   instance        Instance to add the region to
+ * @param   start           Start of the memory region
+ * @param   len             Length of the memory region
+ * @param   flags           Access flags, @ref BPF_MEM_REGION_READ etc.
+ *
+ * @returns                 0 on success
+ * @returns                 -ENOMEM when the region pool is exhausted
+ */
+int bpf_instance_add_region(bpf_instance_t *instance,
+                            void *start, size_t len, uint8_t flags);
+
+/**
+ * @brief Execute an instance
+ *
+ * @see bpf_execute
+ */
+static inline int bpf_instance_execute(bpf_instance_t *instance, void *ctx,
+                                       size_t ctx_len, int64_t *result)
+{
+    return bpf_execute(&instance->bpf, ctx, ctx_len, result);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_INSTANCE_H */
+/** @} */
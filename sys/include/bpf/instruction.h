@@ -81,6 +81,9 @@ extern "C" {
 
 #define BPF_INSTRUCTION_ALU_BYTESWAP    0xd0
 
+#define BPF_INSTRUCTION_CALL_HELPER     0x0     /**< Call source for helper calls */
+#define BPF_INSTRUCTION_CALL_PSEUDO     0x1     /**< Call source for bpf-to-bpf calls */
+
 /**
  * @brief eBPF instruction format
  *
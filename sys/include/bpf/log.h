@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_log BPF log buffer
+ * @ingroup     sys_bpf
+ * @brief       Non-blocking bpf_printf for eBPF applications
+ *
+ * With this module, the bpf_printf helper doesn't print synchronously.
+ * Instead, it appends a binary record with the format string and the
+ * arguments to a ring buffer. Logging from a hook then costs a short copy and
+ * not the time to push a line through stdio.
+ *
+ * Records are formatted and printed when the buffer is drained. The buffer is
+ * drained by a low priority thread when @ref CONFIG_BPF_LOG_THREAD is enabled,
+ * and by the `bpflog` shell command. Records that don't fit in the buffer are
+ * dropped and counted.
+ *
+ * Writing is not lock-free: the ring buffer only supports a single producer,
+ * so a writer masks interrupts while it copies its record. This bounds the
+ * critical section to the size of one record, at most
+ * @ref CONFIG_BPF_LOG_FMT_MAX bytes of format string plus the arguments.
+ *
+ * The arguments are printed after the application has finished, so only
+ * integer conversions (`d`, `i`, `u`, `x`, `X`, `c`) are formatted. Other
+ * conversions, including `%s`, are printed verbatim. `%s` and `%p` still
+ * consume their argument.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_LOG_H
+#define BPF_LOG_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bpf.h"
+#include "thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Size of the log buffer in bytes, must be a power of two
+ */
+#ifndef CONFIG_BPF_LOG_BUF_SIZE
+#define CONFIG_BPF_LOG_BUF_SIZE     (512U)
+#endif
+
+/**
+ * @brief Maximum length of a logged format string, longer strings are
+ *        truncated
+ */
+#ifndef CONFIG_BPF_LOG_FMT_MAX
+#define CONFIG_BPF_LOG_FMT_MAX      (64U)
+#endif
+
+/**
+ * @brief Drain the log buffer from a low priority thread
+ */
+#ifndef CONFIG_BPF_LOG_THREAD
+#define CONFIG_BPF_LOG_THREAD       (1)
+#endif
+
+/**
+ * @brief Stack size of the log thread
+ */
+#ifndef CONFIG_BPF_LOG_STACKSIZE
+#define CONFIG_BPF_LOG_STACKSIZE    (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief Priority of the log thread
+ */
+#ifndef CONFIG_BPF_LOG_PRIO
+#define CONFIG_BPF_LOG_PRIO         (THREAD_PRIORITY_MIN - 1)
+#endif
+
+/**
+ * @brief Number of arguments stored per record
+ */
+#define BPF_LOG_ARGS_NUMOF          (4U)
+
+/**
+ * @brief Initialize the log buffer and start the log thread
+ *
+ * Called by @ref bpf_init
+ */
+void bpf_log_init(void);
+
+/**
+ * @brief Append a record to the log buffer
+ *
+ * Safe to call from interrupt context, never blocks. Interrupts are masked
+ * while the record is copied.
+ *
+ * @param   fmt         Format string, doesn't need to be zero terminated
+ * @param   fmt_len     Length of the format string
+ * @param   args        @ref BPF_LOG_ARGS_NUMOF arguments
+ *
+ * @returns             0 on success
+ * @returns             -ENOBUFS when the record doesn't fit and was dropped
+ */
+int bpf_log_write(const char *fmt, size_t fmt_len, const uint32_t *args);
+
+/**
+ * @brief Append a record for the bpf_printf helper
+ *
+ * The format string is read from the memory regions of the application.
+ *
+ * @param   bpf         Calling application
+ * @param   fmt         Format string in application memory
+ * @param   args        @ref BPF_LOG_ARGS_NUMOF arguments
+ *
+ * @returns             0 on success
+ * @returns             -EFAULT when the format string is not readable
+ * @returns             -ENOBUFS when the record was dropped
+ */
+int bpf_log_printf(const bpf_t *bpf, const char *fmt, const uint32_t *args);
+
+/**
+ * @brief Print all records in the log buffer
+ *
+ * @returns             Number of records printed
+ */
+unsigned bpf_log_drain(void);
+
+/**
+ * @brief Number of records dropped since initialization
+ */
+uint32_t bpf_log_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_LOG_H */
+/** @} */
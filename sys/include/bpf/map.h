@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_map BPF lookup maps
+ * @ingroup     sys_bpf
+ * @brief       Set membership and prefix lookups for eBPF applications
+ *
+ * Maps are filled by the host and queried by applications through helpers.
+ * They are registered with a numeric ID, which is how an application
+ * refers to them.
+ *
+ * - A bloom filter map (@ref bpf_map_bloom_t) answers "maybe in the set" or
+ *   "certainly not in the set" for arbitrary keys in constant time, using
+ *   @ref sys_bloom.
+ * - A longest-prefix-match map (@ref bpf_map_lpm_t) stores IPv6 prefixes
+ *   with a value each, in a path-compressed binary trie. A lookup returns the
+ *   value of the longest prefix containing an address. Its cost is bounded
+ *   by the address length, not by the number of prefixes.
+ *
+ * The maps are not locked. Don't modify a map while applications using it
+ * can run.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_MAP_H
+#define BPF_MAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bloom.h"
+#include "memarray.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Map types
+ */
+typedef enum {
+    BPF_MAP_TYPE_BLOOM,         /**< Bloom filter */
+    BPF_MAP_TYPE_LPM,           /**< IPv6 longest-prefix-match trie */
+} bpf_map_type_t;
+
+/**
+ * @brief Common map header
+ */
+typedef struct bpf_map {
+    struct bpf_map *next;       /**< Next registered map */
+    uint32_t id;                /**< ID used by applications */
+    bpf_map_type_t type;        /**< Map type */
+} bpf_map_t;
+
+/**
+ * @brief Bloom filter map
+ */
+typedef struct {
+    bpf_map_t super;            /**< Map header */
+    bloom_t bloom;              /**< Bloom filter */
+} bpf_map_bloom_t;
+
+/**
+ * @brief LPM trie node
+ */
+typedef struct bpf_map_lpm_node {
+    struct bpf_map_lpm_node *child[2];  /**< Children by the next prefix bit */
+    ipv6_addr_t prefix;         /**< Prefix, bits beyond @p len are zero */
+    uint32_t value;             /**< Value of the prefix */
+    uint8_t len;                /**< Prefix length in bits */
+    bool has_value;             /**< False for intermediate nodes */
+} bpf_map_lpm_node_t;
+
+/**
+ * @brief Longest-prefix-match map
+ */
+typedef struct {
+    bpf_map_t super;            /**< Map header */
+    bpf_map_lpm_node_t *root;   /**< Root of the trie */
+    memarray_t nodes;           /**< Free nodes */
+    bpf_map_lpm_node_t *storage;    /**< Node storage */
+    size_t storage_numof;       /**< Number of nodes in @p storage */
+} bpf_map_lpm_t;
+
+/**
+ * @brief Initialize a bloom filter map
+ *
+ * @param   map         Map to initialize
+ * @param   id          Map ID
+ * @param   bitfield    Bloom filter bits, must hold @p size bits
+ * @param   size        Number of bits in the filter
+ * @param   hashes      Hash functions
+ * @param   hashes_numof Number of hash functions
+ */
+void bpf_map_bloom_init(bpf_map_bloom_t *map, uint32_t id, uint8_t *bitfield,
+                        size_t size, hashfp_t *hashes, int hashes_numof);
+
+/**
+ * @brief Add a key to a bloom filter map
+ */
+void bpf_map_bloom_add(bpf_map_bloom_t *map, const void *key, size_t len);
+
+/**
+ * @brief Initialize a longest-prefix-match map
+ *
+ * A prefix takes up to two nodes, one for the prefix and one for where it
+ * branches off from the other prefixes.
+ *
+ * @param   map         Map to initialize
+ * @param   id          Map ID
+ * @param   nodes       Node storage
+ * @param   nodes_numof Number of nodes in @p nodes
+ */
+void bpf_map_lpm_init(bpf_map_lpm_t *map, uint32_t id,
+                      bpf_map_lpm_node_t *nodes, size_t nodes_numof);
+
+/**
+ * @brief Remove all prefixes from a longest-prefix-match map
+ *
+ * @param   map         Map
+ */
+void bpf_map_lpm_clear(bpf_map_lpm_t *map);
+
+/**
+ * @brief Add a prefix to a longest-prefix-match map or update its value
+ *
+ * @param   map         Map
+ * @param   prefix      Prefix, bits beyond @p len are ignored
+ * @param   len         Prefix length in bits, at most 128
+ * @param   value       Value to store
+ *
+ * @returns             0 on success
+ * @returns             -ENOMEM when the map is out of nodes
+ */
+int bpf_map_lpm_add(bpf_map_lpm_t *map, const ipv6_addr_t *prefix,
+                    uint8_t len, uint32_t value);
+
+/**
+ * @brief Remove a prefix from a longest-prefix-match map
+ *
+ * @returns             0 on success
+ * @returns             -ENOENT when the prefix is not in the map
+ */
+int bpf_map_lpm_remove(bpf_map_lpm_t *map, const ipv6_addr_t *prefix,
+                       uint8_t len);
+
+/**
+ * @brief Look up the longest prefix containing @p addr
+ *
+ * @param   map         Map
+ * @param   addr        Address to look up
+ * @param   value       Value of the matching prefix, may be NULL
+ *
+ * @returns             Length of the matching prefix
+ * @returns             -ENOENT when no prefix matches
+ */
+int bpf_map_lpm_lookup(const bpf_map_lpm_t *map, const ipv6_addr_t *addr,
+                       uint32_t *value);
+
+/**
+ * @brief Iterate over the prefixes of a longest-prefix-match map
+ *
+ * The prefixes are returned in no particular order.
+ *
+ * @param   map         Map
+ * @param   prev        Previously returned prefix, NULL to start
+ *
+ * @returns             The next prefix, NULL when there are no more prefixes
+ */
+const bpf_map_lpm_node_t *bpf_map_lpm_next(const bpf_map_lpm_t *map,
+                                           const bpf_map_lpm_node_t *prev);
+
+/**
+ * @brief Make a map available to applications
+ *
+ * @param   map         Initialized map, its ID must be unique
+ */
+void bpf_map_register(bpf_map_t *map);
+
+/**
+ * @brief Remove a map from the registry
+ */
+void bpf_map_unregister(bpf_map_t *map);
+
+/**
+ * @brief Find a registered map
+ *
+ * @param   id          Map ID
+ * @param   type        Expected map type
+ *
+ * @returns             The map, NULL when there is no map of @p type with @p id
+ */
+bpf_map_t *bpf_map_find(uint32_t id, bpf_map_type_t type);
+
+/**
+ * @brief Iterate over the registered maps
+ *
+ * @param   prev        Previously returned map, NULL to start
+ *
+ * @returns             The next map, NULL when there are no more maps
+ */
+bpf_map_t *bpf_map_next(const bpf_map_t *prev);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_MAP_H */
+/** @} */
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_mgmt BPF management
+ * @ingroup     sys_bpf
+ * @brief       Load, inspect and attach eBPF applications at runtime
+ *
+ * Applications are kept in a fixed number of slots. Every slot holds a copy
+ * of the bytecode, an instance created by @ref sys_bpf_instance and a hook
+ * through which the instance can be attached to a trigger. The per-hook
+ * execution statistics are available to find applications that fail or take
+ * too long, execution times require @ref CONFIG_BPF_HOOK_PROFILE.
+ *
+ * The same operations are available through the `bpf` shell command and,
+ * with the `gcoap` module, as CoAP resources. Responses of the resources are
+ * CBOR encoded:
+ *
+ * | Resource       | Method | Request payload          | Response payload |
+ * |----------------|--------|--------------------------|------------------|
+ * | `/bpf/prog`    | GET    |                          | Slot list        |
+ * | `/bpf/prog`    | POST   | Bytecode, block1         | Slot number      |
+ * | `/bpf/verify`  | POST   | Bytecode                 | Stack depth      |
+ * | `/bpf/attach`  | POST   | `[slot, trigger, policy]`|                  |
+ * | `/bpf/detach`  | POST   | `slot`                   |                  |
+ * | `/bpf/unload`  | POST   | `slot`                   |                  |
+ * | `/bpf/maps`    | GET    |                          | Map list         |
+ *
+ * The slot list is an array with an entry per used slot:
+ * `[slot, size, stack, trigger or null, policy, executions, errors,
+ * duration_us]`. The map list is an array with an entry per registered map:
+ * `[id, type, contents]`, where the contents of a bloom filter map are its
+ * bit field as byte string and the contents of a longest-prefix-match map
+ * are an array of `[prefix, length, value]`.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_MGMT_H
+#define BPF_MGMT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include "bpf.h"
+#include "bpf/instance.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of application slots
+ */
+#ifndef CONFIG_BPF_MGMT_SLOT_NUMOF
+#define CONFIG_BPF_MGMT_SLOT_NUMOF      (2U)
+#endif
+
+/**
+ * @brief Maximum application size in bytes
+ */
+#ifndef CONFIG_BPF_MGMT_APP_SIZE
+#define CONFIG_BPF_MGMT_APP_SIZE        (1024U)
+#endif
+
+/**
+ * @brief Application slot
+ */
+typedef struct {
+    union {
+        uint64_t align;         /**< Bytecode alignment */
+        uint8_t application[CONFIG_BPF_MGMT_APP_SIZE]; /**< Bytecode copy */
+    } app;                      /**< Application */
+    size_t application_len;     /**< Application length, 0 for a free slot */
+    bpf_instance_t *instance;   /**< Instance executing the application */
+    bpf_hook_t hook;            /**< Hook of the instance */
+    int trigger;                /**< Attached trigger, -1 when detached */
+} bpf_mgmt_slot_t;
+
+/**
+ * @brief Verify an application without loading it
+ *
+ * @returns             Stack depth required by the application
+ * @returns             -EINVAL when the application is malformed
+ */
+int bpf_mgmt_verify(const uint8_t *application, size_t len);
+
+/**
+ * @brief Load an application into a free slot
+ *
+ * The bytecode is copied into the slot.
+ *
+ * @returns             Slot number
+ * @returns             -EFBIG when the application is too large
+ * @returns             -ENOSPC when no slot is free
+ * @returns             -EINVAL when the application can't be instantiated
+ */
+int bpf_mgmt_load(const uint8_t *application, size_t len);
+
+/**
+ * @brief Load an application from a file
+ *
+ * Requires the `vfs` module.
+ *
+ * @returns             Slot number
+ * @returns             negative errno on failure
+ */
+int bpf_mgmt_load_file(const char *path);
+
+/**
+ * @brief Verify an application in a file without loading it
+ *
+ * Requires the `vfs` module and a free slot to read the file into.
+ *
+ * @returns             Stack depth required by the application
+ * @returns             negative errno on failure
+ */
+int bpf_mgmt_verify_file(const char *path);
+
+/**
+ * @brief Detach and unload the application in @p slot
+ *
+ * @returns             0 on success
+ * @returns             -ENOENT when the slot is not used
+ */
+int bpf_mgmt_unload(unsigned slot);
+
+/**
+ * @brief Attach the application in @p slot to a trigger
+ *
+ * @returns             0 on success
+ * @returns             -ENOENT when the slot is not used
+ * @returns             -EINVAL when the trigger or policy is invalid
+ * @returns             -EALREADY when the application is already attached
+ * @returns             -ENOSPC when the chain of the trigger is full
+ */
+int bpf_mgmt_attach(unsigned slot, unsigned trigger, bpf_hook_policy_t policy);
+
+/**
+ * @brief Detach the application in @p slot from its trigger
+ *
+ * @returns             0 on success
+ * @returns             -ENOENT when the slot is not used or not attached
+ */
+int bpf_mgmt_detach(unsigned slot);
+
+/**
+ * @brief Get a used slot
+ *
+ * @returns             The slot, NULL when @p slot is not used
+ */
+const bpf_mgmt_slot_t *bpf_mgmt_get(unsigned slot);
+
+/**
+ * @brief Encode the slot list as CBOR
+ *
+ * @returns             Length of the encoding
+ * @returns             -ENOBUFS when @p buf is too small
+ */
+ssize_t bpf_mgmt_list_cbor(uint8_t *buf, size_t len);
+
+/**
+ * @brief Encode the registered maps as CBOR
+ *
+ * Requires the `bpf_map` module.
+ *
+ * @returns             Length of the encoding
+ * @returns             -ENOBUFS when @p buf is too small
+ */
+ssize_t bpf_mgmt_maps_cbor(uint8_t *buf, size_t len);
+
+/**
+ * @brief Register the CoAP resources
+ *
+ * Requires the `gcoap` module.
+ */
+void bpf_mgmt_coap_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_MGMT_H */
+/** @} */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_mpu BPF hardware isolation
+ * @ingroup     sys_bpf
+ * @brief       Memory protection of compiled applications by the MPU
+ *
+ * Compiled applications (see @ref sys_bpf_aot) check every memory access
+ * against the memory regions of the application in software. With this
+ * module, an application can instead be compiled without these checks and
+ * executed isolated, leaving the checks to hardware:
+ *
+ *     BPF_AOT_ISOLATED_PROGRAMS += bpf/foo.bin
+ *
+ * Such an application must have @ref BPF_FLAG_ISOLATED set in
+ * @ref bpf_t::flags, @ref bpf_execute then executes it with
+ * @ref bpf_mpu_execute.
+ *
+ * The memory regions of the application are mapped to memory protection
+ * regions for the duration of the execution, an access outside of them
+ * faults and ends the execution with @ref BPF_ILLEGAL_MEM. Helpers are
+ * called with the default protection and keep checking their arguments.
+ *
+ * Only `native` is supported for now: the pages of the regions are protected
+ * according to the region flags and a segmentation fault ends the execution.
+ * Regions must be page aligned and a multiple of the page size. Memory
+ * outside of the regions is not protected, this is meant for testing
+ * isolated applications and the fault handling, not as a sandbox.
+ *
+ * Only a single isolated application executes at a time.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_MPU_H
+#define BPF_MPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bpf.h"
+#include "bpf/call.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the fault handling
+ *
+ * Called by @ref bpf_init
+ */
+void bpf_mpu_init(void);
+
+/**
+ * @brief Execute an isolated application
+ *
+ * Executes @ref bpf_t::native with hardware memory protection. Applications
+ * that are not compiled are executed by @ref bpf_execute.
+ *
+ * @param   bpf     bpf context
+ * @param   ctx     Context passed to the application
+ * @param   ctx_len Length of @p ctx
+ * @param   result  Return value of the application
+ *
+ * @returns         Same return codes as @ref bpf_execute
+ * @returns         -EINVAL when a region can't be protected by the hardware
+ */
+int bpf_mpu_execute(bpf_t *bpf, void *ctx, size_t ctx_len, int64_t *result);
+
+/**
+ * @brief Call a helper from an isolated application
+ *
+ * Used by the compiled application instead of calling the helper directly.
+ * The helper runs without the memory protection of the application.
+ *
+ * @param   bpf     bpf context
+ * @param   num     Helper number, see @ref bpf_get_call
+ * @param   a1      First argument of the helper, up to @p a5
+ *
+ * @returns         Return value of the helper
+ * @returns         BPF_ILLEGAL_CALL when the helper is not available
+ */
+uint32_t bpf_mpu_call(bpf_t *bpf, uint32_t num, uint32_t a1, uint32_t a2,
+                      uint32_t a3, uint32_t a4, uint32_t a5);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_MPU_H */
+/** @} */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_pkt BPF packet access
+ * @ingroup     sys_bpf
+ * @brief       Read access to GNRC packets from eBPF applications
+ *
+ * A @ref gnrc_pktsnip_t packet is a chain of snips and not a contiguous
+ * buffer. Instead of merging the packet before running a filter,
+ * @ref bpf_pkt_execute exposes the packet through the `bpf_pkt_load_*`
+ * helpers. These walk the snip chain and copy the requested bytes, the
+ * fixed-width loads convert from network byte order.
+ *
+ * The packet data is addressed as if the snips were concatenated in chain
+ * order. Netif header snips don't contain packet data and are skipped. The
+ * last snip that was read from is cached, so parsing the headers of a packet
+ * from front to back doesn't walk the chain from the start on every load.
+ *
+ * The application receives a @ref bpf_pkt_ctx_t with the packet length as
+ * context. Loads beyond the packet length fail.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_PKT_H
+#define BPF_PKT_H
+
+#include <stdint.h>
+#include "bpf.h"
+#include "net/gnrc/pkt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Packet state of a running application
+ */
+struct bpf_pkt {
+    gnrc_pktsnip_t *pkt;        /**< First data snip of the packet */
+    gnrc_pktsnip_t *snip;       /**< Snip of the last load */
+    uint32_t snip_offset;       /**< Packet offset of @p snip */
+    uint32_t len;               /**< Packet length without netif headers */
+};
+
+/**
+ * @brief Execute an application on a packet
+ *
+ * @param   bpf     bpf context
+ * @param   pkt     Packet to inspect, must not be modified while the
+ *                  application runs
+ * @param   result  Return value of the application
+ *
+ * @returns         Same return codes as @ref bpf_execute
+ */
+int bpf_pkt_execute(bpf_t *bpf, gnrc_pktsnip_t *pkt, int64_t *result);
+
+/**
+ * @brief Copy packet data into a buffer
+ *
+ * @param   state   Packet state
+ * @param   offset  Packet offset to start reading from
+ * @param   dst     Destination buffer
+ * @param   len     Number of bytes to copy
+ *
+ * @returns         0 on success
+ * @returns         -1 when the area is beyond the packet length
+ */
+int bpf_pkt_load(bpf_pkt_t *state, uint32_t offset, void *dst, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_PKT_H */
+/** @} */
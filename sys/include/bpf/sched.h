@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_sched BPF runtime scheduler
+ * @ingroup     sys_bpf
+ * @brief       Event driven execution of eBPF applications
+ *
+ * All scheduled applications are executed from a single runtime thread built
+ * on @ref sys_event. An application is bound to a schedule entry, which can be
+ * triggered periodically by a ztimer, periodically after sampling a SAUL
+ * device, or manually with @ref bpf_sched_trigger from interrupts, message
+ * handlers or hooks.
+ *
+ * Entries are posted to one of @ref BPF_SCHED_PRIO_NUMOF event queues, higher
+ * priority queues are always served first. Triggering an entry that is still
+ * pending coalesces both triggers into a single execution. All entries pending
+ * when the runtime thread wakes up are executed as a single batch.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_SCHED_H
+#define BPF_SCHED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bpf.h"
+#include "event.h"
+#include "msg.h"
+#include "thread.h"
+#include "ztimer.h"
+#include "ztimer/periodic.h"
+#ifdef MODULE_SAUL_REG
+#include "saul_reg.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Stack size of the runtime thread
+ */
+#ifndef CONFIG_BPF_SCHED_STACKSIZE
+#define CONFIG_BPF_SCHED_STACKSIZE  (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief Priority of the runtime thread
+ */
+#ifndef CONFIG_BPF_SCHED_PRIO
+#define CONFIG_BPF_SCHED_PRIO       (THREAD_PRIORITY_MAIN - 1)
+#endif
+
+/**
+ * @brief Schedule entry priorities
+ */
+typedef enum {
+    BPF_SCHED_PRIO_HIGH,        /**< Served before all other entries */
+    BPF_SCHED_PRIO_LOW,         /**< Served when no high priority entry is pending */
+    BPF_SCHED_PRIO_NUMOF,       /**< Number of priorities */
+} bpf_sched_prio_t;
+
+/**
+ * @brief Forward declaration of the schedule entry
+ */
+typedef struct bpf_sched_entry bpf_sched_entry_t;
+
+/**
+ * @brief Called from the runtime thread after every execution
+ *
+ * @param   entry       Executed entry
+ * @param   res         Return code of @ref bpf_execute
+ * @param   result      Return value of the application
+ */
+typedef void (*bpf_sched_done_t)(bpf_sched_entry_t *entry, int res,
+                                 int64_t result);
+
+/**
+ * @brief Schedule entry binding an application to its triggers
+ */
+struct bpf_sched_entry {
+    event_t super;              /**< Event posted to the runtime queue */
+    bpf_t *bpf;                 /**< Application to execute */
+    void *ctx;                  /**< Context passed to the application */
+    size_t ctx_len;             /**< Length of the context */
+    bpf_sched_prio_t prio;      /**< Queue the entry is posted to */
+    bpf_sched_done_t done;      /**< Completion callback, may be NULL */
+    ztimer_periodic_t timer;    /**< Periodic trigger */
+#if defined(MODULE_SAUL_REG) || defined(DOXYGEN)
+    saul_reg_t *dev;            /**< Device sampled before every execution */
+    phydat_t data;              /**< Sample passed as context */
+#endif
+    bpf_sched_entry_t *msg_next; /**< Next entry bound to a message type */
+    msg_t msg;                  /**< Last message dispatched to the entry */
+    bpf_hook_t hook;            /**< Hook installed by @ref bpf_sched_hook */
+    bpf_hook_trigger_t trigger; /**< Trigger of @ref bpf_sched_entry::hook */
+    uint32_t executions;        /**< Number of executions */
+    uint32_t coalesced;         /**< Triggers merged into a pending execution */
+};
+
+/**
+ * @brief Start the runtime thread
+ *
+ * Called by @ref bpf_init
+ */
+void bpf_sched_init(void);
+
+/**
+ * @brief Initialize a schedule entry
+ *
+ * @param   entry       Entry to initialize
+ * @param   bpf         Application, must be set up
+ * @param   ctx         Context passed to every execution
+ * @param   ctx_len     Length of the context
+ * @param   prio        Priority of the entry
+ * @param   done        Completion callback, may be NULL
+ */
+void bpf_sched_entry_init(bpf_sched_entry_t *entry, bpf_t *bpf,
+                          void *ctx, size_t ctx_len, bpf_sched_prio_t prio,
+                          bpf_sched_done_t done);
+
+/**
+ * @brief Schedule a single execution of the entry
+ *
+ * Safe to call from interrupt context. Triggers arriving while the entry is
+ * pending are coalesced.
+ *
+ * @param   entry       Entry to trigger
+ */
+void bpf_sched_trigger(bpf_sched_entry_t *entry);
+
+/**
+ * @brief Trigger the entry periodically
+ *
+ * @param   entry       Entry to trigger
+ * @param   clock       ztimer clock to use
+ * @param   interval    Interval in ticks of @p clock
+ */
+void bpf_sched_periodic(bpf_sched_entry_t *entry, ztimer_clock_t *clock,
+                        uint32_t interval);
+
+#if defined(MODULE_SAUL_REG) || defined(DOXYGEN)
+/**
+ * @brief Periodically sample a SAUL device and execute the entry on the sample
+ *
+ * The context of the entry is replaced by the @ref phydat_t read from @p dev.
+ * The device is read from the runtime thread before every execution.
+ *
+ * @param   entry       Entry to trigger
+ * @param   dev         SAUL device to sample
+ * @param   clock       ztimer clock to use
+ * @param   interval    Interval in ticks of @p clock
+ */
+void bpf_sched_saul(bpf_sched_entry_t *entry, saul_reg_t *dev,
+                    ztimer_clock_t *clock, uint32_t interval);
+#endif
+
+/**
+ * @brief Trigger the entry on messages of type @p type
+ *
+ * The context of the entry is replaced by the @ref msg_t passed to
+ * @ref bpf_sched_msg_dispatch. Messages arriving while the entry is pending
+ * are coalesced, the application sees the last one.
+ *
+ * @param   entry       Entry to trigger
+ * @param   type        Message type
+ */
+void bpf_sched_msg(bpf_sched_entry_t *entry, uint16_t type);
+
+/**
+ * @brief Trigger the entries bound to the type of a message
+ *
+ * Called from the message loop of the thread that received @p msg.
+ *
+ * @param   msg         Received message
+ *
+ * @returns             Number of entries triggered
+ */
+unsigned bpf_sched_msg_dispatch(const msg_t *msg);
+
+/**
+ * @brief Trigger the entry whenever the hooks of @p trigger are executed
+ *
+ * The entry is installed as a hook at @p trigger. It doesn't take part in the
+ * result of the chain and runs in the runtime thread with its own context,
+ * the context passed to @ref bpf_hook_execute is not available anymore then.
+ *
+ * @param   entry       Entry to trigger
+ * @param   trigger     Hook trigger
+ *
+ * @returns             0 on success
+ * @returns             -ENOSPC when the chain of @p trigger is full
+ */
+int bpf_sched_hook(bpf_sched_entry_t *entry, bpf_hook_trigger_t trigger);
+
+/**
+ * @brief Stop all triggers of the entry and cancel a pending execution
+ *
+ * @param   entry       Entry to stop
+ */
+void bpf_sched_stop(bpf_sched_entry_t *entry);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_SCHED_H */
+/** @} */
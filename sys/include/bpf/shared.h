@@ -26,6 +26,7 @@ union {                 \
 enum {
     /* Aux helper functions */
     BPF_FUNC_BPF_PRINTF = 0x1,
+    BPF_FUNC_BPF_TAIL_CALL = 0x2,
 
     /* Key/value store functions */
     BPF_FUNC_BPF_STORE_LOCAL = 0x10,
@@ -40,6 +41,7 @@ enum {
     BPF_FUNC_BPF_SAUL_REG_FIND_NTH = 0x30,
     BPF_FUNC_BPF_SAUL_REG_FIND_TYPE = 0x31,
     BPF_FUNC_BPF_SAUL_REG_READ = 0x32,
+    BPF_FUNC_BPF_SAUL_READ_BATCH = 0x33,
 
     /* (g)coap functions */
     BPF_FUNC_BPF_GCOAP_RESP_INIT = 0x40,
@@ -48,6 +50,28 @@ enum {
     BPF_FUNC_BPF_COAP_GET_PDU = 0x43,
 
     BPF_FUNC_BPF_FMT_S16_DFP = 0x50,
+
+    /* Memory functions */
+    BPF_FUNC_BPF_MEMCPY = 0x60,
+    BPF_FUNC_BPF_MEMSET = 0x61,
+    BPF_FUNC_BPF_MEMCMP = 0x62,
+
+    /* Checksum and hash functions */
+    BPF_FUNC_BPF_FLETCHER32 = 0x70,
+    BPF_FUNC_BPF_CRC16_CCITT = 0x71,
+    BPF_FUNC_BPF_SHA256_INIT = 0x72,
+    BPF_FUNC_BPF_SHA256_UPDATE = 0x73,
+    BPF_FUNC_BPF_SHA256_FINAL = 0x74,
+
+    /* Packet calls */
+    BPF_FUNC_BPF_PKT_LOAD_BYTES = 0x80,
+    BPF_FUNC_BPF_PKT_LOAD_U8 = 0x81,
+    BPF_FUNC_BPF_PKT_LOAD_U16 = 0x82,
+    BPF_FUNC_BPF_PKT_LOAD_U32 = 0x83,
+
+    /* Map calls */
+    BPF_FUNC_BPF_MAP_BLOOM_CHECK = 0x90,
+    BPF_FUNC_BPF_MAP_LPM_LOOKUP = 0x91,
 };
 
 /* Helper structs */
@@ -57,6 +81,10 @@ typedef struct {
     size_t buf_len; /**< Packet buffer length */
 } bpf_coap_ctx_t;
 
+typedef struct {
+    uint32_t len;   /**< Packet length, excluding netif headers */
+} bpf_pkt_ctx_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_snapshot BPF state snapshots
+ * @ingroup     sys_bpf
+ * @brief       Persist key-value stores and maps across reboots
+ *
+ * The global store, the local stores of registered applications and the
+ * registered maps (with the `bpf_map` module) are serialized into a compact
+ * binary image. Its layout only depends on the store size and the registered
+ * maps, so every value has a fixed position in the image.
+ *
+ * The image is written in pages of @ref CONFIG_BPF_SNAPSHOT_PAGE_SIZE bytes.
+ * Store updates and map modifications mark the pages they change as dirty,
+ * a snapshot only writes the dirty pages. Registering or removing a map
+ * changes the layout and marks the full image as dirty.
+ *
+ * Local stores are only persisted for applications registered with
+ * @ref bpf_snapshot_register, the ID identifies the application across
+ * reboots. At startup, register the applications and maps and restore the
+ * image in a single pass with @ref bpf_snapshot_restore_file. Values of
+ * unregistered applications and maps are skipped.
+ *
+ * The image is written through a callback, which makes it possible to store
+ * it directly on an MTD device. With the `vfs` module, files are supported
+ * directly.
+ *
+ * Image format, all fields are little endian:
+ *
+ * | Section  | Content                                                     |
+ * |----------|-------------------------------------------------------------|
+ * | Header   | `"BPFS"`, version (u8), reserved (u8), store values (u16),  |
+ * |          | maps (u16), reserved (u16), image length (u32)              |
+ * | Store    | Per store value: owner (u16, 0 for the global store,        |
+ * |          | 0xffff for a free value), reserved (u16), key (u32),        |
+ * |          | value (u32)                                                 |
+ * | Maps     | Per map: ID (u32), type (u8), reserved (3 bytes),           |
+ * |          | content length (u32) and content                            |
+ *
+ * The content of a bloom filter map is its bit field. The content of a
+ * longest-prefix-match map is a record per node: prefix (16 bytes),
+ * length (u8), has value (u8), reserved (u16), value (u32).
+ *
+ * Executing applications can't be suspended, their register and stack state
+ * is not part of a snapshot. Don't take a snapshot while applications run.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_SNAPSHOT_H
+#define BPF_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include "bpf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Size of a snapshot page in bytes
+ */
+#ifndef CONFIG_BPF_SNAPSHOT_PAGE_SIZE
+#define CONFIG_BPF_SNAPSHOT_PAGE_SIZE   (64U)
+#endif
+
+/**
+ * @brief Maximum number of pages of an image
+ */
+#ifndef CONFIG_BPF_SNAPSHOT_PAGES_MAX
+#define CONFIG_BPF_SNAPSHOT_PAGES_MAX   (64U)
+#endif
+
+/**
+ * @brief Size of a longest-prefix-match node record in the image
+ */
+#define BPF_SNAPSHOT_LPM_RECORD_SIZE    (24U)
+
+struct bpf_map;
+
+/**
+ * @brief Application whose local store is persisted
+ */
+typedef struct bpf_snapshot_app {
+    struct bpf_snapshot_app *next;  /**< Next registered application */
+    bpf_t *bpf;                 /**< Application */
+    uint16_t id;                /**< Persistent ID */
+} bpf_snapshot_app_t;
+
+/**
+ * @brief Callback writing a part of the image
+ *
+ * @param   arg     Callback argument
+ * @param   offset  Offset in the image
+ * @param   buf     Image data
+ * @param   len     Length of @p buf
+ *
+ * @returns         0 on success, negative errno on failure
+ */
+typedef int (*bpf_snapshot_write_t)(void *arg, size_t offset,
+                                    const void *buf, size_t len);
+
+/**
+ * @brief Callback reading the image sequentially
+ *
+ * @returns         Number of bytes read, 0 at the end of the image
+ * @returns         negative errno on failure
+ */
+typedef ssize_t (*bpf_snapshot_read_t)(void *arg, void *buf, size_t len);
+
+/**
+ * @brief Persist the local store of an application
+ *
+ * @param   app     Registration to initialize
+ * @param   bpf     Application
+ * @param   id      Persistent ID, 1 to 0xfffe
+ */
+void bpf_snapshot_register(bpf_snapshot_app_t *app, bpf_t *bpf, uint16_t id);
+
+/**
+ * @brief Stop persisting the local store of an application
+ */
+void bpf_snapshot_unregister(bpf_snapshot_app_t *app);
+
+/**
+ * @brief Length of the image in bytes
+ */
+size_t bpf_snapshot_len(void);
+
+/**
+ * @brief Serialize part of the image
+ *
+ * @param   offset  Offset in the image
+ * @param   buf     Buffer for the image data
+ * @param   len     Number of bytes to serialize
+ *
+ * @returns         Number of bytes serialized, less than @p len at the end
+ *                  of the image
+ */
+size_t bpf_snapshot_read(size_t offset, void *buf, size_t len);
+
+/**
+ * @brief Write the dirty pages of the image
+ *
+ * @param   write   Callback writing the pages
+ * @param   arg     Callback argument
+ *
+ * @returns         Number of pages written
+ * @returns         -EFBIG when the image exceeds
+ *                  @ref CONFIG_BPF_SNAPSHOT_PAGES_MAX pages
+ * @returns         Error of @p write, the remaining pages stay dirty
+ */
+int bpf_snapshot_save(bpf_snapshot_write_t write, void *arg);
+
+/**
+ * @brief Restore stores and maps from an image
+ *
+ * Marks the full image as dirty, the restored maps may be laid out
+ * differently.
+ *
+ * @param   read    Callback reading the image
+ * @param   arg     Callback argument
+ *
+ * @returns         0 on success
+ * @returns         -EINVAL when the image is malformed or was written with a
+ *                  different store size
+ * @returns         Error of @p read
+ */
+int bpf_snapshot_restore(bpf_snapshot_read_t read, void *arg);
+
+/**
+ * @brief Write the dirty pages of the image to a file
+ *
+ * Requires the `vfs` module. The file is created if it doesn't exist, a new
+ * file should be written after @ref bpf_snapshot_invalidate.
+ *
+ * @returns         Number of pages written
+ * @returns         negative errno on failure
+ */
+int bpf_snapshot_save_file(const char *path);
+
+/**
+ * @brief Restore stores and maps from a file
+ *
+ * Requires the `vfs` module.
+ *
+ * @returns         0 on success
+ * @returns         negative errno on failure
+ */
+int bpf_snapshot_restore_file(const char *path);
+
+/**
+ * @brief Mark the full image as dirty
+ */
+void bpf_snapshot_invalidate(void);
+
+/**
+ * @brief Mark a part of the image as dirty
+ *
+ * Used by the store and the maps.
+ *
+ * @param   offset  Offset in the image
+ * @param   len     Length of the part
+ */
+void bpf_snapshot_mark(size_t offset, size_t len);
+
+/**
+ * @brief Mark a store value as dirty
+ *
+ * @param   idx     Index of the value in the store pool
+ */
+void bpf_snapshot_mark_store(unsigned idx);
+
+/**
+ * @brief Offset of a map content in the image
+ *
+ * @returns         The offset, 0 when the map is not registered
+ */
+size_t bpf_snapshot_map_offset(const struct bpf_map *map);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_SNAPSHOT_H */
+/** @} */
@@ -23,8 +23,10 @@
 #ifndef BPF_STORE_H
 #define BPF_STORE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include "bpf.h"
 #include "btree.h"
 
 #ifdef __cplusplus
@@ -64,6 +66,33 @@ int bpf_store_update_local(bpf_t *bpf, uint32_t key, uint32_t value);
 int bpf_store_fetch_global(uint32_t key, uint32_t *value);
 int bpf_store_fetch_local(bpf_t *bpf, uint32_t key, uint32_t *value);
 
+/**
+ * @brief Remove all values from the local store of @p bpf and return them to
+ *        the value pool
+ *
+ * @param   bpf     bpf context to clear the local store of
+ */
+void bpf_store_clear_local(bpf_t *bpf);
+
+/**
+ * @brief Get a value from the value pool by index
+ *
+ * @param   idx     Index, less than @ref CONFIG_BPF_STORE_NUM_VALUES
+ *
+ * @returns         The value, it may be unused
+ */
+bpf_store_keyval_t *bpf_store_get_slot(unsigned idx);
+
+/**
+ * @brief Check whether a value of the pool is in a store
+ *
+ * @param   bpf     bpf context of the local store, NULL for the global store
+ * @param   keyval  Value from @ref bpf_store_get_slot
+ *
+ * @returns         true if @p keyval is in the store
+ */
+bool bpf_store_contains(bpf_t *bpf, bpf_store_keyval_t *keyval);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_bpf_verify BPF application verifier
+ * @ingroup     sys_bpf
+ * @brief       Static checks on eBPF applications
+ *
+ * With the `bpf_verify_cache` module, @ref bpf_verify keeps the results of the
+ * most recently verified applications, including their decoded function
+ * table, keyed by the SHA-256 of the bytecode.
+ * Verifying an application again, for example when it is uploaded a second
+ * time, only costs hashing it.
+ *
+ * @{
+ *
+ * @file
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BPF_VERIFY_H
+#define BPF_VERIFY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "bpf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of verification results kept by `bpf_verify_cache`
+ */
+#ifndef CONFIG_BPF_VERIFY_CACHE_NUMOF
+#define CONFIG_BPF_VERIFY_CACHE_NUMOF   (4U)
+#endif
+
+/**
+ * @brief Maximum number of functions in an application
+ *
+ * Functions are the application entry and all bpf-to-bpf call targets.
+ */
+#ifndef CONFIG_BPF_VERIFY_MAX_FUNCTIONS
+#define CONFIG_BPF_VERIFY_MAX_FUNCTIONS (16U)
+#endif
+
+/**
+ * @brief Results of @ref bpf_verify
+ */
+typedef struct {
+    uint32_t frame_size;        /**< See @ref bpf_verify_frame_size */
+    uint32_t stack_depth;       /**< See @ref bpf_verify_stack_depth */
+    unsigned num_functions;     /**< Number of entries in @p functions */
+    /**
+     * @brief First instruction of every function, in ascending order
+     *
+     * The application entry (0) followed by the bpf-to-bpf call targets, as
+     * decoded by the call graph analysis.
+     */
+    uint32_t functions[CONFIG_BPF_VERIFY_MAX_FUNCTIONS];
+} bpf_verify_result_t;
+
+/**
+ * @brief Hits and misses of `bpf_verify_cache`
+ */
+typedef struct {
+    unsigned hits;              /**< Results served from the cache */
+    unsigned misses;            /**< Applications analyzed */
+} bpf_verify_cache_stats_t;
+
+/**
+ * @brief Check the application for structural errors
+ *
+ * @param   application     Application bytecode
+ * @param   len             Length of the application in bytes
+ *
+ * @returns                 BPF_OK when the application is well formed
+ * @returns                 BPF_ILLEGAL_LEN when the length is not a multiple
+ *                          of the instruction size
+ * @returns                 BPF_NO_RETURN when the application does not end
+ *                          with a return instruction
+ */
+int bpf_verify_preflight(const uint8_t *application, size_t len);
+
+/**
+ * @brief Compute the stack frame size of an application
+ *
+ * Tracks all values derived from the frame pointer (r10) by constant offsets
+ * and returns the deepest offset accessed or computed, rounded up to 8 bytes.
+ * The result is the largest frame of all functions in the application.
+ * Accesses through pointers that can't be followed by this analysis are still
+ * checked against the stack region at runtime.
+ *
+ * @param   application     Application bytecode
+ * @param   len             Length of the application in bytes
+ *
+ * @returns                 Stack frame size in bytes, 0 when a frame pointer
+ *                          offset is out of range, see @ref bpf_verify
+ */
+size_t bpf_verify_frame_size(const uint8_t *application, size_t len);
+
+/**
+ * @brief Compute the maximum nesting of bpf-to-bpf calls in an application
+ *
+ * @param   application     Application bytecode
+ * @param   len             Length of the application in bytes
+ *
+ * @returns                 Maximum call depth, 0 when the application doesn't
+ *                          contain bpf-to-bpf calls
+ * @returns                 BPF_ILLEGAL_JUMP when a call target is outside the
+ *                          application
+ * @returns                 BPF_ILLEGAL_CALL when the calls nest deeper than
+ *                          @ref CONFIG_BPF_MAX_CALL_DEPTH, this includes
+ *                          recursion, or when the application has more than
+ *                          @ref CONFIG_BPF_VERIFY_MAX_FUNCTIONS functions
+ */
+int bpf_verify_call_depth(const uint8_t *application, size_t len);
+
+/**
+ * @brief Compute the maximum stack depth used by an application
+ *
+ * This is the frame size multiplied by the number of nested frames.
+ *
+ * @param   application     Application bytecode
+ * @param   len             Length of the application in bytes
+ *
+ * @returns                 Stack depth in bytes
+ * @returns                 BPF_ILLEGAL_INSTRUCTION when a frame pointer offset
+ *                          is out of range
+ * @returns                 Negative on an invalid call graph, see
+ *                          @ref bpf_verify_call_depth
+ */
+int bpf_verify_stack_depth(const uint8_t *application, size_t len);
+
+/**
+ * @brief Run all checks on an application
+ *
+ * Combines @ref bpf_verify_preflight, @ref bpf_verify_frame_size and
+ * @ref bpf_verify_stack_depth. Failures are cached as well.
+ *
+ * @param   application     Application bytecode
+ * @param   len             Length of the application in bytes
+ * @param[out] result       Frame size, stack depth and functions of the
+ *                          application
+ *
+ * @returns                 BPF_OK when the application passes all checks
+ * @returns                 Negative on an error of one of the checks
+ */
+int bpf_verify(const uint8_t *application, size_t len,
+               bpf_verify_result_t *result);
+
+/**
+ * @brief Read the statistics of the verification cache
+ *
+ * Requires the `bpf_verify_cache` module.
+ *
+ * @param[out] stats        Hits and misses since boot
+ */
+void bpf_verify_cache_stats(bpf_verify_cache_stats_t *stats);
+
+/**
+ * @brief Drop all cached verification results
+ *
+ * Requires the `bpf_verify_cache` module.
+ */
+void bpf_verify_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BPF_VERIFY_H */
+/** @} */
@@ -328,6 +328,22 @@ int gnrc_ipv6_nib_get_next_hop_l2addr(const ipv6_addr_t *dst,
                                       gnrc_netif_t *netif, gnrc_pktsnip_t *pkt,
                                       gnrc_ipv6_nib_nc_t *nce);
 
+/**
+ * @brief   Gets the number of changes to the NIB
+ *
+ * The number changes whenever a change to the NIB (e.g. of a route, a prefix,
+ * a default router or the state or link-layer address of a neighbor) may
+ * change the result of @ref gnrc_ipv6_nib_get_next_hop_l2addr(). A result is
+ * thus still valid as long as the number read *before* getting it did not
+ * change.
+ *
+ * Does not acquire the NIB, so it is cheap enough to be called for every
+ * packet.
+ *
+ * @return  The number of changes to the NIB. May wrap around.
+ */
+uint32_t gnrc_ipv6_nib_changes(void);
+
 /**
  * @brief   Handles a received ICMPv6 packet
  *
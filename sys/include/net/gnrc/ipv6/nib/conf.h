@@ -214,6 +214,30 @@ extern "C" {
 #ifndef CONFIG_GNRC_IPV6_NIB_MULTIHOP_DAD
 #define CONFIG_GNRC_IPV6_NIB_MULTIHOP_DAD             0
 #endif
+
+/**
+ * @brief   Index the neighbor cache by IPv6 address
+ *
+ * Neighbor lookups then only compare the entries in one of
+ * @ref CONFIG_GNRC_IPV6_NIB_NC_HASH_BUCKETS hash buckets instead of all
+ * @ref CONFIG_GNRC_IPV6_NIB_NUMOF entries. Only pays off for nodes with many
+ * neighbors, such as border routers.
+ */
+#ifndef CONFIG_GNRC_IPV6_NIB_NC_HASH
+#define CONFIG_GNRC_IPV6_NIB_NC_HASH                  0
+#endif
+
+/**
+ * @brief   Find the longest prefix match for a destination in a compressed
+ *          binary trie of the off-link entries
+ *
+ * The cost of a forwarding table lookup then depends on the depth of the trie
+ * instead of @ref CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF. Only pays off for nodes
+ * with many routes, such as border routers.
+ */
+#ifndef CONFIG_GNRC_IPV6_NIB_FT_TRIE
+#define CONFIG_GNRC_IPV6_NIB_FT_TRIE                  0
+#endif
 /** @} */
 
 /**
@@ -271,6 +295,18 @@ extern "C" {
 #define CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF              (8)
 #endif
 
+#if CONFIG_GNRC_IPV6_NIB_NC_HASH || defined(DOXYGEN)
+/**
+ * @brief   Number of hash buckets of the neighbor cache index
+ *
+ * @note    Only used with @ref CONFIG_GNRC_IPV6_NIB_NC_HASH. Costs one or two
+ *          bytes per bucket, depending on @ref CONFIG_GNRC_IPV6_NIB_NUMOF.
+ */
+#ifndef CONFIG_GNRC_IPV6_NIB_NC_HASH_BUCKETS
+#define CONFIG_GNRC_IPV6_NIB_NC_HASH_BUCKETS         ((CONFIG_GNRC_IPV6_NIB_NUMOF + 1) / 2)
+#endif
+#endif
+
 #if CONFIG_GNRC_IPV6_NIB_MULTIHOP_P6C || defined(DOXYGEN)
 /**
  * @brief   Number of authoritative border router entries in NIB
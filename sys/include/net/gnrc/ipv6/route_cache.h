@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_ipv6_route_cache IPv6 route cache
+ * @ingroup     net_gnrc_ipv6
+ * @brief       Cache of the next hops the NIB resolved for unicast
+ *              destinations
+ *
+ * With this module, @ref net_gnrc_ipv6 keeps the next hop, interface and
+ * link-layer address that @ref gnrc_ipv6_nib_get_next_hop_l2addr() resolved
+ * for the last @ref CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE unicast destinations.
+ * Packets sent or forwarded to a cached destination skip the NIB lookup until
+ * the NIB changes (see @ref gnrc_ipv6_nib_changes()).
+ * @{
+ *
+ * @file
+ * @brief   IPv6 route cache definitions
+ *
+ * @author  Koen Zandberg <koen@bergzand.net>
+ */
+#ifndef NET_GNRC_IPV6_ROUTE_CACHE_H
+#define NET_GNRC_IPV6_ROUTE_CACHE_H
+
+#include <stdint.h>
+
+#include "net/gnrc/ipv6/nib/nc.h"
+#include "net/gnrc/netif.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup    net_gnrc_ipv6_route_cache_conf GNRC IPv6 route cache compile configurations
+ * @ingroup     net_gnrc_ipv6_route_cache
+ * @ingroup     net_gnrc_conf
+ * @{
+ */
+/**
+ * @brief   Number of destinations in the route cache
+ */
+#ifndef CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE
+#define CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE      (4U)
+#endif
+/** @} */
+
+/**
+ * @brief   Gets the cached next hop to a destination
+ *
+ * @param[in] dst       The destination address.
+ * @param[in] iface     The interface the sender requested. May be NULL.
+ * @param[in] changes   The current value of @ref gnrc_ipv6_nib_changes().
+ * @param[out] nce      The next hop and its link-layer address, if cached.
+ *
+ * @return  The interface to the next hop.
+ * @return  NULL, if there is no entry for @p dst and @p iface that was
+ *          resolved for @p changes.
+ */
+gnrc_netif_t *gnrc_ipv6_route_cache_get(const ipv6_addr_t *dst,
+                                        const gnrc_netif_t *iface,
+                                        uint32_t changes,
+                                        gnrc_ipv6_nib_nc_t *nce);
+
+/**
+ * @brief   Adds the next hop to a destination to the cache
+ *
+ * Replaces the oldest entry if the cache is full. The next hop is not cached
+ * if the NIB needs to see every packet to it, i.e. if its reachability is
+ * not confirmed or if @p netif has a route info callback.
+ *
+ * @param[in] dst       The destination address.
+ * @param[in] iface     The interface the sender requested. May be NULL.
+ * @param[in] netif     The interface to the next hop.
+ * @param[in] nce       The next hop and its link-layer address.
+ * @param[in] changes   The value of @ref gnrc_ipv6_nib_changes() read
+ *                      *before* @p nce was resolved.
+ */
+void gnrc_ipv6_route_cache_add(const ipv6_addr_t *dst, gnrc_netif_t *iface,
+                               gnrc_netif_t *netif,
+                               const gnrc_ipv6_nib_nc_t *nce,
+                               uint32_t changes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_IPV6_ROUTE_CACHE_H */
+/** @} */
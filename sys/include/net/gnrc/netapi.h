@@ -54,6 +54,38 @@
  * USEMODULE += gnrc_netapi_callbacks
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * @}
+ *
+ * @defgroup    net_gnrc_netapi_batch   Batching extension
+ * @ingroup     net_gnrc_netapi
+ * @brief       Pass several packets to a network module in one message
+ * @{
+ * @details The submodule `gnrc_netapi_batch` lets a network module collect
+ *          the packets it passes up the stack with gnrc_netapi_dispatch() and
+ *          pass them on in a single @ref GNRC_NETAPI_MSG_TYPE_RCV_BATCH
+ *          message, so that a burst of received packets wakes up the next
+ *          module once instead of once per packet.
+ *
+ * A thread collects packets after calling gnrc_netapi_batch_init() and calls
+ * gnrc_netapi_batch_poll() after every message it handled. Packets are only
+ * collected while further messages wait in the thread's message queue: the
+ * batch is passed on once the queue is empty,
+ * @ref CONFIG_GNRC_NETAPI_BATCH_SIZE packets were collected, the packets are
+ * dispatched to another target or @ref CONFIG_GNRC_NETAPI_BATCH_LATENCY_US
+ * after the first packet was collected.
+ *
+ * Packets are only collected for targets that are all registered with
+ * @ref GNRC_NETREG_ENTRY_INIT_BATCH, all other targets still get one message
+ * per packet right away. Packets sent down the stack are not collected: every
+ * module there has a higher priority than the one before it and handles each
+ * message right away, so there is never a further message to wait for.
+ *
+ * To use, add the module `gnrc_netapi_batch` to the `USEMODULE` macro in
+ * your application's Makefile:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ {.mk}
+ * USEMODULE += gnrc_netapi_batch
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @}
  */
 
 #ifndef NET_GNRC_NETAPI_H
@@ -93,6 +125,56 @@ extern "C" {
  */
 #define GNRC_NETAPI_MSG_TYPE_ACK        (0x0205)
 
+#if defined(MODULE_GNRC_NETAPI_BATCH) || defined(DOXYGEN)
+/**
+ * @brief   @ref core_msg type for passing several @ref net_gnrc_pkt up the
+ *          network stack
+ *
+ * The content is a batch, see gnrc_netapi_batch_numof() and
+ * gnrc_netapi_batch_get().
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ */
+#define GNRC_NETAPI_MSG_TYPE_RCV_BATCH  (0x0207)
+
+/**
+ * @defgroup    net_gnrc_netapi_batch_conf  Batching compile configuration
+ * @ingroup     net_gnrc_netapi_batch
+ * @{
+ */
+/**
+ * @brief   Maximum number of packets passed on in one message
+ */
+#ifndef CONFIG_GNRC_NETAPI_BATCH_SIZE
+#define CONFIG_GNRC_NETAPI_BATCH_SIZE       (8U)
+#endif
+
+/**
+ * @brief   Time in microseconds a collected packet waits at most before it is
+ *          passed on
+ */
+#ifndef CONFIG_GNRC_NETAPI_BATCH_LATENCY_US
+#define CONFIG_GNRC_NETAPI_BATCH_LATENCY_US (1000U)
+#endif
+/** @} */
+
+/**
+ * @brief   Packets collected by a thread
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ */
+typedef struct {
+    uint32_t since;             /**< time the first packet was collected */
+    uint32_t demux_ctx;         /**< demultiplexing context of the packets */
+    gnrc_nettype_t type;        /**< protocol type of the packets */
+    uint8_t numof;              /**< number of collected packets */
+    /**
+     * @brief   The collected packets
+     */
+    gnrc_pktsnip_t *pkts[CONFIG_GNRC_NETAPI_BATCH_SIZE];
+} gnrc_netapi_batch_t;
+#endif
+
 /**
  * @brief   Data structure to be send for setting (@ref GNRC_NETAPI_MSG_TYPE_SET)
  *          and getting (@ref GNRC_NETAPI_MSG_TYPE_GET) options
@@ -164,6 +246,9 @@ static inline int gnrc_netapi_send(kernel_pid_t pid, gnrc_pktsnip_t *pkt)
  * @param[in] cmd       command for all subscribers
  * @param[in] pkt       pointer into the packet buffer holding the data to send
  *
+ * @note    With @ref net_gnrc_netapi_batch, @p pkt is collected if the calling
+ *          thread called gnrc_netapi_batch_init() before.
+ *
  * @return Number of subscribers to (@p type, @p demux_ctx).
  */
 int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx, uint16_t cmd,
@@ -215,6 +300,74 @@ static inline int gnrc_netapi_dispatch_receive(gnrc_nettype_t type, uint32_t dem
     return gnrc_netapi_dispatch(type, demux_ctx, GNRC_NETAPI_MSG_TYPE_RCV, pkt);
 }
 
+#if defined(MODULE_GNRC_NETAPI_BATCH) || defined(DOXYGEN)
+/**
+ * @brief   Collects the packets the calling thread dispatches from now on
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ *
+ * @param[in] batch     storage for the collected packets, must stay valid as
+ *                      long as the thread collects packets. NULL to stop
+ *                      collecting, pass the collected packets on with
+ *                      gnrc_netapi_batch_flush() before.
+ */
+void gnrc_netapi_batch_init(gnrc_netapi_batch_t *batch);
+
+/**
+ * @brief   Passes on the packets collected by the calling thread
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ */
+void gnrc_netapi_batch_flush(void);
+
+/**
+ * @brief   Passes on the packets collected by the calling thread unless
+ *          further messages are queued for it
+ *
+ * To be called after every message the thread handled, so that no packet
+ * waits while the thread is blocked.
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ */
+void gnrc_netapi_batch_poll(void);
+
+/**
+ * @brief   Number of packets in a received batch
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ *
+ * @param[in] batch     content of a @ref GNRC_NETAPI_MSG_TYPE_RCV_BATCH
+ *                      message
+ *
+ * @return  number of packets in @p batch
+ */
+static inline unsigned gnrc_netapi_batch_numof(const gnrc_pktsnip_t *batch)
+{
+    return batch->size / sizeof(gnrc_pktsnip_t *);
+}
+
+/**
+ * @brief   Gets a packet of a received batch
+ *
+ * The receiver owns the packets of the batch and releases @p batch itself
+ * with gnrc_pktbuf_release() when done, that doesn't release the packets.
+ *
+ * @note    Only available with @ref net_gnrc_netapi_batch.
+ *
+ * @param[in] batch     content of a @ref GNRC_NETAPI_MSG_TYPE_RCV_BATCH
+ *                      message
+ * @param[in] idx       index of the packet, less than
+ *                      gnrc_netapi_batch_numof()
+ *
+ * @return  the packet
+ */
+static inline gnrc_pktsnip_t *gnrc_netapi_batch_get(const gnrc_pktsnip_t *batch,
+                                                    unsigned idx)
+{
+    return ((gnrc_pktsnip_t **)batch->data)[idx];
+}
+#endif
+
 /**
  * @brief   Shortcut function for sending @ref GNRC_NETAPI_MSG_TYPE_GET messages and
  *          parsing the returned @ref GNRC_NETAPI_MSG_TYPE_ACK message
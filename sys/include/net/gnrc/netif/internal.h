@@ -63,6 +63,36 @@ void gnrc_netif_acquire(gnrc_netif_t *netif);
  */
 void gnrc_netif_release(gnrc_netif_t *netif);
 
+#if (IS_USED(MODULE_NETDEV_RECV_LOAN) && IS_USED(MODULE_GNRC_PKTBUF_STATIC_LOAN)) || \
+    DOXYGEN
+/**
+ * @brief   Receives a frame in a buffer lent by the device of the interface
+ *
+ * The frame is wrapped in a packet snip without copying it, the buffer is
+ * given back to the device once the snip and all snips marked in it are
+ * released.
+ *
+ * @note    Only available with the `netdev_recv_loan` module and the
+ *          `gnrc_pktbuf_static_loan` module, which `netdev_recv_loan` pulls in
+ *          unless `gnrc_pktbuf_malloc` is used.
+ *
+ * @param[in] netif the network interface
+ * @param[out] pkt  snip of the received frame
+ * @param[out] info status information for the received frame, as with
+ *                  netdev_driver_t::recv(). May be NULL.
+ *
+ * @return  length of the frame in @p pkt
+ * @return  0, if no frame was received
+ * @return  `-ENOTSUP`, if the device can't lend a buffer, the frame is to be
+ *          received with netdev_driver_t::recv()
+ * @return  other negative errno on error, the frame was dropped
+ *
+ * @internal
+ */
+int gnrc_netif_recv_loan(gnrc_netif_t *netif, gnrc_pktsnip_t **pkt,
+                         void *info);
+#endif
+
 #if IS_USED(MODULE_GNRC_NETIF_IPV6) || DOXYGEN
 /**
  * @brief   Adds an IPv6 address to the interface
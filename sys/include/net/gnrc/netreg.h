@@ -36,7 +36,7 @@ extern "C" {
 #endif
 
 #if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS) || \
-    defined(DOXYGEN)
+    defined(MODULE_GNRC_NETAPI_BATCH) || defined(DOXYGEN)
 /**
  *  @brief  The type of the netreg entry.
  *
@@ -69,9 +69,34 @@ typedef enum {
      */
     GNRC_NETREG_TYPE_CB,
 #endif
+#if defined(MODULE_GNRC_NETAPI_BATCH) || defined(DOXYGEN)
+    /**
+     * @brief   Use [default IPC](@ref core_msg) for
+     *          [netapi](@ref net_gnrc_netapi) operations, several packets may
+     *          be passed in one message.
+     *
+     * @note    Only available with `gnrc_netapi_batch` module.
+     */
+    GNRC_NETREG_TYPE_BATCH,
+#endif
 } gnrc_netreg_type_t;
 #endif
 
+/**
+ * @brief   Number of buckets per @ref net_gnrc_nettype "type" of the hashed
+ *          registry
+ *
+ * With the `gnrc_netreg_hash` module the entries of a type are distributed
+ * over this many lists by their demux context, so a lookup only walks the
+ * entries that share a bucket with the requested context. Costs
+ * `sizeof(void *)` bytes per bucket and type.
+ *
+ * @note    Must be a power of 2.
+ */
+#ifndef CONFIG_GNRC_NETREG_HASH_BUCKETS
+#define CONFIG_GNRC_NETREG_HASH_BUCKETS     (8U)
+#endif
+
 /**
  * @brief   Demux context value to get all packets of a certain type.
  *
@@ -93,7 +118,8 @@ typedef enum {
  *
  * @return  An initialized netreg entry
  */
-#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS)
+#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS) || \
+    defined(MODULE_GNRC_NETAPI_BATCH)
 #define GNRC_NETREG_ENTRY_INIT_PID(demux_ctx, pid)  { NULL, demux_ctx, \
                                                       GNRC_NETREG_TYPE_DEFAULT, \
                                                       { pid } }
@@ -101,6 +127,28 @@ typedef enum {
 #define GNRC_NETREG_ENTRY_INIT_PID(demux_ctx, pid)  { NULL, demux_ctx, { pid } }
 #endif
 
+/**
+ * @brief   Initializes a netreg entry statically with PID of a thread that
+ *          handles @ref GNRC_NETAPI_MSG_TYPE_RCV_BATCH messages
+ *
+ * @param[in] demux_ctx The @ref gnrc_netreg_entry_t::demux_ctx "demux context"
+ *                      for the netreg entry
+ * @param[in] pid       The PID of the registering thread
+ *
+ * @note    Same as @ref GNRC_NETREG_ENTRY_INIT_PID without
+ *          @ref net_gnrc_netapi_batch.
+ *
+ * @return  An initialized netreg entry
+ */
+#if defined(MODULE_GNRC_NETAPI_BATCH) || defined(DOXYGEN)
+#define GNRC_NETREG_ENTRY_INIT_BATCH(demux_ctx, pid) { NULL, demux_ctx, \
+                                                       GNRC_NETREG_TYPE_BATCH, \
+                                                       { pid } }
+#else
+#define GNRC_NETREG_ENTRY_INIT_BATCH(demux_ctx, pid) \
+    GNRC_NETREG_ENTRY_INIT_PID(demux_ctx, pid)
+#endif
+
 #if defined(MODULE_GNRC_NETAPI_MBOX) || defined(DOXYGEN)
 /**
  * @brief   Initializes a netreg entry statically with mbox
@@ -181,12 +229,12 @@ typedef struct gnrc_netreg_entry {
      */
     uint32_t demux_ctx;
 #if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS) || \
-    defined(DOXYGEN)
+    defined(MODULE_GNRC_NETAPI_BATCH) || defined(DOXYGEN)
     /**
      * @brief   Type of the registry entry
      *
-     * @note    Only available with @ref net_gnrc_netapi_mbox or
-     *          @ref net_gnrc_netapi_callbacks.
+     * @note    Only available with @ref net_gnrc_netapi_mbox,
+     *          @ref net_gnrc_netapi_callbacks or @ref net_gnrc_netapi_batch.
      */
     gnrc_netreg_type_t type;
 #endif
@@ -237,7 +285,8 @@ static inline void gnrc_netreg_entry_init_pid(gnrc_netreg_entry_t *entry,
 {
     entry->next = NULL;
     entry->demux_ctx = demux_ctx;
-#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS)
+#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS) || \
+    defined(MODULE_GNRC_NETAPI_BATCH)
     entry->type = GNRC_NETREG_TYPE_DEFAULT;
 #endif
     entry->target.pid = pid;
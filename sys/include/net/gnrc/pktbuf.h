@@ -62,6 +62,53 @@ extern "C" {
 #ifndef CONFIG_GNRC_PKTBUF_SIZE
 #define CONFIG_GNRC_PKTBUF_SIZE    (6144)
 #endif
+
+/**
+ * @brief   Number of packet snip slots with `gnrc_pktbuf_static_classes`
+ *
+ * @details With the `gnrc_pktbuf_static_classes` module, the static packet
+ *          buffer is split into size classes of fixed-size slots for packet
+ *          snips, small headers and MTU-sized payloads. An allocation is
+ *          served from the smallest class it fits, or from the first-fit
+ *          arena taking the rest of @ref CONFIG_GNRC_PKTBUF_SIZE when it
+ *          fits no class or its class is full.
+ *
+ *          The number of slots of every class scales with
+ *          @ref CONFIG_GNRC_PKTBUF_SIZE, by default the classes take about a
+ *          sixth of it: one snip slot per 256 bytes, one header slot per
+ *          KiB and one MTU-sized slot per 8 KiB.
+ */
+#ifndef CONFIG_GNRC_PKTBUF_STATIC_SNIP_NUMOF
+#define CONFIG_GNRC_PKTBUF_STATIC_SNIP_NUMOF    (CONFIG_GNRC_PKTBUF_SIZE / 256)
+#endif
+
+/**
+ * @brief   Size of a small header slot with `gnrc_pktbuf_static_classes`
+ */
+#ifndef CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE
+#define CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE      (64U)
+#endif
+
+/**
+ * @brief   Number of small header slots with `gnrc_pktbuf_static_classes`
+ */
+#ifndef CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF
+#define CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF     (CONFIG_GNRC_PKTBUF_SIZE / 1024)
+#endif
+
+/**
+ * @brief   Size of an MTU-sized payload slot with `gnrc_pktbuf_static_classes`
+ */
+#ifndef CONFIG_GNRC_PKTBUF_STATIC_MTU_SIZE
+#define CONFIG_GNRC_PKTBUF_STATIC_MTU_SIZE      (1280U)
+#endif
+
+/**
+ * @brief   Number of MTU-sized payload slots with `gnrc_pktbuf_static_classes`
+ */
+#ifndef CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF
+#define CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF     (CONFIG_GNRC_PKTBUF_SIZE / 8192)
+#endif
 /** @} */
 
 /**
@@ -93,6 +140,47 @@ void gnrc_pktbuf_init(void);
 gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, const void *data, size_t size,
                                 gnrc_nettype_t type);
 
+#if defined(MODULE_GNRC_PKTBUF_STATIC_LOAN) || defined(DOXYGEN)
+/**
+ * @brief   Callback returning lent data to its owner
+ *
+ * @param[in] arg   the argument given to @ref gnrc_pktbuf_add_loan()
+ * @param[in] data  the data given to @ref gnrc_pktbuf_add_loan()
+ */
+typedef void (*gnrc_pktbuf_release_cb_t)(void *arg, void *data);
+
+/**
+ * @brief   Adds a new gnrc_pktsnip_t with data lent by its owner to the
+ *          packet buffer
+ *
+ * Unlike @ref gnrc_pktbuf_add() the data isn't copied into the packet buffer,
+ * e.g. a network device lends its receive buffer. Snips marked in or split off
+ * the data keep pointing into it, @p release is called once all of it has
+ * been released.
+ *
+ * @note    Only available with the `gnrc_pktbuf_static_loan` module.
+ *
+ * @warning @p release is called with the packet buffer locked, it must not
+ *          call any function of the packet buffer.
+ *
+ * @param[in] next      Next gnrc_pktsnip_t in the packet. Leave NULL if you
+ *                      want to create a new packet.
+ * @param[in] data      Lent data, must stay valid until @p release is called.
+ * @param[in] size      Length of @p data. May not be 0.
+ * @param[in] type      Protocol type of the gnrc_pktsnip_t.
+ * @param[in] release   Called with @p arg when the data is no longer used.
+ * @param[in] arg       Argument for @p release.
+ *
+ * @return  The new gnrc_pktsnip_t.
+ * @return  NULL, if no space is left in the packet buffer. The data stays
+ *          with its owner then, @p release is not called.
+ */
+gnrc_pktsnip_t *gnrc_pktbuf_add_loan(gnrc_pktsnip_t *next, void *data,
+                                     size_t size, gnrc_nettype_t type,
+                                     gnrc_pktbuf_release_cb_t release,
+                                     void *arg);
+#endif
+
 /**
  * @brief   Marks the first @p size bytes in a received packet with a new
  *          packet snip that is appended to the packet.
@@ -301,7 +389,11 @@ int gnrc_pktbuf_merge(gnrc_pktsnip_t *pkt);
  *
  * @note    Only available with DEVELHELP defined.
  *
- * @details Statistics include maximum number of reserved bytes.
+ * @details Statistics include maximum number of reserved bytes, the
+ *          fragmentation of the packet buffer and the number of failed
+ *          allocations. With `gnrc_pktbuf_static_classes` the use of every
+ *          size class is included, with `gnrc_pktbuf_static_latency` the
+ *          average and maximum time an allocation took.
  */
 void gnrc_pktbuf_stats(void);
 #endif
@@ -118,6 +118,36 @@ typedef int (*netdev_test_send_cb_t)(netdev_t *dev, const iolist_t *iolist);
 typedef int (*netdev_test_recv_cb_t)(netdev_t *dev, char *buf, int len,
                                      void *info);
 
+#if defined(MODULE_NETDEV_RECV_LOAN) || defined(DOXYGEN)
+/**
+ * @brief   Callback type to handle receive-into-lent-buffer command
+ *
+ * @note    Only available with the `netdev_recv_loan` module.
+ *
+ * @param[in] dev       network device descriptor
+ * @param[out] buf      the lent buffer the frame starts at
+ * @param[out] info     status information for the received packet. Might
+ *                      be of different type for different netdev devices.
+ *                      May be NULL if not needed or applicable
+ *
+ * @return  -ENOBUFS if no buffer can be lent
+ * @return  <0 on other errors
+ * @return  length of the frame in @p buf
+ */
+typedef int (*netdev_test_recv_loan_cb_t)(netdev_t *dev, void **buf,
+                                          void *info);
+
+/**
+ * @brief   Callback type to handle the release of a lent buffer
+ *
+ * @note    Only available with the `netdev_recv_loan` module.
+ *
+ * @param[in] dev       network device descriptor
+ * @param[in] buf       the buffer lent by a @ref netdev_test_recv_loan_cb_t
+ */
+typedef void (*netdev_test_recv_release_cb_t)(netdev_t *dev, void *buf);
+#endif
+
 /**
  * @brief   Callback type to handle device initialization
  *
@@ -184,6 +214,10 @@ typedef struct {
      */
     netdev_test_send_cb_t send_cb;                  /**< callback to handle send command */
     netdev_test_recv_cb_t recv_cb;                  /**< callback to handle receive command */
+#if defined(MODULE_NETDEV_RECV_LOAN) || defined(DOXYGEN)
+    netdev_test_recv_loan_cb_t recv_loan_cb;        /**< callback to handle receive into lent buffer command */
+    netdev_test_recv_release_cb_t recv_release_cb;  /**< callback to handle release of lent buffer */
+#endif
     netdev_test_init_cb_t init_cb;                  /**< callback to handle initialization events */
     netdev_test_isr_cb_t isr_cb;                    /**< callback to handle ISR events */
     netdev_test_get_cb_t get_cbs[NETOPT_NUMOF];     /**< callback to handle get command */
@@ -221,6 +255,30 @@ static inline void netdev_test_set_recv_cb(netdev_test_t *dev,
     mutex_unlock(&dev->mutex);
 }
 
+#if defined(MODULE_NETDEV_RECV_LOAN) || defined(DOXYGEN)
+/**
+ * @brief   override receive into lent buffer callbacks
+ *
+ * Without a @p recv_loan_cb the device has no buffer to lend and frames are
+ * received with the receive callback.
+ *
+ * @note    Only available with the `netdev_recv_loan` module.
+ *
+ * @param[in] dev               a @ref sys_netdev_test device
+ * @param[in] recv_loan_cb      a receive into lent buffer callback
+ * @param[in] recv_release_cb   a lent buffer release callback
+ */
+static inline void netdev_test_set_recv_loan_cb(netdev_test_t *dev,
+                                                netdev_test_recv_loan_cb_t recv_loan_cb,
+                                                netdev_test_recv_release_cb_t recv_release_cb)
+{
+    mutex_lock(&dev->mutex);
+    dev->recv_loan_cb = recv_loan_cb;
+    dev->recv_release_cb = recv_release_cb;
+    mutex_unlock(&dev->mutex);
+}
+#endif
+
 /**
  * @brief   override initialization callback
  *
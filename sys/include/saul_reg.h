@@ -55,6 +55,14 @@ typedef struct {
  */
 extern saul_reg_t *saul_reg;
 
+/**
+ * @brief   Number of changes to the registry
+ *
+ * Incremented whenever a device is added or removed. Users keeping pointers
+ * to registry entries compare it to detect stale entries.
+ */
+extern unsigned saul_reg_generation;
+
 /**
  * @brief   Register a device with the SAUL registry
  *
@@ -244,6 +244,12 @@ typedef struct ztimer_clock ztimer_clock_t;
 struct ztimer_base {
     ztimer_base_t *next;        /**< next timer in list */
     uint32_t offset;            /**< offset from last timer in list */
+#if MODULE_ZTIMER_HEAP || DOXYGEN
+    ztimer_base_t *child;       /**< left child, see @ref ztimer_heap_init */
+    ztimer_base_t *prev;        /**< parent in the heap */
+    uint8_t heap_state;         /**< see @ref ZTIMER_HEAP_UNSET */
+    uint8_t heap_rank;          /**< length of the right spine in the heap */
+#endif
 };
 
 #if MODULE_ZTIMER_NOW64
@@ -307,6 +313,10 @@ struct ztimer_clock {
 #if MODULE_PM_LAYERED || DOXYGEN
     uint8_t required_pm_mode;       /**< min. pm mode required for the clock to run */
 #endif
+#if MODULE_ZTIMER_HEAP || DOXYGEN
+    ztimer_base_t *heap;            /**< heap of pending timers             */
+    uint8_t use_heap;               /**< set by @ref ztimer_heap_init       */
+#endif
 };
 
 /**
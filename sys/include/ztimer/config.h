@@ -117,6 +117,20 @@ extern "C" {
 #define CONFIG_ZTIMER_MSEC_REQUIRED_PM_MODE ZTIMER_CLOCK_NO_REQUIRED_PM_MODE
 #endif
 
+/**
+ * @brief   Keep the timers of ZTIMER_USEC in a heap, see @ref sys_ztimer_heap
+ */
+#ifndef CONFIG_ZTIMER_USEC_HEAP
+#define CONFIG_ZTIMER_USEC_HEAP             (1)
+#endif
+
+/**
+ * @brief   Keep the timers of ZTIMER_MSEC in a heap, see @ref sys_ztimer_heap
+ */
+#ifndef CONFIG_ZTIMER_MSEC_HEAP
+#define CONFIG_ZTIMER_MSEC_HEAP             (1)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_ztimer_heap ztimer leftist heap backend
+ * @ingroup     sys_ztimer
+ * @brief       Keeps the timers of a clock in a leftist heap
+ *
+ * By default a clock keeps its timers in a delta encoded list, which makes
+ * @ref ztimer_set and @ref ztimer_remove walk all timers set to expire
+ * earlier, with interrupts disabled. On a clock initialized with
+ * @ref ztimer_heap_init, timers are kept in a leftist heap instead. With n
+ * timers set, setting a timer, removing one and expiring the first one each
+ * visit at most 2 * log2(n + 1) timers in the worst case, e.g. 16 timers for
+ * 255 timers set. This bounds the time these operations run with interrupts
+ * disabled. Expiring k timers at once costs k times that.
+ *
+ * Each timer grows by two pointers and two bytes when this module is used,
+ * also on clocks that keep using the list. The list is faster for a handful
+ * of timers, the heap pays off with dozens of timers armed at once.
+ *
+ * Unlike with the list, timers set to the same target are not guaranteed to
+ * expire in the order they were set.
+ *
+ * With `ztimer_auto_init`, the heap is used by ZTIMER_USEC and ZTIMER_MSEC
+ * unless @ref CONFIG_ZTIMER_USEC_HEAP or @ref CONFIG_ZTIMER_MSEC_HEAP is set
+ * to 0.
+ *
+ * @{
+ *
+ * @file
+ * @brief       ztimer leftist heap backend
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef ZTIMER_HEAP_H
+#define ZTIMER_HEAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ztimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    States of a timer on a heap clock, see @ref ztimer_base_t::heap_state
+ * @{
+ */
+#define ZTIMER_HEAP_UNSET   (0U)    /**< timer is not set */
+#define ZTIMER_HEAP_QUEUED  (1U)    /**< timer is in the heap */
+#define ZTIMER_HEAP_DUE     (2U)    /**< timer expired, in the clock's list */
+/** @} */
+
+/**
+ * @brief   Keep the timers of @p clock in a leftist heap
+ *
+ * Must be called before any timer is set on the clock.
+ *
+ * @param[in]   clock   clock to initialize
+ */
+void ztimer_heap_init(ztimer_clock_t *clock);
+
+/**
+ * @brief   Add a timer to the heap of a clock
+ *
+ * @internal Called by ztimer core with interrupts disabled
+ *
+ * @param[in]   clock   clock to add the timer to
+ * @param[in]   entry   timer to add, its offset is relative to the
+ *                      clock's base
+ */
+void ztimer_heap_add(ztimer_clock_t *clock, ztimer_base_t *entry);
+
+/**
+ * @brief   Remove a timer that hasn't expired yet from the heap
+ *
+ * @internal Called by ztimer core with interrupts disabled
+ *
+ * @param[in]   clock   clock to remove the timer from
+ * @param[in]   entry   timer to remove
+ */
+void ztimer_heap_remove(ztimer_clock_t *clock, ztimer_base_t *entry);
+
+/**
+ * @brief   Advance the base of the clock
+ *
+ * Timers expiring within @p diff ticks are moved to the clock's list with an
+ * offset of 0, in the order they expire.
+ *
+ * @internal Called by ztimer core with interrupts disabled
+ *
+ * @param[in]   clock   clock to advance
+ * @param[in]   diff    ticks passed since the last advance
+ */
+void ztimer_heap_advance(ztimer_clock_t *clock, uint32_t diff);
+
+/**
+ * @brief   Check whether a timer on a heap clock has expired
+ *
+ * @param[in]   entry   timer that is set
+ *
+ * @returns     true when the timer is in the list of expired timers
+ */
+static inline bool ztimer_heap_is_due(const ztimer_base_t *entry)
+{
+    return entry->heap_state == ZTIMER_HEAP_DUE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZTIMER_HEAP_H */
+/** @} */
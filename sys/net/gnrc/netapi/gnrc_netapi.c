@@ -19,12 +19,17 @@
  */
 
 #include <errno.h>
+#include <string.h>
 
+#include "irq.h"
 #include "mbox.h"
 #include "msg.h"
 #include "net/gnrc/netreg.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/netapi.h"
+#ifdef MODULE_GNRC_NETAPI_BATCH
+#include "xtimer.h"
+#endif
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -81,54 +86,218 @@ static inline int _snd_rcv_mbox(mbox_t *mbox, uint16_t type, gnrc_pktsnip_t *pkt
 }
 #endif
 
+static void _dispatch_entry(gnrc_netreg_entry_t *sendto, uint16_t cmd,
+                            gnrc_pktsnip_t *pkt)
+{
+#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS) || \
+    defined(MODULE_GNRC_NETAPI_BATCH)
+    uint32_t status = 0;
+    switch (sendto->type) {
+#ifdef MODULE_GNRC_NETAPI_BATCH
+        case GNRC_NETREG_TYPE_BATCH:
+            /* a single packet is passed as without batching */
+#endif
+        case GNRC_NETREG_TYPE_DEFAULT:
+            if (_gnrc_netapi_send_recv(sendto->target.pid, pkt, cmd) < 1) {
+                /* unable to dispatch packet */
+                status = EIO;
+            }
+            break;
+#ifdef MODULE_GNRC_NETAPI_MBOX
+        case GNRC_NETREG_TYPE_MBOX:
+            if (_snd_rcv_mbox(sendto->target.mbox, cmd, pkt) < 1) {
+                /* unable to dispatch packet */
+                status = EIO;
+            }
+            break;
+#endif
+#ifdef MODULE_GNRC_NETAPI_CALLBACKS
+        case GNRC_NETREG_TYPE_CB:
+            sendto->target.cbd->cb(cmd, pkt, sendto->target.cbd->ctx);
+            break;
+#endif
+        default:
+            /* unknown dispatch type */
+            status = ECANCELED;
+            break;
+    }
+    if (status != 0) {
+        gnrc_pktbuf_release_error(pkt, status);
+    }
+#else
+    if (_gnrc_netapi_send_recv(sendto->target.pid, pkt, cmd) < 1) {
+        /* unable to dispatch packet */
+        gnrc_pktbuf_release_error(pkt, EIO);
+    }
+#endif
+}
+
+#ifdef MODULE_GNRC_NETAPI_BATCH
+/* Packets collected by a thread, NULL if the thread doesn't collect */
+static gnrc_netapi_batch_t *_batches[KERNEL_PID_LAST + 1];
+
+void gnrc_netapi_batch_init(gnrc_netapi_batch_t *batch)
+{
+    if (batch != NULL) {
+        memset(batch, 0, sizeof(*batch));
+    }
+    _batches[thread_getpid()] = batch;
+}
+
+static void _batch_send(gnrc_netreg_entry_t *sendto,
+                        const gnrc_netapi_batch_t *batch,
+                        gnrc_pktsnip_t *pkts)
+{
+    msg_t msg;
+
+    msg.type = GNRC_NETAPI_MSG_TYPE_RCV_BATCH;
+    msg.content.ptr = pkts;
+    if (msg_try_send(&msg, sendto->target.pid) < 1) {
+        DEBUG("gnrc_netapi: dropped batch to %" PRIkernel_pid "\n",
+              sendto->target.pid);
+        for (unsigned i = 0; i < batch->numof; i++) {
+            gnrc_pktbuf_release_error(batch->pkts[i], EIO);
+        }
+        gnrc_pktbuf_release(pkts);
+    }
+}
+
+static void _batch_flush(gnrc_netapi_batch_t *batch)
+{
+    int numof = gnrc_netreg_num(batch->type, batch->demux_ctx);
+    gnrc_pktsnip_t *pkts = NULL;
+    unsigned batch_numof = 0;
+
+    if (numof == 0) {
+        /* the receivers unregistered while the packets were collected */
+        for (unsigned i = 0; i < batch->numof; i++) {
+            gnrc_pktbuf_release_error(batch->pkts[i], ENOENT);
+        }
+        batch->numof = 0;
+        return;
+    }
+    for (gnrc_netreg_entry_t *e = gnrc_netreg_lookup(batch->type,
+                                                     batch->demux_ctx);
+         e != NULL; e = gnrc_netreg_getnext(e)) {
+        batch_numof += (e->type == GNRC_NETREG_TYPE_BATCH);
+    }
+    if ((batch->numof > 1) && (batch_numof > 0)) {
+        /* if this fails, the packets are passed one by one */
+        pkts = gnrc_pktbuf_add(NULL, batch->pkts,
+                               batch->numof * sizeof(batch->pkts[0]),
+                               GNRC_NETTYPE_UNDEF);
+        if (pkts != NULL) {
+            gnrc_pktbuf_hold(pkts, batch_numof - 1);
+        }
+    }
+    for (unsigned i = 0; i < batch->numof; i++) {
+        gnrc_pktbuf_hold(batch->pkts[i], numof - 1);
+    }
+    for (gnrc_netreg_entry_t *e = gnrc_netreg_lookup(batch->type,
+                                                     batch->demux_ctx);
+         e != NULL; e = gnrc_netreg_getnext(e)) {
+        if ((pkts != NULL) && (e->type == GNRC_NETREG_TYPE_BATCH)) {
+            _batch_send(e, batch, pkts);
+            continue;
+        }
+        for (unsigned i = 0; i < batch->numof; i++) {
+            _dispatch_entry(e, GNRC_NETAPI_MSG_TYPE_RCV, batch->pkts[i]);
+        }
+    }
+    batch->numof = 0;
+}
+
+void gnrc_netapi_batch_flush(void)
+{
+    kernel_pid_t pid = thread_getpid();
+    gnrc_netapi_batch_t *batch = _batches[pid];
+
+    if ((batch == NULL) || (batch->numof == 0)) {
+        return;
+    }
+    /* callbacks dispatching further packets must not collect them into the
+     * batch being passed on */
+    _batches[pid] = NULL;
+    _batch_flush(batch);
+    _batches[pid] = batch;
+}
+
+void gnrc_netapi_batch_poll(void)
+{
+    gnrc_netapi_batch_t *batch = _batches[thread_getpid()];
+
+    if ((batch == NULL) || (batch->numof == 0)) {
+        return;
+    }
+    /* no further message to collect packets from, don't hold them back */
+    if ((msg_avail() == 0) ||
+        ((xtimer_now_usec() - batch->since) >=
+         CONFIG_GNRC_NETAPI_BATCH_LATENCY_US)) {
+        gnrc_netapi_batch_flush();
+    }
+}
+
+/* Collects pkt if the calling thread collects packets */
+static bool _collect(gnrc_nettype_t type, uint32_t demux_ctx, uint16_t cmd,
+                     gnrc_pktsnip_t *pkt)
+{
+    if (irq_is_in()) {
+        return false;
+    }
+
+    gnrc_netapi_batch_t *batch = _batches[thread_getpid()];
+
+    /* modules on the send path preempt the one sending to them, so no
+     * packet would ever wait for a further one there */
+    if ((batch == NULL) || (cmd != GNRC_NETAPI_MSG_TYPE_RCV)) {
+        return false;
+    }
+    for (gnrc_netreg_entry_t *e = gnrc_netreg_lookup(type, demux_ctx);
+         e != NULL; e = gnrc_netreg_getnext(e)) {
+        if (e->type != GNRC_NETREG_TYPE_BATCH) {
+            /* mailboxes, callbacks and plain threads take one packet at a
+             * time, collecting would only delay them. The packets collected
+             * so far go first to keep the order of the packets */
+            gnrc_netapi_batch_flush();
+            return false;
+        }
+    }
+    if ((batch->numof > 0) &&
+        ((batch->type != type) || (batch->demux_ctx != demux_ctx))) {
+        gnrc_netapi_batch_flush();
+    }
+    if (batch->numof == 0) {
+        batch->type = type;
+        batch->demux_ctx = demux_ctx;
+        batch->since = xtimer_now_usec();
+    }
+    batch->pkts[batch->numof++] = pkt;
+    if ((batch->numof == CONFIG_GNRC_NETAPI_BATCH_SIZE) ||
+        ((xtimer_now_usec() - batch->since) >=
+         CONFIG_GNRC_NETAPI_BATCH_LATENCY_US)) {
+        gnrc_netapi_batch_flush();
+    }
+    return true;
+}
+#endif
+
 int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx,
                          uint16_t cmd, gnrc_pktsnip_t *pkt)
 {
     int numof = gnrc_netreg_num(type, demux_ctx);
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    if ((numof != 0) && _collect(type, demux_ctx, cmd, pkt)) {
+        return numof;
+    }
+#endif
     if (numof != 0) {
         gnrc_netreg_entry_t *sendto = gnrc_netreg_lookup(type, demux_ctx);
 
         gnrc_pktbuf_hold(pkt, numof - 1);
 
         while (sendto) {
-#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS)
-            uint32_t status = 0;
-            switch (sendto->type) {
-                case GNRC_NETREG_TYPE_DEFAULT:
-                    if (_gnrc_netapi_send_recv(sendto->target.pid, pkt,
-                                               cmd) < 1) {
-                        /* unable to dispatch packet */
-                        status = EIO;
-                    }
-                    break;
-#ifdef MODULE_GNRC_NETAPI_MBOX
-                case GNRC_NETREG_TYPE_MBOX:
-                    if (_snd_rcv_mbox(sendto->target.mbox, cmd, pkt) < 1) {
-                        /* unable to dispatch packet */
-                        status = EIO;
-                    }
-                    break;
-#endif
-#ifdef MODULE_GNRC_NETAPI_CALLBACKS
-                case GNRC_NETREG_TYPE_CB:
-                    sendto->target.cbd->cb(cmd, pkt, sendto->target.cbd->ctx);
-                    break;
-#endif
-                default:
-                    /* unknown dispatch type */
-                    status = ECANCELED;
-                    break;
-            }
-            if (status != 0) {
-                gnrc_pktbuf_release_error(pkt, status);
-            }
-#else
-            if (_gnrc_netapi_send_recv(sendto->target.pid, pkt, cmd) < 1) {
-                /* unable to dispatch packet */
-                gnrc_pktbuf_release_error(pkt, EIO);
-            }
-#endif
+            _dispatch_entry(sendto, cmd, pkt);
             sendto = gnrc_netreg_getnext(sendto);
         }
     }
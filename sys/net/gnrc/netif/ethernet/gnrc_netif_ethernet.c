@@ -15,11 +15,13 @@
  * @author  Kaspar Schleiser <kaspar@schleiser.de>
  */
 
+#include <errno.h>
 #include <string.h>
 
 #include "net/ethernet/hdr.h"
 #include "net/gnrc.h"
 #include "net/gnrc/netif/ethernet.h"
+#include "net/gnrc/netif/internal.h"
 #ifdef MODULE_GNRC_IPV6
 #include "net/ipv6/hdr.h"
 #endif
@@ -165,44 +167,61 @@ static int _send(gnrc_netif_t *netif, gnrc_pktsnip_t *pkt)
     return res;
 }
 
-static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
+/* Receives a frame into pkt, lent by the device if it supports it */
+static int _recv_frame(gnrc_netif_t *netif, gnrc_pktsnip_t **pkt)
 {
     netdev_t *dev = netif->dev;
+    int nread;
+
+#if IS_USED(MODULE_NETDEV_RECV_LOAN) && IS_USED(MODULE_GNRC_PKTBUF_STATIC_LOAN)
+    nread = gnrc_netif_recv_loan(netif, pkt, NULL);
+    if (nread != -ENOTSUP) {
+        return nread;
+    }
+#endif
     int bytes_expected = dev->driver->recv(dev, NULL, 0, NULL);
-    gnrc_pktsnip_t *pkt = NULL;
 
-    if (bytes_expected > 0) {
-        pkt = gnrc_pktbuf_add(NULL, NULL,
-                              bytes_expected,
-                              GNRC_NETTYPE_UNDEF);
+    if (bytes_expected <= 0) {
+        return bytes_expected;
+    }
+    *pkt = gnrc_pktbuf_add(NULL, NULL, bytes_expected, GNRC_NETTYPE_UNDEF);
+    if (!*pkt) {
+        DEBUG("gnrc_netif_ethernet: cannot allocate pktsnip.\n");
 
-        if (!pkt) {
-            DEBUG("gnrc_netif_ethernet: cannot allocate pktsnip.\n");
+        /* drop the packet */
+        dev->driver->recv(dev, NULL, bytes_expected, NULL);
+        return -ENOBUFS;
+    }
 
-            /* drop the packet */
-            dev->driver->recv(dev, NULL, bytes_expected, NULL);
+    nread = dev->driver->recv(dev, (*pkt)->data, bytes_expected, NULL);
+    if (nread <= 0) {
+        DEBUG("gnrc_netif_ethernet: read error.\n");
+        gnrc_pktbuf_release(*pkt);
+        *pkt = NULL;
+        return nread;
+    }
 
-            goto out;
-        }
+    if (nread < bytes_expected) {
+        /* we've got less than the expected packet size,
+         * so free the unused space.*/
 
-        int nread = dev->driver->recv(dev, pkt->data, bytes_expected, NULL);
-        if (nread <= 0) {
-            DEBUG("gnrc_netif_ethernet: read error.\n");
-            goto safe_out;
-        }
+        DEBUG("gnrc_netif_ethernet: reallocating.\n");
+        gnrc_pktbuf_realloc_data(*pkt, nread);
+    }
+    return nread;
+}
+
+static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
+{
+    gnrc_pktsnip_t *pkt = NULL;
+    int nread = _recv_frame(netif, &pkt);
+
+    if (nread > 0) {
 #ifdef MODULE_NETSTATS_L2
         netif->stats.rx_count++;
         netif->stats.rx_bytes += nread;
 #endif
 
-        if (nread < bytes_expected) {
-            /* we've got less than the expected packet size,
-             * so free the unused space.*/
-
-            DEBUG("gnrc_netif_ethernet: reallocating.\n");
-            gnrc_pktbuf_realloc_data(pkt, nread);
-        }
-
         DEBUG("gnrc_netif_ethernet: received packet from %s of length %d\n",
               gnrc_netif_addr_to_str(pkt->data, ETHERNET_ADDR_LEN, addr_str),
               nread);
@@ -219,7 +238,7 @@ static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
         ethernet_hdr_t *hdr = (ethernet_hdr_t *)eth_hdr->data;
 
 #ifdef MODULE_L2FILTER
-        if (!l2filter_pass(dev->filter, hdr->src, ETHERNET_ADDR_LEN)) {
+        if (!l2filter_pass(netif->dev->filter, hdr->src, ETHERNET_ADDR_LEN)) {
             DEBUG("gnrc_netif_ethernet: incoming packet filtered by l2filter\n");
             goto safe_out;
         }
@@ -249,7 +268,6 @@ static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
         LL_APPEND(pkt, netif_hdr);
     }
 
-out:
     return pkt;
 
 safe_out:
@@ -264,6 +264,43 @@ int gnrc_netif_get_from_netdev(gnrc_netif_t *netif, gnrc_netapi_opt_t *opt)
     return res;
 }
 
+#if IS_USED(MODULE_NETDEV_RECV_LOAN) && IS_USED(MODULE_GNRC_PKTBUF_STATIC_LOAN)
+static void _recv_release(void *arg, void *data)
+{
+    netdev_t *dev = arg;
+
+    dev->driver->recv_release(dev, data);
+}
+
+int gnrc_netif_recv_loan(gnrc_netif_t *netif, gnrc_pktsnip_t **pkt,
+                         void *info)
+{
+    netdev_t *dev = netif->dev;
+    void *buf;
+    int nread;
+
+    if (dev->driver->recv_loan == NULL) {
+        return -ENOTSUP;
+    }
+    nread = dev->driver->recv_loan(dev, &buf, info);
+    if (nread == -ENOBUFS) {
+        /* all buffers of the device are in use, copy the frame */
+        return -ENOTSUP;
+    }
+    if (nread <= 0) {
+        return nread;
+    }
+    *pkt = gnrc_pktbuf_add_loan(NULL, buf, nread, GNRC_NETTYPE_UNDEF,
+                                _recv_release, dev);
+    if (*pkt == NULL) {
+        DEBUG("gnrc_netif: cannot allocate pktsnip for lent frame\n");
+        dev->driver->recv_release(dev, buf);
+        return -ENOBUFS;
+    }
+    return nread;
+}
+#endif
+
 int gnrc_netif_set_from_netdev(gnrc_netif_t *netif,
                                const gnrc_netapi_opt_t *opt)
 {
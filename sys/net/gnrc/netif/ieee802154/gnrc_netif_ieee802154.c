@@ -13,8 +13,11 @@
  * @author  Martine Lenders <m.lenders@fu-berlin.de>
  */
 
+#include <errno.h>
+
 #include "net/gnrc.h"
 #include "net/gnrc/netif/ieee802154.h"
+#include "net/gnrc/netif/internal.h"
 #include "net/netdev/ieee802154.h"
 
 #ifdef MODULE_GNRC_IPV6
@@ -92,28 +95,57 @@ static inline bool _already_received(gnrc_netif_t *netif,
 }
 #endif /* MODULE_GNRC_NETIF_DEDUP */
 
-static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
+/* Receives a frame into pkt, lent by the device if it supports it */
+static int _recv_frame(gnrc_netif_t *netif, gnrc_pktsnip_t **pkt,
+                       netdev_ieee802154_rx_info_t *rx_info)
 {
     netdev_t *dev = netif->dev;
-    netdev_ieee802154_rx_info_t rx_info;
-    gnrc_pktsnip_t *pkt = NULL;
-    int bytes_expected = dev->driver->recv(dev, NULL, 0, NULL);
+    int nread;
 
-    if (bytes_expected >= (int)IEEE802154_MIN_FRAME_LEN) {
-        int nread;
+#if IS_USED(MODULE_NETDEV_RECV_LOAN) && IS_USED(MODULE_GNRC_PKTBUF_STATIC_LOAN)
+    nread = gnrc_netif_recv_loan(netif, pkt, rx_info);
+    if ((nread > 0) && (nread < (int)IEEE802154_MIN_FRAME_LEN)) {
+        DEBUG("_recv_ieee802154: received frame is too short\n");
+        gnrc_pktbuf_release(*pkt);
+        *pkt = NULL;
+        return 0;
+    }
+    if (nread != -ENOTSUP) {
+        return nread;
+    }
+#endif
+    int bytes_expected = dev->driver->recv(dev, NULL, 0, NULL);
 
-        pkt = gnrc_pktbuf_add(NULL, NULL, bytes_expected, GNRC_NETTYPE_UNDEF);
-        if (pkt == NULL) {
-            DEBUG("_recv_ieee802154: cannot allocate pktsnip.\n");
-            /* Discard packet on netdev device */
+    if (bytes_expected < (int)IEEE802154_MIN_FRAME_LEN) {
+        if (bytes_expected > 0) {
+            DEBUG("_recv_ieee802154: received frame is too short\n");
             dev->driver->recv(dev, NULL, bytes_expected, NULL);
-            return NULL;
-        }
-        nread = dev->driver->recv(dev, pkt->data, bytes_expected, &rx_info);
-        if (nread <= 0) {
-            gnrc_pktbuf_release(pkt);
-            return NULL;
         }
+        return 0;
+    }
+    *pkt = gnrc_pktbuf_add(NULL, NULL, bytes_expected, GNRC_NETTYPE_UNDEF);
+    if (*pkt == NULL) {
+        DEBUG("_recv_ieee802154: cannot allocate pktsnip.\n");
+        /* Discard packet on netdev device */
+        dev->driver->recv(dev, NULL, bytes_expected, NULL);
+        return -ENOBUFS;
+    }
+    nread = dev->driver->recv(dev, (*pkt)->data, bytes_expected, rx_info);
+    if (nread <= 0) {
+        gnrc_pktbuf_release(*pkt);
+        *pkt = NULL;
+    }
+    return nread;
+}
+
+static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
+{
+    netdev_t *dev = netif->dev;
+    netdev_ieee802154_rx_info_t rx_info;
+    gnrc_pktsnip_t *pkt = NULL;
+    int nread = _recv_frame(netif, &pkt, &rx_info);
+
+    if (nread > 0) {
 #ifdef MODULE_NETSTATS_L2
         netif->stats.rx_count++;
         netif->stats.rx_bytes += nread;
@@ -209,9 +241,6 @@ static gnrc_pktsnip_t *_recv(gnrc_netif_t *netif)
 
         DEBUG("_recv_ieee802154: reallocating.\n");
         gnrc_pktbuf_realloc_data(pkt, nread);
-    } else if (bytes_expected > 0) {
-        DEBUG("_recv_ieee802154: received frame is too short\n");
-        dev->driver->recv(dev, NULL, bytes_expected, NULL);
     }
 
     return pkt;
@@ -30,20 +30,52 @@
 
 #define _INVALID_TYPE(type) (((type) < GNRC_NETTYPE_UNDEF) || ((type) >= GNRC_NETTYPE_NUMOF))
 
-/* The registry as lookup table by gnrc_nettype_t */
-static gnrc_netreg_entry_t *netreg[GNRC_NETTYPE_NUMOF];
+#ifdef MODULE_GNRC_NETREG_HASH
+#define _BUCKETS            CONFIG_GNRC_NETREG_HASH_BUCKETS
+
+static_assert((_BUCKETS & (_BUCKETS - 1)) == 0,
+              "CONFIG_GNRC_NETREG_HASH_BUCKETS must be a power of 2");
+#else
+#define _BUCKETS            (1U)
+#endif
+
+/* The registry as lookup table by gnrc_nettype_t, with gnrc_netreg_hash the
+ * entries of a type are additionally split into buckets by demux context.
+ * Entries with equal demux context always share a list, so
+ * gnrc_netreg_getnext() only needs to follow gnrc_netreg_entry_t::next */
+static gnrc_netreg_entry_t *netreg[GNRC_NETTYPE_NUMOF][_BUCKETS];
+
+static inline gnrc_netreg_entry_t **_bucket(gnrc_nettype_t type,
+                                            uint32_t demux_ctx)
+{
+#ifdef MODULE_GNRC_NETREG_HASH
+    /* multiplicative hash, spreads the low bits that differ between ports
+     * or protocol numbers into the upper half */
+    unsigned idx = ((demux_ctx * 0x9e3779b1U) >> 16) & (_BUCKETS - 1);
+
+    return &netreg[type][idx];
+#else
+    (void)demux_ctx;
+    return &netreg[type][0];
+#endif
+}
 
 void gnrc_netreg_init(void)
 {
     /* set all pointers in registry to NULL */
-    memset(netreg, 0, GNRC_NETTYPE_NUMOF * sizeof(gnrc_netreg_entry_t *));
+    memset(netreg, 0, sizeof(netreg));
 }
 
 int gnrc_netreg_register(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
 {
 #if DEVELHELP
-# if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS)
-    bool has_msg_q = (entry->type != GNRC_NETREG_TYPE_DEFAULT) ||
+# if defined(MODULE_GNRC_NETAPI_MBOX) || defined(MODULE_GNRC_NETAPI_CALLBACKS) || \
+     defined(MODULE_GNRC_NETAPI_BATCH)
+    bool uses_msg = (entry->type == GNRC_NETREG_TYPE_DEFAULT);
+#  ifdef MODULE_GNRC_NETAPI_BATCH
+    uses_msg |= (entry->type == GNRC_NETREG_TYPE_BATCH);
+#  endif
+    bool has_msg_q = !uses_msg ||
                      thread_has_msg_queue(thread_get(entry->target.pid));
 # else
     bool has_msg_q = thread_has_msg_queue(thread_get(entry->target.pid));
@@ -61,7 +93,7 @@ int gnrc_netreg_register(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
         return -EINVAL;
     }
 
-    LL_PREPEND(netreg[type], entry);
+    LL_PREPEND(*_bucket(type, entry->demux_ctx), entry);
 
     return 0;
 }
@@ -72,7 +104,7 @@ void gnrc_netreg_unregister(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
         return;
     }
 
-    LL_DELETE(netreg[type], entry);
+    LL_DELETE(*_bucket(type, entry->demux_ctx), entry);
 }
 
 /**
@@ -94,7 +126,8 @@ static gnrc_netreg_entry_t *_netreg_lookup(gnrc_netreg_entry_t *from,
     gnrc_netreg_entry_t *res = NULL;
 
     if (from || !_INVALID_TYPE(type)) {
-        gnrc_netreg_entry_t *head = (from) ? from->next : netreg[type];
+        gnrc_netreg_entry_t *head = (from) ? from->next
+                                            : *_bucket(type, demux_ctx);
         LL_SEARCH_SCALAR(head, res, demux_ctx, demux_ctx);
     }
 
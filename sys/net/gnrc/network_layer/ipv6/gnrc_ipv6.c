@@ -36,6 +36,9 @@
 #ifdef MODULE_GNRC_IPV6_EXT_FRAG
 #include "net/gnrc/ipv6/ext/frag.h"
 #endif
+#ifdef MODULE_GNRC_IPV6_ROUTE_CACHE
+#include "net/gnrc/ipv6/route_cache.h"
+#endif
 
 #include "net/gnrc/ipv6.h"
 
@@ -68,6 +71,10 @@ static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 
 kernel_pid_t gnrc_ipv6_pid = KERNEL_PID_UNDEF;
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+static gnrc_netapi_batch_t _batch;
+#endif
+
 /* handles GNRC_NETAPI_MSG_TYPE_RCV commands */
 static void _receive(gnrc_pktsnip_t *pkt);
 /* Sends packet over the appropriate interface(s).
@@ -174,11 +181,14 @@ static void _dispatch_next_header(gnrc_pktsnip_t *pkt, unsigned nh,
 static void *_event_loop(void *args)
 {
     msg_t msg, reply, msg_q[GNRC_IPV6_MSG_QUEUE_SIZE];
-    gnrc_netreg_entry_t me_reg = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
-                                                            thread_getpid());
+    gnrc_netreg_entry_t me_reg = GNRC_NETREG_ENTRY_INIT_BATCH(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                              thread_getpid());
 
     (void)args;
     msg_init_queue(msg_q, GNRC_IPV6_MSG_QUEUE_SIZE);
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    gnrc_netapi_batch_init(&_batch);
+#endif
 
     /* initialize fragmentation data-structures */
 #ifdef MODULE_GNRC_IPV6_EXT_FRAG
@@ -206,6 +216,17 @@ static void *_event_loop(void *args)
                 _send(msg.content.ptr, true);
                 break;
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                DEBUG("ipv6: GNRC_NETAPI_MSG_TYPE_RCV_BATCH received\n");
+                for (unsigned i = 0; i < gnrc_netapi_batch_numof(msg.content.ptr); i++) {
+                    _receive(gnrc_netapi_batch_get(msg.content.ptr, i));
+                }
+                gnrc_pktbuf_release(msg.content.ptr);
+                break;
+
+#endif
+
             case GNRC_NETAPI_MSG_TYPE_GET:
             case GNRC_NETAPI_MSG_TYPE_SET:
                 DEBUG("ipv6: reply to unsupported get/set\n");
@@ -248,6 +269,9 @@ static void *_event_loop(void *args)
             default:
                 break;
         }
+#ifdef MODULE_GNRC_NETAPI_BATCH
+        gnrc_netapi_batch_poll();
+#endif
     }
 
     return NULL;
@@ -482,6 +506,34 @@ static void _send_by_netif_hdr(gnrc_pktsnip_t *pkt)
 }
 #endif  /* MODULE_GNRC_IPV6_EXT_FRAG */
 
+/* Gets the next hop to dst and the interface to it, from the route cache if
+ * possible. Returns NULL if there is none, pkt is released by the NIB then */
+static gnrc_netif_t *_get_next_hop(const ipv6_addr_t *dst, gnrc_netif_t *netif,
+                                   gnrc_pktsnip_t *pkt, gnrc_ipv6_nib_nc_t *nce)
+{
+    gnrc_netif_t *next_netif;
+#ifdef MODULE_GNRC_IPV6_ROUTE_CACHE
+    /* read before the lookup, so a change during it invalidates the result */
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    if ((next_netif = gnrc_ipv6_route_cache_get(dst, netif, changes,
+                                                nce)) != NULL) {
+        DEBUG("ipv6: next hop to %s from route cache\n",
+              ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)));
+        return next_netif;
+    }
+#endif  /* MODULE_GNRC_IPV6_ROUTE_CACHE */
+    if (gnrc_ipv6_nib_get_next_hop_l2addr(dst, netif, pkt, nce) < 0) {
+        return NULL;
+    }
+    next_netif = gnrc_netif_get_by_pid(gnrc_ipv6_nib_nc_get_iface(nce));
+    assert(next_netif != NULL);
+#ifdef MODULE_GNRC_IPV6_ROUTE_CACHE
+    gnrc_ipv6_route_cache_add(dst, netif, next_netif, nce, changes);
+#endif  /* MODULE_GNRC_IPV6_ROUTE_CACHE */
+    return next_netif;
+}
+
 static void _send_unicast(gnrc_pktsnip_t *pkt, bool prep_hdr,
                           gnrc_netif_t *netif, ipv6_hdr_t *ipv6_hdr,
                           uint8_t netif_hdr_flags)
@@ -489,15 +541,12 @@ static void _send_unicast(gnrc_pktsnip_t *pkt, bool prep_hdr,
     gnrc_ipv6_nib_nc_t nce;
 
     DEBUG("ipv6: send unicast\n");
-    if (gnrc_ipv6_nib_get_next_hop_l2addr(&ipv6_hdr->dst, netif, pkt,
-                                          &nce) < 0) {
+    if ((netif = _get_next_hop(&ipv6_hdr->dst, netif, pkt, &nce)) == NULL) {
         /* packet is released by NIB */
         DEBUG("ipv6: no link-layer address or interface for next hop to %s\n",
               ipv6_addr_to_str(addr_str, &ipv6_hdr->dst, sizeof(addr_str)));
         return;
     }
-    netif = gnrc_netif_get_by_pid(gnrc_ipv6_nib_nc_get_iface(&nce));
-    assert(netif != NULL);
     if (_safe_fill_ipv6_hdr(netif, pkt, prep_hdr)) {
         DEBUG("ipv6: add interface header to packet\n");
         if ((pkt = _create_netif_hdr(nce.l2addr, nce.l2addr_len, pkt,
@@ -34,6 +34,7 @@
 
 /* pointers for default router selection */
 _nib_dr_entry_t *_prime_def_router = NULL;
+atomic_uint_least32_t _nib_changes = ATOMIC_VAR_INIT(0);
 static clist_node_t _next_removable = { NULL };
 
 static _nib_onl_entry_t _nodes[CONFIG_GNRC_IPV6_NIB_NUMOF];
@@ -43,6 +44,47 @@ static _nib_dr_entry_t _def_routers[CONFIG_GNRC_IPV6_NIB_DEFAULT_ROUTER_NUMOF];
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_MULTIHOP_P6C)
 static _nib_abr_entry_t _abrs[CONFIG_GNRC_IPV6_NIB_ABR_NUMOF];
 #endif  /* CONFIG_GNRC_IPV6_NIB_MULTIHOP_P6C */
+
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+#if CONFIG_GNRC_IPV6_NIB_NUMOF < UINT8_MAX
+typedef uint8_t _onl_idx_t;
+#else
+typedef uint16_t _onl_idx_t;
+#endif
+
+/* Chains of _nodes with a specified address by hash of that address. Links
+ * are the index in _nodes + 1, so 0 ends a chain. Chains are sorted by index,
+ * so the first match in a chain is also the first match in _nodes */
+static _onl_idx_t _onl_buckets[CONFIG_GNRC_IPV6_NIB_NC_HASH_BUCKETS];
+static _onl_idx_t _onl_next[CONFIG_GNRC_IPV6_NIB_NUMOF];
+#endif  /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
+
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_FT_TRIE)
+#define _TRIE_NUMOF     (2 * CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF)
+
+#if _TRIE_NUMOF < UINT8_MAX
+typedef uint8_t _trie_idx_t;
+#else
+typedef uint16_t _trie_idx_t;
+#endif
+
+/* Node of the compressed binary trie over the prefixes in _dsts. Nodes are
+ * referenced by their index in _trie + 1, so 0 is no node. The first
+ * CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF nodes stand for the entry of _dsts with the
+ * same index, the others are branches that only split the trie where entries
+ * diverge. Entries with equal prefix share one position in the trie, the
+ * others are linked by _trie_node_t::dup */
+typedef struct {
+    _trie_idx_t child[2];   /* subtrees by the bit after the prefix */
+    _trie_idx_t dup;        /* next entry with the same prefix */
+    uint8_t len;            /* prefix length of a branch */
+} _trie_node_t;
+
+static _trie_node_t _trie[_TRIE_NUMOF];
+static _trie_idx_t _trie_root;
+static _trie_idx_t _trie_free;          /* released branches by child[0] */
+static _trie_idx_t _trie_branches;      /* branches ever used */
+#endif  /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
 static rmutex_t _nib_mutex = RMUTEX_INIT;
 
 static char addr_str[IPV6_ADDR_MAX_STR_LEN];
@@ -64,7 +106,17 @@ void _nib_init(void)
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_MULTIHOP_P6C)
     memset(_abrs, 0, sizeof(_abrs));
 #endif  /* CONFIG_GNRC_IPV6_NIB_MULTIHOP_P6C */
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+    memset(_onl_buckets, 0, sizeof(_onl_buckets));
+    memset(_onl_next, 0, sizeof(_onl_next));
+#endif  /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_FT_TRIE)
+    _trie_root = 0;
+    _trie_free = 0;
+    _trie_branches = 0;
+#endif  /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
 #endif  /* TEST_SUITES */
+    _nib_changed();
     evtimer_init_msg(&_nib_evtimer);
     /* TODO: load ABR information from persistent memory */
 }
@@ -86,6 +138,63 @@ static inline bool _addr_equals(const ipv6_addr_t *addr,
            (ipv6_addr_equal(addr, &node->ipv6));
 }
 
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+static _onl_idx_t *_onl_bucket(const ipv6_addr_t *addr)
+{
+    /* fold the whole address, neighbors on the same link only differ in
+     * their interface identifier but routes may share that */
+    uint32_t hash = addr->u32[0].u32 ^ addr->u32[1].u32 ^
+                    addr->u32[2].u32 ^ addr->u32[3].u32;
+
+    /* the last byte of the address is in the upper bits on little endian
+     * platforms, mix it into the bits the multiplication spreads */
+    hash ^= hash >> 16;
+    return &_onl_buckets[((hash * 0x9e3779b1U) >> 16) %
+                         CONFIG_GNRC_IPV6_NIB_NC_HASH_BUCKETS];
+}
+
+void _nib_onl_unindex(const _nib_onl_entry_t *node)
+{
+    _onl_idx_t idx = (node - _nodes) + 1;
+
+    for (_onl_idx_t *ptr = _onl_bucket(&node->ipv6); *ptr;
+         ptr = &_onl_next[*ptr - 1]) {
+        if (*ptr == idx) {
+            *ptr = _onl_next[idx - 1];
+            _onl_next[idx - 1] = 0;
+            return;
+        }
+    }
+}
+
+static void _onl_index(const _nib_onl_entry_t *node)
+{
+    _onl_idx_t idx = (node - _nodes) + 1;
+    _onl_idx_t *ptr = _onl_bucket(&node->ipv6);
+
+    while (*ptr && (*ptr < idx)) {
+        ptr = &_onl_next[*ptr - 1];
+    }
+    if (*ptr != idx) {
+        _onl_next[idx - 1] = *ptr;
+        *ptr = idx;
+    }
+}
+#endif  /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
+
+static void _onl_set_addr(_nib_onl_entry_t *node, const ipv6_addr_t *addr)
+{
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+    _nib_onl_unindex(node);
+    memcpy(&node->ipv6, addr, sizeof(node->ipv6));
+    if (!ipv6_addr_is_unspecified(addr)) {
+        _onl_index(node);
+    }
+#else   /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
+    memcpy(&node->ipv6, addr, sizeof(node->ipv6));
+#endif  /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
+}
+
 _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
 {
     _nib_onl_entry_t *node = NULL;
@@ -93,6 +202,20 @@ _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
     DEBUG("nib: Allocating on-link node entry (addr = %s, iface = %u)\n",
           (addr == NULL) ? "NULL" : ipv6_addr_to_str(addr_str, addr,
                                                      sizeof(addr_str)), iface);
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+    if ((addr != NULL) && !ipv6_addr_is_unspecified(addr)) {
+        for (_onl_idx_t i = *_onl_bucket(addr); i; i = _onl_next[i - 1]) {
+            _nib_onl_entry_t *tmp = &_nodes[i - 1];
+
+            if ((_nib_onl_get_if(tmp) == iface) &&
+                ipv6_addr_equal(addr, &tmp->ipv6)) {
+                DEBUG("  %p is an exact match\n", (void *)tmp);
+                _override_node(addr, iface, tmp);
+                return tmp;
+            }
+        }
+    }
+#endif  /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
     for (unsigned i = 0; i < CONFIG_GNRC_IPV6_NIB_NUMOF; i++) {
         _nib_onl_entry_t *tmp = &_nodes[i];
 
@@ -108,6 +231,11 @@ _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
         }
     }
     if (node != NULL) {
+        /* a new entry, or one that had no address yet */
+        if ((node->mode == _EMPTY) ||
+            ((addr != NULL) && !ipv6_addr_equal(addr, &node->ipv6))) {
+            _nib_changed();
+        }
         _override_node(addr, iface, node);
     }
 #if ENABLE_DEBUG
@@ -191,6 +319,7 @@ _nib_onl_entry_t *_nib_nc_add(const ipv6_addr_t *addr, unsigned iface,
         /* masked above already */
         node->info |= cstate;
         node->mode |= _NC;
+        _nib_changed();
     }
     if (node->next == NULL) {
         DEBUG("nib: queueing (addr = %s, iface = %u) for potential removal\n",
@@ -215,20 +344,41 @@ _nib_onl_entry_t *_nib_onl_iter(const _nib_onl_entry_t *last)
     return NULL;
 }
 
+static inline bool _onl_get_match(const _nib_onl_entry_t *node,
+                                  const ipv6_addr_t *addr, unsigned iface)
+{
+    return (node->mode != _EMPTY) &&
+           /* either requested or current interface undefined or
+            * interfaces equal */
+           ((_nib_onl_get_if(node) == 0) || (iface == 0) ||
+            (_nib_onl_get_if(node) == iface)) &&
+           ipv6_addr_equal(&node->ipv6, addr);
+}
+
 _nib_onl_entry_t *_nib_onl_get(const ipv6_addr_t *addr, unsigned iface)
 {
     assert(addr != NULL);
     DEBUG("nib: Getting on-link node entry (addr = %s, iface = %u)\n",
           ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)), iface);
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+    /* entries with unspecified address are not indexed */
+    if (!ipv6_addr_is_unspecified(addr)) {
+        for (_onl_idx_t i = *_onl_bucket(addr); i; i = _onl_next[i - 1]) {
+            _nib_onl_entry_t *node = &_nodes[i - 1];
+
+            if (_onl_get_match(node, addr, iface)) {
+                DEBUG("  Found %p\n", (void *)node);
+                return node;
+            }
+        }
+        DEBUG("  No suitable entry found\n");
+        return NULL;
+    }
+#endif  /* CONFIG_GNRC_IPV6_NIB_NC_HASH */
     for (unsigned i = 0; i < CONFIG_GNRC_IPV6_NIB_NUMOF; i++) {
         _nib_onl_entry_t *node = &_nodes[i];
 
-        if ((node->mode != _EMPTY) &&
-            /* either requested or current interface undefined or
-             * interfaces equal */
-            ((_nib_onl_get_if(node) == 0) || (iface == 0) ||
-             (_nib_onl_get_if(node) == iface)) &&
-            ipv6_addr_equal(&node->ipv6, addr)) {
+        if (_onl_get_match(node, addr, iface)) {
             DEBUG("  Found %p\n", (void *)node);
             return node;
         }
@@ -242,6 +392,10 @@ void _nib_nc_set_reachable(_nib_onl_entry_t *node)
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ARSM)
     gnrc_netif_t *netif = gnrc_netif_get_by_pid(_nib_onl_get_if(node));
 
+    if ((node->info & GNRC_IPV6_NIB_NC_INFO_NUD_STATE_MASK) !=
+        GNRC_IPV6_NIB_NC_INFO_NUD_STATE_REACHABLE) {
+        _nib_changed();
+    }
     node->info &= ~GNRC_IPV6_NIB_NC_INFO_NUD_STATE_MASK;
     node->info |= GNRC_IPV6_NIB_NC_INFO_NUD_STATE_REACHABLE;
 #ifdef TEST_SUITES
@@ -266,6 +420,7 @@ void _nib_nc_remove(_nib_onl_entry_t *node)
           ipv6_addr_to_str(addr_str, &node->ipv6, sizeof(addr_str)),
           _nib_onl_get_if(node));
     node->mode &= ~(_NC);
+    _nib_changed();
     evtimer_del((evtimer_t *)&_nib_evtimer, &node->snd_na.event);
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ARSM)
     evtimer_del((evtimer_t *)&_nib_evtimer, &node->nud_timeout.event);
@@ -370,6 +525,7 @@ _nib_dr_entry_t *_nib_drl_add(const ipv6_addr_t *router_addr, unsigned iface)
         }
         _override_node(router_addr, iface, def_router->next_hop);
         def_router->next_hop->mode |= _DRL;
+        _nib_changed();
     }
     return def_router;
 }
@@ -384,6 +540,7 @@ void _nib_drl_remove(_nib_dr_entry_t *nib_dr)
     if (nib_dr == _prime_def_router) {
         _prime_def_router = NULL;
     }
+    _nib_changed();
 }
 
 _nib_dr_entry_t *_nib_drl_iter(const _nib_dr_entry_t *last)
@@ -420,8 +577,18 @@ _nib_dr_entry_t *_nib_drl_get(const ipv6_addr_t *router_addr, unsigned iface)
     return NULL;
 }
 
+/* Returns the selected default router, counts a change if it is not prev */
+static inline _nib_dr_entry_t *_drl_selected(const _nib_dr_entry_t *prev)
+{
+    if (_prime_def_router != prev) {
+        _nib_changed();
+    }
+    return _prime_def_router;
+}
+
 _nib_dr_entry_t *_nib_drl_get_dr(void)
 {
+    const _nib_dr_entry_t *prev = _prime_def_router;
     _nib_dr_entry_t *ptr = NULL;
 
     /* if there is already a default router selected or
@@ -449,11 +616,11 @@ _nib_dr_entry_t *_nib_drl_get_dr(void)
             else if (next != NULL) {
                 _prime_def_router = next;
             }
-            return _prime_def_router;
+            return _drl_selected(prev);
         }
     } while (_node_unreachable(ptr->next_hop));
     _prime_def_router = ptr;
-    return _prime_def_router;
+    return _drl_selected(prev);
 }
 
 void _nib_drl_ft_get(const _nib_dr_entry_t *drl, gnrc_ipv6_nib_ft_t *fte)
@@ -468,6 +635,154 @@ void _nib_drl_ft_get(const _nib_dr_entry_t *drl, gnrc_ipv6_nib_ft_t *fte)
     fte->iface = _nib_onl_get_if(drl->next_hop);
 }
 
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_FT_TRIE)
+static inline _trie_node_t *_trie_node(_trie_idx_t idx)
+{
+    return &_trie[idx - 1];
+}
+
+static inline bool _trie_is_entry(_trie_idx_t idx)
+{
+    return idx <= CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF;
+}
+
+static inline unsigned _trie_len(_trie_idx_t idx)
+{
+    return _trie_is_entry(idx) ? _dsts[idx - 1].pfx_len : _trie_node(idx)->len;
+}
+
+static inline unsigned _addr_bit(const ipv6_addr_t *addr, unsigned pos)
+{
+    return (addr->u8[pos / 8] >> (7 - (pos % 8))) & 0x1;
+}
+
+/* prefix of a node, a branch shares it with all entries below it */
+static const ipv6_addr_t *_trie_pfx(_trie_idx_t idx)
+{
+    while (!_trie_is_entry(idx)) {
+        /* branches always have two subtrees */
+        idx = _trie_node(idx)->child[0];
+    }
+    return &_dsts[idx - 1].pfx;
+}
+
+static _trie_idx_t _trie_branch(unsigned len, _trie_idx_t child0,
+                                _trie_idx_t child1)
+{
+    _trie_idx_t idx = _trie_free;
+
+    if (idx != 0) {
+        _trie_free = _trie_node(idx)->child[0];
+    }
+    else {
+        /* a trie over n entries never needs more than n - 1 branches */
+        assert(_trie_branches < CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF);
+        idx = CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF + 1 + _trie_branches++;
+    }
+    _trie_node(idx)->child[0] = child0;
+    _trie_node(idx)->child[1] = child1;
+    _trie_node(idx)->len = len;
+    return idx;
+}
+
+static void _trie_branch_free(_trie_idx_t idx)
+{
+    _trie_node(idx)->child[0] = _trie_free;
+    _trie_free = idx;
+}
+
+static void _trie_insert(const _nib_offl_entry_t *dst)
+{
+    _trie_idx_t idx = (dst - _dsts) + 1;
+    _trie_node_t *node = _trie_node(idx);
+    _trie_idx_t *link = &_trie_root;
+
+    memset(node, 0, sizeof(*node));
+    while (*link) {
+        _trie_idx_t cur = *link;
+        const ipv6_addr_t *cur_pfx = _trie_pfx(cur);
+        unsigned cur_len = _trie_len(cur);
+        unsigned common = ipv6_addr_match_prefix(cur_pfx, &dst->pfx);
+
+        common = (common < cur_len) ? common : cur_len;
+        common = (common < dst->pfx_len) ? common : dst->pfx_len;
+        if ((common == cur_len) && (common == dst->pfx_len)) {
+            if (_trie_is_entry(cur)) {
+                node->dup = _trie_node(cur)->dup;
+                _trie_node(cur)->dup = idx;
+            }
+            else {
+                /* the entry takes the place of the branch */
+                memcpy(node->child, _trie_node(cur)->child, sizeof(node->child));
+                _trie_branch_free(cur);
+                *link = idx;
+            }
+            return;
+        }
+        if (common == cur_len) {
+            link = &_trie_node(cur)->child[_addr_bit(&dst->pfx, cur_len)];
+            continue;
+        }
+        if (common == dst->pfx_len) {
+            /* the entry covers the subtree */
+            node->child[_addr_bit(cur_pfx, common)] = cur;
+            *link = idx;
+        }
+        else if (_addr_bit(&dst->pfx, common)) {
+            *link = _trie_branch(common, cur, idx);
+        }
+        else {
+            *link = _trie_branch(common, idx, cur);
+        }
+        return;
+    }
+    *link = idx;
+}
+
+static void _trie_remove(const _nib_offl_entry_t *dst)
+{
+    _trie_idx_t idx = (dst - _dsts) + 1;
+    _trie_node_t *node = _trie_node(idx);
+    _trie_idx_t *parent = NULL, *link = &_trie_root;
+
+    while (*link && (_trie_len(*link) < dst->pfx_len)) {
+        parent = link;
+        link = &_trie_node(*link)->child[_addr_bit(&dst->pfx,
+                                                   _trie_len(*link))];
+    }
+    assert(*link != 0);
+    if (*link != idx) {
+        /* one of the entries with equal prefix that are not in the trie */
+        for (_trie_idx_t *ptr = &_trie_node(*link)->dup; *ptr;
+             ptr = &_trie_node(*ptr)->dup) {
+            if (*ptr == idx) {
+                *ptr = node->dup;
+                break;
+            }
+        }
+        return;
+    }
+    if (node->dup) {
+        memcpy(_trie_node(node->dup)->child, node->child, sizeof(node->child));
+        *link = node->dup;
+        return;
+    }
+    if (node->child[0] && node->child[1]) {
+        *link = _trie_branch(dst->pfx_len, node->child[0], node->child[1]);
+        return;
+    }
+    *link = (node->child[0]) ? node->child[0] : node->child[1];
+    if ((*link == 0) && (parent != NULL) && !_trie_is_entry(*parent)) {
+        /* a branch needs two subtrees, replace it with the remaining one */
+        _trie_idx_t branch = *parent;
+        _trie_idx_t *children = _trie_node(branch)->child;
+
+        *parent = (children[0]) ? children[0] : children[1];
+        _trie_branch_free(branch);
+    }
+}
+#endif  /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
+
 _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
                                    const ipv6_addr_t *pfx, unsigned pfx_len)
 {
@@ -493,8 +808,13 @@ _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
             (ipv6_addr_match_prefix(&tmp->pfx, pfx) >= pfx_len)) {  /* the prefix matches */
             /* exact match (or next hop address was previously unset) */
             DEBUG("  %p is an exact match\n", (void *)tmp);
+            if (!(tmp_node->mode & _DST) ||
+                ((next_hop != NULL) &&
+                 !ipv6_addr_equal(next_hop, &tmp_node->ipv6))) {
+                _nib_changed();
+            }
             if (next_hop != NULL) {
-                memcpy(&tmp_node->ipv6, next_hop, sizeof(tmp_node->ipv6));
+                _onl_set_addr(tmp_node, next_hop);
             }
             tmp->next_hop->mode |= _DST;
             return tmp;
@@ -515,6 +835,10 @@ _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
         dst->next_hop->mode |= _DST;
         ipv6_addr_init_prefix(&dst->pfx, pfx, pfx_len);
         dst->pfx_len = pfx_len;
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_FT_TRIE)
+        _trie_insert(dst);
+#endif  /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
+        _nib_changed();
     }
     return dst;
 }
@@ -551,7 +875,11 @@ void _nib_offl_clear(_nib_offl_entry_t *dst)
             dst->next_hop->mode &= ~(_DST);
             _nib_onl_clear(dst->next_hop);
         }
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_FT_TRIE)
+        _trie_remove(dst);
+#endif  /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
         memset(dst, 0, sizeof(_nib_offl_entry_t));
+        _nib_changed();
     }
 }
 
@@ -574,10 +902,86 @@ bool _nib_offl_is_entry(const _nib_offl_entry_t *entry)
     return (entry >= _dsts) && _in_dsts(entry);
 }
 
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_FT_TRIE)
+/* Follows the bits of dst from idx down to the next entry matching dst. All
+ * entries matching dst are on that path, ordered by prefix length */
+static _trie_idx_t _trie_path(const ipv6_addr_t *dst, _trie_idx_t idx)
+{
+    while (idx != 0) {
+        unsigned len = _trie_len(idx);
+
+        if (_trie_is_entry(idx)) {
+            /* if the entry doesn't match neither will any entry below */
+            return (ipv6_addr_match_prefix(&_dsts[idx - 1].pfx, dst) >= len)
+                   ? idx : 0;
+        }
+        idx = _trie_node(idx)->child[_addr_bit(dst, len)];
+    }
+    return 0;
+}
+
+static inline _trie_idx_t _trie_path_next(const ipv6_addr_t *dst,
+                                          _trie_idx_t idx)
+{
+    unsigned len = _trie_len(idx);
+
+    if (len >= IPV6_ADDR_BIT_LEN) {
+        return 0;
+    }
+    return _trie_path(dst, _trie_node(idx)->child[_addr_bit(dst, len)]);
+}
+
+static _nib_offl_entry_t *_nib_offl_get_match(const ipv6_addr_t *dst)
+{
+    _nib_offl_entry_t *res = NULL;
+
+    DEBUG("nib: get match for destination %s from NIB trie\n",
+          ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)));
+    for (_trie_idx_t idx = _trie_path(dst, _trie_root); idx != 0;
+         idx = _trie_path_next(dst, idx)) {
+        _nib_offl_entry_t *match = NULL;
+
+        /* of entries with equal prefix the first in _dsts wins, as with
+         * the linear search */
+        for (_trie_idx_t ptr = idx; ptr != 0; ptr = _trie_node(ptr)->dup) {
+            _nib_offl_entry_t *entry = &_dsts[ptr - 1];
+
+            if ((entry->mode != _EMPTY) &&
+                ((match == NULL) || (entry < match))) {
+                match = entry;
+            }
+        }
+        if (match != NULL) {
+            DEBUG("nib: best match so far %s/%u\n",
+                  ipv6_addr_to_str(addr_str, &match->pfx, sizeof(addr_str)),
+                  match->pfx_len);
+            res = match;
+        }
+    }
+    return res;
+}
+
+_nib_offl_entry_t *_nib_pl_get_on_link(const ipv6_addr_t *dst)
+{
+    _nib_offl_entry_t *res = NULL;
+
+    for (_trie_idx_t idx = _trie_path(dst, _trie_root); idx != 0;
+         idx = _trie_path_next(dst, idx)) {
+        for (_trie_idx_t ptr = idx; ptr != 0; ptr = _trie_node(ptr)->dup) {
+            _nib_offl_entry_t *entry = &_dsts[ptr - 1];
+
+            if ((entry->mode & _PL) && (entry->flags & _PFX_ON_LINK) &&
+                ((res == NULL) || (entry < res))) {
+                res = entry;
+            }
+        }
+    }
+    return res;
+}
+#else   /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
 static _nib_offl_entry_t *_nib_offl_get_match(const ipv6_addr_t *dst)
 {
     _nib_offl_entry_t *res = NULL;
-    uint8_t best_match = 0;
 
     DEBUG("nib: get match for destination %s from NIB\n",
           ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)));
@@ -593,16 +997,32 @@ static _nib_offl_entry_t *_nib_offl_get_match(const ipv6_addr_t *dst)
                   ipv6_addr_to_str(addr_str, &entry->next_hop->ipv6,
                                    sizeof(addr_str)),
                   _nib_onl_get_if(entry->next_hop), match);
-            if ((match > best_match) && (match >= entry->pfx_len)) {
-                DEBUG("nib: best match (%u bits)\n", match);
+            /* the longest matching prefix wins, not the one sharing the
+             * most bits with dst */
+            if ((match >= entry->pfx_len) &&
+                ((res == NULL) || (entry->pfx_len > res->pfx_len))) {
+                DEBUG("nib: best match (%u bits)\n", entry->pfx_len);
                 res = entry;
-                best_match = match;
             }
         }
     }
     return res;
 }
 
+_nib_offl_entry_t *_nib_pl_get_on_link(const ipv6_addr_t *dst)
+{
+    _nib_offl_entry_t *entry = NULL;
+
+    while ((entry = _nib_offl_iter(entry))) {
+        if ((entry->mode & _PL) && (entry->flags & _PFX_ON_LINK) &&
+            (ipv6_addr_match_prefix(dst, &entry->pfx) >= entry->pfx_len)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+#endif  /* CONFIG_GNRC_IPV6_NIB_FT_TRIE */
+
 void _nib_ft_get(const _nib_offl_entry_t *dst, gnrc_ipv6_nib_ft_t *fte)
 {
     assert((dst != NULL) && (dst->next_hop != NULL) && (fte != NULL));
@@ -829,7 +1249,7 @@ static void _override_node(const ipv6_addr_t *addr, unsigned iface,
 {
     _nib_onl_clear(node);
     if (addr != NULL) {
-        memcpy(&node->ipv6, addr, sizeof(node->ipv6));
+        _onl_set_addr(node, addr);
     }
     _nib_onl_set_if(node, iface);
 }
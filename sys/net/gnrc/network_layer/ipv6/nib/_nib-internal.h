@@ -20,6 +20,7 @@
 #define PRIV_NIB_INTERNAL_H
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -257,6 +258,28 @@ extern evtimer_msg_t _nib_evtimer;
  */
 extern _nib_dr_entry_t *_prime_def_router;
 
+/**
+ * @brief   Number of changes to the NIB
+ *
+ * Incremented whenever a change to the NIB may change the result of
+ * @ref gnrc_ipv6_nib_get_next_hop_l2addr(). Returned by
+ * @ref gnrc_ipv6_nib_changes().
+ *
+ * Only written with the NIB acquired, but read without it, so that the route
+ * cache does not need to take the NIB mutex for every packet.
+ */
+extern atomic_uint_least32_t _nib_changes;
+
+/**
+ * @brief   Marks a change to the NIB
+ *
+ * @see @ref _nib_changes
+ */
+static inline void _nib_changed(void)
+{
+    atomic_fetch_add(&_nib_changes, 1);
+}
+
 /**
  * @brief   Initializes NIB internally
  */
@@ -310,6 +333,17 @@ static inline void _nib_onl_set_if(_nib_onl_entry_t *node, unsigned iface)
  */
 _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface);
 
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH) || defined(DOXYGEN)
+/**
+ * @brief   Removes an on-link entry from the address index
+ *
+ * @note    Only available if @ref CONFIG_GNRC_IPV6_NIB_NC_HASH != 0.
+ *
+ * @param[in] node  An entry.
+ */
+void _nib_onl_unindex(const _nib_onl_entry_t *node);
+#endif
+
 /**
  * @brief   Clears out a NIB entry (on-link version)
  *
@@ -321,7 +355,11 @@ _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface);
 static inline bool _nib_onl_clear(_nib_onl_entry_t *node)
 {
     if (node->mode == _EMPTY) {
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH)
+        _nib_onl_unindex(node);
+#endif
         memset(node, 0, sizeof(_nib_onl_entry_t));
+        _nib_changed();
         return true;
     }
     return false;
@@ -569,8 +607,9 @@ static inline _nib_offl_entry_t *_nib_offl_add(const ipv6_addr_t *next_hop,
 {
     _nib_offl_entry_t *nib_offl = _nib_offl_alloc(next_hop, iface, pfx, pfx_len);
 
-    if (nib_offl != NULL) {
+    if ((nib_offl != NULL) && !(nib_offl->mode & mode)) {
         nib_offl->mode |= mode;
+        _nib_changed();
     }
     return nib_offl;
 }
@@ -662,6 +701,19 @@ _nib_offl_entry_t *_nib_pl_add(unsigned iface,
  */
 void _nib_pl_remove(_nib_offl_entry_t *nib_offl);
 
+/**
+ * @brief   Gets an on-link prefix list entry covering @p dst
+ *
+ * @pre `(dst != NULL)`
+ *
+ * @param[in] dst   An IPv6 address.
+ *
+ * @return  The first prefix list entry with the on-link flag set whose prefix
+ *          covers @p dst.
+ * @return  NULL, if @p dst is not covered by an on-link prefix.
+ */
+_nib_offl_entry_t *_nib_pl_get_on_link(const ipv6_addr_t *dst);
+
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ROUTER) || DOXYGEN
 /**
  * @brief   Creates or gets an existing forwarding table entry by its prefix
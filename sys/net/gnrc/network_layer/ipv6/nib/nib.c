@@ -165,7 +165,7 @@ void gnrc_ipv6_nib_init_iface(gnrc_netif_t *netif)
 
 static bool _on_link(const ipv6_addr_t *dst, unsigned *iface)
 {
-    _nib_offl_entry_t *entry = NULL;
+    _nib_offl_entry_t *entry;
 
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_6LN)
     if (*iface != 0) {
@@ -174,12 +174,9 @@ static bool _on_link(const ipv6_addr_t *dst, unsigned *iface)
         }
     }
 #endif  /* CONFIG_GNRC_IPV6_NIB_6LN */
-    while ((entry = _nib_offl_iter(entry))) {
-        if ((entry->mode & _PL) && (entry->flags & _PFX_ON_LINK) &&
-            (ipv6_addr_match_prefix(dst, &entry->pfx) >= entry->pfx_len)) {
-            *iface = _nib_onl_get_if(entry->next_hop);
-            return true;
-        }
+    if ((entry = _nib_pl_get_on_link(dst)) != NULL) {
+        *iface = _nib_onl_get_if(entry->next_hop);
+        return true;
     }
     return ipv6_addr_is_link_local(dst);
 }
@@ -288,6 +285,11 @@ int gnrc_ipv6_nib_get_next_hop_l2addr(const ipv6_addr_t *dst,
     return res;
 }
 
+uint32_t gnrc_ipv6_nib_changes(void)
+{
+    return atomic_load(&_nib_changes);
+}
+
 void gnrc_ipv6_nib_handle_pkt(gnrc_netif_t *netif, const ipv6_hdr_t *ipv6,
                               const icmpv6_hdr_t *icmpv6, size_t icmpv6_len)
 {
@@ -28,6 +28,7 @@ int gnrc_ipv6_nib_nc_set(const ipv6_addr_t *ipv6, unsigned iface,
                          const uint8_t *l2addr, size_t l2addr_len)
 {
     _nib_onl_entry_t *node;
+    uint16_t info;
 
     assert(ipv6 != NULL);
     assert(l2addr_len <= CONFIG_GNRC_IPV6_NIB_L2ADDR_MAX_LEN);
@@ -39,6 +40,11 @@ int gnrc_ipv6_nib_nc_set(const ipv6_addr_t *ipv6, unsigned iface,
         return -ENOMEM;
     }
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ARSM)
+    if ((node->l2addr_len != l2addr_len) ||
+        ((l2addr != NULL) && (l2addr_len > 0) &&
+         (memcmp(node->l2addr, l2addr, l2addr_len) != 0))) {
+        _nib_changed();
+    }
     if ((l2addr != NULL) && (l2addr_len > 0)) {
         memcpy(node->l2addr, l2addr, l2addr_len);
     }
@@ -50,10 +56,14 @@ int gnrc_ipv6_nib_nc_set(const ipv6_addr_t *ipv6, unsigned iface,
         return -EINVAL;
     }
 #endif
+    info = node->info;
     node->info &= ~(GNRC_IPV6_NIB_NC_INFO_AR_STATE_MASK |
                     GNRC_IPV6_NIB_NC_INFO_NUD_STATE_MASK);
     node->info |= (GNRC_IPV6_NIB_NC_INFO_AR_STATE_MANUAL |
                    GNRC_IPV6_NIB_NC_INFO_NUD_STATE_UNMANAGED);
+    if (node->info != info) {
+        _nib_changed();
+    }
     _nib_release();
     return 0;
 }
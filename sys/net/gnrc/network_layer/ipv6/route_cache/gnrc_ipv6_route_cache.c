@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @author  Koen Zandberg <koen@bergzand.net>
+ */
+
+#include "kernel_defines.h"
+#include "net/gnrc/ipv6/nib.h"
+#include "net/gnrc/ipv6/nib/conf.h"
+
+#include "net/gnrc/ipv6/route_cache.h"
+
+/**
+ * @brief   Next hop to a unicast destination as resolved by the NIB
+ */
+typedef struct {
+    ipv6_addr_t dst;                /**< destination address */
+    gnrc_netif_t *iface;            /**< interface requested by the sender */
+    gnrc_netif_t *netif;            /**< interface to the next hop, NULL if
+                                     *   the entry is unused */
+    gnrc_ipv6_nib_nc_t nce;         /**< next hop and its link-layer address */
+    uint32_t changes;               /**< gnrc_ipv6_nib_changes() the entry was
+                                     *   resolved for */
+} _route_cache_t;
+
+static _route_cache_t _route_cache[CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE];
+static unsigned _route_cache_next;  /* entry replaced next */
+
+gnrc_netif_t *gnrc_ipv6_route_cache_get(const ipv6_addr_t *dst,
+                                        const gnrc_netif_t *iface,
+                                        uint32_t changes,
+                                        gnrc_ipv6_nib_nc_t *nce)
+{
+    for (unsigned i = 0; i < CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE; i++) {
+        const _route_cache_t *entry = &_route_cache[i];
+
+        if ((entry->netif != NULL) && (entry->changes == changes) &&
+            (entry->iface == iface) && ipv6_addr_equal(&entry->dst, dst)) {
+            *nce = entry->nce;
+            return entry->netif;
+        }
+    }
+    return NULL;
+}
+
+void gnrc_ipv6_route_cache_add(const ipv6_addr_t *dst, gnrc_netif_t *iface,
+                               gnrc_netif_t *netif,
+                               const gnrc_ipv6_nib_nc_t *nce,
+                               uint32_t changes)
+{
+    _route_cache_t *entry;
+
+    /* the NIB needs to see the packets to a neighbor whose reachability is
+     * not confirmed to do neighbor unreachability detection */
+    if (IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ARSM) &&
+        (gnrc_ipv6_nib_nc_get_nud_state(nce) !=
+         GNRC_IPV6_NIB_NC_INFO_NUD_STATE_REACHABLE) &&
+        (gnrc_ipv6_nib_nc_get_nud_state(nce) !=
+         GNRC_IPV6_NIB_NC_INFO_NUD_STATE_UNMANAGED)) {
+        return;
+    }
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ROUTER)
+    /* the routing protocol is told about every usage of a route */
+    if (netif->ipv6.route_info_cb != NULL) {
+        return;
+    }
+#endif  /* CONFIG_GNRC_IPV6_NIB_ROUTER */
+    entry = &_route_cache[_route_cache_next];
+    _route_cache_next = (_route_cache_next + 1) % CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE;
+    entry->dst = *dst;
+    entry->iface = iface;
+    entry->netif = netif;
+    entry->nce = *nce;
+    entry->changes = changes;
+}
+
+/** @} */
@@ -30,6 +30,10 @@
 
 static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+static gnrc_netapi_batch_t _batch;
+#endif
+
 #if ENABLE_DEBUG
 static char _stack[GNRC_SIXLOWPAN_STACK_SIZE + THREAD_EXTRA_STACKSIZE_PRINTF];
 #else
@@ -309,11 +313,14 @@ static void _send(gnrc_pktsnip_t *pkt)
 static void *_event_loop(void *args)
 {
     msg_t msg, reply, msg_q[GNRC_SIXLOWPAN_MSG_QUEUE_SIZE];
-    gnrc_netreg_entry_t me_reg = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
-                                                            thread_getpid());
+    gnrc_netreg_entry_t me_reg = GNRC_NETREG_ENTRY_INIT_BATCH(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                              thread_getpid());
 
     (void)args;
     msg_init_queue(msg_q, GNRC_SIXLOWPAN_MSG_QUEUE_SIZE);
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    gnrc_netapi_batch_init(&_batch);
+#endif
 
     /* register interest in all 6LoWPAN packets */
     gnrc_netreg_register(GNRC_NETTYPE_SIXLOWPAN, &me_reg);
@@ -337,6 +344,17 @@ static void *_event_loop(void *args)
                 _send(msg.content.ptr);
                 break;
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                DEBUG("6lo: GNRC_NETAPI_MSG_TYPE_RCV_BATCH received\n");
+                for (unsigned i = 0; i < gnrc_netapi_batch_numof(msg.content.ptr); i++) {
+                    _receive(gnrc_netapi_batch_get(msg.content.ptr, i));
+                }
+                gnrc_pktbuf_release(msg.content.ptr);
+                break;
+
+#endif
+
             case GNRC_NETAPI_MSG_TYPE_GET:
             case GNRC_NETAPI_MSG_TYPE_SET:
                 DEBUG("6lo: reply to unsupported get/set\n");
@@ -365,6 +383,9 @@ static void *_event_loop(void *args)
                 DEBUG("6lo: operation not supported\n");
                 break;
         }
+#ifdef MODULE_GNRC_NETAPI_BATCH
+        gnrc_netapi_batch_poll();
+#endif
     }
 
     return NULL;
@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <sys/types.h>
 
+#include "kernel_defines.h"
 #include "mutex.h"
 #include "od.h"
 #include "utlist.h"
@@ -33,37 +34,122 @@
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LATENCY
+#include "xtimer.h"
+#endif
+
 #define _ALIGNMENT_MASK    (sizeof(_unused_t) - 1)
+#define _ALIGN_SIZE(size)  (((size) + _ALIGNMENT_MASK) & ~(_ALIGNMENT_MASK))
 
 typedef struct _unused {
     struct _unused *next;
     unsigned int size;
 } _unused_t;
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+/* The size classes are laid out at the start of the packet buffer, the
+ * first-fit arena takes the rest */
+#define _SNIP_SLOT_SIZE    _ALIGN_SIZE(sizeof(gnrc_pktsnip_t))
+#define _HDR_SLOT_SIZE     _ALIGN_SIZE(CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE)
+#define _MTU_SLOT_SIZE     _ALIGN_SIZE(CONFIG_GNRC_PKTBUF_STATIC_MTU_SIZE)
+#define _SLOTS_NUMOF       (CONFIG_GNRC_PKTBUF_STATIC_SNIP_NUMOF + \
+                            CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF + \
+                            CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF)
+#define _ARENA_OFFSET      ((_SNIP_SLOT_SIZE * CONFIG_GNRC_PKTBUF_STATIC_SNIP_NUMOF) + \
+                            (_HDR_SLOT_SIZE * CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF) + \
+                            (_MTU_SLOT_SIZE * CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF))
+
+typedef struct {
+    _unused_t *free;        /* free slots, linked through _unused_t::next */
+    uint8_t *start;         /* first slot */
+    uint16_t size;          /* size of a slot */
+    uint16_t numof;         /* number of slots */
+    uint16_t first;         /* index of the first slot in _slot_used */
+    uint16_t used;          /* number of slots in use */
+#ifdef DEVELHELP
+    uint16_t peak;          /* maximum number of slots in use */
+    uint32_t allocs;        /* allocations served by the class */
+    uint32_t fallbacks;     /* allocations passed to the arena, class full */
+#endif
+} _class_t;
+
+/* smallest class first, an allocation goes to the first class it fits */
+static _class_t _classes[] = {
+    { .size = _SNIP_SLOT_SIZE, .numof = CONFIG_GNRC_PKTBUF_STATIC_SNIP_NUMOF },
+    { .size = _HDR_SLOT_SIZE, .numof = CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF },
+    { .size = _MTU_SLOT_SIZE, .numof = CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF },
+};
+
+/* Bytes in use per slot. gnrc_pktbuf_mark() and gnrc_pktbuf_realloc_data()
+ * free parts of an allocation, so a slot is free again once all of its bytes
+ * are */
+static uint16_t _slot_used[_SLOTS_NUMOF];
+#else
+#define _ARENA_OFFSET      (0U)
+#endif
+
 static mutex_t _mutex = MUTEX_INIT;
 /* The static buffer needs to be aligned to word size, so that its start
  * address can be casted to `_unused_t *` safely. Just allocating an array of
  * (word sized) uintptr_t is a trivial way to do this */
 static uintptr_t _pktbuf_buf[CONFIG_GNRC_PKTBUF_SIZE / sizeof(uintptr_t)];
 static uint8_t *_pktbuf = (uint8_t *)_pktbuf_buf;
+/* first-fit arena, all of the packet buffer without size classes */
+static uint8_t *_arena = ((uint8_t *)_pktbuf_buf) + _ARENA_OFFSET;
 static _unused_t *_first_unused;
 
+static_assert(_ARENA_OFFSET + sizeof(_unused_t) <= sizeof(_pktbuf_buf),
+              "size classes leave no space for the packet buffer arena");
+
 #ifdef DEVELHELP
 /* maximum number of bytes allocated */
 static uint16_t max_byte_count = 0;
+/* number of allocations and failed allocations */
+static uint32_t _allocs = 0;
+static uint32_t _alloc_fails = 0;
+#endif
+
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+typedef struct _loan {
+    struct _loan *next;
+    uint8_t *data;                      /* lent data */
+    size_t size;                        /* size of the lent data */
+    size_t used;                        /* bytes of the data not released */
+    gnrc_pktbuf_release_cb_t release;   /* returns the data to its owner */
+    void *arg;                          /* argument of release */
+} _loan_t;
+
+/* Data outside of the packet buffer is lent, the loans are kept in the
+ * packet buffer itself */
+static _loan_t *_loans;
+#endif
+
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LATENCY
+/* time spent in _pktbuf_alloc() */
+static uint64_t _alloc_time_us = 0;
+static uint32_t _alloc_time_max_us = 0;
 #endif
 
 /* internal gnrc_pktbuf functions */
 static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, const void *data, size_t size,
                                     gnrc_nettype_t type);
 static void *_pktbuf_alloc(size_t size);
+static void *_arena_alloc(size_t size);
 static void _pktbuf_free(void *data, size_t size);
+static void _arena_free(void *data, size_t size);
 
 static inline bool _pktbuf_contains(void *ptr)
 {
     return (unsigned)((uint8_t *)ptr - _pktbuf) < CONFIG_GNRC_PKTBUF_SIZE;
 }
 
+/* data lent with gnrc_pktbuf_add_loan() */
+static inline bool _is_lent(void *ptr)
+{
+    return IS_USED(MODULE_GNRC_PKTBUF_STATIC_LOAN) && (ptr != NULL) &&
+           !_pktbuf_contains(ptr);
+}
+
 /* fits size to byte alignment */
 static inline size_t _align(size_t size)
 {
@@ -83,12 +169,98 @@ static inline void _set_pktsnip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *next,
 #endif
 }
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+static void _classes_init(void)
+{
+    uint8_t *start = _pktbuf;
+    unsigned first = 0;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_classes); i++) {
+        _class_t *class = &_classes[i];
+
+        class->free = NULL;
+        class->start = start;
+        class->first = first;
+        class->used = 0;
+        /* link the slots in address order */
+        for (unsigned j = class->numof; j > 0; j--) {
+            _unused_t *slot = (_unused_t *)(start + ((j - 1) * class->size));
+            slot->next = class->free;
+            class->free = slot;
+        }
+        start += class->size * class->numof;
+        first += class->numof;
+    }
+    memset(_slot_used, 0, sizeof(_slot_used));
+}
+
+static void *_class_alloc(size_t size)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_classes); i++) {
+        _class_t *class = &_classes[i];
+        _unused_t *slot = class->free;
+
+        if (size > class->size) {
+            continue;
+        }
+        if (slot == NULL) {
+            /* segregated: a full class doesn't take slots of a bigger one */
+#ifdef DEVELHELP
+            class->fallbacks++;
+#endif
+            return NULL;
+        }
+        class->free = slot->next;
+        class->used++;
+        _slot_used[class->first +
+                   (((uint8_t *)slot) - class->start) / class->size] = size;
+#ifdef DEVELHELP
+        class->allocs++;
+        if (class->used > class->peak) {
+            class->peak = class->used;
+        }
+#endif
+        return slot;
+    }
+    return NULL;
+}
+
+static void _class_free(void *data, size_t size)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_classes); i++) {
+        _class_t *class = &_classes[i];
+        unsigned offset = ((uint8_t *)data) - class->start;
+
+        if (offset >= (unsigned)(class->size * class->numof)) {
+            continue;
+        }
+        unsigned idx = offset / class->size;
+        size = _align(size);
+        assert(_slot_used[class->first + idx] >= size);
+        _slot_used[class->first + idx] -= size;
+        if (_slot_used[class->first + idx] == 0) {
+            _unused_t *slot = (_unused_t *)(class->start + (idx * class->size));
+            slot->next = class->free;
+            class->free = slot;
+            class->used--;
+        }
+        return;
+    }
+}
+#endif
+
 void gnrc_pktbuf_init(void)
 {
     mutex_lock(&_mutex);
-    _first_unused = (_unused_t *)_pktbuf_buf;
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+    _classes_init();
+#endif
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+    _loans = NULL;
+#endif
+    _first_unused = (_unused_t *)_arena;
     _first_unused->next = NULL;
-    _first_unused->size = sizeof(_pktbuf_buf);
+    _first_unused->size = sizeof(_pktbuf_buf) - _ARENA_OFFSET;
     mutex_unlock(&_mutex);
 }
 
@@ -108,6 +280,60 @@ gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, const void *data, size_t s
     return pkt;
 }
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+gnrc_pktsnip_t *gnrc_pktbuf_add_loan(gnrc_pktsnip_t *next, void *data,
+                                     size_t size, gnrc_nettype_t type,
+                                     gnrc_pktbuf_release_cb_t release,
+                                     void *arg)
+{
+    gnrc_pktsnip_t *pkt;
+    _loan_t *loan;
+
+    assert((data != NULL) && (size > 0) && !_pktbuf_contains(data));
+    mutex_lock(&_mutex);
+    pkt = _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+    loan = _pktbuf_alloc(sizeof(_loan_t));
+    if ((pkt == NULL) || (loan == NULL)) {
+        DEBUG("pktbuf: error allocating new packet snip for lent data\n");
+        _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
+        _pktbuf_free(loan, sizeof(_loan_t));
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    loan->data = data;
+    loan->size = size;
+    loan->used = size;
+    loan->release = release;
+    loan->arg = arg;
+    loan->next = _loans;
+    _loans = loan;
+    _set_pktsnip(pkt, next, data, size, type);
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+static void _loan_free(void *data, size_t size)
+{
+    for (_loan_t **ptr = &_loans; *ptr; ptr = &(*ptr)->next) {
+        _loan_t *loan = *ptr;
+
+        if ((size_t)((uint8_t *)data - loan->data) >= loan->size) {
+            continue;
+        }
+        /* lent data is split without regard to alignment, so it is
+         * accounted for byte by byte */
+        assert(loan->used >= size);
+        loan->used -= size;
+        if (loan->used == 0) {
+            *ptr = loan->next;
+            loan->release(loan->arg, loan->data);
+            _pktbuf_free(loan, sizeof(_loan_t));
+        }
+        return;
+    }
+}
+#endif
+
 gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
 {
     gnrc_pktsnip_t *marked_snip;
@@ -132,8 +358,9 @@ gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_
         return NULL;
     }
     /* marked data would not fit _unused_t marker => move data around to allow
-     * for proper free */
-    if ((pkt->size != size) && (size < required_new_size)) {
+     * for proper free, lent data is never freed into the packet buffer */
+    if ((pkt->size != size) && (size < required_new_size) &&
+        !_is_lent(pkt->data)) {
         void *new_data_rest;
         new_data_marked = _pktbuf_alloc(size);
         if (new_data_marked == NULL) {
@@ -176,7 +403,8 @@ int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
     mutex_lock(&_mutex);
     assert(pkt != NULL);
     assert(((pkt->size == 0) && (pkt->data == NULL)) ||
-           ((pkt->size > 0) && (pkt->data != NULL) && _pktbuf_contains(pkt->data)));
+           ((pkt->size > 0) && (pkt->data != NULL) &&
+            (_pktbuf_contains(pkt->data) || _is_lent(pkt->data))));
     /* new size and old size are equal */
     if (size == pkt->size) {
         /* nothing to do */
@@ -203,6 +431,9 @@ int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
         _pktbuf_free(pkt->data, pkt->size);
         pkt->data = new_data;
     }
+    else if (_is_lent(pkt->data)) {
+        _pktbuf_free(((uint8_t *)pkt->data) + size, pkt->size - size);
+    }
     else if (_align(pkt->size) > aligned_size) {
         _pktbuf_free(((uint8_t *)pkt->data) + aligned_size,
                      pkt->size - aligned_size);
@@ -299,18 +530,71 @@ static inline void _print_unused(_unused_t *ptr)
 }
 #endif
 
+static void _print_fragmentation(void)
+{
+    unsigned free = 0, largest = 0, holes = 0;
+
+    for (_unused_t *ptr = _first_unused; ptr; ptr = ptr->next) {
+        free += ptr->size;
+        holes++;
+        if (ptr->size > largest) {
+            largest = ptr->size;
+        }
+    }
+    /* share of the free bytes that the largest allocation can't use */
+    printf("  arena: %u bytes free in %u holes, largest: %u bytes, "
+           "fragmentation: %u%%\n", free, holes, largest,
+           free ? (unsigned)(100 - ((largest * 100U) / free)) : 0);
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+    for (unsigned i = 0; i < ARRAY_SIZE(_classes); i++) {
+        const _class_t *class = &_classes[i];
+        unsigned bytes = 0;
+
+        for (unsigned j = 0; j < class->numof; j++) {
+            bytes += _slot_used[class->first + j];
+        }
+        /* bytes of the used slots not taken by their allocation */
+        printf("  class %4u: %3u/%-3u slots used (peak %u), %" PRIu32
+               " allocations, %" PRIu32 " to the arena, %u bytes unused\n",
+               class->size, class->used, class->numof, class->peak,
+               class->allocs, class->fallbacks,
+               (class->used * class->size) - bytes);
+    }
+#endif
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+    unsigned loans = 0, lent = 0;
+
+    for (_loan_t *loan = _loans; loan; loan = loan->next) {
+        loans++;
+        lent += loan->used;
+    }
+    printf("  lent: %u bytes in %u loans\n", lent, loans);
+#endif
+    printf("  allocations: %" PRIu32 ", failed: %" PRIu32 "\n",
+           _allocs, _alloc_fails);
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LATENCY
+    printf("  allocation latency: %" PRIu32 " ns average, %" PRIu32
+           " us maximum\n",
+           _allocs ? (uint32_t)((_alloc_time_us * 1000) / _allocs) : 0,
+           _alloc_time_max_us);
+#endif
+}
+
 void gnrc_pktbuf_stats(void)
 {
+    mutex_lock(&_mutex);
+    printf("packet buffer: first byte: %p, last byte: %p (size: %u)\n",
+           (void *)&_pktbuf[0], (void *)&_pktbuf[CONFIG_GNRC_PKTBUF_SIZE], CONFIG_GNRC_PKTBUF_SIZE);
+    printf("  position of last byte used: %" PRIu16 "\n", max_byte_count);
+    _print_fragmentation();
+    mutex_unlock(&_mutex);
 #ifdef MODULE_OD
     _unused_t *ptr = _first_unused;
-    uint8_t *chunk = &_pktbuf[0];
+    uint8_t *chunk = _arena;
     int count = 0;
 
-    printf("packet buffer: first byte: %p, last byte: %p (size: %u)\n",
-           (void *)&_pktbuf[0], (void *)&_pktbuf[CONFIG_GNRC_PKTBUF_SIZE], CONFIG_GNRC_PKTBUF_SIZE);
-    printf("  position of last byte used: %" PRIu16 "\n", max_byte_count);
     if (ptr == NULL) {  /* packet buffer is completely full */
-        _print_chunk(chunk, CONFIG_GNRC_PKTBUF_SIZE, count++);
+        _print_chunk(chunk, CONFIG_GNRC_PKTBUF_SIZE - _ARENA_OFFSET, count++);
     }
 
     if (((void *)ptr) == ((void *)chunk)) { /* _first_unused is at the beginning */
@@ -336,7 +620,7 @@ void gnrc_pktbuf_stats(void)
         _print_chunk(chunk, &_pktbuf[CONFIG_GNRC_PKTBUF_SIZE] - chunk, count);
     }
 #else
-    DEBUG("pktbuf: needs od module\n");
+    DEBUG("pktbuf: chunk dump needs od module\n");
 #endif
 }
 #endif
@@ -344,8 +628,20 @@ void gnrc_pktbuf_stats(void)
 #ifdef TEST_SUITES
 bool gnrc_pktbuf_is_empty(void)
 {
-    return (_first_unused == (_unused_t *)_pktbuf) &&
-           (_first_unused->size == sizeof(_pktbuf_buf));
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+    if (_loans != NULL) {
+        return false;
+    }
+#endif
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+    for (unsigned i = 0; i < ARRAY_SIZE(_classes); i++) {
+        if (_classes[i].used) {
+            return false;
+        }
+    }
+#endif
+    return (_first_unused == (_unused_t *)_arena) &&
+           (_first_unused->size == sizeof(_pktbuf_buf) - _ARENA_OFFSET);
 }
 
 bool gnrc_pktbuf_is_sane(void)
@@ -355,14 +651,14 @@ bool gnrc_pktbuf_is_sane(void)
     /* Invariants of this implementation:
      *  - the head of _unused_t list is _first_unused
      *  - if _unused_t list is empty the packet buffer is full and _first_unused is NULL
-     *  - forall ptr_in _unused_t list: &_pktbuf[0] < ptr < &_pktbuf[CONFIG_GNRC_PKTBUF_SIZE]
+     *  - forall ptr_in _unused_t list: _arena <= ptr < &_pktbuf[CONFIG_GNRC_PKTBUF_SIZE]
      *  - forall ptr in _unused_t list: ptr->next == NULL || ptr < ptr->next
      *  - forall ptr in _unused_t list: (ptr->next != NULL && ptr->size <= (ptr->next - ptr)) ||
      *                                  (ptr->next == NULL && ptr->size == (CONFIG_GNRC_PKTBUF_SIZE - (ptr - &_pktbuf[0])))
      */
 
     while (ptr) {
-        if (&_pktbuf[0] >= (uint8_t *)ptr && (uint8_t *)ptr >= &_pktbuf[CONFIG_GNRC_PKTBUF_SIZE]) {
+        if (_arena > (uint8_t *)ptr || (uint8_t *)ptr >= &_pktbuf[CONFIG_GNRC_PKTBUF_SIZE]) {
             return false;
         }
         if ((ptr->next != NULL) && (ptr >= ptr->next)) {
@@ -407,9 +703,38 @@ static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, const void *data, size
 
 static void *_pktbuf_alloc(size_t size)
 {
-    _unused_t *prev = NULL, *ptr = _first_unused;
+    void *ptr = NULL;
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LATENCY
+    uint32_t start = xtimer_now_usec();
+#endif
 
     size = _align(size);
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+    ptr = _class_alloc(size);
+#endif
+    if (ptr == NULL) {
+        ptr = _arena_alloc(size);
+    }
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LATENCY
+    uint32_t time_us = xtimer_now_usec() - start;
+    _alloc_time_us += time_us;
+    if (time_us > _alloc_time_max_us) {
+        _alloc_time_max_us = time_us;
+    }
+#endif
+#ifdef DEVELHELP
+    _allocs++;
+    if (ptr == NULL) {
+        _alloc_fails++;
+    }
+#endif
+    return ptr;
+}
+
+static void *_arena_alloc(size_t size)
+{
+    _unused_t *prev = NULL, *ptr = _first_unused;
+
     while (ptr && (size > ptr->size)) {
         prev = ptr;
         ptr = ptr->next;
@@ -470,12 +795,26 @@ static inline _unused_t *_merge(_unused_t *a, _unused_t *b)
 
 static void _pktbuf_free(void *data, size_t size)
 {
-    size_t bytes_at_end;
-    _unused_t *new = (_unused_t *)data, *prev = NULL, *ptr = _first_unused;
-
     if (!_pktbuf_contains(data)) {
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+        _loan_free(data, size);
+#endif
+        return;
+    }
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+    if ((uint8_t *)data < _arena) {
+        _class_free(data, size);
         return;
     }
+#endif
+    _arena_free(data, size);
+}
+
+static void _arena_free(void *data, size_t size)
+{
+    size_t bytes_at_end;
+    _unused_t *new = (_unused_t *)data, *prev = NULL, *ptr = _first_unused;
+
     while (ptr && (((void *)ptr) < data)) {
         prev = ptr;
         ptr = ptr->next;
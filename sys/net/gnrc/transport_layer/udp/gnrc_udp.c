@@ -39,6 +39,13 @@
  */
 static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+/**
+ * @brief   Packets collected for the next layer
+ */
+static gnrc_netapi_batch_t _batch;
+#endif
+
 /**
  * @brief   Allocate memory for the UDP thread's stack
  */
@@ -225,13 +232,16 @@ static void *_event_loop(void *arg)
     (void)arg;
     msg_t msg, reply;
     msg_t msg_queue[GNRC_UDP_MSG_QUEUE_SIZE];
-    gnrc_netreg_entry_t netreg = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
-                                                            thread_getpid());
+    gnrc_netreg_entry_t netreg = GNRC_NETREG_ENTRY_INIT_BATCH(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                              thread_getpid());
     /* preset reply message */
     reply.type = GNRC_NETAPI_MSG_TYPE_ACK;
     reply.content.value = (uint32_t)-ENOTSUP;
     /* initialize message queue */
     msg_init_queue(msg_queue, GNRC_UDP_MSG_QUEUE_SIZE);
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    gnrc_netapi_batch_init(&_batch);
+#endif
     /* register UPD at netreg */
     gnrc_netreg_register(GNRC_NETTYPE_UDP, &netreg);
 
@@ -247,6 +257,15 @@ static void *_event_loop(void *arg)
                 DEBUG("udp: GNRC_NETAPI_MSG_TYPE_SND\n");
                 _send(msg.content.ptr);
                 break;
+#ifdef MODULE_GNRC_NETAPI_BATCH
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                DEBUG("udp: GNRC_NETAPI_MSG_TYPE_RCV_BATCH\n");
+                for (unsigned i = 0; i < gnrc_netapi_batch_numof(msg.content.ptr); i++) {
+                    _receive(gnrc_netapi_batch_get(msg.content.ptr, i));
+                }
+                gnrc_pktbuf_release(msg.content.ptr);
+                break;
+#endif
             case GNRC_NETAPI_MSG_TYPE_SET:
             case GNRC_NETAPI_MSG_TYPE_GET:
                 msg_reply(&msg, &reply);
@@ -255,6 +274,9 @@ static void *_event_loop(void *arg)
                 DEBUG("udp: received unidentified message\n");
                 break;
         }
+#ifdef MODULE_GNRC_NETAPI_BATCH
+        gnrc_netapi_batch_poll();
+#endif
     }
 
     /* never reached */
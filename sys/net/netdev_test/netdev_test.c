@@ -24,6 +24,10 @@ void netdev_test_reset(netdev_test_t *dev)
     mutex_lock(&dev->mutex);
     dev->send_cb = NULL;
     dev->recv_cb = NULL;
+#ifdef MODULE_NETDEV_RECV_LOAN
+    dev->recv_loan_cb = NULL;
+    dev->recv_release_cb = NULL;
+#endif
     dev->init_cb = NULL;
     dev->isr_cb = NULL;
     memset(dev->get_cbs, 0, sizeof(dev->get_cbs));
@@ -61,6 +65,36 @@ static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
     return res;
 }
 
+#ifdef MODULE_NETDEV_RECV_LOAN
+static int _recv_loan(netdev_t *netdev, void **buf, void *info)
+{
+    netdev_test_t *dev = (netdev_test_t *)netdev;
+    int res = -ENOBUFS;     /* nothing to lend, use _recv() */
+
+    mutex_lock(&dev->mutex);
+    if (dev->recv_loan_cb != NULL) {
+        /* could fire context change and call _recv_loan so we need to unlock */
+        mutex_unlock(&dev->mutex);
+        res = dev->recv_loan_cb(netdev, buf, info);
+    }
+    else {
+        mutex_unlock(&dev->mutex);
+    }
+    return res;
+}
+
+static void _recv_release(netdev_t *netdev, void *buf)
+{
+    netdev_test_t *dev = (netdev_test_t *)netdev;
+
+    mutex_lock(&dev->mutex);
+    if (dev->recv_release_cb != NULL) {
+        dev->recv_release_cb(netdev, buf);
+    }
+    mutex_unlock(&dev->mutex);
+}
+#endif
+
 static int _init(netdev_t *netdev)
 {
     netdev_test_t *dev = (netdev_test_t *)netdev;
@@ -117,6 +151,10 @@ static int _set(netdev_t *netdev, netopt_t opt, const void *value, size_t value_
 static const netdev_driver_t _driver = {
     .send   = _send,
     .recv   = _recv,
+#ifdef MODULE_NETDEV_RECV_LOAN
+    .recv_loan = _recv_loan,
+    .recv_release = _recv_release,
+#endif
     .init   = _init,
     .isr    = _isr,
     .get    = _get,
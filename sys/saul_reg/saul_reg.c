@@ -30,6 +30,8 @@
  */
 saul_reg_t *saul_reg = NULL;
 
+unsigned saul_reg_generation = 0;
+
 
 int saul_reg_add(saul_reg_t *dev)
 {
@@ -51,6 +53,7 @@ int saul_reg_add(saul_reg_t *dev)
         }
         tmp->next = dev;
     }
+    saul_reg_generation++;
     return 0;
 }
 
@@ -63,6 +66,7 @@ int saul_reg_rm(saul_reg_t *dev)
     }
     if (saul_reg == dev) {
         saul_reg = dev->next;
+        saul_reg_generation++;
         return 0;
     }
     while (tmp->next && (tmp->next != dev)) {
@@ -74,6 +78,7 @@ int saul_reg_rm(saul_reg_t *dev)
     else {
         return -ENODEV;
     }
+    saul_reg_generation++;
     return 0;
 }
 
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Manage bpf applications
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bpf.h"
+#include "bpf/mgmt.h"
+#include "kernel_defines.h"
+#ifdef MODULE_BPF_MAP
+#include "bpf/map.h"
+#endif
+
+static const char *_policies[] = {
+    [BPF_POLICY_CONTINUE] = "continue",
+    [BPF_POLICY_ABORT_ON_NEGATIVE] = "abort-neg",
+    [BPF_POLICY_ABORT_ON_POSITIVE] = "abort-pos",
+    [BPF_POLICY_SINGLE] = "single",
+};
+
+static int _usage(const char *cmd)
+{
+    printf("usage: %s list\n", cmd);
+#ifdef MODULE_VFS
+    printf("       %s load <file>\n", cmd);
+    printf("       %s verify <file>\n", cmd);
+#endif
+    printf("       %s unload <slot>\n", cmd);
+    printf("       %s attach <slot> <trigger> [continue|abort-neg|abort-pos|single]\n",
+           cmd);
+    printf("       %s detach <slot>\n", cmd);
+#ifdef MODULE_BPF_MAP
+    printf("       %s maps\n", cmd);
+#endif
+    return 1;
+}
+
+static int _result(int res)
+{
+    if (res < 0) {
+        printf("error: %d\n", res);
+        return 1;
+    }
+    puts("success");
+    return 0;
+}
+
+static void _list(void)
+{
+    puts("slot  size stack trigger policy    executions errors time_us");
+    for (unsigned i = 0; i < CONFIG_BPF_MGMT_SLOT_NUMOF; i++) {
+        const bpf_mgmt_slot_t *s = bpf_mgmt_get(i);
+        if (!s) {
+            continue;
+        }
+        printf("%4u %5u %5u ", i, (unsigned)s->application_len,
+               (unsigned)s->instance->program->stack_size);
+        if (s->trigger < 0) {
+            printf("%7s ", "-");
+        }
+        else {
+            printf("%7d ", s->trigger);
+        }
+        printf("%-9s %10" PRIu32 " %6" PRIu32, _policies[s->hook.policy],
+               s->hook.executions, s->hook.errors);
+#if CONFIG_BPF_HOOK_PROFILE
+        printf(" %7" PRIu32 "\n", s->hook.duration_us);
+#else
+        printf(" %7s\n", "-");
+#endif
+    }
+}
+
+#ifdef MODULE_BPF_MAP
+static void _maps(void)
+{
+    for (bpf_map_t *map = bpf_map_next(NULL); map; map = bpf_map_next(map)) {
+        if (map->type == BPF_MAP_TYPE_BLOOM) {
+            const bloom_t *bloom = &((bpf_map_bloom_t *)map)->bloom;
+            unsigned set = 0;
+            for (size_t i = 0; i < bloom->m; i++) {
+                set += (bloom->a[i / 8] >> (i % 8)) & 1;
+            }
+            printf("map %" PRIu32 ": bloom, %u of %u bits set\n", map->id,
+                   set, (unsigned)bloom->m);
+            continue;
+        }
+        const bpf_map_lpm_t *lpm = (bpf_map_lpm_t *)map;
+        printf("map %" PRIu32 ": lpm\n", map->id);
+        for (const bpf_map_lpm_node_t *node = bpf_map_lpm_next(lpm, NULL);
+                node; node = bpf_map_lpm_next(lpm, node)) {
+            char addr[IPV6_ADDR_MAX_STR_LEN];
+            printf("    %s/%u: %" PRIu32 "\n",
+                   ipv6_addr_to_str(addr, &node->prefix, sizeof(addr)),
+                   node->len, node->value);
+        }
+    }
+}
+#endif
+
+static int _policy(const char *name)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_policies); i++) {
+        if (strcmp(name, _policies[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int _bpf_handler(int argc, char **argv)
+{
+    if (argc < 2) {
+        return _usage(argv[0]);
+    }
+
+    if (strcmp(argv[1], "list") == 0) {
+        _list();
+        return 0;
+    }
+#ifdef MODULE_BPF_MAP
+    if (strcmp(argv[1], "maps") == 0) {
+        _maps();
+        return 0;
+    }
+#endif
+    if (argc < 3) {
+        return _usage(argv[0]);
+    }
+#ifdef MODULE_VFS
+    if (strcmp(argv[1], "load") == 0) {
+        int res = bpf_mgmt_load_file(argv[2]);
+        if (res >= 0) {
+            printf("loaded into slot %d\n", res);
+            return 0;
+        }
+        return _result(res);
+    }
+    if (strcmp(argv[1], "verify") == 0) {
+        int res = bpf_mgmt_verify_file(argv[2]);
+        if (res >= 0) {
+            printf("valid, %d bytes of stack\n", res);
+            return 0;
+        }
+        return _result(res);
+    }
+#endif
+
+    unsigned slot = atoi(argv[2]);
+    if (strcmp(argv[1], "unload") == 0) {
+        return _result(bpf_mgmt_unload(slot));
+    }
+    if (strcmp(argv[1], "detach") == 0) {
+        return _result(bpf_mgmt_detach(slot));
+    }
+    if ((strcmp(argv[1], "attach") == 0) && (argc >= 4)) {
+        int policy = (argc > 4) ? _policy(argv[4]) : BPF_POLICY_CONTINUE;
+        if (policy < 0) {
+            return _usage(argv[0]);
+        }
+        return _result(bpf_mgmt_attach(slot, atoi(argv[3]), policy));
+    }
+    return _usage(argv[0]);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Print the buffered output of bpf applications
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "bpf/log.h"
+
+int _bpf_log_handler(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    bpf_log_drain();
+    uint32_t dropped = bpf_log_dropped();
+    if (dropped) {
+        printf("bpflog: %" PRIu32 " records dropped\n", dropped);
+    }
+    return 0;
+}
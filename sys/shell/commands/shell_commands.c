@@ -26,6 +26,14 @@
 extern int _reboot_handler(int argc, char **argv);
 extern int _version_handler(int argc, char **argv);
 
+#ifdef MODULE_BPF_LOG
+extern int _bpf_log_handler(int argc, char **argv);
+#endif
+
+#ifdef MODULE_BPF_MGMT
+extern int _bpf_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_CONFIG
 extern int _id_handler(int argc, char **argv);
 #endif
@@ -198,6 +206,12 @@ const shell_command_t _shell_command_list[] = {
 #ifdef MODULE_USB_BOARD_RESET
     {"bootloader", "Reboot to bootloader", _bootloader_handler},
 #endif
+#ifdef MODULE_BPF_LOG
+    {"bpflog", "Prints the buffered bpf_printf output", _bpf_log_handler},
+#endif
+#ifdef MODULE_BPF_MGMT
+    {"bpf", "Manage bpf applications", _bpf_handler},
+#endif
 #ifdef MODULE_CONFIG
     {"id", "Gets or sets the node's id.", _id_handler},
 #endif
@@ -44,6 +44,7 @@
 #include "ztimer/periph_timer.h"
 #include "ztimer/periph_rtt.h"
 #include "ztimer/config.h"
+#include "ztimer/heap.h"
 
 #include "log.h"
 
@@ -140,6 +141,10 @@ void ztimer_init(void)
               CONFIG_ZTIMER_USEC_REQUIRED_PM_MODE);
     ZTIMER_USEC->required_pm_mode = CONFIG_ZTIMER_USEC_REQUIRED_PM_MODE;
 #  endif
+#  if MODULE_ZTIMER_HEAP && CONFIG_ZTIMER_USEC_HEAP
+    LOG_DEBUG("ztimer_init(): ZTIMER_USEC keeping timers in a heap\n");
+    ztimer_heap_init(ZTIMER_USEC);
+#  endif
 #endif
 
 #ifdef ZTIMER_RTT_INIT
@@ -165,5 +170,9 @@ void ztimer_init(void)
               CONFIG_ZTIMER_MSEC_REQUIRED_PM_MODE);
     ZTIMER_MSEC->required_pm_mode = CONFIG_ZTIMER_MSEC_REQUIRED_PM_MODE;
 #  endif
+#  if MODULE_ZTIMER_HEAP && CONFIG_ZTIMER_MSEC_HEAP
+    LOG_DEBUG("ztimer_init(): ZTIMER_MSEC keeping timers in a heap\n");
+    ztimer_heap_init(ZTIMER_MSEC);
+#  endif
 #endif
 }
@@ -31,10 +31,15 @@
 #include "pm_layered.h"
 #endif
 #include "ztimer.h"
+#ifdef MODULE_ZTIMER_HEAP
+#include "ztimer/heap.h"
+#endif
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+static void _add_entry(ztimer_clock_t *clock, ztimer_base_t *entry);
+static void _del_entry(ztimer_clock_t *clock, ztimer_base_t *entry);
 static void _add_entry_to_list(ztimer_clock_t *clock, ztimer_base_t *entry);
 static void _del_entry_from_list(ztimer_clock_t *clock, ztimer_base_t *entry);
 static void _ztimer_update(ztimer_clock_t *clock);
@@ -49,6 +54,14 @@ static inline uint32_t _min_u32(uint32_t a, uint32_t b)
 
 static unsigned _is_set(const ztimer_clock_t *clock, const ztimer_t *t)
 {
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap) {
+        if (!clock->heap && !clock->list.next) {
+            return 0;
+        }
+        return t->base.heap_state != ZTIMER_HEAP_UNSET;
+    }
+#endif
     if (!clock->list.next) {
         return 0;
     }
@@ -57,13 +70,54 @@ static unsigned _is_set(const ztimer_clock_t *clock, const ztimer_t *t)
     }
 }
 
+/* Expired timers are at the head of the list, on a heap clock the heap holds
+ * the ones that haven't expired yet */
+static ztimer_base_t *_first(const ztimer_clock_t *clock)
+{
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap && !clock->list.next) {
+        return clock->heap;
+    }
+#endif
+    return clock->list.next;
+}
+
+/* Ticks from the clock's base until the first timer expires */
+static uint32_t _first_offset(const ztimer_clock_t *clock)
+{
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap && !clock->list.next) {
+        return clock->heap->offset - clock->list.offset;
+    }
+#endif
+    return clock->list.next->offset;
+}
+
+static inline unsigned _is_empty(const ztimer_clock_t *clock)
+{
+    return _first(clock) == NULL;
+}
+
+/* Moves the clock's base to the target of the first timer */
+static void _advance_to_first(ztimer_clock_t *clock)
+{
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap) {
+        ztimer_heap_advance(clock, _first_offset(clock));
+        return;
+    }
+#endif
+    clock->list.offset += clock->list.next->offset;
+    clock->list.next->offset = 0;
+}
+
 void ztimer_remove(ztimer_clock_t *clock, ztimer_t *timer)
 {
     unsigned state = irq_disable();
 
     if (_is_set(clock, timer)) {
         ztimer_update_head_offset(clock);
-        _del_entry_from_list(clock, &timer->base);
+        _del_entry(clock, &timer->base);
 
         _ztimer_update(clock);
     }
@@ -79,8 +133,9 @@ void ztimer_set(ztimer_clock_t *clock, ztimer_t *timer, uint32_t val)
     unsigned state = irq_disable();
 
     ztimer_update_head_offset(clock);
+    unsigned was_first = (_first(clock) == &timer->base);
     if (_is_set(clock, timer)) {
-        _del_entry_from_list(clock, &timer->base);
+        _del_entry(clock, &timer->base);
     }
 
     /* optionally subtract a configurable adjustment value */
@@ -92,8 +147,8 @@ void ztimer_set(ztimer_clock_t *clock, ztimer_t *timer, uint32_t val)
     }
 
     timer->base.offset = val;
-    _add_entry_to_list(clock, &timer->base);
-    if (clock->list.next == &timer->base) {
+    _add_entry(clock, &timer->base);
+    if (_first(clock) == &timer->base) {
 #ifdef MODULE_ZTIMER_EXTEND
         if (clock->max_value < UINT32_MAX) {
             val = _min_u32(val, clock->max_value >> 1);
@@ -102,23 +157,61 @@ void ztimer_set(ztimer_clock_t *clock, ztimer_t *timer, uint32_t val)
 #endif
         clock->ops->set(clock, val);
     }
+    else if (was_first) {
+        /* the alarm is still set for the previous target of this timer */
+        _ztimer_update(clock);
+    }
 
     irq_restore(state);
 }
 
-static void _add_entry_to_list(ztimer_clock_t *clock, ztimer_base_t *entry)
+static void _add_entry(ztimer_clock_t *clock, ztimer_base_t *entry)
 {
-    uint32_t delta_sum = 0;
+#ifdef MODULE_PM_LAYERED
+    /* First timer on the clock */
+    if (_is_empty(clock) &&
+        clock->required_pm_mode != ZTIMER_CLOCK_NO_REQUIRED_PM_MODE) {
+        pm_block(clock->required_pm_mode);
+    }
+#endif
 
-    ztimer_base_t *list = &clock->list;
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap) {
+        ztimer_heap_add(clock, entry);
+        return;
+    }
+#endif
+    _add_entry_to_list(clock, entry);
+}
+
+static void _del_entry(ztimer_clock_t *clock, ztimer_base_t *entry)
+{
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap && !ztimer_heap_is_due(entry)) {
+        ztimer_heap_remove(clock, entry);
+    }
+    else {
+        _del_entry_from_list(clock, entry);
+        entry->heap_state = ZTIMER_HEAP_UNSET;
+    }
+#else
+    _del_entry_from_list(clock, entry);
+#endif
 
 #ifdef MODULE_PM_LAYERED
-    /* First timer on the clock's linked list */
-    if (list->next == NULL &&
+    /* The last timer just got removed from the clock */
+    if (_is_empty(clock) &&
         clock->required_pm_mode != ZTIMER_CLOCK_NO_REQUIRED_PM_MODE) {
-        pm_block(clock->required_pm_mode);
+        pm_unblock(clock->required_pm_mode);
     }
 #endif
+}
+
+static void _add_entry_to_list(ztimer_clock_t *clock, ztimer_base_t *entry)
+{
+    uint32_t delta_sum = 0;
+
+    ztimer_base_t *list = &clock->list;
 
     /* Jump past all entries which are set to an earlier target than the new entry */
     while (list->next) {
@@ -179,6 +272,13 @@ void ztimer_update_head_offset(ztimer_clock_t *clock)
     uint32_t now = ztimer_now(clock);
     uint32_t diff = now - old_base;
 
+#ifdef MODULE_ZTIMER_HEAP
+    if (clock->use_heap) {
+        ztimer_heap_advance(clock, diff);
+        return;
+    }
+#endif
+
     ztimer_base_t *entry = clock->list.next;
 
     DEBUG(
@@ -243,14 +343,6 @@ static void _del_entry_from_list(ztimer_clock_t *clock, ztimer_base_t *entry)
         }
         list = list->next;
     }
-
-#ifdef MODULE_PM_LAYERED
-    /* The last timer just got removed from the clock's linked list */
-    if (clock->list.next == NULL &&
-        clock->required_pm_mode != ZTIMER_CLOCK_NO_REQUIRED_PM_MODE) {
-        pm_unblock(clock->required_pm_mode);
-    }
-#endif
 }
 
 static ztimer_t *_now_next(ztimer_clock_t *clock)
@@ -259,11 +351,15 @@ static ztimer_t *_now_next(ztimer_clock_t *clock)
 
     if (entry && (entry->offset == 0)) {
         clock->list.next = entry->next;
+#ifdef MODULE_ZTIMER_HEAP
+        entry->heap_state = ZTIMER_HEAP_UNSET;
+#endif
         if (!entry->next) {
             /* The last timer just got removed from the clock's linked list */
             clock->last = NULL;
 #ifdef MODULE_PM_LAYERED
-            if (clock->required_pm_mode != ZTIMER_CLOCK_NO_REQUIRED_PM_MODE) {
+            if (_is_empty(clock) &&
+                clock->required_pm_mode != ZTIMER_CLOCK_NO_REQUIRED_PM_MODE) {
                 pm_unblock(clock->required_pm_mode);
             }
 #endif
@@ -279,9 +375,9 @@ static void _ztimer_update(ztimer_clock_t *clock)
 {
 #ifdef MODULE_ZTIMER_EXTEND
     if (clock->max_value < UINT32_MAX) {
-        if (clock->list.next) {
+        if (_first(clock)) {
             clock->ops->set(clock,
-                            _min_u32(clock->list.next->offset,
+                            _min_u32(_first_offset(clock),
                                      clock->max_value >> 1));
         }
         else {
@@ -292,8 +388,8 @@ static void _ztimer_update(ztimer_clock_t *clock)
 #endif
     }
     else {
-        if (clock->list.next) {
-            clock->ops->set(clock, clock->list.next->offset);
+        if (_first(clock)) {
+            clock->ops->set(clock, _first_offset(clock));
         }
         else {
             if (IS_USED(MODULE_ZTIMER_NOW64)) {
@@ -320,8 +416,8 @@ void ztimer_handler(ztimer_clock_t *clock)
         /* calling now triggers checkpointing */
         uint32_t now = ztimer_now(clock);
 
-        if (clock->list.next) {
-            uint32_t target = clock->list.offset + clock->list.next->offset;
+        if (_first(clock)) {
+            uint32_t target = clock->list.offset + _first_offset(clock);
             int32_t diff = (int32_t)(target - now);
             if (diff > 0) {
                 DEBUG("ztimer_handler(): %p postponing by %" PRIi32 "\n",
@@ -345,8 +441,7 @@ void ztimer_handler(ztimer_clock_t *clock)
     }
 #endif
 
-    clock->list.offset += clock->list.next->offset;
-    clock->list.next->offset = 0;
+    _advance_to_first(clock);
 
     ztimer_t *entry = _now_next(clock);
     while (entry) {
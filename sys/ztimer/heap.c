@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for more
+ * details.
+ */
+
+/**
+ * @ingroup     sys_ztimer_heap
+ * @{
+ *
+ * @file
+ * @brief       ztimer leftist heap backend implementation
+ *
+ * Timers in the heap store their absolute target in @ref ztimer_base_t::offset.
+ * Every target lies at or after the clock's base (`clock->list.offset`), so
+ * targets compare by their distance from the base, across counter wraps.
+ * @ref ztimer_heap_advance moves timers out of the heap before the base
+ * passes them.
+ *
+ * Heap links: `child` points to the left child, `next` to the right child and
+ * `prev` to the parent. The root's `prev` points to the clock's list head.
+ * `heap_rank` is the length of the right spine of a timer's subtree. The left
+ * child never has a lower rank than the right one, so the right spine of a
+ * heap of n timers is at most log2(n + 1) timers long. Melding walks the
+ * right spines only. Whether a timer is in the heap, expired or not set is
+ * kept in @ref ztimer_base_t::heap_state.
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "ztimer.h"
+#include "ztimer/heap.h"
+
+static inline uint32_t _key(const ztimer_clock_t *clock,
+                            const ztimer_base_t *entry)
+{
+    return entry->offset - clock->list.offset;
+}
+
+static inline unsigned _rank(const ztimer_base_t *entry)
+{
+    return entry ? entry->heap_rank : 0;
+}
+
+/* Restores the rank of a timer after one of its subtrees changed, swapping
+ * them if the right one became the higher one */
+static void _fix_rank(ztimer_base_t *entry)
+{
+    if (_rank(entry->child) < _rank(entry->next)) {
+        ztimer_base_t *tmp = entry->child;
+        entry->child = entry->next;
+        entry->next = tmp;
+    }
+    entry->heap_rank = _rank(entry->next) + 1;
+}
+
+/* Melds two detached trees along their right spines */
+static ztimer_base_t *_meld(const ztimer_clock_t *clock, ztimer_base_t *a,
+                            ztimer_base_t *b)
+{
+    if (!a) {
+        return b;
+    }
+    if (!b) {
+        return a;
+    }
+    if (_key(clock, b) < _key(clock, a)) {
+        ztimer_base_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    /* a expires no later than b, walk down the right spine of a until b
+     * fits in, then continue with the part of the spine b displaced */
+    ztimer_base_t *root = a;
+    while (b) {
+        ztimer_base_t *right = a->next;
+        if (!right || (_key(clock, b) < _key(clock, right))) {
+            a->next = b;
+            b->prev = a;
+            b = right;
+        }
+        a = a->next;
+    }
+
+    /* ranks changed along the merged spine only */
+    for (;;) {
+        _fix_rank(a);
+        if (a == root) {
+            break;
+        }
+        a = a->prev;
+    }
+    return root;
+}
+
+/* Melds the subtrees of a timer that leaves the heap */
+static ztimer_base_t *_meld_children(const ztimer_clock_t *clock,
+                                     ztimer_base_t *entry)
+{
+    ztimer_base_t *left = entry->child;
+    ztimer_base_t *right = entry->next;
+
+    if (left) {
+        left->prev = NULL;
+    }
+    if (right) {
+        right->prev = NULL;
+    }
+    return _meld(clock, left, right);
+}
+
+static void _set_root(ztimer_clock_t *clock, ztimer_base_t *root)
+{
+    clock->heap = root;
+    if (root) {
+        root->prev = &clock->list;
+    }
+}
+
+void ztimer_heap_init(ztimer_clock_t *clock)
+{
+    assert(!clock->list.next);
+    clock->heap = NULL;
+    clock->use_heap = 1;
+}
+
+void ztimer_heap_add(ztimer_clock_t *clock, ztimer_base_t *entry)
+{
+    entry->offset += clock->list.offset;
+    entry->child = NULL;
+    entry->next = NULL;
+    entry->heap_rank = 1;
+    entry->heap_state = ZTIMER_HEAP_QUEUED;
+    _set_root(clock, _meld(clock, clock->heap, entry));
+}
+
+void ztimer_heap_remove(ztimer_clock_t *clock, ztimer_base_t *entry)
+{
+    assert(entry->heap_state == ZTIMER_HEAP_QUEUED);
+
+    ztimer_base_t *children = _meld_children(clock, entry);
+    if (entry == clock->heap) {
+        _set_root(clock, children);
+    }
+    else {
+        ztimer_base_t *parent = entry->prev;
+        if (parent->child == entry) {
+            parent->child = children;
+        }
+        else {
+            parent->next = children;
+        }
+        if (children) {
+            children->prev = parent;
+        }
+        /* the rank can only change up to the root, and stops changing
+         * within log2(n + 1) timers */
+        for (;;) {
+            unsigned rank = parent->heap_rank;
+            _fix_rank(parent);
+            if ((parent->heap_rank == rank) || (parent == clock->heap)) {
+                break;
+            }
+            parent = parent->prev;
+        }
+    }
+    entry->next = NULL;
+    entry->child = NULL;
+    entry->prev = NULL;
+    entry->heap_state = ZTIMER_HEAP_UNSET;
+}
+
+void ztimer_heap_advance(ztimer_clock_t *clock, uint32_t diff)
+{
+    while (clock->heap && (_key(clock, clock->heap) <= diff)) {
+        ztimer_base_t *entry = clock->heap;
+        _set_root(clock, _meld_children(clock, entry));
+
+        /* Append to the expired timers, which the core handles as a list */
+        entry->next = NULL;
+        entry->child = NULL;
+        entry->prev = NULL;
+        entry->heap_state = ZTIMER_HEAP_DUE;
+        entry->offset = 0;
+        if (clock->last) {
+            clock->last->next = entry;
+        }
+        else {
+            clock->list.next = entry;
+        }
+        clock->last = entry;
+    }
+    clock->list.offset += diff;
+}
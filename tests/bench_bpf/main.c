@@ -23,10 +23,15 @@
 #include <stdint.h>
 #include "bpf.h"
 #include "bpf/shared.h"
+#include "bpf/instruction.h"
+#include "checksum/fletcher32.h"
 #include "embUnit.h"
+#include "macros/units.h"
+#include "timex.h"
 #include "xtimer.h"
 
 #include "fletcher32_bpf.h"
+#include "bpf_aot/fletcher32_bpf.h"
 
 static const unsigned char wrap_around_data[] =
         "AD3Awn4kb6FtcsyE0RU25U7f55Yncn3LP3oEx9Gl4qr7iDW7I8L6Pbw9jNnh0sE4DmCKuc"
@@ -38,16 +43,127 @@ static const unsigned char wrap_around_data[] =
 
 static uint8_t _bpf_stack[512];
 
+/* fletcher32 on the native bpf_fletcher32 helper */
+static const uint8_t fletcher32_helper[] = {
+    0x61, 0x12, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = *(u32 *)(r1 + 8) */
+    0x79, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = *(u64 *)(r1 + 0) */
+    0x85, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, /* call bpf_fletcher32 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
 typedef struct {
     __bpf_shared_ptr(const uint16_t *, data);
     uint32_t words;
 } fletcher32_ctx_t;
 
+#define OPCODE_LOOPS        (1000U)
+#define OPCODE_COPIES       (16U)
+
+typedef struct {
+    const char *name;
+    bpf_instruction_t instr;
+} _opcode_t;
+
+/* r2 and r3 are operands, r1 counts the loop iterations */
+static const _opcode_t _opcodes[] = {
+    { "add64 reg", { .opcode = 0x0f, .dst = 3, .src = 2 } },
+    { "mov64 imm", { .opcode = 0xb7, .dst = 3, .immediate = 42 } },
+    { "lsh64 imm", { .opcode = 0x67, .dst = 3, .immediate = 3 } },
+    { "arsh64 reg", { .opcode = 0xcf, .dst = 3, .src = 2 } },
+    { "xor64 reg", { .opcode = 0xaf, .dst = 3, .src = 2 } },
+    { "mul64 reg", { .opcode = 0x2f, .dst = 3, .src = 2 } },
+    { "jeq imm", { .opcode = 0x15, .dst = 2, .immediate = 0 } },
+    { "ldxdw", { .opcode = 0x79, .dst = 3, .src = 10, .offset = -8 } },
+    { "stxdw", { .opcode = 0x7b, .dst = 10, .src = 2, .offset = -8 } },
+};
+
+/* Word aligned, like applications loaded from flash */
+static uint64_t _opcode_app[4 + OPCODE_COPIES + 4];
+
+static uint32_t _opcode_loop(const bpf_instruction_t *op, unsigned copies)
+{
+    bpf_instruction_t *app = (bpf_instruction_t*)_opcode_app;
+    unsigned len = 0;
+
+    app[len++] = (bpf_instruction_t){ .opcode = 0xb7, .dst = 1,
+                                      .immediate = OPCODE_LOOPS };
+    app[len++] = (bpf_instruction_t){ .opcode = 0xb7, .dst = 2, .immediate = 3 };
+    app[len++] = (bpf_instruction_t){ .opcode = 0xb7, .dst = 3, .immediate = 5 };
+    for (unsigned i = 0; i < copies; i++) {
+        app[len++] = *op;
+    }
+    app[len++] = (bpf_instruction_t){ .opcode = 0x07, .dst = 1, .immediate = -1 };
+    app[len] = (bpf_instruction_t){ .opcode = 0x55, .dst = 1,
+                                    .offset = -(int16_t)(copies + 2) };
+    len++;
+    app[len++] = (bpf_instruction_t){ .opcode = 0xb7, .dst = 0 };
+    app[len++] = (bpf_instruction_t){ .opcode = 0x95 };
+
+    bpf_t bpf = {
+        .application = (const uint8_t*)_opcode_app,
+        .application_len = len * sizeof(bpf_instruction_t),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_setup(&bpf);
+
+    int64_t result = -1;
+    uint32_t start = xtimer_now_usec();
+    int res = bpf_execute(&bpf, NULL, 0, &result);
+    uint32_t stop = xtimer_now_usec();
+
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(0, (int)result);
+    return stop - start;
+}
+
+static void tests_bpf_opcodes(void)
+{
+    /* The loop overhead is measured separately and subtracted */
+    uint32_t base = _opcode_loop(&_opcodes[0].instr, 0);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_opcodes); i++) {
+        uint32_t duration = _opcode_loop(&_opcodes[i].instr, OPCODE_COPIES) - base;
+        uint32_t ns = (uint64_t)duration * NS_PER_US /
+                      (OPCODE_LOOPS * OPCODE_COPIES);
+#ifdef CLOCK_CORECLOCK
+        printf("%-12s %4"PRIu32" ns/op, %3"PRIu32" cycles/op\n", _opcodes[i].name,
+               ns, (uint32_t)((uint64_t)duration * (CLOCK_CORECLOCK / KHZ(1)) /
+                              (OPCODE_LOOPS * OPCODE_COPIES * US_PER_MS)));
+#else
+        printf("%-12s %4"PRIu32" ns/op\n", _opcodes[i].name, ns);
+#endif
+    }
+}
+
 static void _init(void)
 {
     bpf_init();
 }
 
+/* Result of a single interpreter run, the other variants must match it */
+static uint32_t _interpreted(void)
+{
+    fletcher32_ctx_t ctx = {
+        .data = (const uint16_t*)wrap_around_data,
+        .words = sizeof(wrap_around_data)/2,
+    };
+    bpf_t bpf = {
+        .application = bpf_fletcher32_bpf_bin,
+        .application_len = sizeof(bpf_fletcher32_bpf_bin),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_mem_region_t region;
+    bpf_setup(&bpf);
+
+    bpf_add_region(&bpf, &region,
+                   (void*)wrap_around_data, sizeof(wrap_around_data), BPF_MEM_REGION_READ);
+    int64_t result = 0;
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, &ctx, sizeof(ctx), &result));
+    return (uint32_t)result;
+}
+
 static void tests_bpf_run1(void)
 {
     fletcher32_ctx_t ctx = {
@@ -75,15 +191,87 @@ static void tests_bpf_run1(void)
     uint32_t stop = xtimer_now_usec();
 
     TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(fletcher32((const uint16_t*)wrap_around_data,
+                                     sizeof(wrap_around_data)/2),
+                          (uint32_t)result);
     printf("Result: %"PRIx32"\n", (uint32_t)result);
     printf("duration: %"PRIu32" us -> %"PRIu32" us/exec\n",
            (stop - start), (stop - start)/1000);
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    printf("instructions: %"PRIu32"\n", bpf.instruction_count);
+#endif
+}
+
+static void tests_bpf_aot(void)
+{
+    fletcher32_ctx_t ctx = {
+        .data = (const uint16_t*)wrap_around_data,
+        .words = sizeof(wrap_around_data)/2,
+    };
+    bpf_t bpf = {
+        .native = bpf_aot_fletcher32_bpf,
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_mem_region_t region;
+    bpf_setup(&bpf);
+
+    bpf_add_region(&bpf, &region,
+                   (void*)wrap_around_data, sizeof(wrap_around_data), BPF_MEM_REGION_READ);
+    int64_t result = 0;
+    uint32_t start = xtimer_now_usec();
+    int res = 0;
+    for (unsigned i = 0; i < 1000; i++) {
+        res = bpf_execute(&bpf, &ctx, sizeof(ctx), &result);
+    }
+    uint32_t stop = xtimer_now_usec();
+
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(_interpreted(), (uint32_t)result);
+    printf("AOT result: %"PRIx32"\n", (uint32_t)result);
+    printf("AOT duration: %"PRIu32" us -> %"PRIu32" us/exec\n",
+           (stop - start), (stop - start)/1000);
+}
+
+static void tests_bpf_helper(void)
+{
+    fletcher32_ctx_t ctx = {
+        .data = (const uint16_t*)wrap_around_data,
+        .words = sizeof(wrap_around_data)/2,
+    };
+    bpf_t bpf = {
+        .application = fletcher32_helper,
+        .application_len = sizeof(fletcher32_helper),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_mem_region_t region;
+    bpf_setup(&bpf);
+
+    bpf_add_region(&bpf, &region,
+                   (void*)wrap_around_data, sizeof(wrap_around_data), BPF_MEM_REGION_READ);
+    int64_t result = 0;
+    uint32_t start = xtimer_now_usec();
+    int res = 0;
+    for (unsigned i = 0; i < 1000; i++) {
+        res = bpf_execute(&bpf, &ctx, sizeof(ctx), &result);
+    }
+    uint32_t stop = xtimer_now_usec();
+
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(_interpreted(), (uint32_t)result);
+    printf("Helper result: %"PRIx32"\n", (uint32_t)result);
+    printf("Helper duration: %"PRIu32" us -> %"PRIu32" us/exec\n",
+           (stop - start), (stop - start)/1000);
 }
 
 Test *tests_bpf(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
         new_TestFixture(tests_bpf_run1),
+        new_TestFixture(tests_bpf_aot),
+        new_TestFixture(tests_bpf_helper),
+        new_TestFixture(tests_bpf_opcodes),
     };
 
     EMB_UNIT_TESTCALLER(bpf_tests, _init, NULL, fixtures);
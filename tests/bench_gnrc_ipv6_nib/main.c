@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Latency of neighbor cache and forwarding table operations of
+ *              the NIB for different numbers of entries
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "kernel_defines.h"
+#include "net/gnrc/ipv6/nib/ft.h"
+#include "net/ipv6/addr.h"
+#include "xtimer.h"
+
+#include "_nib-internal.h"
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS          (16U)
+#endif
+
+#define BENCH_IFACE         (1U)
+
+static const unsigned _sizes[] = { 16, 128, 512 };
+
+static _nib_onl_entry_t *_nodes[CONFIG_GNRC_IPV6_NIB_NUMOF];
+static _nib_offl_entry_t *_dsts[CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF];
+
+static const ipv6_addr_t _next_hop = { .u8 = {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1
+    } };
+
+/* Neighbors are link-local addresses differing in their last bytes */
+static void _neighbor(ipv6_addr_t *addr, unsigned i)
+{
+    ipv6_addr_set_link_local_prefix(addr);
+    addr->u32[2].u32 = 0;
+    addr->u32[3] = byteorder_htonl(0x02000000 + i);
+}
+
+/* Destinations are /64 prefixes, spread over the second and fourth 16 bit
+ * word so that they share prefixes of different lengths */
+static void _destination(ipv6_addr_t *addr, unsigned i)
+{
+    ipv6_addr_from_str(addr, "2001:db8::");
+    addr->u16[2] = byteorder_htons(i & 0x7);
+    addr->u16[3] = byteorder_htons(i * 0x9e37);
+}
+
+/* Hundredths of microseconds per operation */
+static unsigned _per_op(uint32_t duration, unsigned ops)
+{
+    return (unsigned)(((uint64_t)duration * 100) / ops);
+}
+
+static void _print(const char *table, unsigned entries, unsigned add,
+                   unsigned get, unsigned del)
+{
+    printf("%s %u: add %u.%02u us, get %u.%02u us, del %u.%02u us\n",
+           table, entries, add / 100, add % 100, get / 100, get % 100,
+           del / 100, del % 100);
+}
+
+static void _bench_nc(unsigned entries)
+{
+    ipv6_addr_t addr;
+    uint32_t add, get, del, start;
+
+    _nib_acquire();
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < entries; i++) {
+        _neighbor(&addr, i);
+        _nodes[i] = _nib_nc_add(&addr, BENCH_IFACE,
+                                GNRC_IPV6_NIB_NC_INFO_NUD_STATE_UNMANAGED);
+    }
+    add = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned run = 0; run < BENCH_RUNS; run++) {
+        for (unsigned i = 0; i < entries; i++) {
+            _neighbor(&addr, i);
+            if (_nib_onl_get(&addr, BENCH_IFACE) != _nodes[i]) {
+                printf("nc %u: lookup of entry %u failed\n", entries, i);
+            }
+        }
+    }
+    get = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < entries; i++) {
+        _nib_nc_remove(_nodes[i]);
+    }
+    del = xtimer_now_usec() - start;
+    _nib_release();
+
+    _print("nc", entries, _per_op(add, entries),
+           _per_op(get, entries * BENCH_RUNS), _per_op(del, entries));
+}
+
+static void _bench_ft(unsigned entries)
+{
+    ipv6_addr_t addr;
+    gnrc_ipv6_nib_ft_t fte;
+    uint32_t add, get, del, start;
+
+    _nib_acquire();
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < entries; i++) {
+        _destination(&addr, i);
+        _dsts[i] = _nib_ft_add(&_next_hop, BENCH_IFACE, &addr, 64);
+    }
+    add = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned run = 0; run < BENCH_RUNS; run++) {
+        for (unsigned i = 0; i < entries; i++) {
+            _destination(&addr, i);
+            addr.u32[3] = byteorder_htonl(run + 1);
+            if ((_nib_get_route(&addr, NULL, &fte) < 0) ||
+                (fte.dst_len != 64)) {
+                printf("ft %u: lookup of entry %u failed\n", entries, i);
+            }
+        }
+    }
+    get = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < entries; i++) {
+        _nib_ft_remove(_dsts[i]);
+    }
+    del = xtimer_now_usec() - start;
+    _nib_release();
+
+    _print("ft", entries, _per_op(add, entries),
+           _per_op(get, entries * BENCH_RUNS), _per_op(del, entries));
+}
+
+int main(void)
+{
+    unsigned max = (CONFIG_GNRC_IPV6_NIB_NUMOF < CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF)
+                 ? CONFIG_GNRC_IPV6_NIB_NUMOF : CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF;
+
+    printf("gnrc_ipv6_nib benchmark, index %s, up to %u entries\n",
+           IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_NC_HASH) ? "on" : "off", max);
+    for (unsigned i = 0; (i < ARRAY_SIZE(_sizes)) && (_sizes[i] <= max); i++) {
+        _bench_nc(_sizes[i]);
+    }
+    for (unsigned i = 0; (i < ARRAY_SIZE(_sizes)) && (_sizes[i] <= max); i++) {
+        _bench_ft(_sizes[i]);
+    }
+    puts("DONE");
+
+    return 0;
+}
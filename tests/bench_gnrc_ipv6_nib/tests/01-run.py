@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2020 Inria
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    child.expect(r"gnrc_ipv6_nib benchmark, index (on|off), up to (\d+) entries")
+    numof = int(child.match.group(2))
+    for table in ("nc", "ft"):
+        for entries in (16, 128, 512):
+            if entries > numof:
+                continue
+            child.expect(r"{} {}: add \d+\.\d+ us, get \d+\.\d+ us, "
+                         r"del \d+\.\d+ us".format(table, entries))
+    child.expect_exact("DONE")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc, timeout=120))
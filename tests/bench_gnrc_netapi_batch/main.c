@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Context switches per packet passed through network layers
+ *              with gnrc_netapi
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "kernel_defines.h"
+#include "msg.h"
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netreg.h"
+#include "net/gnrc/pktbuf.h"
+#include "schedstatistics.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#ifndef BENCH_PKTS
+#define BENCH_PKTS          (256U)
+#endif
+
+/* Time between two single received packets */
+#ifndef BENCH_RX_GAP_US
+#define BENCH_RX_GAP_US     (200U)
+#endif
+
+/* Packets received or sent back to back, then the source waits */
+#ifndef BENCH_BURST
+#define BENCH_BURST         (8U)
+#endif
+
+#ifndef BENCH_BURST_GAP_US
+#define BENCH_BURST_GAP_US  (5000U)
+#endif
+
+/* Layers a packet passes before it reaches the sink */
+#define BENCH_LAYERS        (3U)
+#define BENCH_MSG_QUEUE     (16U)
+
+#define BENCH_MSG_DONE      (0x4242)
+
+/* Demux contexts of the first layer of a chain */
+#define BENCH_RX            (0U)
+#define BENCH_TX            (16U)
+
+typedef struct {
+#if IS_USED(MODULE_GNRC_NETAPI_BATCH)
+    gnrc_netapi_batch_t batch;
+#endif
+    uint32_t demux_ctx;
+    unsigned count;             /* packets received by the sink */
+    uint64_t latency;           /* sum of the latencies seen by the sink */
+} _layer_t;
+
+static char _stacks[2][BENCH_LAYERS + 1][THREAD_STACKSIZE_DEFAULT];
+static _layer_t _layers[2][BENCH_LAYERS + 1];
+static kernel_pid_t _main_pid;
+
+static void _handle(_layer_t *layer, gnrc_pktsnip_t *pkt)
+{
+    if ((layer->demux_ctx % BENCH_TX) < BENCH_LAYERS) {
+        if (!gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UNDEF,
+                                          layer->demux_ctx + 1, pkt)) {
+            gnrc_pktbuf_release(pkt);
+        }
+        return;
+    }
+
+    /* sink */
+    layer->latency += xtimer_now_usec() - *((uint32_t *)pkt->data);
+    gnrc_pktbuf_release(pkt);
+    if (++layer->count == BENCH_PKTS) {
+        msg_t done = { .type = BENCH_MSG_DONE };
+        msg_send(&done, _main_pid);
+    }
+}
+
+static void *_layer(void *arg)
+{
+    _layer_t *layer = arg;
+    msg_t msg, msg_queue[BENCH_MSG_QUEUE];
+    gnrc_netreg_entry_t entry = GNRC_NETREG_ENTRY_INIT_BATCH(layer->demux_ctx,
+                                                             thread_getpid());
+
+    msg_init_queue(msg_queue, BENCH_MSG_QUEUE);
+#if IS_USED(MODULE_GNRC_NETAPI_BATCH)
+    gnrc_netapi_batch_init(&layer->batch);
+#endif
+    gnrc_netreg_register(GNRC_NETTYPE_UNDEF, &entry);
+
+    while (1) {
+        msg_receive(&msg);
+        switch (msg.type) {
+            case GNRC_NETAPI_MSG_TYPE_RCV:
+                _handle(layer, msg.content.ptr);
+                break;
+#if IS_USED(MODULE_GNRC_NETAPI_BATCH)
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                for (unsigned i = 0; i < gnrc_netapi_batch_numof(msg.content.ptr); i++) {
+                    _handle(layer, gnrc_netapi_batch_get(msg.content.ptr, i));
+                }
+                gnrc_pktbuf_release(msg.content.ptr);
+                break;
+#endif
+            default:
+                break;
+        }
+#if IS_USED(MODULE_GNRC_NETAPI_BATCH)
+        gnrc_netapi_batch_poll();
+#endif
+    }
+    return NULL;
+}
+
+/* Creates a chain of layers, ascending priorities make every layer preempt
+ * the one before it like on the send path of GNRC, descending ones like on
+ * the receive path */
+static void _chain(unsigned chain, uint32_t demux_ctx, int step)
+{
+    for (unsigned i = 0; i <= BENCH_LAYERS; i++) {
+        _layers[chain][i].demux_ctx = demux_ctx + i;
+        thread_create(_stacks[chain][i], sizeof(_stacks[chain][i]),
+                      THREAD_PRIORITY_MAIN + step * (int)(i + 1),
+                      THREAD_CREATE_STACKTEST, _layer, &_layers[chain][i],
+                      "layer");
+    }
+}
+
+static unsigned _schedules(void)
+{
+    unsigned schedules = 0;
+
+    for (unsigned i = 0; i <= KERNEL_PID_LAST; i++) {
+        schedules += sched_pidlist[i].schedules;
+    }
+    return schedules;
+}
+
+static void _run(const char *name, unsigned chain, uint32_t demux_ctx,
+                 unsigned burst, uint32_t gap)
+{
+    _layer_t *sink = &_layers[chain][BENCH_LAYERS];
+    msg_t msg;
+
+    sink->count = 0;
+    sink->latency = 0;
+    unsigned schedules = _schedules();
+    uint32_t start = xtimer_now_usec();
+
+    for (unsigned i = 0; i < BENCH_PKTS; i++) {
+        uint32_t now = xtimer_now_usec();
+        gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, &now, sizeof(now),
+                                              GNRC_NETTYPE_UNDEF);
+
+        if (!pkt || !gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UNDEF,
+                                                  demux_ctx, pkt)) {
+            puts("dispatch failed");
+            gnrc_pktbuf_release(pkt);
+            return;
+        }
+        if ((i + 1) % burst == 0) {
+            xtimer_usleep(gap);
+        }
+    }
+    do {
+        msg_receive(&msg);
+    } while (msg.type != BENCH_MSG_DONE);
+
+    uint32_t duration = xtimer_now_usec() - start;
+    /* in hundredths */
+    unsigned switches = ((_schedules() - schedules) * 100) / BENCH_PKTS;
+
+    printf("%s: %u packets, %u.%02u switches/packet, "
+           "%" PRIu32 " us latency, %" PRIu32 " us\n",
+           name, BENCH_PKTS, switches / 100, switches % 100,
+           (uint32_t)(sink->latency / BENCH_PKTS), duration);
+}
+
+int main(void)
+{
+    msg_t msg_queue[BENCH_MSG_QUEUE];
+
+    msg_init_queue(msg_queue, BENCH_MSG_QUEUE);
+    _main_pid = thread_getpid();
+
+    printf("gnrc_netapi benchmark, batching %s\n",
+           IS_USED(MODULE_GNRC_NETAPI_BATCH) ? "on" : "off");
+    _chain(0, BENCH_RX, 1);
+    _chain(1, BENCH_TX, -1);
+
+    _run("rx", 0, BENCH_RX, 1, BENCH_RX_GAP_US);
+    _run("rx burst", 0, BENCH_RX, BENCH_BURST, BENCH_BURST_GAP_US);
+    _run("tx burst", 1, BENCH_TX, BENCH_BURST, BENCH_BURST_GAP_US);
+    puts("DONE");
+
+    return 0;
+}
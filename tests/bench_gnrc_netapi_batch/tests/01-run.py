@@ -0,0 +1,22 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2020 Inria
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    child.expect(r"gnrc_netapi benchmark, batching (on|off)")
+    for path in ("rx", "rx burst", "tx burst"):
+        child.expect(r"{}: \d+ packets, \d+\.\d+ switches/packet, "
+                     r"\d+ us latency, \d+ us".format(path))
+    child.expect_exact("DONE")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Packet buffer throughput under a mix of received and sent
+ *              packets
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "kernel_defines.h"
+#include "net/gnrc/pktbuf.h"
+#include "random.h"
+#include "xtimer.h"
+
+#ifndef BENCH_PKTS
+#define BENCH_PKTS          (20000U)
+#endif
+
+/* Packets kept in the packet buffer at most */
+#ifndef BENCH_WINDOW_MAX
+#define BENCH_WINDOW_MAX    (16U)
+#endif
+
+#define BENCH_TRACE_NUMOF   (256U)
+
+#define BENCH_NETIF_HDR     (16U)
+#define BENCH_IPV6_HDR      (40U)
+#define BENCH_UDP_HDR       (8U)
+#define BENCH_MTU           (1280U)
+
+static const unsigned _windows[] = { 1, 4, 8, 16 };
+
+typedef struct {
+    uint16_t size;          /* payload size */
+    bool rx;                /* received, otherwise sent */
+} _pkt_t;
+
+static _pkt_t _trace[BENCH_TRACE_NUMOF];
+static gnrc_pktsnip_t *_window[BENCH_WINDOW_MAX];
+
+static void _trace_init(void)
+{
+    for (unsigned i = 0; i < BENCH_TRACE_NUMOF; i++) {
+        _trace[i].rx = random_uint32_range(0, 2);
+        /* mostly link-layer sized frames, some full MTU packets */
+        if (random_uint32_range(0, 8) == 0) {
+            _trace[i].size = random_uint32_range(512, BENCH_MTU -
+                                                 BENCH_IPV6_HDR - BENCH_UDP_HDR);
+        }
+        else {
+            _trace[i].size = random_uint32_range(8, 96);
+        }
+    }
+}
+
+static gnrc_pktsnip_t *_rx(const _pkt_t *p)
+{
+    /* the whole frame as the device driver puts it, then the headers are
+     * marked while passing the stack */
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, BENCH_IPV6_HDR +
+                                          BENCH_UDP_HDR + p->size,
+                                          GNRC_NETTYPE_UNDEF);
+    gnrc_pktsnip_t *netif = NULL;
+
+    if ((pkt == NULL) ||
+        ((netif = gnrc_pktbuf_add(NULL, NULL, BENCH_NETIF_HDR,
+                                  GNRC_NETTYPE_NETIF)) == NULL)) {
+        gnrc_pktbuf_release(pkt);
+        return NULL;
+    }
+    LL_APPEND(pkt, netif);
+    if (!gnrc_pktbuf_mark(pkt, BENCH_IPV6_HDR, GNRC_NETTYPE_UNDEF) ||
+        !gnrc_pktbuf_mark(pkt, BENCH_UDP_HDR, GNRC_NETTYPE_UNDEF)) {
+        gnrc_pktbuf_release(pkt);
+        return NULL;
+    }
+    return pkt;
+}
+
+static gnrc_pktsnip_t *_tx(const _pkt_t *p)
+{
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, p->size,
+                                          GNRC_NETTYPE_UNDEF);
+    static const struct {
+        uint16_t size;
+        gnrc_nettype_t type;
+    } _hdrs[] = {
+        { BENCH_UDP_HDR, GNRC_NETTYPE_UNDEF },
+        { BENCH_IPV6_HDR, GNRC_NETTYPE_UNDEF },
+        { BENCH_NETIF_HDR, GNRC_NETTYPE_NETIF },
+    };
+
+    for (unsigned i = 0; (pkt != NULL) && (i < ARRAY_SIZE(_hdrs)); i++) {
+        gnrc_pktsnip_t *hdr = gnrc_pktbuf_add(pkt, NULL, _hdrs[i].size,
+                                              _hdrs[i].type);
+        if (hdr == NULL) {
+            gnrc_pktbuf_release(pkt);
+        }
+        pkt = hdr;
+    }
+    return pkt;
+}
+
+static void _bench(unsigned window)
+{
+    unsigned failed = 0;
+
+    uint32_t start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_PKTS; i++) {
+        const _pkt_t *p = &_trace[i % BENCH_TRACE_NUMOF];
+        gnrc_pktsnip_t **slot = &_window[i % window];
+
+        /* the oldest packet leaves the stack */
+        if (*slot) {
+            gnrc_pktbuf_release(*slot);
+        }
+        *slot = p->rx ? _rx(p) : _tx(p);
+        if (*slot == NULL) {
+            failed++;
+        }
+    }
+    uint32_t time = xtimer_now_usec() - start;
+
+    for (unsigned i = 0; i < window; i++) {
+        if (_window[i]) {
+            gnrc_pktbuf_release(_window[i]);
+            _window[i] = NULL;
+        }
+    }
+    printf("window %2u: %7" PRIu32 " packets/s, %5u failed\n", window,
+           (uint32_t)(((uint64_t)BENCH_PKTS * US_PER_SEC) / time), failed);
+}
+
+int main(void)
+{
+    puts("gnrc_pktbuf benchmark");
+    printf("%s, %u packets\n",
+           IS_USED(MODULE_GNRC_PKTBUF_STATIC_CLASSES) ? "size classes" :
+                                                        "first-fit",
+           BENCH_PKTS);
+    _trace_init();
+    for (unsigned i = 0; i < ARRAY_SIZE(_windows); i++) {
+        _bench(_windows[i]);
+    }
+#ifdef DEVELHELP
+    gnrc_pktbuf_stats();
+#endif
+    puts("DONE");
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Interface between the benchmark and the scripting runtimes
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Stack size of the thread running a runtime
+ */
+#ifndef BENCH_STACKSIZE
+#define BENCH_STACKSIZE     (THREAD_STACKSIZE_DEFAULT * 4)
+#endif
+
+/**
+ * @brief Workloads, every runtime implements all of them identically
+ */
+typedef enum {
+    BENCH_FLETCHER32,           /**< Fletcher32 over 64 generated words */
+    BENCH_FIB,                  /**< 30th Fibonacci number, iterative */
+    BENCH_SENSOR,               /**< Min, max, sum and threshold count of 64 samples */
+    BENCH_COAP,                 /**< Build a CoAP 2.05 response with a text payload */
+    BENCH_WORKLOAD_NUMOF,
+} bench_workload_t;
+
+/**
+ * @brief A scripting runtime under test
+ */
+typedef struct {
+    const char *name;
+    /**
+     * @brief Initialize the runtime and load the workloads
+     *
+     * @returns 0 on success
+     */
+    int (*load)(void);
+    /**
+     * @brief Run a single workload
+     *
+     * @returns 0 on success
+     */
+    int (*run)(bench_workload_t workload, int32_t *result);
+    /**
+     * @brief Heap used by the runtime since @ref load, -1 if unknown
+     */
+    long (*heap_used)(void);
+    /**
+     * @brief Release the runtime
+     */
+    void (*unload)(void);
+    /**
+     * @brief Size of the loaded scripts or bytecode in bytes
+     */
+    size_t script_size;
+} bench_runtime_t;
+
+/**
+ * @brief Fill a heap with a pattern for @ref bench_touched
+ */
+void bench_paint(void *heap, size_t len);
+
+/**
+ * @brief Number of bytes of a painted heap that were written to
+ */
+size_t bench_touched(const void *heap, size_t len);
+
+/**
+ * @name Runtimes
+ * @{
+ */
+extern const bench_runtime_t bench_runtime_c;
+extern const bench_runtime_t bench_runtime_femto;
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
+/** @} */
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Workloads as femto-container applications
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "bpf.h"
+#include "kernel_defines.h"
+
+static const uint8_t _fletcher32[] = {
+    0xb7, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = 0 */
+    0xb7, 0x02, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, /* r2 = 7 */
+    0xbf, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = r1 */
+    0x67, 0x03, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r3 <<= 1 */
+    0x0f, 0xa3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 += r10 */
+    0xbf, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r2 */
+    0x57, 0x04, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r4 &= 0xffff */
+    0x6b, 0x43, 0x80, 0xff, 0x00, 0x00, 0x00, 0x00, /* *(u16 *)(r3 - 128) = r4 */
+    0x07, 0x02, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, /* r2 += 31 */
+    0x07, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r1 += 1 */
+    0xa5, 0x01, 0xf7, 0xff, 0x40, 0x00, 0x00, 0x00, /* if r1 < 64 goto -9 */
+    0xb7, 0x01, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r1 = 0xffff */
+    0xb7, 0x02, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r2 = 0xffff */
+    0xbf, 0xa3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = r10 */
+    0x07, 0x03, 0x00, 0x00, 0x80, 0xff, 0xff, 0xff, /* r3 += -128 */
+    0x69, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = *(u16 *)(r3 + 0) */
+    0x0f, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 += r4 */
+    0x0f, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 += r1 */
+    0x07, 0x03, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, /* r3 += 2 */
+    0xad, 0xa3, 0xfb, 0xff, 0x00, 0x00, 0x00, 0x00, /* if r3 < r10 goto sum */
+    0xbf, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r1 */
+    0x77, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r4 >>= 16 */
+    0x57, 0x01, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r1 &= 0xffff */
+    0x0f, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 += r4 */
+    0xbf, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r1 */
+    0x77, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r4 >>= 16 */
+    0x57, 0x01, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r1 &= 0xffff */
+    0x0f, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 += r4 */
+    0xbf, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r2 */
+    0x77, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r4 >>= 16 */
+    0x57, 0x02, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r2 &= 0xffff */
+    0x0f, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 += r4 */
+    0xbf, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r2 */
+    0x77, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r4 >>= 16 */
+    0x57, 0x02, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r2 &= 0xffff */
+    0x0f, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 += r4 */
+    0xbf, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = r2 */
+    0xaf, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 ^= r1 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t _fib[] = {
+    0xb7, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = 0 */
+    0xb7, 0x02, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r2 = 1 */
+    0xb7, 0x03, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, /* r3 = 30 */
+    0xbf, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r1 */
+    0x0f, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 += r2 */
+    0xbf, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = r2 */
+    0xbf, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r4 */
+    0x07, 0x03, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, /* r3 += -1 */
+    0x55, 0x03, 0xfa, 0xff, 0x00, 0x00, 0x00, 0x00, /* if r3 != 0 goto -6 */
+    0xbf, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = r1 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t _sensor[] = {
+    0xb7, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = 0 */
+    0xb7, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = 0 */
+    0xbf, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = r2 */
+    0x97, 0x03, 0x00, 0x00, 0x65, 0x00, 0x00, 0x00, /* r3 %= 101 */
+    0x07, 0x03, 0x00, 0x00, 0xce, 0xff, 0xff, 0xff, /* r3 += -50 */
+    0xbf, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r1 */
+    0x67, 0x04, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r4 <<= 1 */
+    0x0f, 0xa4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 += r10 */
+    0x6b, 0x34, 0x80, 0xff, 0x00, 0x00, 0x00, 0x00, /* *(u16 *)(r4 - 128) = r3 */
+    0x07, 0x02, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, /* r2 += 37 */
+    0x07, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r1 += 1 */
+    0xa5, 0x01, 0xf6, 0xff, 0x40, 0x00, 0x00, 0x00, /* if r1 < 64 goto -10 */
+    0xb7, 0x01, 0x00, 0x00, 0xff, 0x7f, 0x00, 0x00, /* r1 = 32767 */
+    0xb7, 0x02, 0x00, 0x00, 0x00, 0x80, 0xff, 0xff, /* r2 = -32768 */
+    0xb7, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r7 = 0 */
+    0xb7, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r8 = 0 */
+    0xbf, 0xa6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r6 = r10 */
+    0x07, 0x06, 0x00, 0x00, 0x80, 0xff, 0xff, 0xff, /* r6 += -128 */
+    0x69, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = *(u16 *)(r6 + 0) */
+    0x67, 0x03, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, /* r3 <<= 48 */
+    0xc7, 0x03, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, /* r3 s>>= 48 */
+    0x0f, 0x37, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r7 += r3 */
+    0x7d, 0x13, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, /* if r3 s>= r1 goto min */
+    0xbf, 0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = r3 */
+    0xdd, 0x23, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, /* if r3 s<= r2 goto max */
+    0xbf, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r3 */
+    0xd5, 0x03, 0x01, 0x00, 0x14, 0x00, 0x00, 0x00, /* if r3 s<= 20 goto +1 */
+    0x07, 0x08, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r8 += 1 */
+    0x07, 0x06, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, /* r6 += 2 */
+    0xad, 0xa6, 0xf4, 0xff, 0x00, 0x00, 0x00, 0x00, /* if r6 < r10 goto loop */
+    0xbf, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = r8 */
+    0x27, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, /* r0 *= 128 */
+    0x1f, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 -= r1 */
+    0x0f, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 += r2 */
+    0x67, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r0 <<= 16 */
+    0x57, 0x07, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r7 &= 0xffff */
+    0x4f, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 |= r7 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t _coap[] = {
+    0xbf, 0xa6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r6 = r10 */
+    0x07, 0x06, 0x00, 0x00, 0xc0, 0xff, 0xff, 0xff, /* r6 += -64 */
+    0x72, 0x06, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 0) = 0x64 */
+    0x72, 0x06, 0x01, 0x00, 0x45, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 1) = 0x45 */
+    0x72, 0x06, 0x02, 0x00, 0x12, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 2) = 0x12 */
+    0x72, 0x06, 0x03, 0x00, 0x34, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 3) = 0x34 */
+    0x72, 0x06, 0x04, 0x00, 0xde, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 4) = 0xde */
+    0x72, 0x06, 0x05, 0x00, 0xad, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 5) = 0xad */
+    0x72, 0x06, 0x06, 0x00, 0xbe, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 6) = 0xbe */
+    0x72, 0x06, 0x07, 0x00, 0xef, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 7) = 0xef */
+    0x72, 0x06, 0x08, 0x00, 0xc0, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 8) = 0xc0 */
+    0x72, 0x06, 0x09, 0x00, 0xff, 0x00, 0x00, 0x00, /* *(u8 *)(r6 + 9) = 0xff */
+    0xb7, 0x01, 0x00, 0x00, 0x15, 0xcd, 0x5b, 0x07, /* r1 = 123456789 */
+    0xb7, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = 0 */
+    0xbf, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = r1 */
+    0x37, 0x03, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, /* r3 /= 10 */
+    0x07, 0x02, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r2 += 1 */
+    0x55, 0x03, 0xfd, 0xff, 0x00, 0x00, 0x00, 0x00, /* if r3 != 0 goto -3 */
+    0xbf, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 = r6 */
+    0x07, 0x04, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, /* r4 += 10 */
+    0x0f, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r4 += r2 */
+    0xbf, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r5 = r4 */
+    0xbf, 0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = r1 */
+    0x97, 0x03, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, /* r3 %= 10 */
+    0x07, 0x03, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, /* r3 += 48 */
+    0x07, 0x04, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, /* r4 += -1 */
+    0x73, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* *(u8 *)(r4 + 0) = r3 */
+    0x37, 0x01, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, /* r1 /= 10 */
+    0x55, 0x01, 0xf9, 0xff, 0x00, 0x00, 0x00, 0x00, /* if r1 != 0 goto -7 */
+    0xb7, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r7 = 0 */
+    0xb7, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r8 = 0 */
+    0xbf, 0x59, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r9 = r5 */
+    0x1f, 0x69, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r9 -= r6 */
+    0xbf, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = r6 */
+    0x0f, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 += r8 */
+    0x71, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 = *(u8 *)(r3 + 0) */
+    0x07, 0x08, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r8 += 1 */
+    0x2f, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r3 *= r8 */
+    0x0f, 0x37, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r7 += r3 */
+    0xad, 0x98, 0xf9, 0xff, 0x00, 0x00, 0x00, 0x00, /* if r8 < r9 goto sum */
+    0x57, 0x07, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, /* r7 &= 0xffff */
+    0xbf, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = r9 */
+    0x67, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r0 <<= 16 */
+    0x4f, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 |= r7 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const struct {
+    const uint8_t *application;
+    size_t len;
+} _applications[] = {
+    [BENCH_FLETCHER32] = { _fletcher32, sizeof(_fletcher32) },
+    [BENCH_FIB] = { _fib, sizeof(_fib) },
+    [BENCH_SENSOR] = { _sensor, sizeof(_sensor) },
+    [BENCH_COAP] = { _coap, sizeof(_coap) },
+};
+
+static uint8_t _bpf_stack[512];
+static bpf_t _bpf[BENCH_WORKLOAD_NUMOF];
+
+static int _load(void)
+{
+    bpf_init();
+    bench_paint(_bpf_stack, sizeof(_bpf_stack));
+    for (unsigned i = 0; i < ARRAY_SIZE(_bpf); i++) {
+        _bpf[i] = (bpf_t){
+            .application = _applications[i].application,
+            .application_len = _applications[i].len,
+            .stack = _bpf_stack,
+            .stack_size = sizeof(_bpf_stack),
+        };
+        bpf_setup(&_bpf[i]);
+    }
+    return 0;
+}
+
+static int _run(bench_workload_t workload, int32_t *result)
+{
+    int64_t res = 0;
+    int err = bpf_execute(&_bpf[workload], NULL, 0, &res);
+    *result = res;
+    return err;
+}
+
+static long _heap_used(void)
+{
+    /* The VM stack is the only memory of the applications */
+    return bench_touched(_bpf_stack, sizeof(_bpf_stack));
+}
+
+static void _unload(void)
+{
+}
+
+const bench_runtime_t bench_runtime_femto = {
+    .name = "femto-container",
+    .load = _load,
+    .run = _run,
+    .heap_used = _heap_used,
+    .unload = _unload,
+    .script_size = sizeof(_fletcher32) + sizeof(_fib) + sizeof(_sensor) +
+                   sizeof(_coap),
+};
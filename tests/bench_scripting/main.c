@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2020 Inria
+ * Copyright (C) 2020 Koen Zandberg <koen@bergzand.net>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compare femto-containers with native C
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "kernel_defines.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS          (100U)
+#endif
+
+#define BENCH_PAINT         (0xa5)
+
+typedef struct {
+    const bench_runtime_t *runtime;
+    int error;
+    uint32_t load_us;
+    long heap;
+    int32_t result[BENCH_WORKLOAD_NUMOF];
+    uint32_t run_us[BENCH_WORKLOAD_NUMOF];
+} _measurement_t;
+
+static const char *const _workloads[] = {
+    [BENCH_FLETCHER32] = "fletcher32",
+    [BENCH_FIB] = "fib",
+    [BENCH_SENSOR] = "sensor",
+    [BENCH_COAP] = "coap",
+};
+
+static const bench_runtime_t *const _runtimes[] = {
+    &bench_runtime_c,
+    &bench_runtime_femto,
+};
+
+static char _stack[BENCH_STACKSIZE];
+static _measurement_t _measurement;
+static int32_t _expected[BENCH_WORKLOAD_NUMOF];
+
+void bench_paint(void *heap, size_t len)
+{
+    memset(heap, BENCH_PAINT, len);
+}
+
+size_t bench_touched(const void *heap, size_t len)
+{
+    const uint8_t *p = heap;
+    size_t touched = 0;
+    for (size_t i = 0; i < len; i++) {
+        touched += (p[i] != BENCH_PAINT);
+    }
+    return touched;
+}
+
+/* Inputs of the reference implementation, volatile so that the compiler
+ * doesn't fold the workloads into constants */
+static volatile uint32_t _input[] = {
+    [BENCH_FLETCHER32] = 7,
+    [BENCH_FIB] = 30,
+    [BENCH_SENSOR] = 37,
+    [BENCH_COAP] = 123456789,
+};
+
+/* Reference implementation of the workloads */
+static int32_t _fletcher32(void)
+{
+    uint16_t data[64];
+    uint32_t value = _input[BENCH_FLETCHER32];
+    for (unsigned i = 0; i < ARRAY_SIZE(data); i++) {
+        data[i] = value & 0xffff;
+        value += 31;
+    }
+
+    uint32_t sum1 = 0xffff;
+    uint32_t sum2 = 0xffff;
+    for (unsigned i = 0; i < ARRAY_SIZE(data); i++) {
+        sum1 += data[i];
+        sum2 += sum1;
+    }
+    for (unsigned i = 0; i < 2; i++) {
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    }
+    /* Folded, the other runtimes don't all have 32-bit unsigned integers */
+    return sum2 ^ sum1;
+}
+
+static int32_t _fib(void)
+{
+    int32_t a = 0;
+    int32_t b = 1;
+    for (unsigned i = _input[BENCH_FIB]; i; i--) {
+        int32_t next = a + b;
+        a = b;
+        b = next;
+    }
+    return a;
+}
+
+static int32_t _sensor(void)
+{
+    int16_t samples[64];
+    uint32_t step = _input[BENCH_SENSOR];
+    for (unsigned i = 0; i < ARRAY_SIZE(samples); i++) {
+        samples[i] = (int16_t)((i * step) % 101) - 50;
+    }
+
+    int32_t min = INT16_MAX;
+    int32_t max = INT16_MIN;
+    int32_t sum = 0;
+    int32_t above = 0;
+    for (unsigned i = 0; i < ARRAY_SIZE(samples); i++) {
+        sum += samples[i];
+        if (samples[i] < min) {
+            min = samples[i];
+        }
+        if (samples[i] > max) {
+            max = samples[i];
+        }
+        if (samples[i] > 20) {
+            above++;
+        }
+    }
+    return (above * 128 + (max - min)) * 65536 + (sum & 0xffff);
+}
+
+static int32_t _coap(void)
+{
+    uint8_t buf[32] = {
+        0x64, 0x45, 0x12, 0x34,     /* ACK, 2.05, message ID */
+        0xde, 0xad, 0xbe, 0xef,     /* token */
+        0xc0,                       /* content format text/plain */
+        0xff,                       /* payload marker */
+    };
+    uint32_t value = _input[BENCH_COAP];
+    unsigned len = 10;
+    for (uint32_t v = value; v; v /= 10) {
+        len++;
+    }
+    for (unsigned i = len; i > 10; i--) {
+        buf[i - 1] = '0' + value % 10;
+        value /= 10;
+    }
+
+    int32_t sum = 0;
+    for (unsigned i = 0; i < len; i++) {
+        sum += (i + 1) * buf[i];
+    }
+    return len * 65536 + (sum & 0xffff);
+}
+
+static int _c_load(void)
+{
+    return 0;
+}
+
+static int _c_run(bench_workload_t workload, int32_t *result)
+{
+    switch (workload) {
+        case BENCH_FLETCHER32:
+            *result = _fletcher32();
+            break;
+        case BENCH_FIB:
+            *result = _fib();
+            break;
+        case BENCH_SENSOR:
+            *result = _sensor();
+            break;
+        case BENCH_COAP:
+            *result = _coap();
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+static long _c_heap_used(void)
+{
+    return 0;
+}
+
+static void _c_unload(void)
+{
+}
+
+const bench_runtime_t bench_runtime_c = {
+    .name = "c",
+    .load = _c_load,
+    .run = _c_run,
+    .heap_used = _c_heap_used,
+    .unload = _c_unload,
+};
+
+static void *_bench(void *arg)
+{
+    _measurement_t *m = arg;
+    const bench_runtime_t *runtime = m->runtime;
+
+    uint32_t start = xtimer_now_usec();
+    m->error = runtime->load();
+    m->load_us = xtimer_now_usec() - start;
+
+    for (unsigned w = 0; (w < BENCH_WORKLOAD_NUMOF) && !m->error; w++) {
+        start = xtimer_now_usec();
+        for (unsigned i = 0; (i < BENCH_RUNS) && !m->error; i++) {
+            m->error = runtime->run(w, &m->result[w]);
+        }
+        m->run_us[w] = xtimer_now_usec() - start;
+    }
+    m->heap = m->error ? -1 : runtime->heap_used();
+    runtime->unload();
+    return NULL;
+}
+
+static void _print(const _measurement_t *m, unsigned stack)
+{
+    printf("{\"runtime\":\"%s\",\"error\":%d,\"load_us\":%"PRIu32","
+           "\"stack\":%u,\"heap\":%ld,\"script\":%u,\"runs\":%u,"
+           "\"workloads\":{",
+           m->runtime->name, m->error, m->load_us, stack, m->heap,
+           (unsigned)m->runtime->script_size, BENCH_RUNS);
+    for (unsigned w = 0; w < BENCH_WORKLOAD_NUMOF; w++) {
+        bool ok = !m->error && (m->result[w] == _expected[w]);
+        printf("%s\"%s\":{\"result\":%"PRId32",\"ok\":%s,\"us\":%"PRIu32"}",
+               w ? "," : "", _workloads[w], m->result[w],
+               ok ? "true" : "false", m->run_us[w]);
+    }
+    puts("}}");
+}
+
+int main(void)
+{
+    for (unsigned w = 0; w < BENCH_WORKLOAD_NUMOF; w++) {
+        _c_run(w, &_expected[w]);
+    }
+
+    puts("START");
+    for (unsigned i = 0; i < ARRAY_SIZE(_runtimes); i++) {
+        memset(&_measurement, 0, sizeof(_measurement));
+        _measurement.runtime = _runtimes[i];
+
+        /* Runs to completion before main continues */
+        thread_create(_stack, sizeof(_stack), THREAD_PRIORITY_MAIN - 1,
+                      THREAD_CREATE_STACKTEST, _bench, &_measurement,
+                      _runtimes[i]->name);
+        _print(&_measurement, sizeof(_stack) - thread_measure_stack_free(_stack));
+    }
+    puts("DONE");
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       ztimer list and heap backends under a growing number of timers
+ *
+ * The timers are set on a mock clock, so no alarm fires while measuring and
+ * only the time spent in ztimer itself is measured.
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "kernel_defines.h"
+#include "random.h"
+#include "ztimer.h"
+#include "ztimer/heap.h"
+#include "ztimer/mock.h"
+
+#ifndef BENCH_TIMERS_MAX
+#define BENCH_TIMERS_MAX    (256U)
+#endif
+
+#ifndef BENCH_OPS
+#define BENCH_OPS           (512U)
+#endif
+
+/* Timer offsets are drawn from this range, in mock clock ticks */
+#define BENCH_OFFSET_MIN    (1000LU)
+#define BENCH_OFFSET_MAX    (1000000LU)
+
+static const unsigned _numof[] = { 1, 4, 16, 64, 256 };
+
+static ztimer_t _timers[BENCH_TIMERS_MAX];
+static ztimer_mock_t _mock;
+static uint16_t _index[BENCH_OPS];
+static uint32_t _offset[BENCH_OPS];
+static unsigned _fired;
+
+static void _cb(void *arg)
+{
+    (void)arg;
+    _fired++;
+}
+
+static void _init(unsigned numof, bool heap)
+{
+    ztimer_clock_t *clock = &_mock.super;
+
+    ztimer_mock_init(&_mock, 32);
+    if (heap) {
+        ztimer_heap_init(clock);
+    }
+    memset(_timers, 0, sizeof(_timers));
+    for (unsigned i = 0; i < numof; i++) {
+        _timers[i].callback = _cb;
+        ztimer_set(clock, &_timers[i],
+                   random_uint32_range(BENCH_OFFSET_MIN, BENCH_OFFSET_MAX));
+    }
+    for (unsigned i = 0; i < BENCH_OPS; i++) {
+        _index[i] = random_uint32_range(0, numof);
+        _offset[i] = random_uint32_range(BENCH_OFFSET_MIN, BENCH_OFFSET_MAX);
+    }
+    _fired = 0;
+}
+
+/* Average time of a single operation in nanoseconds */
+static uint32_t _ns(uint32_t start, unsigned ops)
+{
+    return (uint64_t)(ztimer_now(ZTIMER_USEC) - start) * 1000 / ops;
+}
+
+static void _bench(unsigned numof, bool heap)
+{
+    ztimer_clock_t *clock = &_mock.super;
+
+    _init(numof, heap);
+
+    /* Moving a timer that is already set */
+    uint32_t start = ztimer_now(ZTIMER_USEC);
+    for (unsigned i = 0; i < BENCH_OPS; i++) {
+        ztimer_set(clock, &_timers[_index[i]], _offset[i]);
+    }
+    uint32_t set_ns = _ns(start, BENCH_OPS);
+
+    /* Removing a timer and setting it again */
+    start = ztimer_now(ZTIMER_USEC);
+    for (unsigned i = 0; i < BENCH_OPS; i++) {
+        ztimer_remove(clock, &_timers[_index[i]]);
+        ztimer_set(clock, &_timers[_index[i]], _offset[i]);
+    }
+    uint32_t reset_ns = _ns(start, BENCH_OPS);
+
+    /* Running the clock until all timers fired */
+    start = ztimer_now(ZTIMER_USEC);
+    ztimer_mock_advance(&_mock, BENCH_OFFSET_MAX);
+    uint32_t expire_ns = _ns(start, numof);
+
+    printf("%6u %-7s %10" PRIu32 " %10" PRIu32 " %10" PRIu32 "%s\n",
+           numof, heap ? "heap" : "list", set_ns, reset_ns, expire_ns,
+           (_fired == numof) ? "" : " missed timers");
+}
+
+int main(void)
+{
+    puts("ztimer stress benchmark, average time per operation");
+    printf("%6s %-7s %10s %10s %10s\n",
+           "timers", "backend", "set[ns]", "rm+set[ns]", "expire[ns]");
+    for (unsigned i = 0; i < ARRAY_SIZE(_numof); i++) {
+        if (_numof[i] > BENCH_TIMERS_MAX) {
+            break;
+        }
+        _bench(_numof[i], false);
+        _bench(_numof[i], true);
+    }
+    puts("DONE");
+    return 0;
+}
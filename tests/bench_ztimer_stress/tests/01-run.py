@@ -0,0 +1,21 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2020 Inria
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    child.expect_exact("ztimer stress benchmark")
+    while child.expect([r"\s+\d+ (list|heap)\s+\d+\s+\d+\s+\d+( missed timers)?\r\n",
+                        "DONE"]) == 0:
+        assert child.match.group(2) is None, "timers missed"
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
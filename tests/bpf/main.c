@@ -18,12 +18,31 @@
  *
  * @}
  */
+#include <errno.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "bpf.h"
 #include "bpf/store.h"
+#include "bpf/call.h"
+#include "bpf/instance.h"
+#include "bpf/instruction.h"
+#include "bpf/map.h"
+#ifdef MODULE_BPF_MPU
+#include "bpf/mpu.h"
+#include "bpf_aot/isolated.h"
+#endif
+#include "bpf/pkt.h"
+#ifdef MODULE_BPF_SCHED
+#include "bpf/sched.h"
+#include "ztimer.h"
+#endif
+#include "bpf/snapshot.h"
+#include "bpf/verify.h"
 #include "embUnit.h"
+#include "hashes.h"
+#include "saul_reg.h"
 
 #include "sample.h"
 #include "sample_storage.h"
@@ -67,9 +86,58 @@ static const uint8_t application[] = {
     0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
 };
 
+static const uint8_t mem_helpers[] = {
+    0xbf, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r6 = r1 */
+    0xbf, 0xa1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = r10 */
+    0x07, 0x01, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xff, /* r1 += -8 */
+    0xbf, 0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r6 */
+    0xb7, 0x03, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, /* r3 = 8 */
+    0x85, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, /* call bpf_memcpy */
+    0xbf, 0xa1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = r10 */
+    0x07, 0x01, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xff, /* r1 += -8 */
+    0xbf, 0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r6 */
+    0xb7, 0x03, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, /* r3 = 8 */
+    0x85, 0x00, 0x00, 0x00, 0x62, 0x00, 0x00, 0x00, /* call bpf_memcmp */
+    0xbf, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r7 = r0 */
+    0xbf, 0x61, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = r6 */
+    0xbf, 0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r6 */
+    0x07, 0x02, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, /* r2 += 8 */
+    0xb7, 0x03, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, /* r3 = 8 */
+    0x85, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, /* call bpf_memcpy, beyond ctx */
+    0x67, 0x07, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, /* r7 <<= 32 */
+    0x4f, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 |= r7 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t pkt_loads[] = {
+    0xb7, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r1 = 0 */
+    0x85, 0x00, 0x00, 0x00, 0x82, 0x00, 0x00, 0x00, /* call bpf_pkt_load_u16 */
+    0xbf, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r7 = r0 */
+    0xb7, 0x01, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, /* r1 = 2 */
+    0x85, 0x00, 0x00, 0x00, 0x83, 0x00, 0x00, 0x00, /* call bpf_pkt_load_u32, across snips */
+    0xbf, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r8 = r0 */
+    0xb7, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r1 = 1 */
+    0x85, 0x00, 0x00, 0x00, 0x82, 0x00, 0x00, 0x00, /* call bpf_pkt_load_u16, before the cursor */
+    0x67, 0x07, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, /* r7 <<= 16 */
+    0x4f, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 |= r7 */
+    0x67, 0x08, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, /* r8 <<= 32 */
+    0x4f, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 |= r8 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t map_bloom_check[] = {
+    0xbf, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r1 */
+    0xb7, 0x01, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, /* r1 = 7 */
+    0xb7, 0x03, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, /* r3 = 4 */
+    0x85, 0x00, 0x00, 0x00, 0x90, 0x00, 0x00, 0x00, /* call bpf_map_bloom_check */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
 static void _init(void)
 {
-    bpf_init();
+    /* bpf_init() starts the runtime threads, it is only called once */
+    bpf_store_init();
+    bpf_instance_init();
 }
 
 static void tests_bpf_run1(void)
@@ -155,6 +223,1134 @@ static void tests_bpf_saul(void)
     printf("BPF saul val: %"PRIu32"\n", val);
 }
 
+static int _saul_dummy_read(const void *dev, phydat_t *res)
+{
+    memset(res, 0, sizeof(*res));
+    res->val[0] = (int16_t)(uintptr_t)dev;
+    return 1;
+}
+
+static const saul_driver_t _saul_dummy_driver = {
+    .read = _saul_dummy_read,
+    .write = saul_notsup,
+    .type = SAUL_SENSE_TEMP,
+};
+
+static saul_reg_t *_saul_find_nth(bpf_t *bpf, unsigned pos)
+{
+    return (saul_reg_t *)(uintptr_t)bpf_vm_saul_reg_find_nth(bpf, pos,
+                                                             0, 0, 0, 0);
+}
+
+static void tests_bpf_saul_cache(void)
+{
+    saul_reg_t devs[] = {
+        { .dev = (void *)10, .name = "a", .driver = &_saul_dummy_driver },
+        { .dev = (void *)20, .name = "b", .driver = &_saul_dummy_driver },
+        { .dev = (void *)30, .name = "c", .driver = &_saul_dummy_driver },
+    };
+    bpf_t bpf = {
+        .application = application,
+        .application_len = sizeof(application),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint8_t *positions = _bpf_stack;
+    phydat_t *data = (phydat_t *)&_bpf_stack[8];
+
+    /* Start from an empty registry so the devices are at known positions */
+    saul_reg_t *registry = saul_reg;
+    saul_reg = NULL;
+    for (unsigned i = 0; i < ARRAY_SIZE(devs); i++) {
+        TEST_ASSERT_EQUAL_INT(0, saul_reg_add(&devs[i]));
+    }
+    bpf_setup(&bpf);
+
+    /* Lookups are cached */
+    TEST_ASSERT(_saul_find_nth(&bpf, 1) == &devs[1]);
+    TEST_ASSERT(bpf.saul_cache[1] == &devs[1]);
+    TEST_ASSERT(_saul_find_nth(&bpf, 1) == &devs[1]);
+
+    /* Positions beyond the registry and the cache */
+    TEST_ASSERT_NULL(_saul_find_nth(&bpf, ARRAY_SIZE(devs)));
+    TEST_ASSERT_NULL(_saul_find_nth(&bpf, CONFIG_BPF_SAUL_CACHE_NUMOF));
+    TEST_ASSERT_NULL(_saul_find_nth(&bpf, UINT32_MAX));
+
+    /* Removing a device moves the following ones */
+    TEST_ASSERT_EQUAL_INT(0, saul_reg_rm(&devs[1]));
+    TEST_ASSERT(_saul_find_nth(&bpf, 1) == &devs[2]);
+    TEST_ASSERT_NULL(_saul_find_nth(&bpf, 2));
+
+    /* Batch reads stop at the first missing device */
+    positions[0] = 1;
+    positions[1] = 0;
+    positions[2] = 2;
+    TEST_ASSERT_EQUAL_INT(2, bpf_vm_saul_read_batch(&bpf, (uintptr_t)positions,
+                                                    (uintptr_t)data, 3, 0, 0));
+    TEST_ASSERT_EQUAL_INT(30, data[0].val[0]);
+    TEST_ASSERT_EQUAL_INT(10, data[1].val[0]);
+
+    /* The positions and the results must be accessible by the application */
+    TEST_ASSERT_EQUAL_INT(UINT32_MAX,
+                          bpf_vm_saul_read_batch(&bpf, (uintptr_t)positions,
+                                                 (uintptr_t)devs, 2, 0, 0));
+    TEST_ASSERT_EQUAL_INT(UINT32_MAX,
+                          bpf_vm_saul_read_batch(&bpf, (uintptr_t)positions,
+                                                 (uintptr_t)data,
+                                                 UINT8_MAX + 1, 0, 0));
+
+    saul_reg = registry;
+    saul_reg_generation++;
+}
+
+static void tests_bpf_instance(void)
+{
+    bpf_program_t *program = bpf_program_load(sample_bin, sizeof(sample_bin));
+    TEST_ASSERT_NOT_NULL(program);
+    /* Loading the same image again shares the program */
+    TEST_ASSERT(program == bpf_program_load(sample_bin, sizeof(sample_bin)));
+    bpf_program_release(program);
+
+    bpf_instance_t *inst1 = bpf_instance_new(program);
+    bpf_instance_t *inst2 = bpf_instance_new(program);
+    TEST_ASSERT_NOT_NULL(inst1);
+    TEST_ASSERT_NOT_NULL(inst2);
+    TEST_ASSERT(inst1->bpf.stack != inst2->bpf.stack);
+    TEST_ASSERT_EQUAL_INT(3, program->refcount);
+
+    /* The program stays loaded while instances reference it */
+    bpf_program_release(program);
+    TEST_ASSERT_EQUAL_INT(2, program->refcount);
+
+    unsigned int ctx = 8;
+    int64_t result = 0;
+    TEST_ASSERT_EQUAL_INT(0, bpf_instance_execute(inst1, &ctx, sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(16, (int)result);
+    ctx = 8;
+    TEST_ASSERT_EQUAL_INT(0, bpf_instance_execute(inst2, &ctx, sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(16, (int)result);
+
+    uint8_t buf[8];
+    TEST_ASSERT_EQUAL_INT(0, bpf_instance_add_region(inst1, buf, sizeof(buf),
+                                                     BPF_MEM_REGION_READ));
+
+    bpf_instance_free(inst1);
+    bpf_instance_free(inst2);
+
+    /* All pool entries are returned */
+    bpf_instance_t *instances[CONFIG_BPF_INSTANCE_NUMOF];
+    program = bpf_program_load(application, sizeof(application));
+    for (unsigned i = 0; i < CONFIG_BPF_INSTANCE_NUMOF; i++) {
+        instances[i] = bpf_instance_new(program);
+        TEST_ASSERT_NOT_NULL(instances[i]);
+    }
+    TEST_ASSERT_NULL(bpf_instance_new(program));
+    for (unsigned i = 0; i < CONFIG_BPF_INSTANCE_NUMOF; i++) {
+        bpf_instance_free(instances[i]);
+    }
+    bpf_program_release(program);
+}
+
+static const uint8_t deep_stack[] = {
+    0x7a, 0x0a, 0xf8, 0xf7, 0x00, 0x00, 0x00, 0x00, /* *(u64 *)(r10 - 2056) = 0 */
+    0xb7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = 0 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static void tests_bpf_stack_depth(void)
+{
+    TEST_ASSERT_EQUAL_INT(64, bpf_verify_stack_depth(application,
+                                                     sizeof(application)));
+    TEST_ASSERT_EQUAL_INT(2056, bpf_verify_stack_depth(deep_stack,
+                                                       sizeof(deep_stack)));
+
+    bpf_program_t *program = bpf_program_load(application, sizeof(application));
+    TEST_ASSERT_NOT_NULL(program);
+    TEST_ASSERT_EQUAL_INT(64, program->stack_size);
+
+    bpf_instance_t *instance = bpf_instance_new(program);
+    TEST_ASSERT_NOT_NULL(instance);
+    TEST_ASSERT_EQUAL_INT(CONFIG_BPF_INSTANCE_SMALL_STACK_SIZE,
+                          instance->bpf.stack_size);
+    bpf_instance_free(instance);
+    bpf_program_release(program);
+
+    /* Programs exceeding the largest stack class are rejected */
+    TEST_ASSERT_NULL(bpf_program_load(deep_stack, sizeof(deep_stack)));
+}
+
+static const uint8_t local_call[] = {
+    0x7a, 0x0a, 0xf8, 0xff, 0x07, 0x00, 0x00, 0x00, /* *(u64 *)(r10 - 8) = 7 */
+    0xb7, 0x06, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r6 = 1 */
+    0x85, 0x10, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, /* call +4 <sub> */
+    0x79, 0xa1, 0xf8, 0xff, 0x00, 0x00, 0x00, 0x00, /* r1 = *(u64 *)(r10 - 8) */
+    0x0f, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 += r1 */
+    0x0f, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 += r6 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+/* sub: */
+    0x7a, 0x0a, 0xf8, 0xff, 0x2a, 0x00, 0x00, 0x00, /* *(u64 *)(r10 - 8) = 42 */
+    0xb7, 0x06, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, /* r6 = 100 */
+    0x79, 0xa0, 0xf8, 0xff, 0x00, 0x00, 0x00, 0x00, /* r0 = *(u64 *)(r10 - 8) */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t recursive_call[] = {
+    0x85, 0x10, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, /* call -1 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t tail_call[] = {
+    0xb7, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = 0 */
+    0x85, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, /* call bpf_tail_call */
+    0xb7, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, /* r0 = 1 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t tail_call_target[] = {
+    0x61, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = *(u32 *)(r1 + 0) */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static void tests_bpf_local_call(void)
+{
+    bpf_t bpf = {
+        .application = local_call,
+        .application_len = sizeof(local_call),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    int64_t result = 0;
+
+    TEST_ASSERT_EQUAL_INT(1, bpf_verify_call_depth(local_call, sizeof(local_call)));
+    TEST_ASSERT_EQUAL_INT(16, bpf_verify_stack_depth(local_call, sizeof(local_call)));
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_CALL,
+                          bpf_verify_call_depth(recursive_call,
+                                                sizeof(recursive_call)));
+
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(8, bpf.frame_size);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, NULL, 0, &result));
+    TEST_ASSERT_EQUAL_INT(50, (int)result);
+}
+
+static const uint8_t mov64_imm[] = {
+    0xb7, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, /* r0 = -1 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t mov64_reg[] = {
+    0x18, 0x01, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, /* r1 = 0x1ffffffff ll */
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0xbf, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = r1 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static void tests_bpf_mov64(void)
+{
+    bpf_t bpf = {
+        .application = mov64_imm,
+        .application_len = sizeof(mov64_imm),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    int64_t result = 0;
+
+    /* The immediate is sign extended to 64 bit */
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, NULL, 0, &result));
+    TEST_ASSERT(result == -1);
+
+    /* The source register is copied without truncation */
+    bpf.application = mov64_reg;
+    bpf.application_len = sizeof(mov64_reg);
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, NULL, 0, &result));
+    TEST_ASSERT(result == 0x1ffffffff);
+}
+
+static void tests_bpf_verify(void)
+{
+    static uint8_t image[sizeof(local_call)];
+    bpf_verify_result_t verified;
+
+#ifdef MODULE_BPF_VERIFY_CACHE
+    bpf_verify_cache_stats_t before, after;
+    bpf_verify_cache_clear();
+    bpf_verify_cache_stats(&before);
+#endif
+
+    TEST_ASSERT_EQUAL_INT(BPF_OK, bpf_verify(local_call, sizeof(local_call),
+                                             &verified));
+    TEST_ASSERT_EQUAL_INT(8, verified.frame_size);
+    TEST_ASSERT_EQUAL_INT(16, verified.stack_depth);
+    TEST_ASSERT_EQUAL_INT(2, verified.num_functions);
+    TEST_ASSERT_EQUAL_INT(0, verified.functions[0]);
+    TEST_ASSERT_EQUAL_INT(7, verified.functions[1]);
+
+    /* Same bytecode at another address */
+    memcpy(image, local_call, sizeof(image));
+    memset(&verified, 0, sizeof(verified));
+    TEST_ASSERT_EQUAL_INT(BPF_OK, bpf_verify(image, sizeof(image), &verified));
+    TEST_ASSERT_EQUAL_INT(16, verified.stack_depth);
+    TEST_ASSERT_EQUAL_INT(2, verified.num_functions);
+    TEST_ASSERT_EQUAL_INT(7, verified.functions[1]);
+
+    /* Uploaded again with a larger frame in the same buffer */
+    image[2] = 0xf0;    /* *(u64 *)(r10 - 16) = 7 */
+    TEST_ASSERT_EQUAL_INT(BPF_OK, bpf_verify(image, sizeof(image), &verified));
+    TEST_ASSERT_EQUAL_INT(16, verified.frame_size);
+    TEST_ASSERT_EQUAL_INT(32, verified.stack_depth);
+
+    /* Failures are remembered too */
+    for (unsigned i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_CALL,
+                              bpf_verify(recursive_call, sizeof(recursive_call),
+                                         &verified));
+    }
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_LEN,
+                          bpf_verify(local_call, sizeof(local_call) - 1,
+                                     &verified));
+
+#ifdef MODULE_BPF_VERIFY_CACHE
+    bpf_verify_cache_stats(&after);
+    TEST_ASSERT_EQUAL_INT(2, after.hits - before.hits);
+    TEST_ASSERT_EQUAL_INT(4, after.misses - before.misses);
+
+    /* Setup computes the frame size without the cache */
+    bpf_t bpf = {
+        .application = image,
+        .application_len = sizeof(image),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(16, bpf.frame_size);
+    bpf_verify_cache_stats(&before);
+    TEST_ASSERT_EQUAL_INT(after.hits, before.hits);
+    TEST_ASSERT_EQUAL_INT(after.misses, before.misses);
+#endif
+}
+
+static const uint8_t fp_sub_int32_min[] = {
+    0xbf, 0xa2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r2 = r10 */
+    0x17, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, /* r2 -= INT32_MIN */
+    0x72, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* *(u8 *)(r2 + 0) = 0 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+#define CALL_GRAPH_FAN_OUT      (32U)
+#define CALL_GRAPH_FUNC_LEN     (CALL_GRAPH_FAN_OUT + 1)
+
+/* Layers of functions, each calling the next layer from all its call sites */
+static size_t _call_graph(bpf_instruction_t *app, unsigned layers)
+{
+    for (unsigned func = 0; func < layers; func++) {
+        bpf_instruction_t *start = &app[func * CALL_GRAPH_FUNC_LEN];
+        for (unsigned i = 0; i < CALL_GRAPH_FAN_OUT; i++) {
+            start[i] = (bpf_instruction_t){
+                .opcode = 0x85,
+                .src = BPF_INSTRUCTION_CALL_PSEUDO,
+                .immediate = CALL_GRAPH_FUNC_LEN - i - 1,
+            };
+        }
+        if (func == layers - 1) {
+            /* The last layer doesn't call */
+            memset(start, 0, CALL_GRAPH_FAN_OUT * sizeof(*start));
+        }
+        start[CALL_GRAPH_FAN_OUT] = (bpf_instruction_t){ .opcode = 0x95 };
+    }
+    return layers * CALL_GRAPH_FUNC_LEN * sizeof(bpf_instruction_t);
+}
+
+static void tests_bpf_verify_call_graph(void)
+{
+    static bpf_instruction_t app[(CONFIG_BPF_VERIFY_MAX_FUNCTIONS + 1) *
+                                 CALL_GRAPH_FUNC_LEN];
+    size_t len;
+
+    /* Every function is analyzed once, not once per call site */
+    len = _call_graph(app, CONFIG_BPF_MAX_CALL_DEPTH + 1);
+    TEST_ASSERT_EQUAL_INT(CONFIG_BPF_MAX_CALL_DEPTH,
+                          bpf_verify_call_depth((uint8_t *)app, len));
+    len = _call_graph(app, CONFIG_BPF_MAX_CALL_DEPTH + 2);
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_CALL,
+                          bpf_verify_call_depth((uint8_t *)app, len));
+
+    /* Too many functions */
+    for (unsigned i = 0; i < CONFIG_BPF_VERIFY_MAX_FUNCTIONS; i++) {
+        app[i] = (bpf_instruction_t){
+            .opcode = 0x85,
+            .src = BPF_INSTRUCTION_CALL_PSEUDO,
+            .immediate = CONFIG_BPF_VERIFY_MAX_FUNCTIONS - 1,
+        };
+        app[CONFIG_BPF_VERIFY_MAX_FUNCTIONS + i] =
+            (bpf_instruction_t){ .opcode = 0x95 };
+    }
+    len = CONFIG_BPF_VERIFY_MAX_FUNCTIONS * 2 * sizeof(bpf_instruction_t);
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_CALL,
+                          bpf_verify_call_depth((uint8_t *)app, len));
+
+    /* Out of range call target */
+    app[0].immediate = -2;
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_JUMP,
+                          bpf_verify_call_depth((uint8_t *)app, len));
+
+    /* The offset of a frame pointer derived register can't be negated */
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_INSTRUCTION,
+                          bpf_verify_stack_depth(fp_sub_int32_min,
+                                                 sizeof(fp_sub_int32_min)));
+}
+
+static void tests_bpf_tail_call(void)
+{
+    static uint8_t target_stack[8];
+    bpf_t target = {
+        .application = tail_call_target,
+        .application_len = sizeof(tail_call_target),
+        .stack = target_stack,
+        .stack_size = sizeof(target_stack),
+    };
+    bpf_t *const programs[] = { &target };
+    bpf_prog_array_t array = { .programs = programs, .len = 1 };
+    bpf_t bpf = {
+        .application = tail_call,
+        .application_len = sizeof(tail_call),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint32_t ctx = 1234;
+    int64_t result = 0;
+
+    bpf_setup(&target);
+    bpf_setup(&bpf);
+
+    /* Without program array the tail call falls through */
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, &ctx, sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(1, (int)result);
+
+    bpf.tail_calls = &array;
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, &ctx, sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(1234, (int)result);
+#if CONFIG_BPF_COUNT_INSTRUCTIONS
+    /* The count includes the target but is kept by the program executed */
+    TEST_ASSERT_EQUAL_INT(4, bpf.instruction_count);
+    TEST_ASSERT_EQUAL_INT(0, target.instruction_count);
+#endif
+}
+
+static const uint8_t hook_add[] = {
+    0x61, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = *(u32 *)(r1 + 0) */
+    0x07, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, /* r0 += 2 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t hook_sub[] = {
+    0x61, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = *(u32 *)(r1 + 0) */
+    0x17, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, /* r0 -= 5 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static const uint8_t hook_zero[] = {
+    0xb7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = 0 */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static void tests_bpf_hooks(void)
+{
+    bpf_t bpf[] = {
+        { .application = hook_add, .application_len = sizeof(hook_add) },
+        { .application = hook_sub, .application_len = sizeof(hook_sub) },
+        { .application = hook_zero, .application_len = sizeof(hook_zero) },
+    };
+    bpf_hook_t hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF + 1] = {
+        { .application = &bpf[0], .policy = BPF_POLICY_CONTINUE },
+        { .application = &bpf[1], .policy = BPF_POLICY_ABORT_ON_NEGATIVE },
+        { .application = &bpf[2], .policy = BPF_POLICY_SINGLE },
+    };
+    uint32_t ctx = 1;
+    int64_t result = 42;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(bpf); i++) {
+        bpf[i].stack = _bpf_stack;
+        bpf[i].stack_size = sizeof(_bpf_stack);
+        bpf_setup(&bpf[i]);
+    }
+
+    /* Without hooks the result is left untouched */
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(42, (int)result);
+
+    /* Hooks are installed at the front, hook_sub aborts the chain */
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_install(&hooks[0], BPF_HOOK_TRIGGER_NETIF));
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_install(&hooks[1], BPF_HOOK_TRIGGER_NETIF));
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(-4, (int)result);
+    TEST_ASSERT_EQUAL_INT(0, hooks[0].executions);
+    TEST_ASSERT_EQUAL_INT(1, hooks[1].executions);
+
+    /* A positive result continues the chain */
+    ctx = 7;
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(9, (int)result);
+    TEST_ASSERT_EQUAL_INT(1, hooks[0].executions);
+
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_uninstall(&hooks[1], BPF_HOOK_TRIGGER_NETIF));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, bpf_hook_uninstall(&hooks[1],
+                                                      BPF_HOOK_TRIGGER_NETIF));
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_install(&hooks[2], BPF_HOOK_TRIGGER_NETIF));
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(0, (int)result);
+    TEST_ASSERT_EQUAL_INT(1, hooks[0].executions);
+
+    /* The chain of a trigger is limited */
+    for (unsigned i = 3; i < ARRAY_SIZE(hooks); i++) {
+        hooks[i] = (bpf_hook_t){ .application = &bpf[0] };
+    }
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_install(&hooks[1], BPF_HOOK_TRIGGER_NETIF));
+    for (unsigned i = 3; i < CONFIG_BPF_HOOK_CHAIN_NUMOF; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bpf_hook_install(&hooks[i], BPF_HOOK_TRIGGER_NETIF));
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, bpf_hook_install(&hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF],
+                                                    BPF_HOOK_TRIGGER_NETIF));
+
+    for (unsigned i = 0; i < CONFIG_BPF_HOOK_CHAIN_NUMOF; i++) {
+        TEST_ASSERT_EQUAL_INT(0, bpf_hook_uninstall(&hooks[i], BPF_HOOK_TRIGGER_NETIF));
+    }
+    result = 42;
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(42, (int)result);
+}
+
+static bpf_hook_t _reentrant_hooks[3];
+
+/* Changes the chain twice while it is running */
+static int _reentrant(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    (void)bpf;
+    (void)ctx;
+    if (_reentrant_hooks[0].executions == 0) {
+        bpf_hook_uninstall(&_reentrant_hooks[1], BPF_HOOK_TRIGGER_NETIF);
+        bpf_hook_install(&_reentrant_hooks[2], BPF_HOOK_TRIGGER_NETIF);
+    }
+    *result = 1;
+    return BPF_OK;
+}
+
+static void tests_bpf_hooks_rebuild(void)
+{
+    bpf_t bpf = {
+        .application = hook_zero,
+        .application_len = sizeof(hook_zero),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint32_t ctx = 1;
+    int64_t result;
+
+    bpf_setup(&bpf);
+    bpf.native = _reentrant;
+    for (unsigned i = 0; i < ARRAY_SIZE(_reentrant_hooks); i++) {
+        _reentrant_hooks[i] = (bpf_hook_t){ .application = &bpf };
+    }
+
+    /* The running execution keeps the chain of 0 and 1 it started with, the
+     * next one runs the rebuilt chain of 2 and 0 */
+    bpf_hook_install(&_reentrant_hooks[1], BPF_HOOK_TRIGGER_NETIF);
+    bpf_hook_install(&_reentrant_hooks[0], BPF_HOOK_TRIGGER_NETIF);
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(1, _reentrant_hooks[0].executions);
+    TEST_ASSERT_EQUAL_INT(1, _reentrant_hooks[1].executions);
+    TEST_ASSERT_EQUAL_INT(0, _reentrant_hooks[2].executions);
+
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(2, _reentrant_hooks[0].executions);
+    TEST_ASSERT_EQUAL_INT(1, _reentrant_hooks[1].executions);
+    TEST_ASSERT_EQUAL_INT(1, _reentrant_hooks[2].executions);
+
+    bpf_hook_uninstall(&_reentrant_hooks[0], BPF_HOOK_TRIGGER_NETIF);
+    bpf_hook_uninstall(&_reentrant_hooks[2], BPF_HOOK_TRIGGER_NETIF);
+}
+
+static bpf_hook_t _full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF + 2];
+static int _full_install[2];
+static bool _full_changed;
+
+/* Replaces a hook of a full chain while it is running, then runs the chain
+ * again */
+static int _replace(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    (void)bpf;
+    *result = 1;
+    if (!_full_changed) {
+        int64_t nested;
+
+        _full_changed = true;
+        bpf_hook_uninstall(&_full_hooks[1], BPF_HOOK_TRIGGER_NETIF);
+        _full_install[0] = bpf_hook_install(
+            &_full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF], BPF_HOOK_TRIGGER_NETIF);
+        _full_install[1] = bpf_hook_install(
+            &_full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF + 1],
+            BPF_HOOK_TRIGGER_NETIF);
+        bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, (void *)ctx, sizeof(uint32_t),
+                         &nested);
+    }
+    return BPF_OK;
+}
+
+static void tests_bpf_hooks_full(void)
+{
+    bpf_t bpf = {
+        .application = hook_zero,
+        .application_len = sizeof(hook_zero),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint32_t ctx = 1;
+    int64_t result;
+
+    bpf_setup(&bpf);
+    bpf.native = _replace;
+    _full_changed = false;
+    for (unsigned i = 0; i < ARRAY_SIZE(_full_hooks); i++) {
+        _full_hooks[i] = (bpf_hook_t){ .application = &bpf };
+    }
+    /* Installed at the front, so 0 runs first */
+    for (unsigned i = CONFIG_BPF_HOOK_CHAIN_NUMOF; i-- > 0;) {
+        TEST_ASSERT_EQUAL_INT(0, bpf_hook_install(&_full_hooks[i],
+                                                  BPF_HOOK_TRIGGER_NETIF));
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOSPC,
+                          bpf_hook_install(&_full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF],
+                                           BPF_HOOK_TRIGGER_NETIF));
+
+    /* The chain stays full while the replacing hook is running, the nested
+     * execution runs the new chain without the removed hook and the outer
+     * one finishes the chain it started with */
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(0, _full_install[0]);
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, _full_install[1]);
+    TEST_ASSERT_EQUAL_INT(2, _full_hooks[0].executions);
+    TEST_ASSERT_EQUAL_INT(1, _full_hooks[1].executions);
+    TEST_ASSERT_EQUAL_INT(1, _full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF].executions);
+    TEST_ASSERT_EQUAL_INT(0,
+        _full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF + 1].executions);
+
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &ctx,
+                                              sizeof(ctx), &result));
+    TEST_ASSERT_EQUAL_INT(1, _full_hooks[1].executions);
+    TEST_ASSERT_EQUAL_INT(2, _full_hooks[CONFIG_BPF_HOOK_CHAIN_NUMOF].executions);
+
+    for (unsigned i = 0; i <= CONFIG_BPF_HOOK_CHAIN_NUMOF; i++) {
+        bpf_hook_uninstall(&_full_hooks[i], BPF_HOOK_TRIGGER_NETIF);
+    }
+}
+
+static void tests_bpf_mem_helpers(void)
+{
+    bpf_t bpf = {
+        .application = mem_helpers,
+        .application_len = sizeof(mem_helpers),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint8_t ctx[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int64_t result = 0;
+
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, ctx, sizeof(ctx), &result));
+    /* Equal memcmp result in the upper word, denied memcpy in the lower */
+    TEST_ASSERT_EQUAL_INT(0, (int)(result >> 32));
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_MEM, (int32_t)result);
+
+    /* The context stays registered after the run, use a separate area */
+    uint8_t data[8];
+    bpf_mem_region_t region;
+    bpf_add_region(&bpf, &region, data, sizeof(data), BPF_MEM_REGION_READ);
+    TEST_ASSERT_EQUAL_INT(0, bpf_check_mem(&bpf, (intptr_t)data, sizeof(data),
+                                           BPF_MEM_REGION_READ));
+    TEST_ASSERT_EQUAL_INT(-1, bpf_check_mem(&bpf, (intptr_t)data, sizeof(data),
+                                            BPF_MEM_REGION_WRITE));
+    TEST_ASSERT_EQUAL_INT(-1, bpf_check_mem(&bpf, (intptr_t)data, sizeof(data) + 1,
+                                            BPF_MEM_REGION_READ));
+    /* An area wrapping around the address space ends below its start */
+    TEST_ASSERT_EQUAL_INT(-1, bpf_check_mem(&bpf, (intptr_t)&data[4],
+                                            SIZE_MAX - 1, BPF_MEM_REGION_READ));
+}
+
+static void tests_bpf_pkt(void)
+{
+    bpf_t bpf = {
+        .application = pkt_loads,
+        .application_len = sizeof(pkt_loads),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint8_t netif[4] = { 0 };
+    uint8_t header[] = { 0x12, 0x34, 0x56, 0x78 };
+    uint8_t payload[] = { 0x9a, 0xbc };
+    gnrc_pktsnip_t payload_snip = {
+        .data = payload, .size = sizeof(payload), .type = GNRC_NETTYPE_UNDEF,
+    };
+    gnrc_pktsnip_t header_snip = {
+        .next = &payload_snip, .data = header, .size = sizeof(header),
+        .type = GNRC_NETTYPE_UNDEF,
+    };
+    gnrc_pktsnip_t netif_snip = {
+        .next = &header_snip, .data = netif, .size = sizeof(netif),
+        .type = GNRC_NETTYPE_NETIF,
+    };
+    int64_t result = 0;
+
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_pkt_execute(&bpf, &netif_snip, &result));
+    TEST_ASSERT(result == 0x56789abc12343456);
+    TEST_ASSERT_NULL(bpf.pkt);
+
+    bpf_pkt_t state = { .pkt = &header_snip, .snip = &header_snip, .len = 6 };
+    uint8_t buf[3];
+    TEST_ASSERT_EQUAL_INT(0, bpf_pkt_load(&state, 3, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0x78, buf[0]);
+    TEST_ASSERT_EQUAL_INT(0xbc, buf[2]);
+    TEST_ASSERT_EQUAL_INT(-1, bpf_pkt_load(&state, 4, buf, sizeof(buf)));
+}
+
+static void tests_bpf_map_lpm(void)
+{
+    static bpf_map_lpm_node_t nodes[6];
+    bpf_map_lpm_t map;
+    ipv6_addr_t prefix = {{ 0x20, 0x01, 0x0d, 0xb8 }};
+    ipv6_addr_t addr = {{ 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01 }};
+    uint32_t value = 0;
+
+    bpf_map_lpm_init(&map, 1, nodes, ARRAY_SIZE(nodes));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, bpf_map_lpm_lookup(&map, &addr, &value));
+
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&map, &prefix, 32, 32));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&map, &addr, 48, 48));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&map, &prefix, 0, 0));
+    /* Branches off the /48 at bit 47 */
+    addr.u8[5] = 0x00;
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&map, &addr, 48, 480));
+
+    addr.u8[5] = 0x01;
+    addr.u8[15] = 0x01;
+    TEST_ASSERT_EQUAL_INT(48, bpf_map_lpm_lookup(&map, &addr, &value));
+    TEST_ASSERT_EQUAL_INT(48, value);
+    addr.u8[5] = 0x00;
+    TEST_ASSERT_EQUAL_INT(48, bpf_map_lpm_lookup(&map, &addr, &value));
+    TEST_ASSERT_EQUAL_INT(480, value);
+    addr.u8[5] = 0x02;
+    TEST_ASSERT_EQUAL_INT(32, bpf_map_lpm_lookup(&map, &addr, &value));
+    TEST_ASSERT_EQUAL_INT(32, value);
+    addr.u8[0] = 0xfe;
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_lookup(&map, &addr, &value));
+
+    TEST_ASSERT_EQUAL_INT(-ENOENT, bpf_map_lpm_remove(&map, &prefix, 16));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_remove(&map, &prefix, 32));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_remove(&map, &prefix, 0));
+    addr.u8[0] = 0x20;
+    TEST_ASSERT_EQUAL_INT(-ENOENT, bpf_map_lpm_lookup(&map, &addr, &value));
+    addr.u8[5] = 0x00;
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_remove(&map, &addr, 48));
+    addr.u8[5] = 0x01;
+    TEST_ASSERT_EQUAL_INT(48, bpf_map_lpm_lookup(&map, &addr, &value));
+    TEST_ASSERT_EQUAL_INT(48, value);
+    TEST_ASSERT(map.root->has_value);
+    TEST_ASSERT_NULL(map.root->child[0]);
+    TEST_ASSERT_NULL(map.root->child[1]);
+}
+
+static void tests_bpf_map_bloom(void)
+{
+    static uint8_t bitfield[16];
+    static hashfp_t hashes[] = { (hashfp_t)fnv_hash, (hashfp_t)sdbm_hash };
+    bpf_map_bloom_t map;
+    bpf_t bpf = {
+        .application = map_bloom_check,
+        .application_len = sizeof(map_bloom_check),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    uint8_t key[4] = { 1, 2, 3, 4 };
+    int64_t result = 0;
+
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, key, sizeof(key), &result));
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_CALL, (int32_t)result);
+
+    bpf_map_bloom_init(&map, 7, bitfield, sizeof(bitfield) * 8, hashes,
+                       ARRAY_SIZE(hashes));
+    bpf_map_register(&map.super);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, key, sizeof(key), &result));
+    TEST_ASSERT_EQUAL_INT(0, (int)result);
+
+    bpf_map_bloom_add(&map, key, sizeof(key));
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, key, sizeof(key), &result));
+    TEST_ASSERT_EQUAL_INT(1, (int)result);
+    bpf_map_unregister(&map.super);
+}
+
+#ifdef MODULE_BPF_MPU
+/* Page aligned for the isolation on native */
+static uint8_t _isolated_stack[4096] __attribute__((aligned(4096)));
+static uint8_t _isolated_ro[4096] __attribute__((aligned(4096)));
+
+/* Unchecked accesses, as compiled by bpf_aot.py --unchecked */
+static int _isolated_load(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    (void)bpf;
+    (void)ctx;
+    *result = *(volatile uint8_t *)_isolated_ro;
+    return BPF_OK;
+}
+
+static int _isolated_store(bpf_t *bpf, const void *ctx, int64_t *result)
+{
+    (void)bpf;
+    (void)ctx;
+    *(volatile uint8_t *)_isolated_ro = 1;
+    *result = 0;
+    return BPF_OK;
+}
+
+static void tests_bpf_mpu(void)
+{
+    bpf_mem_region_t region;
+    bpf_t bpf = {
+        .native = _isolated_load,
+        .stack = _isolated_stack,
+        .stack_size = sizeof(_isolated_stack),
+        .flags = BPF_FLAG_ISOLATED,
+    };
+    int64_t result = 0;
+
+    bpf_setup(&bpf);
+    bpf_add_region(&bpf, &region, _isolated_ro, sizeof(_isolated_ro),
+                   BPF_MEM_REGION_READ);
+    _isolated_ro[0] = 42;
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, NULL, 0, &result));
+    TEST_ASSERT_EQUAL_INT(42, (int)result);
+
+    bpf.native = _isolated_store;
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_MEM,
+                          bpf_execute(&bpf, NULL, 0, &result));
+    /* Writable again after the execution */
+    _isolated_ro[0] = 0;
+
+    /* The context can't be protected */
+    uint8_t ctx[8];
+    TEST_ASSERT_EQUAL_INT(-EINVAL,
+                          bpf_execute(&bpf, ctx, sizeof(ctx), &result));
+}
+
+/* bpf/isolated.bin, compiled by BPF_AOT_ISOLATED_PROGRAMS:
+ *
+ *     r6 = r10
+ *     r6 += -8
+ *     r1 = r6
+ *     r2 = 42
+ *     r3 = 8
+ *     call bpf_memset
+ *     r0 = *(u8 *)(r10 - 1)
+ *     exit
+ */
+static void tests_bpf_mpu_aot(void)
+{
+    bpf_t bpf = {
+        .native = bpf_aot_isolated,
+        .stack = _isolated_stack,
+        .stack_size = sizeof(_isolated_stack),
+        .flags = BPF_FLAG_ISOLATED,
+    };
+    int64_t result = 0;
+
+    bpf_setup(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_execute(&bpf, NULL, 0, &result));
+    TEST_ASSERT_EQUAL_INT(42, (int)result);
+
+    /* Unknown helpers are rejected behind the gate as well */
+    TEST_ASSERT_EQUAL_INT(BPF_ILLEGAL_CALL,
+                          (int32_t)bpf_mpu_call(&bpf, UINT32_MAX, 0, 0, 0, 0, 0));
+}
+#endif
+
+#ifdef MODULE_BPF_SNAPSHOT
+static uint8_t _image[512];
+static size_t _image_pos;
+
+static int _image_write(void *arg, size_t offset, const void *buf, size_t len)
+{
+    (void)arg;
+    if (offset + len > sizeof(_image)) {
+        return -ENOSPC;
+    }
+    memcpy(_image + offset, buf, len);
+    return 0;
+}
+
+static ssize_t _image_read(void *arg, void *buf, size_t len)
+{
+    (void)arg;
+    if (len > sizeof(_image) - _image_pos) {
+        len = sizeof(_image) - _image_pos;
+    }
+    memcpy(buf, _image + _image_pos, len);
+    _image_pos += len;
+    return len;
+}
+
+static void tests_bpf_snapshot(void)
+{
+    static bpf_map_lpm_node_t nodes[4];
+    bpf_map_lpm_t map;
+    bpf_snapshot_app_t app;
+    bpf_t bpf = { 0 };
+    ipv6_addr_t prefix = {{ 0x20, 0x01, 0x0d, 0xb8 }};
+    uint32_t value = 0;
+
+    bpf_map_lpm_init(&map, 9, nodes, ARRAY_SIZE(nodes));
+    bpf_map_register(&map.super);
+    bpf_snapshot_register(&app, &bpf, 3);
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&map, &prefix, 32, 7));
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_update_global(0x5a5a, 1));
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_update_local(&bpf, 0xa5a5, 2));
+
+    /* Everything is written once, after that only the changes */
+    size_t pages = (bpf_snapshot_len() + CONFIG_BPF_SNAPSHOT_PAGE_SIZE - 1) /
+                   CONFIG_BPF_SNAPSHOT_PAGE_SIZE;
+    TEST_ASSERT_EQUAL_INT(pages, bpf_snapshot_save(_image_write, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bpf_snapshot_save(_image_write, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_update_global(0x5a5a, 1));
+    TEST_ASSERT_EQUAL_INT(0, bpf_snapshot_save(_image_write, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_update_global(0x5a5a, 10));
+    TEST_ASSERT_EQUAL_INT(1, bpf_snapshot_save(_image_write, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&map, &prefix, 32, 70));
+    TEST_ASSERT_EQUAL_INT(1, bpf_snapshot_save(_image_write, NULL));
+
+    /* Lose the state and restore it */
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_update_global(0x5a5a, 0));
+    bpf_store_clear_local(&bpf);
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_remove(&map, &prefix, 32));
+    _image_pos = 0;
+    TEST_ASSERT_EQUAL_INT(0, bpf_snapshot_restore(_image_read, NULL));
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_fetch_global(0x5a5a, &value));
+    TEST_ASSERT_EQUAL_INT(10, value);
+    TEST_ASSERT_EQUAL_INT(0, bpf_store_fetch_local(&bpf, 0xa5a5, &value));
+    TEST_ASSERT_EQUAL_INT(2, value);
+    TEST_ASSERT_EQUAL_INT(32, bpf_map_lpm_lookup(&map, &prefix, &value));
+    TEST_ASSERT_EQUAL_INT(70, value);
+
+    _image[0] = 0;
+    _image_pos = 0;
+    TEST_ASSERT_EQUAL_INT(-EINVAL, bpf_snapshot_restore(_image_read, NULL));
+
+    bpf_snapshot_unregister(&app);
+    bpf_store_clear_local(&bpf);
+    bpf_map_unregister(&map.super);
+}
+
+static void tests_bpf_snapshot_maps(void)
+{
+    static bpf_map_lpm_node_t nodes[4];
+    static uint8_t bitfield[16];
+    static uint8_t saved[sizeof(bitfield)];
+    static hashfp_t hashes[] = { (hashfp_t)fnv_hash, (hashfp_t)sdbm_hash };
+    bpf_map_lpm_t lpm;
+    bpf_map_bloom_t bloom;
+    ipv6_addr_t prefix = {{ 0x20, 0x01, 0x0d, 0xb8 }};
+    ipv6_addr_t other = {{ 0x20, 0x01, 0x0d, 0xb9 }};
+    uint8_t key[4] = { 1, 2, 3, 4 };
+    uint32_t value = 0;
+
+    bpf_map_lpm_init(&lpm, 9, nodes, ARRAY_SIZE(nodes));
+    bpf_map_register(&lpm.super);
+    bpf_map_bloom_init(&bloom, 10, bitfield, sizeof(bitfield) * 8, hashes,
+                       ARRAY_SIZE(hashes));
+    bpf_map_register(&bloom.super);
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&lpm, &prefix, 32, 7));
+    bpf_map_bloom_add(&bloom, key, sizeof(key));
+    memcpy(saved, bitfield, sizeof(saved));
+    TEST_ASSERT(bpf_snapshot_save(_image_write, NULL) > 0);
+
+    /* Changes after the snapshot are undone, not merged */
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&lpm, &other, 32, 8));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_remove(&lpm, &prefix, 32));
+    memset(bitfield, 0xff, sizeof(bitfield));
+    _image_pos = 0;
+    TEST_ASSERT_EQUAL_INT(0, bpf_snapshot_restore(_image_read, NULL));
+    TEST_ASSERT_EQUAL_INT(32, bpf_map_lpm_lookup(&lpm, &prefix, &value));
+    TEST_ASSERT_EQUAL_INT(7, value);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, bpf_map_lpm_lookup(&lpm, &other, NULL));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(saved, bitfield, sizeof(saved)));
+
+    /* The restored trie still has all of its nodes */
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_add(&lpm, &other, 32, 8));
+    TEST_ASSERT_EQUAL_INT(0, bpf_map_lpm_remove(&lpm, &other, 32));
+    bpf_map_lpm_clear(&lpm);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, bpf_map_lpm_lookup(&lpm, &prefix, NULL));
+
+    bpf_map_unregister(&bloom.super);
+    bpf_map_unregister(&lpm.super);
+}
+#endif
+
+#ifdef MODULE_BPF_SCHED
+static const uint8_t sched_app[] = {
+    0x69, 0x10, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, /* r0 = *(u16 *)(r1 + 2) */
+    0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* exit */
+};
+
+static int _sched_res;
+static int64_t _sched_result;
+static bpf_sched_entry_t *_sched_chained;
+
+static void _sched_done(bpf_sched_entry_t *entry, int res, int64_t result)
+{
+    (void)entry;
+    _sched_res = res;
+    _sched_result = result;
+}
+
+static void _sched_trigger_chained(bpf_sched_entry_t *entry, int res,
+                                   int64_t result)
+{
+    (void)entry;
+    (void)res;
+    (void)result;
+    /* Called from the runtime thread, the entry stays pending */
+    bpf_sched_trigger(_sched_chained);
+    bpf_sched_trigger(_sched_chained);
+}
+
+static void tests_bpf_sched_periodic(void)
+{
+    bpf_t bpf = {
+        .application = sched_app,
+        .application_len = sizeof(sched_app),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_sched_entry_t entry;
+    uint32_t ctx = 0x00070000;
+
+    bpf_setup(&bpf);
+    bpf_sched_entry_init(&entry, &bpf, &ctx, sizeof(ctx), BPF_SCHED_PRIO_LOW,
+                         _sched_done);
+    _sched_result = 0;
+    bpf_sched_periodic(&entry, ZTIMER_MSEC, 10);
+    ztimer_sleep(ZTIMER_MSEC, 55);
+    bpf_sched_stop(&entry);
+
+    /* Five intervals passed, allow one of jitter */
+    TEST_ASSERT(entry.executions >= 4);
+    TEST_ASSERT(entry.executions <= 6);
+    TEST_ASSERT_EQUAL_INT(BPF_OK, _sched_res);
+    TEST_ASSERT_EQUAL_INT(7, (int)_sched_result);
+
+    uint32_t executions = entry.executions;
+    ztimer_sleep(ZTIMER_MSEC, 30);
+    TEST_ASSERT_EQUAL_INT(executions, entry.executions);
+}
+
+static void tests_bpf_sched_coalesce(void)
+{
+    bpf_t bpf = {
+        .application = sched_app,
+        .application_len = sizeof(sched_app),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_sched_entry_t high, low;
+    uint32_t ctx = 0x00070000;
+
+    bpf_setup(&bpf);
+    bpf_sched_entry_init(&high, &bpf, &ctx, sizeof(ctx), BPF_SCHED_PRIO_HIGH,
+                         _sched_trigger_chained);
+    bpf_sched_entry_init(&low, &bpf, &ctx, sizeof(ctx), BPF_SCHED_PRIO_LOW,
+                         _sched_done);
+    _sched_chained = &low;
+
+    /* The runtime thread preempts the test, both entries are done after */
+    bpf_sched_trigger(&high);
+    TEST_ASSERT_EQUAL_INT(1, high.executions);
+    TEST_ASSERT_EQUAL_INT(0, high.coalesced);
+    TEST_ASSERT_EQUAL_INT(1, low.executions);
+    TEST_ASSERT_EQUAL_INT(1, low.coalesced);
+
+    bpf_sched_stop(&high);
+    bpf_sched_stop(&low);
+}
+
+static void tests_bpf_sched_msg(void)
+{
+    bpf_t bpf = {
+        .application = sched_app,
+        .application_len = sizeof(sched_app),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_sched_entry_t entry;
+    msg_t msg = { .type = 0x4242, .content.value = 1 };
+
+    bpf_setup(&bpf);
+    bpf_sched_entry_init(&entry, &bpf, NULL, 0, BPF_SCHED_PRIO_HIGH,
+                         _sched_done);
+    bpf_sched_msg(&entry, 0x4242);
+
+    TEST_ASSERT_EQUAL_INT(1, bpf_sched_msg_dispatch(&msg));
+    TEST_ASSERT_EQUAL_INT(1, entry.executions);
+    TEST_ASSERT_EQUAL_INT(0x4242, (int)_sched_result);
+    TEST_ASSERT_EQUAL_INT(1, entry.msg.content.value);
+
+    msg.type = 0x4243;
+    TEST_ASSERT_EQUAL_INT(0, bpf_sched_msg_dispatch(&msg));
+    TEST_ASSERT_EQUAL_INT(1, entry.executions);
+
+    bpf_sched_stop(&entry);
+    msg.type = 0x4242;
+    TEST_ASSERT_EQUAL_INT(0, bpf_sched_msg_dispatch(&msg));
+    TEST_ASSERT_EQUAL_INT(1, entry.executions);
+}
+
+static void tests_bpf_sched_hook(void)
+{
+    bpf_t bpf = {
+        .application = sched_app,
+        .application_len = sizeof(sched_app),
+        .stack = _bpf_stack,
+        .stack_size = sizeof(_bpf_stack),
+    };
+    bpf_sched_entry_t entry;
+    uint32_t ctx = 0x00070000;
+    uint32_t hook_ctx = 0x00080000;
+    int64_t result = 42;
+
+    bpf_setup(&bpf);
+    bpf_sched_entry_init(&entry, &bpf, &ctx, sizeof(ctx), BPF_SCHED_PRIO_HIGH,
+                         _sched_done);
+    TEST_ASSERT_EQUAL_INT(0, bpf_sched_hook(&entry, BPF_HOOK_TRIGGER_NETIF));
+
+    /* The entry runs with its own context and leaves the chain result */
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &hook_ctx,
+                                              sizeof(hook_ctx), &result));
+    TEST_ASSERT_EQUAL_INT(42, (int)result);
+    TEST_ASSERT_EQUAL_INT(1, entry.executions);
+    TEST_ASSERT_EQUAL_INT(7, (int)_sched_result);
+
+    bpf_sched_stop(&entry);
+    TEST_ASSERT_EQUAL_INT(0, bpf_hook_execute(BPF_HOOK_TRIGGER_NETIF, &hook_ctx,
+                                              sizeof(hook_ctx), &result));
+    TEST_ASSERT_EQUAL_INT(1, entry.executions);
+}
+#endif
 
 Test *tests_bpf(void)
 {
@@ -163,6 +1359,35 @@ Test *tests_bpf(void)
         new_TestFixture(tests_bpf_run2),
         new_TestFixture(tests_bpf_storage),
         new_TestFixture(tests_bpf_saul),
+        new_TestFixture(tests_bpf_saul_cache),
+        new_TestFixture(tests_bpf_instance),
+        new_TestFixture(tests_bpf_stack_depth),
+        new_TestFixture(tests_bpf_local_call),
+        new_TestFixture(tests_bpf_mov64),
+        new_TestFixture(tests_bpf_verify),
+        new_TestFixture(tests_bpf_verify_call_graph),
+        new_TestFixture(tests_bpf_tail_call),
+        new_TestFixture(tests_bpf_hooks),
+        new_TestFixture(tests_bpf_hooks_rebuild),
+        new_TestFixture(tests_bpf_hooks_full),
+        new_TestFixture(tests_bpf_mem_helpers),
+        new_TestFixture(tests_bpf_pkt),
+        new_TestFixture(tests_bpf_map_lpm),
+        new_TestFixture(tests_bpf_map_bloom),
+#ifdef MODULE_BPF_MPU
+        new_TestFixture(tests_bpf_mpu),
+        new_TestFixture(tests_bpf_mpu_aot),
+#endif
+#ifdef MODULE_BPF_SNAPSHOT
+        new_TestFixture(tests_bpf_snapshot),
+        new_TestFixture(tests_bpf_snapshot_maps),
+#endif
+#ifdef MODULE_BPF_SCHED
+        new_TestFixture(tests_bpf_sched_periodic),
+        new_TestFixture(tests_bpf_sched_coalesce),
+        new_TestFixture(tests_bpf_sched_msg),
+        new_TestFixture(tests_bpf_sched_hook),
+#endif
     };
 
     EMB_UNIT_TESTCALLER(bpf_tests, _init, NULL, fixtures);
@@ -171,6 +1396,8 @@ Test *tests_bpf(void)
 
 int main(void)
 {
+    bpf_init();
+
     TESTS_START();
     TESTS_RUN(tests_bpf());
     TESTS_END();
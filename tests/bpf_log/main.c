@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests the bpf log buffer
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bpf.h"
+#include "bpf/log.h"
+
+static uint8_t _stack[64];
+
+static void _write(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+                   uint32_t a3)
+{
+    const uint32_t args[BPF_LOG_ARGS_NUMOF] = { a0, a1, a2, a3 };
+
+    bpf_log_write(fmt, strlen(fmt), args);
+}
+
+static void _test_format(void)
+{
+    static const uint32_t args[BPF_LOG_ARGS_NUMOF] = { 0 };
+
+    _write("ints: %d %u %x %c\n", (uint32_t)-5, 7, 0xbeef, 'A');
+    _write("flags: %05lu|%-4x|%+d|%X\n", 42, 0xa, 3, 0xbeef);
+    _write("verbatim: %s %p %d %%\n", 1, 2, 7, 0);
+    _write("excess: %u %u %u %u %u\n", 1, 2, 3, 4);
+    /* Only the given length of the format string is logged */
+    bpf_log_write("length: abc|ignored", 11, args);
+    bpf_log_write("\n", 1, args);
+
+    printf("format: %u records\n", bpf_log_drain());
+}
+
+static const char *_result(int res)
+{
+    switch (res) {
+        case 0:
+            return "ok";
+        case -EFAULT:
+            return "EFAULT";
+        case -ENOBUFS:
+            return "ENOBUFS";
+        default:
+            return "unexpected";
+    }
+}
+
+static void _test_overflow(void)
+{
+    static const uint32_t args[BPF_LOG_ARGS_NUMOF] = { 0 };
+    uint32_t dropped = bpf_log_dropped();
+    unsigned fit = 0;
+
+    /* Empty records print nothing */
+    while (bpf_log_write("", 0, args) == 0) {
+        fit++;
+    }
+    int res = bpf_log_write("", 0, args);
+    dropped = bpf_log_dropped() - dropped;
+    unsigned drained = bpf_log_drain();
+    unsigned left = bpf_log_drain();
+
+    printf("overflow: %u fit, %u dropped, %u drained, %u left\n",
+           fit, (unsigned)dropped, drained, left);
+    printf("overflow: %s\n", _result(res));
+}
+
+static void _test_printf(void)
+{
+    static const uint32_t args[BPF_LOG_ARGS_NUMOF] = { 1 };
+    static const char outside[] = "denied\n";
+    bpf_t bpf = {
+        .stack = _stack,
+        .stack_size = sizeof(_stack),
+    };
+
+    bpf_setup(&bpf);
+    strcpy((char *)_stack, "printf: %u\n");
+    printf("printf: %s\n",
+           _result(bpf_log_printf(&bpf, (const char *)_stack, args)));
+    printf("printf: %s\n", _result(bpf_log_printf(&bpf, outside, args)));
+    /* Unterminated at the end of the stack */
+    memset(_stack, 'x', sizeof(_stack));
+    printf("printf: %s\n",
+           _result(bpf_log_printf(&bpf, (const char *)&_stack[sizeof(_stack) - 4],
+                                  args)));
+    bpf_log_drain();
+}
+
+int main(void)
+{
+    _test_format();
+    _test_overflow();
+    _test_printf();
+    puts("DONE");
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2020 Inria
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    child.expect_exact('ints: -5 7 beef A')
+    child.expect_exact('flags: 00042|a   |+3|BEEF')
+    child.expect_exact('verbatim: %s %p 7 %')
+    child.expect_exact('excess: 1 2 3 4 %u')
+    child.expect(r'length: abc\r?\n')
+    child.expect_exact('format: 6 records')
+    child.expect(r'overflow: (\d+) fit, (\d+) dropped, (\d+) drained, (\d+) left')
+    fit, dropped, drained, left = (int(n) for n in child.match.groups())
+    assert fit > 0
+    assert dropped == 2
+    assert drained == fit
+    assert left == 0
+    child.expect_exact('overflow: ENOBUFS')
+    child.expect_exact('printf: ok')
+    child.expect_exact('printf: EFAULT')
+    child.expect_exact('printf: EFAULT')
+    child.expect_exact('printf: 1')
+    child.expect_exact('DONE')
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -14,6 +14,7 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <stdio.h>
 
 #include "common.h"
@@ -37,6 +38,8 @@ static gnrc_netreg_entry_t dumper_undef, dumper_ipv6;
 static msg_t _main_msg_queue[MSG_QUEUE_SIZE];
 static uint8_t tmp_buffer[ETHERNET_DATA_LEN];
 static size_t tmp_buffer_bytes = 0;
+static uint8_t lent_buffer[ETHERNET_DATA_LEN];
+static bool lent = false;
 
 static int _dump_send_packet(netdev_t *netdev, const iolist_t *iolist)
 {
@@ -85,6 +88,42 @@ void _test_trigger_recv(gnrc_netif_t *netif, const uint8_t *data,
     netdev_trigger_event_isr(dev);
 }
 
+static int _netdev_recv_loan(netdev_t *dev, void **buf, void *info)
+{
+    if (lent) {
+        return -ENOBUFS;
+    }
+    memcpy(lent_buffer, tmp_buffer, tmp_buffer_bytes);
+    lent = true;
+    *buf = lent_buffer;
+    if ((dev == ieee802154_dev) && (info != NULL)) {
+        netdev_ieee802154_rx_info_t *rx_info = info;
+
+        rx_info->rssi = 0;
+        rx_info->lqi = TEST_LENT_LQI;
+    }
+    return (int)tmp_buffer_bytes;
+}
+
+static void _netdev_recv_release(netdev_t *dev, void *buf)
+{
+    (void)dev;
+    expect(lent && (buf == lent_buffer));
+    lent = false;
+    puts("Lent buffer released");
+}
+
+void _test_trigger_recv_lent(gnrc_netif_t *netif, const uint8_t *data,
+                             size_t data_len)
+{
+    netdev_test_t *dev = (netdev_test_t *)netif->dev;
+
+    netdev_test_set_recv_loan_cb(dev, _netdev_recv_loan, _netdev_recv_release);
+    _test_trigger_recv(netif, data, data_len);
+    /* the buffer may be released later, so keep the release callback */
+    netdev_test_set_recv_loan_cb(dev, NULL, _netdev_recv_release);
+}
+
 static int _netdev_recv(netdev_t *dev, char *buf, int len, void *info)
 {
     int res;
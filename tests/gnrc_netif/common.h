@@ -67,6 +67,7 @@ extern "C" {
 #define ULA8 (0x1aU)
 
 #define TEST_IEEE802154_MAX_FRAG_SIZE   (102)
+#define TEST_LENT_LQI                   (0xabU)
 
 #define ETHERNET_SRC        { LA1, LA2, LA3, LA6, LA7, LA8 }
 #define ETHERNET_IPV6_LL    { LP1, LP2, LP3, LP4, LP5, LP6, LP7, LP8, \
@@ -100,6 +101,9 @@ extern netdev_t *devs[DEFAULT_DEVS_NUMOF];
 void _tests_init(void);
 void _test_trigger_recv(gnrc_netif_t *netif, const uint8_t *data,
                         size_t data_len);
+/* as _test_trigger_recv() but the device lends its buffer with the frame */
+void _test_trigger_recv_lent(gnrc_netif_t *netif, const uint8_t *data,
+                             size_t data_len);
 
 #ifdef __cplusplus
 }
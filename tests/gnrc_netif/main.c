@@ -1515,6 +1515,29 @@ static void test_netapi_recv__ipv6_ethernet_payload(void)
     _test_trigger_recv(&ethernet_netif, data, sizeof(data));
 }
 
+static void test_netapi_recv__lent_ethernet_payload(void)
+{
+    static const uint8_t data[] = { LA1, LA2, LA3, LA6, LA7, LA8,
+        LA1, LA2, LA3, LA6, LA7, LA8 + 1,
+        0xff, 0xff, 0x12, 0x34, 0x45, 0x56 };
+
+    puts("pktdump dumping lent Ethernet packet with payload 12 34 45 56");
+    _test_trigger_recv_lent(&ethernet_netif, data, sizeof(data));
+}
+
+static void test_netapi_recv__lent_ieee802154_payload(void)
+{
+    static const uint8_t data[] = { 0x41, 0xdc, /* FCF */
+        0x03,       /* Sequence number */
+        0x00, 0x00, /* Destination PAN */
+        LA8, LA7, LA6, LA5, LA4, LA3, LA2, LA1,
+        LA8 + 1, LA7, LA6, LA5, LA4, LA3, LA2,
+        LA1, 0x12, 0x34, 0x45, 0x56 };
+
+    puts("pktdump dumping lent IEEE 802.15.4 packet with payload 12 34 45 56");
+    _test_trigger_recv_lent(&ieee802154_netif, data, sizeof(data));
+}
+
 static Test *embunit_tests_gnrc_netif(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -1637,6 +1660,8 @@ int main(void)
     test_netapi_recv__raw_ethernet_payload();
     test_netapi_recv__raw_ieee802154_payload();
     test_netapi_recv__ipv6_ethernet_payload();
+    test_netapi_recv__lent_ethernet_payload();
+    test_netapi_recv__lent_ieee802154_payload();
     return 0;
 }
 
@@ -140,6 +140,32 @@ def testfunc(child):
     child.expect("src_l2addr: 3E:E6:B5:22:FD:0B")
     child.expect("dst_l2addr: 3E:E6:B5:22:FD:0A")
     child.expect(r"~~ PKT    -  2 snips, total size:  \d+ byte")
+    # test_netapi_recv__lent_ethernet_payload
+    child.expect("pktdump dumping lent Ethernet packet with payload 12 34 45 56")
+    child.expect("PKTDUMP: data received:")
+    child.expect(r"~~ SNIP  0 - size:   4 byte, type: NETTYPE_UNDEF \(0\)")
+    child.expect("00000000  12  34  45  56")
+    child.expect(r"~~ SNIP  1 - size:  \d+ byte, type: NETTYPE_NETIF \(-1\)")
+    child.expect(r"if_pid: (\d+)  rssi: -?\d+  lqi: \d+")
+    assert 0 < int(child.match.group(1))
+    child.expect("flags: 0x0")
+    child.expect("src_l2addr: 3E:E6:B5:22:FD:0B")
+    child.expect("dst_l2addr: 3E:E6:B5:22:FD:0A")
+    child.expect(r"~~ PKT    -  2 snips, total size:  \d+ byte")
+    child.expect("Lent buffer released")
+    # test_netapi_recv__lent_ieee802154_payload
+    child.expect(r"pktdump dumping lent IEEE 802\.15\.4 packet with payload 12 34 45 56")
+    child.expect("PKTDUMP: data received:")
+    child.expect(r"~~ SNIP  0 - size:   4 byte, type: NETTYPE_UNDEF \(0\)")
+    child.expect("00000000  12  34  45  56")
+    child.expect(r"~~ SNIP  1 - size:  \d+ byte, type: NETTYPE_NETIF \(-1\)")
+    child.expect(r"if_pid: (\d+)  rssi: 0  lqi: 171")
+    assert 0 < int(child.match.group(1))
+    child.expect("flags: 0x0")
+    child.expect("src_l2addr: 3E:E6:B5:0F:19:22:FD:0B")
+    child.expect("dst_l2addr: 3E:E6:B5:0F:19:22:FD:0A")
+    child.expect(r"~~ PKT    -  2 snips, total size:  \d+ byte")
+    child.expect("Lent buffer released")
 
 
 if __name__ == "__main__":
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Runs the network protocol registry unittests with the hashed
+ *              demux index of gnrc_netreg
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ *
+ * @}
+ */
+
+#include "embUnit.h"
+#include "tests-netreg.h"
+
+int main(void)
+{
+    TESTS_START();
+    tests_netreg();
+    TESTS_END();
+
+    return 0;
+}
@@ -155,6 +155,26 @@ static void test_nib_alloc__success(void)
     TEST_ASSERT_EQUAL_INT(IFACE, _nib_onl_get_if(node));
 }
 
+/*
+ * Creates an entry and allocates it again.
+ * Expected result: gnrc_ipv6_nib_changes() changes when the entry is created,
+ * but not when the existing entry is returned
+ */
+static void test_nib_alloc__changes(void)
+{
+    _nib_onl_entry_t *node;
+    static const ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                               { .u64 = TEST_UINT64 } } };
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    TEST_ASSERT_NOT_NULL((node = _nib_onl_alloc(&addr, IFACE)));
+    node->mode |= _NC;
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    changes = gnrc_ipv6_nib_changes();
+    TEST_ASSERT(node == _nib_onl_alloc(&addr, IFACE));
+    TEST_ASSERT(changes == gnrc_ipv6_nib_changes());
+}
+
 /*
  * Creates an persistent entry and tries to clear it.
  * Expected result: _nib_onl_clear returns false and entry should still be first
@@ -349,6 +369,39 @@ static void test_nib_get__success(void)
     TEST_ASSERT(nib_alloced == nib_got);
 }
 
+/*
+ * Creates CONFIG_GNRC_IPV6_NIB_NUMOF entries with different IP addresses,
+ * removes every second one and tries to get all of them.
+ * Expected result: _nib_onl_get() returns the remaining entries and NULL for
+ * the removed ones
+ */
+static void test_nib_get__success_full(void)
+{
+    _nib_onl_entry_t *nodes[CONFIG_GNRC_IPV6_NIB_NUMOF];
+    ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                  { .u64 = TEST_UINT64 } } };
+
+    for (int i = 0; i < CONFIG_GNRC_IPV6_NIB_NUMOF; i++) {
+        TEST_ASSERT_NOT_NULL((nodes[i] = _nib_onl_alloc(&addr, IFACE)));
+        nodes[i]->mode = _NC;
+        addr.u64[1].u64++;
+    }
+    for (int i = 0; i < CONFIG_GNRC_IPV6_NIB_NUMOF; i += 2) {
+        nodes[i]->mode = _EMPTY;
+        _nib_onl_clear(nodes[i]);
+    }
+    addr.u64[1].u64 = TEST_UINT64;
+    for (int i = 0; i < CONFIG_GNRC_IPV6_NIB_NUMOF; i++) {
+        if (i % 2) {
+            TEST_ASSERT(nodes[i] == _nib_onl_get(&addr, IFACE));
+        }
+        else {
+            TEST_ASSERT_NULL(_nib_onl_get(&addr, IFACE));
+        }
+        addr.u64[1].u64++;
+    }
+}
+
 /*
  * Tries to get a NIB entry that is not in the NIB.
  * Expected result: _nib_onl_get() returns NULL
@@ -700,6 +753,25 @@ static void test_nib_drl_add__success(void)
     TEST_ASSERT_EQUAL_INT(IFACE, _nib_onl_get_if(nib_dr->next_hop));
 }
 
+/*
+ * Creates a default router list entry and adds it again.
+ * Expected result: gnrc_ipv6_nib_changes() changes when the entry is created,
+ * but not when the existing entry is returned
+ */
+static void test_nib_drl_add__changes(void)
+{
+    _nib_dr_entry_t *nib_dr;
+    static const ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                               { .u64 = TEST_UINT64 } } };
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    TEST_ASSERT_NOT_NULL((nib_dr = _nib_drl_add(&addr, IFACE)));
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    changes = gnrc_ipv6_nib_changes();
+    TEST_ASSERT(nib_dr == _nib_drl_add(&addr, IFACE));
+    TEST_ASSERT(changes == gnrc_ipv6_nib_changes());
+}
+
 /*
  * Creates a default router list entry, sets another flag, and tries to remove
  * it.
@@ -1021,6 +1093,36 @@ static void test_nib_drl_get_dr__success4(void)
     TEST_ASSERT(nib_res != node2);
 }
 
+/*
+ * Gets the default router from a list of one unreachable router, then from a
+ * list of two unreachable routers.
+ * Expected result: gnrc_ipv6_nib_changes() changes when the router returned
+ * changes, but not when the same unreachable router is returned again
+ */
+static void test_nib_drl_get_dr__changes(void)
+{
+    _nib_dr_entry_t *node1, *node2;
+    ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                  { .u64 = TEST_UINT64 } } };
+    uint32_t changes;
+
+    TEST_ASSERT_NOT_NULL((node1 = _nib_drl_add(&addr, IFACE)));
+    node1->next_hop->info = GNRC_IPV6_NIB_NC_INFO_NUD_STATE_UNREACHABLE;
+    changes = gnrc_ipv6_nib_changes();
+    TEST_ASSERT(node1 == _nib_drl_get_dr());
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    changes = gnrc_ipv6_nib_changes();
+    TEST_ASSERT(node1 == _nib_drl_get_dr());
+    TEST_ASSERT(node1 == _nib_drl_get_dr());
+    TEST_ASSERT(changes == gnrc_ipv6_nib_changes());
+    addr.u64[1].u64++;
+    TEST_ASSERT_NOT_NULL((node2 = _nib_drl_add(&addr, IFACE)));
+    node2->next_hop->info = GNRC_IPV6_NIB_NC_INFO_NUD_STATE_INCOMPLETE;
+    changes = gnrc_ipv6_nib_changes();
+    TEST_ASSERT(node2 == _nib_drl_get_dr());
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+}
+
 #if CONFIG_GNRC_IPV6_NIB_NUMOF < CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF
 #define MAX_NUMOF   (CONFIG_GNRC_IPV6_NIB_NUMOF)
 #else /* CONFIG_GNRC_IPV6_NIB_NUMOF < CONFIG_GNRC_IPV6_NIB_OFFL_NUMOF */
@@ -1714,6 +1816,34 @@ static void test_nib_pl_remove(void)
     TEST_ASSERT_NULL(_nib_offl_iter(NULL));
 }
 
+/*
+ * Creates two nested prefix list entries, the shorter one first, and one
+ * without the on-link flag, then tries to get the on-link prefix of an address
+ * within all three.
+ * Expected result: _nib_pl_get_on_link() returns the first on-link entry
+ */
+static void test_nib_pl_get_on_link__success(void)
+{
+    _nib_offl_entry_t *dst1, *dst2, *dst3;
+    static const ipv6_addr_t pfx = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                              { .u64 = TEST_UINT64 } } };
+
+    TEST_ASSERT_NOT_NULL((dst1 = _nib_pl_add(IFACE, &pfx, GLOBAL_PREFIX_LEN,
+                                             UINT32_MAX, UINT32_MAX)));
+    TEST_ASSERT_NOT_NULL((dst2 = _nib_pl_add(IFACE, &pfx, 64,
+                                             UINT32_MAX, UINT32_MAX)));
+    TEST_ASSERT_NOT_NULL((dst3 = _nib_pl_add(IFACE, &pfx, 128,
+                                             UINT32_MAX, UINT32_MAX)));
+    TEST_ASSERT_NULL(_nib_pl_get_on_link(&pfx));
+    dst2->flags |= _PFX_ON_LINK;
+    dst3->flags |= _PFX_ON_LINK;
+    TEST_ASSERT(dst2 == _nib_pl_get_on_link(&pfx));
+    dst1->flags |= _PFX_ON_LINK;
+    TEST_ASSERT(dst1 == _nib_pl_get_on_link(&pfx));
+    _nib_pl_remove(dst1);
+    TEST_ASSERT(dst2 == _nib_pl_get_on_link(&pfx));
+}
+
 /*
  * Creates a forwarding table entry.
  * Expected result: new entry should contain the given address and interface
@@ -2010,6 +2140,7 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
         new_TestFixture(test_nib_alloc__success_duplicate),
         new_TestFixture(test_nib_alloc__success_noaddr_override),
         new_TestFixture(test_nib_alloc__success),
+        new_TestFixture(test_nib_alloc__changes),
         new_TestFixture(test_nib_clear__persistent),
         new_TestFixture(test_nib_clear__non_persistent_but_content),
         new_TestFixture(test_nib_clear__empty),
@@ -2021,6 +2152,7 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
         new_TestFixture(test_nib_get__empty),
         new_TestFixture(test_nib_get__not_in_nib),
         new_TestFixture(test_nib_get__success),
+        new_TestFixture(test_nib_get__success_full),
         new_TestFixture(test_nib_nc_add__no_space_left_diff_addr),
         new_TestFixture(test_nib_nc_add__no_space_left_diff_iface),
         new_TestFixture(test_nib_nc_add__no_space_left_diff_addr_iface),
@@ -2037,6 +2169,7 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
         new_TestFixture(test_nib_drl_add__no_space_left_nib_full),
         new_TestFixture(test_nib_drl_add__success_duplicate),
         new_TestFixture(test_nib_drl_add__success),
+        new_TestFixture(test_nib_drl_add__changes),
         new_TestFixture(test_nib_drl_remove__uncleared),
         new_TestFixture(test_nib_drl_remove__cleared),
         new_TestFixture(test_nib_drl_iter__empty),
@@ -2053,6 +2186,7 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
         new_TestFixture(test_nib_drl_get_dr__success2),
         new_TestFixture(test_nib_drl_get_dr__success3),
         new_TestFixture(test_nib_drl_get_dr__success4),
+        new_TestFixture(test_nib_drl_get_dr__changes),
         new_TestFixture(test_nib_offl_alloc__no_space_left_diff_next_hop),
         new_TestFixture(test_nib_offl_alloc__no_space_left_diff_iface),
         new_TestFixture(test_nib_offl_alloc__no_space_left_diff_next_hop_iface),
@@ -2084,6 +2218,7 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
 #endif
         new_TestFixture(test_nib_pl_add__success),
         new_TestFixture(test_nib_pl_remove),
+        new_TestFixture(test_nib_pl_get_on_link__success),
         new_TestFixture(test_nib_ft_add__success),
         new_TestFixture(test_nib_ft_remove),
 #if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_MULTIHOP_P6C)
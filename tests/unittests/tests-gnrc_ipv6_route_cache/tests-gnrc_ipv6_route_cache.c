@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @author  Koen Zandberg <koen@bergzand.net>
+ */
+
+#include <string.h>
+
+#include "embUnit.h"
+#include "kernel_defines.h"
+
+#include "net/gnrc/ipv6/nib.h"
+#include "net/gnrc/ipv6/nib/ft.h"
+#include "net/gnrc/ipv6/nib/nc.h"
+#include "net/gnrc/ipv6/route_cache.h"
+
+#include "unittests-constants.h"
+#include "tests-gnrc_ipv6_route_cache.h"
+
+#define GLOBAL_PREFIX       { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0 }
+#define REMOTE_PREFIX       { 0x20, 0x01, 0x0d, 0xb8, 0xde, 0xad, 0, 0 }
+#define L2ADDR              { 0x90, 0xd5, 0x8e, 0x8c, 0x92, 0x43, 0x73, 0x5c }
+#define IFACE               (6)
+
+static const ipv6_addr_t _nbr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                           { .u64 = TEST_UINT64 } } };
+static const ipv6_addr_t _dst = { .u64 = { { .u8 = REMOTE_PREFIX },
+                                           { .u64 = TEST_UINT64 } } };
+static const uint8_t _l2addr[] = L2ADDR;
+
+/* the route cache only compares and returns the interfaces, so they do not
+ * need to be set up */
+static gnrc_netif_t _netif;
+static gnrc_netif_t _other_netif;
+static gnrc_ipv6_nib_nc_t _nce;
+
+static void set_up(void)
+{
+    void *state = NULL;
+
+    gnrc_ipv6_nib_init();
+    memset(&_netif, 0, sizeof(_netif));
+    memset(&_other_netif, 0, sizeof(_other_netif));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_nc_set(&_nbr, IFACE, _l2addr,
+                                                  sizeof(_l2addr)));
+    TEST_ASSERT(gnrc_ipv6_nib_nc_iter(0, &state, &_nce));
+}
+
+/*
+ * Looks up a destination that was never added.
+ * Expected result: gnrc_ipv6_route_cache_get() returns NULL
+ */
+static void test_route_cache_get__empty(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL,
+                                               gnrc_ipv6_nib_changes(),
+                                               &nce));
+}
+
+/*
+ * Adds a next hop for a destination and looks the destination up with the
+ * same number of NIB changes.
+ * Expected result: the interface and next hop added are returned
+ */
+static void test_route_cache_get__hit(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    TEST_ASSERT(&_netif == gnrc_ipv6_route_cache_get(&_dst, NULL, changes,
+                                                     &nce));
+    TEST_ASSERT(ipv6_addr_equal(&_nbr, &nce.ipv6));
+    TEST_ASSERT_EQUAL_INT(sizeof(_l2addr), nce.l2addr_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_l2addr, nce.l2addr, sizeof(_l2addr)));
+    TEST_ASSERT_EQUAL_INT(IFACE, gnrc_ipv6_nib_nc_get_iface(&nce));
+}
+
+/*
+ * Adds a default route to the NIB and resolves the next hop to a destination
+ * for two packets the way gnrc_ipv6 does, adding it to the cache after each.
+ * Expected result: resolving the next hop does not change the NIB once the
+ * default router is selected, so a third packet hits the cache
+ */
+static void test_route_cache_get__def_router(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+
+    _netif.pid = IFACE;
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_add(NULL, 0, &_nbr, IFACE,
+                                                  0));
+    for (unsigned i = 0; i < 2; i++) {
+        uint32_t changes = gnrc_ipv6_nib_changes();
+
+        TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_get_next_hop_l2addr(&_dst,
+                                                                   &_netif,
+                                                                   NULL,
+                                                                   &nce));
+        TEST_ASSERT(ipv6_addr_equal(&_nbr, &nce.ipv6));
+        gnrc_ipv6_route_cache_add(&_dst, &_netif, &_netif, &nce, changes);
+    }
+    memset(&nce, 0, sizeof(nce));
+    TEST_ASSERT(&_netif == gnrc_ipv6_route_cache_get(&_dst, &_netif,
+                                                     gnrc_ipv6_nib_changes(),
+                                                     &nce));
+    TEST_ASSERT(ipv6_addr_equal(&_nbr, &nce.ipv6));
+}
+
+/*
+ * Adds a next hop for a destination and looks up another destination.
+ * Expected result: gnrc_ipv6_route_cache_get() returns NULL
+ */
+static void test_route_cache_get__miss_dst(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    ipv6_addr_t dst = _dst;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    dst.u8[15]++;
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&dst, NULL, changes, &nce));
+}
+
+/*
+ * Adds a next hop for a destination without a requested interface and looks
+ * the destination up with a requested interface.
+ * Expected result: gnrc_ipv6_route_cache_get() returns NULL
+ */
+static void test_route_cache_get__miss_iface(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, &_netif, changes,
+                                               &nce));
+}
+
+/*
+ * Adds a next hop for a destination, then adds a default route to the NIB.
+ * Expected result: the NIB changes and gnrc_ipv6_route_cache_get() returns
+ * NULL
+ */
+static void test_route_cache_get__route_added(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_add(NULL, 0, &_nbr, IFACE,
+                                                  0));
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL,
+                                               gnrc_ipv6_nib_changes(),
+                                               &nce));
+}
+
+/*
+ * Adds a default route to the NIB and a next hop for a destination, then
+ * removes the default route from the NIB.
+ * Expected result: the NIB changes and gnrc_ipv6_route_cache_get() returns
+ * NULL
+ */
+static void test_route_cache_get__route_removed(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint32_t changes;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_add(NULL, 0, &_nbr, IFACE,
+                                                  0));
+    changes = gnrc_ipv6_nib_changes();
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    gnrc_ipv6_nib_ft_del(NULL, 0);
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL,
+                                               gnrc_ipv6_nib_changes(),
+                                               &nce));
+}
+
+/*
+ * Adds a next hop for a destination, then changes the link-layer address of
+ * the next hop in the NIB.
+ * Expected result: the NIB changes and gnrc_ipv6_route_cache_get() returns
+ * NULL
+ */
+static void test_route_cache_get__nbr_changed(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint8_t l2addr[] = L2ADDR;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    l2addr[7]++;
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_nc_set(&_nbr, IFACE, l2addr,
+                                                  sizeof(l2addr)));
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL,
+                                               gnrc_ipv6_nib_changes(),
+                                               &nce));
+}
+
+/*
+ * Adds a next hop for a destination, then removes the next hop from the NIB.
+ * Expected result: the NIB changes and gnrc_ipv6_route_cache_get() returns
+ * NULL
+ */
+static void test_route_cache_get__nbr_removed(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &_nce, changes);
+    gnrc_ipv6_nib_nc_del(&_nbr, IFACE);
+    TEST_ASSERT(changes != gnrc_ipv6_nib_changes());
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL,
+                                               gnrc_ipv6_nib_changes(),
+                                               &nce));
+}
+
+/*
+ * Adds next hops for CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE + 1 destinations.
+ * Expected result: the first destination was replaced, the others are still
+ * cached
+ */
+static void test_route_cache_add__full(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    ipv6_addr_t dst = _dst;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    for (unsigned i = 0; i <= CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE; i++) {
+        gnrc_ipv6_route_cache_add(&dst, NULL, &_netif, &_nce, changes);
+        dst.u8[15]++;
+    }
+    dst = _dst;
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&dst, NULL, changes, &nce));
+    for (unsigned i = 0; i < CONFIG_GNRC_IPV6_ROUTE_CACHE_SIZE; i++) {
+        dst.u8[15]++;
+        TEST_ASSERT(&_netif == gnrc_ipv6_route_cache_get(&dst, NULL, changes,
+                                                         &nce));
+    }
+}
+
+/*
+ * Adds a next hop whose reachability is not confirmed.
+ * Expected result: with address resolution, the next hop is not cached
+ */
+static void test_route_cache_add__stale(void)
+{
+    gnrc_ipv6_nib_nc_t nce = _nce;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    nce.info &= ~GNRC_IPV6_NIB_NC_INFO_NUD_STATE_MASK;
+    nce.info |= GNRC_IPV6_NIB_NC_INFO_NUD_STATE_STALE;
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_netif, &nce, changes);
+    if (IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ARSM)) {
+        TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL, changes,
+                                                   &nce));
+    }
+    else {
+        TEST_ASSERT(&_netif == gnrc_ipv6_route_cache_get(&_dst, NULL,
+                                                         changes, &nce));
+    }
+}
+
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ROUTER)
+static void _route_info_cb(unsigned type, const ipv6_addr_t *ctx_addr,
+                           const void *ctx)
+{
+    (void)type;
+    (void)ctx_addr;
+    (void)ctx;
+}
+
+/*
+ * Adds a next hop on an interface with a route info callback.
+ * Expected result: the next hop is not cached
+ */
+static void test_route_cache_add__route_info_cb(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    uint32_t changes = gnrc_ipv6_nib_changes();
+
+    _other_netif.ipv6.route_info_cb = _route_info_cb;
+    gnrc_ipv6_route_cache_add(&_dst, NULL, &_other_netif, &_nce, changes);
+    TEST_ASSERT_NULL(gnrc_ipv6_route_cache_get(&_dst, NULL, changes, &nce));
+}
+#endif  /* CONFIG_GNRC_IPV6_NIB_ROUTER */
+
+Test *tests_gnrc_ipv6_route_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_route_cache_get__empty),
+        new_TestFixture(test_route_cache_get__hit),
+        new_TestFixture(test_route_cache_get__def_router),
+        new_TestFixture(test_route_cache_get__miss_dst),
+        new_TestFixture(test_route_cache_get__miss_iface),
+        new_TestFixture(test_route_cache_get__route_added),
+        new_TestFixture(test_route_cache_get__route_removed),
+        new_TestFixture(test_route_cache_get__nbr_changed),
+        new_TestFixture(test_route_cache_get__nbr_removed),
+        new_TestFixture(test_route_cache_add__full),
+        new_TestFixture(test_route_cache_add__stale),
+#if IS_ACTIVE(CONFIG_GNRC_IPV6_NIB_ROUTER)
+        new_TestFixture(test_route_cache_add__route_info_cb),
+#endif
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_ipv6_route_cache_tests, set_up, NULL, fixtures);
+
+    return (Test *)&gnrc_ipv6_route_cache_tests;
+}
+
+void tests_gnrc_ipv6_route_cache(void)
+{
+    TESTS_RUN(tests_gnrc_ipv6_route_cache_tests());
+}
+/** @} */
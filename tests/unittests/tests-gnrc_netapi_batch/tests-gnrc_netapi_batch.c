@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @author  Koen Zandberg <koen@bergzand.net>
+ */
+
+#include "embUnit.h"
+#include "kernel_defines.h"
+
+#include "msg.h"
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netreg.h"
+#include "net/gnrc/pktbuf.h"
+#include "thread.h"
+
+#include "unittests-constants.h"
+#include "tests-gnrc_netapi_batch.h"
+
+/* the test thread receives the packets it dispatches itself */
+#define CTX_BATCH           (TEST_UINT16)
+#define CTX_OTHER           (TEST_UINT16 + 1)
+#define CTX_PID             (TEST_UINT16 + 2)
+#define MSG_QUEUE_SIZE      (8U)
+
+static msg_t _msg_queue[MSG_QUEUE_SIZE];
+static gnrc_netapi_batch_t _batch;
+static gnrc_netreg_entry_t _batch_entry;
+static gnrc_netreg_entry_t _other_entry;
+static gnrc_netreg_entry_t _pid_entry;
+
+static void set_up(void)
+{
+    gnrc_netreg_entry_t batch_entry = GNRC_NETREG_ENTRY_INIT_BATCH(CTX_BATCH,
+                                                                   thread_getpid());
+    gnrc_netreg_entry_t other_entry = GNRC_NETREG_ENTRY_INIT_BATCH(CTX_OTHER,
+                                                                   thread_getpid());
+    gnrc_netreg_entry_t pid_entry = GNRC_NETREG_ENTRY_INIT_PID(CTX_PID,
+                                                               thread_getpid());
+
+    msg_init_queue(_msg_queue, MSG_QUEUE_SIZE);
+    gnrc_pktbuf_init();
+    gnrc_netreg_init();
+    _batch_entry = batch_entry;
+    _other_entry = other_entry;
+    _pid_entry = pid_entry;
+    gnrc_netreg_register(GNRC_NETTYPE_TEST, &_batch_entry);
+    gnrc_netreg_register(GNRC_NETTYPE_TEST, &_other_entry);
+    gnrc_netreg_register(GNRC_NETTYPE_TEST, &_pid_entry);
+    gnrc_netapi_batch_init(&_batch);
+}
+
+static void tear_down(void)
+{
+    gnrc_netapi_batch_init(NULL);
+}
+
+static gnrc_pktsnip_t *_pkt(void)
+{
+    return gnrc_pktbuf_add(NULL, NULL, 1, GNRC_NETTYPE_TEST);
+}
+
+static void _receive(msg_t *msg, uint16_t type)
+{
+    TEST_ASSERT_EQUAL_INT(1, msg_try_receive(msg));
+    TEST_ASSERT_EQUAL_INT(type, msg->type);
+}
+
+/* Releases the packets of a received batch and the batch */
+static void _release_batch(gnrc_pktsnip_t *batch)
+{
+    for (unsigned i = 0; i < gnrc_netapi_batch_numof(batch); i++) {
+        gnrc_pktbuf_release(gnrc_netapi_batch_get(batch, i));
+    }
+    gnrc_pktbuf_release(batch);
+}
+
+/*
+ * Dispatches one packet and flushes.
+ * Expected result: the packet is passed on in a plain
+ * GNRC_NETAPI_MSG_TYPE_RCV message after the flush only
+ */
+static void test_batch_flush__single(void)
+{
+    gnrc_pktsnip_t *pkt = _pkt();
+    msg_t msg;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, pkt));
+    TEST_ASSERT_EQUAL_INT(0, msg_avail());
+    gnrc_netapi_batch_flush();
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV);
+    TEST_ASSERT(msg.content.ptr == pkt);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches three packets and flushes.
+ * Expected result: the packets are passed on in order in one
+ * GNRC_NETAPI_MSG_TYPE_RCV_BATCH message
+ */
+static void test_batch_flush__batch(void)
+{
+    gnrc_pktsnip_t *pkts[3];
+    msg_t msg;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(pkts); i++) {
+        TEST_ASSERT_NOT_NULL((pkts[i] = _pkt()));
+        TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                              CTX_BATCH,
+                                                              pkts[i]));
+    }
+    TEST_ASSERT_EQUAL_INT(0, msg_avail());
+    gnrc_netapi_batch_flush();
+    TEST_ASSERT_EQUAL_INT(1, msg_avail());
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV_BATCH);
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(pkts),
+                          gnrc_netapi_batch_numof(msg.content.ptr));
+    for (unsigned i = 0; i < ARRAY_SIZE(pkts); i++) {
+        TEST_ASSERT(gnrc_netapi_batch_get(msg.content.ptr, i) == pkts[i]);
+    }
+    _release_batch(msg.content.ptr);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches CONFIG_GNRC_NETAPI_BATCH_SIZE packets.
+ * Expected result: the full batch is passed on without a flush
+ */
+static void test_batch_collect__full(void)
+{
+    msg_t msg;
+
+    for (unsigned i = 0; i < CONFIG_GNRC_NETAPI_BATCH_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(0, msg_avail());
+        TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                              CTX_BATCH,
+                                                              _pkt()));
+    }
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV_BATCH);
+    TEST_ASSERT_EQUAL_INT(CONFIG_GNRC_NETAPI_BATCH_SIZE,
+                          gnrc_netapi_batch_numof(msg.content.ptr));
+    _release_batch(msg.content.ptr);
+    gnrc_netapi_batch_flush();
+    TEST_ASSERT_EQUAL_INT(0, msg_avail());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches two packets, then one to another batch target.
+ * Expected result: the first two are passed on as a batch, the third one
+ * after the flush
+ */
+static void test_batch_collect__other_target(void)
+{
+    gnrc_pktsnip_t *pkt = _pkt();
+    msg_t msg;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_OTHER, pkt));
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV_BATCH);
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netapi_batch_numof(msg.content.ptr));
+    _release_batch(msg.content.ptr);
+    TEST_ASSERT_EQUAL_INT(0, msg_avail());
+    gnrc_netapi_batch_flush();
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV);
+    TEST_ASSERT(msg.content.ptr == pkt);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches two packets, then one to a target registered with
+ * GNRC_NETREG_ENTRY_INIT_PID.
+ * Expected result: the batch is passed on first, the third packet right
+ * after it without a flush
+ */
+static void test_batch_collect__pid_target(void)
+{
+    gnrc_pktsnip_t *pkt = _pkt();
+    msg_t msg;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_PID, pkt));
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV_BATCH);
+    _release_batch(msg.content.ptr);
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV);
+    TEST_ASSERT(msg.content.ptr == pkt);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches a packet down the stack.
+ * Expected result: the packet is passed on right away in a plain
+ * GNRC_NETAPI_MSG_TYPE_SND message
+ */
+static void test_batch_collect__send(void)
+{
+    gnrc_pktsnip_t *pkt = _pkt();
+    msg_t msg;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_send(GNRC_NETTYPE_TEST,
+                                                       CTX_BATCH, pkt));
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_SND);
+    TEST_ASSERT(msg.content.ptr == pkt);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches two packets and polls with another message queued, then with
+ * an empty queue.
+ * Expected result: the batch is only passed on by the second poll
+ */
+static void test_batch_poll(void)
+{
+    msg_t msg = { .type = GNRC_NETAPI_MSG_TYPE_ACK };
+
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, msg_send_to_self(&msg));
+    gnrc_netapi_batch_poll();
+    TEST_ASSERT_EQUAL_INT(1, msg_avail());
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_ACK);
+    gnrc_netapi_batch_poll();
+    _receive(&msg, GNRC_NETAPI_MSG_TYPE_RCV_BATCH);
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netapi_batch_numof(msg.content.ptr));
+    _release_batch(msg.content.ptr);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+/*
+ * Dispatches two packets and flushes after the target unregistered.
+ * Expected result: the packets are released, no message is sent
+ */
+static void test_batch_flush__unregistered(void)
+{
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          CTX_BATCH, _pkt()));
+    gnrc_netreg_unregister(GNRC_NETTYPE_TEST, &_batch_entry);
+    gnrc_netapi_batch_flush();
+    TEST_ASSERT_EQUAL_INT(0, msg_avail());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static Test *tests_gnrc_netapi_batch_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_batch_flush__single),
+        new_TestFixture(test_batch_flush__batch),
+        new_TestFixture(test_batch_collect__full),
+        new_TestFixture(test_batch_collect__other_target),
+        new_TestFixture(test_batch_collect__pid_target),
+        new_TestFixture(test_batch_collect__send),
+        new_TestFixture(test_batch_poll),
+        new_TestFixture(test_batch_flush__unregistered),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_netapi_batch_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&gnrc_netapi_batch_tests;
+}
+
+void tests_gnrc_netapi_batch(void)
+{
+    TESTS_RUN(tests_gnrc_netapi_batch_tests());
+}
+/** @} */
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``gnrc_netapi_batch`` module
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+#ifndef TESTS_GNRC_NETAPI_BATCH_H
+#define TESTS_GNRC_NETAPI_BATCH_H
+
+#include "embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_gnrc_netapi_batch(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_GNRC_NETAPI_BATCH_H */
+/** @} */
@@ -18,6 +18,7 @@
 
 #include "embUnit.h"
 
+#include "kernel_defines.h"
 #include "net/gnrc/nettype.h"
 #include "net/gnrc/pkt.h"
 #include "net/gnrc/pktbuf.h"
@@ -202,6 +203,9 @@ static void test_pktbuf_add__memfull(void)
 }
 #endif
 
+/* nine tenths of the packet buffer don't fit into the arena left by size
+ * classes */
+#ifndef MODULE_GNRC_PKTBUF_STATIC_CLASSES
 static void test_pktbuf_add__success(void)
 {
     gnrc_pktsnip_t *pkt, *pkt_prev = NULL;
@@ -225,6 +229,7 @@ static void test_pktbuf_add__success(void)
     }
     TEST_ASSERT(gnrc_pktbuf_is_sane());
 }
+#endif
 
 static void test_pktbuf_add__packed_struct(void)
 {
@@ -245,7 +250,10 @@ static void test_pktbuf_add__packed_struct(void)
     TEST_ASSERT_EQUAL_INT(data.s64, data_cpy->s64);
 }
 
-#ifndef MODULE_GNRC_PKTBUF_MALLOC   /* alignment-handling left to malloc, so no certainty here */
+/* alignment-handling left to malloc, so no certainty here, size classes reuse
+ * the slot */
+#if !defined(MODULE_GNRC_PKTBUF_MALLOC) && \
+    !defined(MODULE_GNRC_PKTBUF_STATIC_CLASSES)
 static void test_pktbuf_add__unaligned_in_aligned_hole(void)
 {
     gnrc_pktsnip_t *pkt1 = gnrc_pktbuf_add(NULL, NULL, 8, GNRC_NETTYPE_TEST);
@@ -813,7 +821,9 @@ static void test_pktbuf_start_write__pkt_users_2(void)
     TEST_ASSERT(gnrc_pktbuf_is_empty());
 }
 
-#ifndef MODULE_GNRC_PKTBUF_MALLOC
+/* fills the packet buffer assuming a single first-fit arena */
+#if !defined(MODULE_GNRC_PKTBUF_MALLOC) && \
+    !defined(MODULE_GNRC_PKTBUF_STATIC_CLASSES)
 static void test_pktbuf_reverse_snips__too_full(void)
 {
     gnrc_pktsnip_t *pkt, *pkt_next, *pkt_huge;
@@ -852,6 +862,199 @@ static void test_pktbuf_reverse_snips__success(void)
     TEST_ASSERT(gnrc_pktbuf_is_empty());
 }
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+/* The classes are laid out from the start of the packet buffer, their free
+ * slots are handed out in address order after gnrc_pktbuf_init() */
+static uint8_t *_hdr_slots(void)
+{
+    gnrc_pktsnip_t *snip1 = gnrc_pktbuf_add(NULL, NULL, 0, GNRC_NETTYPE_TEST);
+    gnrc_pktsnip_t *snip2 = gnrc_pktbuf_add(NULL, NULL, 0, GNRC_NETTYPE_TEST);
+    size_t snip_slot = (uint8_t *)snip2 - (uint8_t *)snip1;
+
+    gnrc_pktbuf_release(snip1);
+    gnrc_pktbuf_release(snip2);
+    return ((uint8_t *)snip1) +
+           (snip_slot * CONFIG_GNRC_PKTBUF_STATIC_SNIP_NUMOF);
+}
+
+static void test_pktbuf_classes__select(void)
+{
+    uint8_t *hdrs = _hdr_slots();
+    uint8_t *arena = hdrs +
+        (CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE * CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF) +
+        (CONFIG_GNRC_PKTBUF_STATIC_MTU_SIZE * CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF);
+    gnrc_pktsnip_t *hdr, *payload, *big;
+
+    hdr = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                          GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT((uint8_t *)hdr < hdrs);
+    TEST_ASSERT(hdr->data == hdrs);
+    payload = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE + 1,
+                              GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(payload);
+#if CONFIG_GNRC_PKTBUF_STATIC_MTU_NUMOF
+    TEST_ASSERT(payload->data == hdrs + (CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE *
+                                         CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF));
+#else
+    TEST_ASSERT(payload->data == arena);
+#endif
+    /* fits no class */
+    big = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_MTU_SIZE + 1,
+                          GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT((uint8_t *)big->data >= arena);
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    gnrc_pktbuf_release(hdr);
+    gnrc_pktbuf_release(payload);
+    gnrc_pktbuf_release(big);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_pktbuf_classes__fallback(void)
+{
+    uint8_t *hdrs = _hdr_slots();
+    uint8_t *hdrs_end = hdrs +
+        (CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE * CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF);
+    gnrc_pktsnip_t *pkts[CONFIG_GNRC_PKTBUF_STATIC_HDR_NUMOF + 1];
+
+    for (unsigned i = 0; i < ARRAY_SIZE(pkts); i++) {
+        pkts[i] = gnrc_pktbuf_add(NULL, TEST_STRING64,
+                                  CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                                  GNRC_NETTYPE_TEST);
+        TEST_ASSERT_NOT_NULL(pkts[i]);
+    }
+    /* the class is full, the last one goes to the arena */
+    TEST_ASSERT((uint8_t *)pkts[ARRAY_SIZE(pkts) - 2]->data < hdrs_end);
+    TEST_ASSERT((uint8_t *)pkts[ARRAY_SIZE(pkts) - 1]->data >= hdrs_end);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(TEST_STRING64, pkts[ARRAY_SIZE(pkts) - 1]->data,
+                                    CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+
+    /* a released slot is used again */
+    void *slot = pkts[0]->data;
+    gnrc_pktbuf_release(pkts[0]);
+    pkts[0] = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                              GNRC_NETTYPE_TEST);
+    TEST_ASSERT(pkts[0]->data == slot);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(pkts); i++) {
+        gnrc_pktbuf_release(pkts[i]);
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_pktbuf_classes__partial_free(void)
+{
+    uint8_t *hdrs = _hdr_slots();
+    gnrc_pktsnip_t *pkt, *hdr, *other;
+
+    pkt = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                          GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT(pkt->data == hdrs);
+    /* split in place, half of the slot is freed with the header */
+    hdr = gnrc_pktbuf_mark(pkt, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE / 2,
+                           GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT(hdr->data == hdrs);
+    pkt = gnrc_pktbuf_remove_snip(pkt, hdr);
+    other = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                            GNRC_NETTYPE_TEST);
+    TEST_ASSERT(other->data != hdrs);
+    gnrc_pktbuf_release(other);
+
+    /* shrinking frees the tail, the slot stays in use */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_realloc_data(pkt, 1));
+    other = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                            GNRC_NETTYPE_TEST);
+    TEST_ASSERT(other->data != hdrs);
+    gnrc_pktbuf_release(other);
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+
+    /* the slot is free again once all of its bytes are */
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+    other = gnrc_pktbuf_add(NULL, NULL, CONFIG_GNRC_PKTBUF_STATIC_HDR_SIZE,
+                            GNRC_NETTYPE_TEST);
+    TEST_ASSERT(other->data == hdrs);
+    gnrc_pktbuf_release(other);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+#endif
+
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+static unsigned _released;
+
+static void _release(void *arg, void *data)
+{
+    TEST_ASSERT(arg == &_released);
+    TEST_ASSERT_NOT_NULL(data);
+    _released++;
+}
+
+static void test_pktbuf_add_loan__success(void)
+{
+    uint8_t data[sizeof(TEST_STRING16)];
+    gnrc_pktsnip_t *pkt;
+
+    _released = 0;
+    memcpy(data, TEST_STRING16, sizeof(data));
+    pkt = gnrc_pktbuf_add_loan(NULL, data, sizeof(data), GNRC_NETTYPE_TEST,
+                               _release, &_released);
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT(pkt->data == data);
+    TEST_ASSERT_EQUAL_INT(sizeof(data), pkt->size);
+    TEST_ASSERT(!gnrc_pktbuf_is_empty());
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT_EQUAL_INT(1, _released);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_pktbuf_add_loan__mark_realloc(void)
+{
+    uint8_t data[sizeof(TEST_STRING64)];
+    gnrc_pktsnip_t *pkt, *hdr;
+
+    _released = 0;
+    pkt = gnrc_pktbuf_add_loan(NULL, data, sizeof(data), GNRC_NETTYPE_TEST,
+                               _release, &_released);
+    TEST_ASSERT_NOT_NULL(pkt);
+    /* unaligned, but lent data is split in place */
+    hdr = gnrc_pktbuf_mark(pkt, 7, GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT(hdr->data == data);
+    TEST_ASSERT(pkt->data == &data[7]);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_realloc_data(pkt, 9));
+    TEST_ASSERT(pkt->data == &data[7]);
+    TEST_ASSERT_EQUAL_INT(9, pkt->size);
+    gnrc_pktbuf_remove_snip(pkt, hdr);
+    TEST_ASSERT_EQUAL_INT(0, _released);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT_EQUAL_INT(1, _released);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_pktbuf_add_loan__realloc_grow(void)
+{
+    uint8_t data[sizeof(TEST_STRING8)];
+    gnrc_pktsnip_t *pkt;
+
+    _released = 0;
+    memcpy(data, TEST_STRING8, sizeof(data));
+    pkt = gnrc_pktbuf_add_loan(NULL, data, sizeof(data), GNRC_NETTYPE_TEST,
+                               _release, &_released);
+    TEST_ASSERT_NOT_NULL(pkt);
+    /* moves the data into the packet buffer and returns the loan */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_realloc_data(pkt, sizeof(TEST_STRING16)));
+    TEST_ASSERT_EQUAL_INT(1, _released);
+    TEST_ASSERT(pkt->data != data);
+    TEST_ASSERT_EQUAL_STRING(TEST_STRING8, pkt->data);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+#endif
+
 Test *tests_pktbuf_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -866,9 +1069,12 @@ Test *tests_pktbuf_tests(void)
 #ifndef MODULE_GNRC_PKTBUF_MALLOC
         new_TestFixture(test_pktbuf_add__memfull),
 #endif
+#ifndef MODULE_GNRC_PKTBUF_STATIC_CLASSES
         new_TestFixture(test_pktbuf_add__success),
+#endif
         new_TestFixture(test_pktbuf_add__packed_struct),
-#ifndef MODULE_GNRC_PKTBUF_MALLOC
+#if !defined(MODULE_GNRC_PKTBUF_MALLOC) && \
+    !defined(MODULE_GNRC_PKTBUF_STATIC_CLASSES)
         new_TestFixture(test_pktbuf_add__unaligned_in_aligned_hole),
 #endif
         new_TestFixture(test_pktbuf_add__0_sized_release),
@@ -906,10 +1112,21 @@ Test *tests_pktbuf_tests(void)
         new_TestFixture(test_pktbuf_start_write__NULL),
         new_TestFixture(test_pktbuf_start_write__pkt_users_1),
         new_TestFixture(test_pktbuf_start_write__pkt_users_2),
-#ifndef MODULE_GNRC_PKTBUF_MALLOC
+#if !defined(MODULE_GNRC_PKTBUF_MALLOC) && \
+    !defined(MODULE_GNRC_PKTBUF_STATIC_CLASSES)
         new_TestFixture(test_pktbuf_reverse_snips__too_full),
-#endif /* MODULE_GNRC_PKTBUF_MALLOC */
+#endif
         new_TestFixture(test_pktbuf_reverse_snips__success),
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CLASSES
+        new_TestFixture(test_pktbuf_classes__select),
+        new_TestFixture(test_pktbuf_classes__fallback),
+        new_TestFixture(test_pktbuf_classes__partial_free),
+#endif
+#ifdef MODULE_GNRC_PKTBUF_STATIC_LOAN
+        new_TestFixture(test_pktbuf_add_loan__success),
+        new_TestFixture(test_pktbuf_add_loan__mark_realloc),
+        new_TestFixture(test_pktbuf_add_loan__realloc_grow),
+#endif
     };
 
     EMB_UNIT_TESTCALLER(gnrc_pktbuf_tests, set_up, NULL, fixtures);
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2020 Inria
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ztimer heap backend
+ *
+ * @author      Koen Zandberg <koen@bergzand.net>
+ */
+
+#include <string.h>
+
+#include "kernel_defines.h"
+#include "ztimer.h"
+#include "ztimer/heap.h"
+#include "ztimer/mock.h"
+
+#include "embUnit/embUnit.h"
+
+#include "tests-ztimer.h"
+
+#define TIMER_NUMOF     (24U)
+
+typedef struct {
+    ztimer_t timer;
+    ztimer_clock_t *clock;
+    uint32_t fired;
+    uint32_t fired_at;
+} _timer_t;
+
+static _timer_t _list_timers[TIMER_NUMOF];
+static _timer_t _heap_timers[TIMER_NUMOF];
+static uint32_t _order[TIMER_NUMOF];
+static unsigned _order_len;
+
+static void _cb(void *arg)
+{
+    _timer_t *t = arg;
+    t->fired++;
+    t->fired_at = ztimer_now(t->clock);
+}
+
+static void _cb_order(void *arg)
+{
+    _order[_order_len++] = (uintptr_t)arg;
+}
+
+static void _cb_count(void *arg)
+{
+    (*(unsigned *)arg)++;
+}
+
+static void _init(_timer_t *timers, ztimer_clock_t *clock)
+{
+    memset(timers, 0, sizeof(_timer_t) * TIMER_NUMOF);
+    for (unsigned i = 0; i < TIMER_NUMOF; i++) {
+        timers[i].timer.callback = _cb;
+        timers[i].timer.arg = &timers[i];
+        timers[i].clock = clock;
+    }
+}
+
+static uint32_t _rand(uint32_t *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+/**
+ * @brief   Timers expire in the order of their targets
+ */
+static void test_ztimer_heap_order(void)
+{
+    static const uint32_t offsets[] = { 500, 20, 300, 20, 0, 1000, 7, 300 };
+    static const uint32_t expected[] = { 4, 6, 1, 3, 2, 7, 0, 5 };
+    ztimer_t timers[ARRAY_SIZE(offsets)];
+    ztimer_mock_t zmock;
+    ztimer_clock_t *z = &zmock.super;
+
+    ztimer_mock_init(&zmock, 32);
+    ztimer_heap_init(z);
+    memset(timers, 0, sizeof(timers));
+    _order_len = 0;
+
+    ztimer_mock_advance(&zmock, 0xfffffe00ul);  /* wraps while running */
+    for (unsigned i = 0; i < ARRAY_SIZE(offsets); i++) {
+        timers[i].callback = _cb_order;
+        timers[i].arg = (void *)(uintptr_t)i;
+        ztimer_set(z, &timers[i], offsets[i]);
+    }
+    ztimer_mock_advance(&zmock, 1);
+    TEST_ASSERT_EQUAL_INT(1, _order_len);
+    ztimer_mock_advance(&zmock, 19);
+    TEST_ASSERT_EQUAL_INT(4, _order_len);
+    ztimer_mock_advance(&zmock, 279);
+    TEST_ASSERT_EQUAL_INT(4, _order_len);
+    ztimer_mock_advance(&zmock, 1);
+    TEST_ASSERT_EQUAL_INT(6, _order_len);
+    ztimer_mock_advance(&zmock, 1000);
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(offsets), _order_len);
+
+    /* Equal targets fire in any order */
+    if (_order[2] == 3) {
+        _order[2] = 1;
+        _order[3] = 3;
+    }
+    if (_order[4] == 7) {
+        _order[4] = 2;
+        _order[5] = 7;
+    }
+    for (unsigned i = 0; i < ARRAY_SIZE(expected); i++) {
+        TEST_ASSERT_EQUAL_INT(expected[i], _order[i]);
+    }
+}
+
+/**
+ * @brief   Stale links of an unset timer are ignored, like on a list clock
+ */
+static void test_ztimer_heap_stale(void)
+{
+    ztimer_t timer;
+    ztimer_mock_t zmock;
+    ztimer_clock_t *z = &zmock.super;
+
+    ztimer_mock_init(&zmock, 32);
+    ztimer_heap_init(z);
+    _order_len = 0;
+
+    memset(&timer, 0x5a, sizeof(timer));
+    timer.callback = _cb_order;
+    timer.arg = NULL;
+    ztimer_remove(z, &timer);
+    TEST_ASSERT_NULL(z->heap);
+
+    ztimer_set(z, &timer, 10);
+    TEST_ASSERT(z->heap == &timer.base);
+    ztimer_mock_advance(&zmock, 10);
+    TEST_ASSERT_EQUAL_INT(1, _order_len);
+    TEST_ASSERT_EQUAL_INT(ZTIMER_HEAP_UNSET, timer.base.heap_state);
+
+    /* Expired timers waiting for the handler are still set */
+    ztimer_set(z, &timer, 10);
+    ztimer_heap_advance(z, 10);
+    TEST_ASSERT_NULL(z->heap);
+    TEST_ASSERT(ztimer_heap_is_due(&timer.base));
+    ztimer_remove(z, &timer);
+    TEST_ASSERT_NULL(z->list.next);
+    TEST_ASSERT_EQUAL_INT(ZTIMER_HEAP_UNSET, timer.base.heap_state);
+}
+
+/* Checks the heap below entry, returns the number of timers in it */
+static unsigned _check(const ztimer_clock_t *clock, const ztimer_base_t *entry)
+{
+    if (!entry) {
+        return 0;
+    }
+    const ztimer_base_t *left = entry->child;
+    const ztimer_base_t *right = entry->next;
+    uint32_t key = entry->offset - clock->list.offset;
+    unsigned left_rank = left ? left->heap_rank : 0;
+    unsigned right_rank = right ? right->heap_rank : 0;
+
+    TEST_ASSERT(left_rank >= right_rank);
+    TEST_ASSERT_EQUAL_INT(right_rank + 1, entry->heap_rank);
+    if (left) {
+        TEST_ASSERT(left->prev == entry);
+        TEST_ASSERT(left->offset - clock->list.offset >= key);
+    }
+    if (right) {
+        TEST_ASSERT(right->prev == entry);
+        TEST_ASSERT(right->offset - clock->list.offset >= key);
+    }
+    return _check(clock, left) + _check(clock, right) + 1;
+}
+
+/**
+ * @brief   The right spine stays logarithmic, also for timers set in the
+ *          order they expire or in reverse
+ */
+static void test_ztimer_heap_spine(void)
+{
+    static ztimer_t timers[255];
+    ztimer_mock_t zmock;
+    ztimer_clock_t *z = &zmock.super;
+    uint32_t seed = 1;
+    unsigned expired = 0;
+
+    ztimer_mock_init(&zmock, 32);
+    ztimer_heap_init(z);
+    memset(timers, 0, sizeof(timers));
+
+    for (unsigned order = 0; order < 3; order++) {
+        for (unsigned i = 0; i < ARRAY_SIZE(timers); i++) {
+            uint32_t val = (order == 0) ? i + 1 :
+                           (order == 1) ? ARRAY_SIZE(timers) - i :
+                           _rand(&seed) % 1000 + 1;
+            timers[i].callback = _cb_count;
+            timers[i].arg = &expired;
+            ztimer_set(z, &timers[i], val);
+        }
+        TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(timers), _check(z, z->heap));
+        /* log2(255 + 1) */
+        TEST_ASSERT(z->heap->heap_rank <= 8);
+
+        /* every other timer, then the rest by expiring them */
+        for (unsigned i = 0; i < ARRAY_SIZE(timers); i += 2) {
+            ztimer_remove(z, &timers[i]);
+        }
+        TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(timers) / 2, _check(z, z->heap));
+        expired = 0;
+        ztimer_mock_advance(&zmock, 1);
+        TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(timers) / 2 - expired,
+                              _check(z, z->heap));
+        ztimer_mock_advance(&zmock, 1000);
+        TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(timers) / 2, expired);
+        TEST_ASSERT_NULL(z->heap);
+    }
+}
+
+static void _compare(unsigned width)
+{
+    ztimer_mock_t list_mock, heap_mock;
+    uint32_t seed = width;
+
+    ztimer_mock_init(&list_mock, width);
+    ztimer_mock_init(&heap_mock, width);
+    ztimer_heap_init(&heap_mock.super);
+    _init(_list_timers, &list_mock.super);
+    _init(_heap_timers, &heap_mock.super);
+
+    for (unsigned round = 0; round < 4000; round++) {
+        uint32_t r = _rand(&seed);
+        unsigned i = r % TIMER_NUMOF;
+        r /= TIMER_NUMOF;
+
+        switch (r % 4) {
+            case 0:
+            case 1:
+                r = (r / 4) % 3000;
+                ztimer_set(&list_mock.super, &_list_timers[i].timer, r);
+                ztimer_set(&heap_mock.super, &_heap_timers[i].timer, r);
+                break;
+            case 2:
+                ztimer_remove(&list_mock.super, &_list_timers[i].timer);
+                ztimer_remove(&heap_mock.super, &_heap_timers[i].timer);
+                break;
+            default:
+                r = (r / 4) % 200;
+                ztimer_mock_advance(&list_mock, r);
+                ztimer_mock_advance(&heap_mock, r);
+                break;
+        }
+        for (i = 0; i < TIMER_NUMOF; i++) {
+            TEST_ASSERT_EQUAL_INT(_list_timers[i].fired,
+                                  _heap_timers[i].fired);
+            TEST_ASSERT_EQUAL_INT(_list_timers[i].fired_at,
+                                  _heap_timers[i].fired_at);
+        }
+    }
+    ztimer_mock_advance(&list_mock, 5000);
+    ztimer_mock_advance(&heap_mock, 5000);
+    for (unsigned i = 0; i < TIMER_NUMOF; i++) {
+        TEST_ASSERT_EQUAL_INT(_list_timers[i].fired, _heap_timers[i].fired);
+    }
+    TEST_ASSERT_NULL(heap_mock.super.heap);
+    TEST_ASSERT_NULL(heap_mock.super.list.next);
+}
+
+/**
+ * @brief   A heap clock behaves like a list clock on random operations
+ */
+static void test_ztimer_heap_compare(void)
+{
+    _compare(16);
+    _compare(32);
+}
+
+Test *tests_ztimer_heap_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ztimer_heap_order),
+        new_TestFixture(test_ztimer_heap_stale),
+        new_TestFixture(test_ztimer_heap_spine),
+        new_TestFixture(test_ztimer_heap_compare),
+    };
+
+    EMB_UNIT_TESTCALLER(ztimer_tests, NULL, NULL, fixtures);
+
+    return (Test *)&ztimer_tests;
+}
+
+/** @} */
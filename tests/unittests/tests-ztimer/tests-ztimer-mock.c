@@ -249,6 +249,37 @@ static void test_ztimer_mock_set16(void)
     TEST_ASSERT_EQUAL_INT(0x100207d2, now);
 }
 
+/**
+ * @brief   Moving the first timer to a later target re-arms the alarm for the
+ *          timer that is first now
+ */
+static void test_ztimer_mock_set_later(void)
+{
+    ztimer_mock_t zmock;
+    ztimer_clock_t *z = &zmock.super;
+
+    ztimer_mock_init(&zmock, 32);
+
+    uint32_t count_a = 0;
+    uint32_t count_b = 0;
+    ztimer_t alarm_a = { .callback = cb_incr, .arg = &count_a, };
+    ztimer_t alarm_b = { .callback = cb_incr, .arg = &count_b, };
+    ztimer_set(z, &alarm_a, 100);
+    ztimer_set(z, &alarm_b, 300);
+    TEST_ASSERT_EQUAL_INT(100, zmock.target);
+
+    ztimer_set(z, &alarm_a, 500);
+    TEST_ASSERT_EQUAL_INT(300, zmock.target);
+
+    ztimer_mock_advance(&zmock, 300);
+    TEST_ASSERT_EQUAL_INT(0, count_a);
+    TEST_ASSERT_EQUAL_INT(1, count_b);
+    TEST_ASSERT_EQUAL_INT(200, zmock.target);
+    ztimer_mock_advance(&zmock, 200);
+    TEST_ASSERT_EQUAL_INT(1, count_a);
+    TEST_ASSERT_EQUAL_INT(1, count_b);
+}
+
 Test *tests_ztimer_mock_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -258,6 +289,7 @@ Test *tests_ztimer_mock_tests(void)
         new_TestFixture(test_ztimer_mock_now3),
         new_TestFixture(test_ztimer_mock_set32),
         new_TestFixture(test_ztimer_mock_set16),
+        new_TestFixture(test_ztimer_mock_set_later),
     };
 
     EMB_UNIT_TESTCALLER(ztimer_tests, NULL, NULL, fixtures);